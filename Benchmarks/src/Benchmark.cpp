@@ -0,0 +1,168 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+BenchmarkSuite::BenchmarkSuite(const BenchmarkOptions& options, std::ostream& log)
+  : m_Options(options), m_Log(log)
+{
+  m_Options.Repetitions = std::max(m_Options.Repetitions, 1u);
+}
+
+bool BenchmarkSuite::IsEnabled(const std::string& group, const std::string& name) const
+{
+  return m_Options.Filter.empty() || (group + "/" + name).find(m_Options.Filter) != std::string::npos;
+}
+
+BenchmarkResult* BenchmarkSuite::AddResult(const std::string& group, const std::string& name, uint64_t operations, std::vector<double>& samples)
+{
+  std::sort(samples.begin(), samples.end());
+  const size_t count = samples.size();
+
+  BenchmarkResult result;
+  result.Group = group;
+  result.Name = name;
+  result.Operations = operations;
+  result.Min = samples.front();
+  result.Max = samples.back();
+  result.Median = count % 2 ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) * 0.5;
+  // Nearest rank
+  result.P95 = samples[std::min(count - 1, (size_t)ceil(count * 0.95) - 1)];
+  double sum = 0.0;
+  for (double sample : samples)
+    sum += sample;
+  result.Mean = sum / count;
+  double variance = 0.0;
+  for (double sample : samples)
+    variance += (sample - result.Mean) * (sample - result.Mean);
+  result.StdDev = count > 1 ? sqrt(variance / (count - 1)) : 0.0;
+  result.Samples = std::move(samples);
+
+  std::ios::fmtflags flags = m_Log.flags();
+  std::streamsize precision = m_Log.precision();
+  m_Log << "  " << std::left << std::setw(44) << group + "/" + name << std::right << std::fixed << std::setprecision(2)
+    << std::setw(12) << result.Median << " ns/op  +-" << std::setw(5) << std::setprecision(1)
+    << (result.Median > 0.0 ? result.StdDev / result.Median * 100.0 : 0.0) << "%  min " << std::setprecision(2)
+    << result.Min << "  p95 " << result.P95 << std::defaultfloat << "  (" << result.GetThroughput() << " op/s)" << std::endl;
+  m_Log.flags(flags);
+  m_Log.precision(precision);
+
+  m_Results.push_back(std::move(result));
+  return &m_Results.back();
+}
+
+void BenchmarkSuite::AddMetric(BenchmarkResult* result, const std::string& name, double value)
+{
+  if (!result)
+    return;
+  result->Metrics.push_back({ name, value });
+  m_Log << "      " << name << ": " << value << std::endl;
+}
+
+void BenchmarkSuite::SetEnvironment(const std::string& key, const std::string& value)
+{
+  for (auto& entry : m_Environment)
+  {
+    if (entry.first == key)
+    {
+      entry.second = value;
+      return;
+    }
+  }
+  m_Environment.push_back({ key, value });
+}
+
+void BenchmarkSuite::Fail(const std::string& message)
+{
+  m_Failures.push_back(message);
+  m_Log << "FAILED: " << message << std::endl;
+}
+
+// ------------------------------- JSON -----------------------------------
+static void WriteString(std::ostream& stream, const std::string& text)
+{
+  stream << '"';
+  for (char c : text)
+  {
+    if (c == '"' || c == '\\')
+      stream << '\\' << c;
+    else if ((unsigned char)c < 0x20)
+      stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec << std::setfill(' ');
+    else
+      stream << c;
+  }
+  stream << '"';
+}
+
+// JSON has no infinities or NaNs
+static void WriteNumber(std::ostream& stream, double value)
+{
+  if (std::isfinite(value))
+    stream << value;
+  else
+    stream << "null";
+}
+
+void BenchmarkSuite::WriteJson(std::ostream& stream) const
+{
+  std::streamsize precision = stream.precision(10);
+
+  stream << "{\n  \"environment\": {";
+  for (size_t i = 0; i < m_Environment.size(); i++)
+  {
+    stream << (i ? ",\n    " : "\n    ");
+    WriteString(stream, m_Environment[i].first);
+    stream << ": ";
+    WriteString(stream, m_Environment[i].second);
+  }
+  stream << "\n  },\n  \"options\": { \"warmup\": " << m_Options.Warmup << ", \"repetitions\": " << m_Options.Repetitions << ", \"filter\": ";
+  WriteString(stream, m_Options.Filter);
+  stream << " },\n  \"failures\": [";
+  for (size_t i = 0; i < m_Failures.size(); i++)
+  {
+    stream << (i ? ", " : "");
+    WriteString(stream, m_Failures[i]);
+  }
+  stream << "],\n  \"benchmarks\": [";
+
+  for (size_t i = 0; i < m_Results.size(); i++)
+  {
+    const BenchmarkResult& result = m_Results[i];
+    stream << (i ? ",\n    {" : "\n    {") << "\n      \"group\": ";
+    WriteString(stream, result.Group);
+    stream << ",\n      \"name\": ";
+    WriteString(stream, result.Name);
+    stream << ",\n      \"operations\": " << result.Operations << ",\n      \"unit\": \"ns/op\"";
+
+    const std::pair<const char*, double> summary[] = {
+      { "min", result.Min }, { "median", result.Median }, { "mean", result.Mean }, { "stddev", result.StdDev },
+      { "p95", result.P95 }, { "max", result.Max }, { "ops_per_second", result.GetThroughput() }
+    };
+    for (const auto& entry : summary)
+    {
+      stream << ",\n      \"" << entry.first << "\": ";
+      WriteNumber(stream, entry.second);
+    }
+
+    stream << ",\n      \"samples\": [";
+    for (size_t s = 0; s < result.Samples.size(); s++)
+    {
+      stream << (s ? ", " : "");
+      WriteNumber(stream, result.Samples[s]);
+    }
+    stream << "],\n      \"metrics\": {";
+    for (size_t m = 0; m < result.Metrics.size(); m++)
+    {
+      stream << (m ? ", " : " ");
+      WriteString(stream, result.Metrics[m].first);
+      stream << ": ";
+      WriteNumber(stream, result.Metrics[m].second);
+    }
+    stream << (result.Metrics.empty() ? "}" : " }") << "\n    }";
+  }
+  stream << "\n  ]\n}\n";
+
+  stream.precision(precision);
+}
+// ------------------------------------------------------------------------
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal benchmark harness. Every benchmark is a function that performs
+// a known number of operations per call; it's called Warmup times untimed,
+// then Repetitions times timed, and the per-operation times are summarized.
+// Results are printed as a table and optionally written as JSON, so runs
+// of different commits can be compared by a script.
+
+struct BenchmarkOptions
+{
+  unsigned int Warmup = 3;
+  unsigned int Repetitions = 20;
+  // Only benchmarks whose "group/name" contains this run, empty for all
+  std::string Filter;
+};
+
+struct BenchmarkResult
+{
+  std::string Group;
+  std::string Name;
+  uint64_t Operations = 0;  // Per repetition
+  std::vector<double> Samples;  // ns per operation, one per repetition, sorted
+  // Summary of Samples
+  double Min = 0.0, Median = 0.0, Mean = 0.0, StdDev = 0.0, P95 = 0.0, Max = 0.0;
+  // Extra numbers, e.g. bytes per operation or the error against a reference
+  std::vector<std::pair<std::string, double>> Metrics;
+
+  // Operations per second at the median time
+  inline double GetThroughput() const { return Median > 0.0 ? 1e9 / Median : 0.0; }
+};
+
+class BenchmarkSuite
+{
+private:
+  BenchmarkOptions m_Options;
+  std::ostream& m_Log;
+  std::vector<BenchmarkResult> m_Results;
+  // Environment of the run, written into the JSON as strings
+  std::vector<std::pair<std::string, std::string>> m_Environment;
+  std::vector<std::string> m_Failures;
+public:
+  BenchmarkSuite(const BenchmarkOptions& options, std::ostream& log);
+
+  // Whether group/name passes the filter, for setup that's only worth
+  // doing when the benchmark runs
+  bool IsEnabled(const std::string& group, const std::string& name) const;
+
+  // Times function, which performs operations operations per call.
+  // Returns nullptr if the benchmark is filtered out; the result stays
+  // valid until the next Run.
+  template<typename Function>
+  BenchmarkResult* Run(const std::string& group, const std::string& name, uint64_t operations, Function&& function)
+  {
+    if (!IsEnabled(group, name))
+      return nullptr;
+
+    for (unsigned int i = 0; i < m_Options.Warmup; i++)
+      function();
+
+    std::vector<double> samples;
+    samples.reserve(m_Options.Repetitions);
+    for (unsigned int i = 0; i < m_Options.Repetitions; i++)
+    {
+      auto start = std::chrono::steady_clock::now();
+      function();
+      double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+      samples.push_back(ns / (double)operations);
+    }
+    return AddResult(group, name, operations, samples);
+  }
+
+  void SetEnvironment(const std::string& key, const std::string& value);
+  // Marks the run as failed, e.g. when a kernel disagrees with its reference
+  void Fail(const std::string& message);
+
+  // Attaches and prints an extra number, does nothing for filtered out
+  // benchmarks
+  void AddMetric(BenchmarkResult* result, const std::string& name, double value);
+
+  void WriteJson(std::ostream& stream) const;
+  inline bool HasFailed() const { return !m_Failures.empty(); }
+  inline std::ostream& GetLog() { return m_Log; }
+  inline const BenchmarkOptions& GetOptions() const { return m_Options; }
+private:
+  BenchmarkResult* AddResult(const std::string& group, const std::string& name, uint64_t operations, std::vector<double>& samples);
+};
+
+// Keeps the compiler from optimizing away a result that's never used
+template<typename T>
+inline void DoNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void* s_Sink;
+  s_Sink = &value;
+#endif
+}
+
+// The groups, each in its own file. GL groups expect a current context.
+// count scales the math kernels' input.
+void RunMathBenchmarks(BenchmarkSuite& suite, size_t count);
+void RunEngineBenchmarks(BenchmarkSuite& suite, bool hasContext);
+void RunSceneBenchmarks(BenchmarkSuite& suite);
+void RunMemoryBenchmarks(BenchmarkSuite& suite, bool hasContext);
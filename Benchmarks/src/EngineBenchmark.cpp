@@ -0,0 +1,165 @@
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "stb_image.h"
+
+#include "Benchmark.h"
+#include "GLDebug.h"
+#include "GLState.h"
+#include "Shader.h"
+#include "ShaderPreprocessor.h"
+#include "VertexArray.h"
+#include "VertexBufferLayout.h"
+
+// Microbenchmarks of the engine's small, frequently called pieces. Paths
+// are relative to the repository root, like the application's.
+
+static const char* BasicShaderPath = "OpenGL/res/shaders/Basic.shader";
+// Has #includes and defines, so the preprocessor does all its work
+static const char* MaterialShaderPath = "OpenGL/res/shaders/Material.shader";
+// Small, but compressed with every PNG row filter, so it goes through
+// stb_image's zlib and unfiltering like real textures do
+static const char* ImagePath = "OpenGL/res/textures/benchmark.png";
+
+static bool ReadFile(const std::string& path, std::vector<unsigned char>& data)
+{
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream)
+    return false;
+  data.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+  return true;
+}
+
+// Uncompressed 32-bit TGA of a gradient, decoding without any decompression
+static std::vector<unsigned char> MakeTga(int width, int height)
+{
+  std::vector<unsigned char> file(18 + (size_t)width * height * 4);
+  file[2] = 2;  // Uncompressed true color
+  file[12] = (unsigned char)width;
+  file[13] = (unsigned char)(width >> 8);
+  file[14] = (unsigned char)height;
+  file[15] = (unsigned char)(height >> 8);
+  file[16] = 32;
+  file[17] = 8;  // Alpha bits
+  unsigned char* pixel = file.data() + 18;
+  for (int y = 0; y < height; y++)
+    for (int x = 0; x < width; x++, pixel += 4)
+    {
+      pixel[0] = (unsigned char)x;
+      pixel[1] = (unsigned char)y;
+      pixel[2] = (unsigned char)(x ^ y);
+      pixel[3] = 255;
+    }
+  return file;
+}
+
+static void RunDecode(BenchmarkSuite& suite, const std::string& name, const std::vector<unsigned char>& file)
+{
+  int width = 0, height = 0, channels;
+  BenchmarkResult* result = suite.Run("engine", name, 1, [&]() {
+    stbi_uc* pixels = stbi_load_from_memory(file.data(), (int)file.size(), &width, &height, &channels, 4);
+    DoNotOptimize(pixels);
+    stbi_image_free(pixels);
+  });
+  if (result)
+  {
+    suite.AddMetric(result, "pixels", (double)width * height);
+    suite.AddMetric(result, "megapixels_per_second", width * height * result->GetThroughput() / 1e6);
+  }
+}
+
+static void RunCpuBenchmarks(BenchmarkSuite& suite)
+{
+  const unsigned int layouts = 10000;
+  suite.Run("engine", "VertexBufferLayout/Push4", layouts, [&]() {
+    for (unsigned int i = 0; i < layouts; i++)
+    {
+      VertexBufferLayout layout;
+      layout.Push<float>(3);
+      layout.Push<PackedNormal>(1);
+      layout.Push<float>(2);
+      layout.Push<unsigned char>(4);
+      DoNotOptimize(layout.GetStride());
+    }
+  });
+
+  for (const char* path : { BasicShaderPath, MaterialShaderPath })
+  {
+    ShaderDefines defines;
+    if (path == MaterialShaderPath)
+      defines = { "STRIPES", "WARM", "ANIMATED" };
+    ShaderProgramSource source;
+    std::string error;
+    if (!ShaderPreprocessor::Process(path, defines, source, error))
+    {
+      suite.Fail(std::string("can't preprocess ") + path + ": " + error);
+      continue;
+    }
+    std::string name = path;
+    name = "ShaderPreprocessor/" + name.substr(name.find_last_of('/') + 1);
+    suite.Run("engine", name, 1, [&]() {
+      ShaderPreprocessor::Process(path, defines, source, error);
+    });
+  }
+
+  std::vector<unsigned char> png;
+  if (ReadFile(ImagePath, png))
+    RunDecode(suite, "stb_image/png", png);
+  else if (suite.IsEnabled("engine", "stb_image/png"))
+    suite.Fail(std::string("can't read '") + ImagePath + "'");
+  RunDecode(suite, "stb_image/tga_512", MakeTga(512, 512));
+}
+
+static void RunGLBenchmarks(BenchmarkSuite& suite)
+{
+  // Names looked up at runtime like a caller that builds them, so the
+  // hash isn't folded into a constant
+  Shader shader(BasicShaderPath);
+  const std::string names[] = { "u_MVP", "u_Texture" };
+  const unsigned int lookups = 10000;
+  suite.Run("engine", "Shader/GetUniformHandle", lookups, [&]() {
+    for (unsigned int i = 0; i < lookups; i++)
+      DoNotOptimize(shader.GetUniformHandle(names[i & 1]).Location);
+  });
+  suite.Run("engine", "GL/glGetUniformLocation", lookups, [&]() {
+    for (unsigned int i = 0; i < lookups; i++)
+      DoNotOptimize(glGetUniformLocation(shader.GetRendererID(), names[i & 1].c_str()));
+  });
+
+  // The same cheap call bare, through GLCall and through the state cache,
+  // which skips it since the VAO is already bound
+  VertexArray va;
+  const unsigned int vertexArray = va.GetRendererID();
+  const unsigned int calls = 10000;
+  BenchmarkResult* raw = suite.Run("engine", "GL/glBindVertexArray", calls, [&]() {
+    for (unsigned int i = 0; i < calls; i++)
+      glBindVertexArray(vertexArray);
+  });
+  // Copied out, the next Run may move the results
+  bool hasRaw = raw != nullptr;
+  double rawNs = hasRaw ? raw->Median : 0.0;
+  BenchmarkResult* wrapped = suite.Run("engine", "GLCall/glBindVertexArray", calls, [&]() {
+    for (unsigned int i = 0; i < calls; i++)
+    {
+      GLCall(glBindVertexArray(vertexArray));
+    }
+  });
+  if (hasRaw && wrapped)
+    suite.AddMetric(wrapped, "overhead_ns", wrapped->Median - rawNs);
+  GLState::Get().BindVertexArray(vertexArray);
+  suite.Run("engine", "GLState/BindVertexArray_redundant", calls, [&]() {
+    for (unsigned int i = 0; i < calls; i++)
+      GLState::Get().BindVertexArray(vertexArray);
+  });
+  GLState::Get().BindVertexArray(0);
+}
+
+void RunEngineBenchmarks(BenchmarkSuite& suite, bool hasContext)
+{
+  RunCpuBenchmarks(suite);
+  if (hasContext)
+    RunGLBenchmarks(suite);
+}
@@ -0,0 +1,149 @@
+#include <GL/glew.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "Benchmark.h"
+#include "Framebuffer.h"
+#include "GLDebug.h"
+#include "HeadlessContext.h"
+#include "Math3D.h"
+#include "Profiler.h"
+
+// Runs every group and prints a table; with --json the results are also
+// written as JSON ("-" for stdout, then the table goes to stderr). The GL
+// groups need a headless context and are skipped without one, e.g. on
+// Windows. Paths are relative to the repository root, so run it from there.
+
+struct Options
+{
+  BenchmarkOptions Suite;
+  size_t Count = 100000;
+  std::string JsonPath;
+  std::string Label;
+  bool GL = true;
+};
+
+static void PrintUsage()
+{
+  std::cerr << "Usage: Benchmarks [--count n] [--repetitions n] [--warmup n] [--filter text]"
+    " [--json path|-] [--label text] [--no-gl]" << std::endl;
+}
+
+// False on an unknown option or one missing its value, so a typo in a
+// script fails instead of running with defaults
+static bool ParseOptions(int argc, char** argv, Options& options)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    bool hasValue = i + 1 < argc;
+    if (strcmp(argv[i], "--count") == 0 && hasValue)
+      options.Count = (size_t)atol(argv[++i]);
+    else if (strcmp(argv[i], "--repetitions") == 0 && hasValue)
+      options.Suite.Repetitions = (unsigned int)atoi(argv[++i]);
+    else if (strcmp(argv[i], "--warmup") == 0 && hasValue)
+      options.Suite.Warmup = (unsigned int)atoi(argv[++i]);
+    else if (strcmp(argv[i], "--filter") == 0 && hasValue)
+      options.Suite.Filter = argv[++i];
+    else if (strcmp(argv[i], "--json") == 0 && hasValue)
+      options.JsonPath = argv[++i];
+    else if (strcmp(argv[i], "--label") == 0 && hasValue)
+      options.Label = argv[++i];
+    else if (strcmp(argv[i], "--no-gl") == 0)
+      options.GL = false;
+    else
+    {
+      bool takesValue = false;
+      for (const char* name : { "--count", "--repetitions", "--warmup", "--filter", "--json", "--label" })
+        takesValue |= strcmp(argv[i], name) == 0;
+      if (takesValue)
+        std::cerr << "Missing value for '" << argv[i] << "'" << std::endl;
+      else
+        std::cerr << "Unknown option '" << argv[i] << "'" << std::endl;
+      PrintUsage();
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  Options options;
+  if (!ParseOptions(argc, argv, options))
+    return 2;
+  bool jsonToStdout = options.JsonPath == "-";
+  BenchmarkSuite suite(options.Suite, jsonToStdout ? std::cerr : std::cout);
+
+  suite.SetEnvironment("build", GL_ERROR_CHECKS == 2 ? "Debug" : GL_ERROR_CHECKS == 1 ? "Release" : "Dist");
+  suite.SetEnvironment("gl_error_checks", std::to_string(GL_ERROR_CHECKS));
+  suite.SetEnvironment("profiling", std::to_string(PROFILING));
+  suite.SetEnvironment("simd", GetSimdLevelName(GetSimdLevel()));
+  if (!options.Label.empty())
+    suite.SetEnvironment("label", options.Label);
+
+  suite.GetLog() << "math (" << options.Count << " elements)" << std::endl;
+  RunMathBenchmarks(suite, options.Count);
+
+  // Same context as the application's headless mode, minus the debug
+  // output, which would be timed along with every call
+  std::unique_ptr<HeadlessContext> context;
+  bool hasContext = false;
+  if (options.GL)
+  {
+    context.reset(new HeadlessContext(3, 3));
+    if (context->IsValid())
+    {
+      glewExperimental = GL_TRUE;
+      GLenum glewStatus = glewInit();
+      hasContext = glewStatus == GLEW_OK || glewStatus == GLEW_ERROR_NO_GLX_DISPLAY;
+    }
+    if (!hasContext)
+      suite.GetLog() << "No GL context, skipping the GL benchmarks" << std::endl;
+  }
+
+  if (hasContext)
+  {
+    suite.SetEnvironment("gl_renderer", (const char*)glGetString(GL_RENDERER));
+    suite.SetEnvironment("gl_version", (const char*)glGetString(GL_VERSION));
+    GLDebugInit();
+
+    // Released before the context
+    Framebuffer framebuffer(256, 256);
+    framebuffer.Bind();
+
+    suite.GetLog() << "engine" << std::endl;
+    RunEngineBenchmarks(suite, true);
+    suite.GetLog() << "scene (" << glGetString(GL_RENDERER) << ")" << std::endl;
+    RunSceneBenchmarks(suite);
+    suite.GetLog() << "memory" << std::endl;
+    RunMemoryBenchmarks(suite, true);
+    framebuffer.Unbind();
+  }
+  else
+  {
+    suite.GetLog() << "engine" << std::endl;
+    RunEngineBenchmarks(suite, false);
+    suite.GetLog() << "memory" << std::endl;
+    RunMemoryBenchmarks(suite, false);
+  }
+
+  if (jsonToStdout)
+  {
+    suite.WriteJson(std::cout);
+  }
+  else if (!options.JsonPath.empty())
+  {
+    std::ofstream stream(options.JsonPath);
+    suite.WriteJson(stream);
+    if (!stream)
+      suite.Fail("can't write '" + options.JsonPath + "'");
+    else
+      suite.GetLog() << "Wrote '" << options.JsonPath << "'" << std::endl;
+  }
+  return suite.HasFailed() ? 1 : 0;
+}
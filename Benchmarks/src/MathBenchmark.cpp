@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Math3D.h"
+
+// Times the batch kernels of Math3D at every SIMD level the CPU supports
+// and checks their results against the scalar ones. One operation is one
+// element of the batch.
+
+static float Random(float min, float max)
+{
+  return min + rand() / (float)RAND_MAX * (max - min);
+}
+
+static float MaxError(const float* a, const float* b, size_t count)
+{
+  float error = 0.0f;
+  for (size_t i = 0; i < count; i++)
+    error = std::max(error, fabsf(a[i] - b[i]));
+  return error;
+}
+
+// Speedup over the scalar kernel and the largest difference to its output
+static void AddComparison(BenchmarkSuite& suite, BenchmarkResult* result, double scalarNs, float error)
+{
+  if (!result)
+    return;
+  suite.AddMetric(result, "speedup_vs_scalar", scalarNs / result->Median);
+  suite.AddMetric(result, "max_error", error);
+}
+
+void RunMathBenchmarks(BenchmarkSuite& suite, size_t count)
+{
+  std::vector<SimdLevel> levels = { SimdLevel::Scalar };
+  SimdLevel supported = GetSimdLevel();
+  if (supported == SimdLevel::AVX)
+    levels.push_back(SimdLevel::SSE);
+  if (supported != SimdLevel::Scalar)
+    levels.push_back(supported);
+
+  srand(1);
+  std::vector<Vec3> points(count), translations(count), scales(count);
+  std::vector<Quat> rotations(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    points[i] = Vec3(Random(-100.0f, 100.0f), Random(-100.0f, 100.0f), Random(-100.0f, 100.0f));
+    translations[i] = Vec3(Random(-100.0f, 100.0f), Random(-100.0f, 100.0f), Random(-100.0f, 100.0f));
+    scales[i] = Vec3(Random(0.5f, 2.0f), Random(0.5f, 2.0f), Random(0.5f, 2.0f));
+    rotations[i] = Normalize(Quat(Random(-1.0f, 1.0f), Random(-1.0f, 1.0f), Random(-1.0f, 1.0f), Random(-1.0f, 1.0f)));
+  }
+  Mat4 viewProjection = Mat4::Perspective(1.0f, 16.0f / 9.0f, 0.1f, 1000.0f)
+    * Mat4::LookAt(Vec3(0.0f, 50.0f, 200.0f), Vec3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f));
+  Mat4 model = Mat4::Compose(Vec3(1.0f, 2.0f, 3.0f), Quat::FromAxisAngle(Normalize(Vec3(1.0f, 1.0f, 0.0f)), 0.7f), Vec3(2.0f, 2.0f, 2.0f));
+  Frustum frustum = Frustum::FromMatrix(viewProjection);
+
+  // Boxes around the points, eight to a node like SceneBvh stores them
+  struct BoxNode
+  {
+    float Bounds[BoxRowCount][8];
+  };
+  std::vector<BoxNode> nodes((count + 7) / 8);
+  for (size_t i = 0; i < nodes.size() * 8; i++)
+  {
+    Aabb box = Aabb::Empty();
+    if (i < count)
+    {
+      Vec3 extent(Random(0.5f, 20.0f), Random(0.5f, 20.0f), Random(0.5f, 20.0f));
+      box = Aabb(points[i] - extent, points[i] + extent);
+    }
+    const float values[BoxRowCount] = { box.Min.x, box.Min.y, box.Min.z, box.Max.x, box.Max.y, box.Max.z };
+    for (int row = 0; row < BoxRowCount; row++)
+      nodes[i / 8].Bounds[row][i % 8] = values[row];
+  }
+
+  std::vector<Vec3> transformed(count), transformedScalar(count);
+  std::vector<Mat4> models(count), modelsScalar(count), mvps(count), mvpsScalar(count);
+  std::vector<unsigned int> masks(nodes.size() * 2), masksScalar;
+  double scalarNs[4] = {};
+  for (SimdLevel level : levels)
+  {
+    SetSimdLevel(level);
+    const std::string suffix = std::string("/") + GetSimdLevelName(level);
+    bool scalar = level == SimdLevel::Scalar;
+
+    BenchmarkResult* result = suite.Run("math", "TransformPoints" + suffix, count, [&]() {
+      TransformPoints(model, points.data(), transformed.data(), count);
+    });
+    if (scalar)
+    {
+      transformedScalar = transformed;
+      scalarNs[0] = result ? result->Median : 0.0;
+    }
+    AddComparison(suite, result, scalarNs[0], MaxError(&transformed[0].x, &transformedScalar[0].x, count * 3));
+
+    result = suite.Run("math", "ComposeTransforms" + suffix, count, [&]() {
+      ComposeTransforms(translations.data(), rotations.data(), scales.data(), models.data(), count);
+    });
+    if (scalar)
+    {
+      modelsScalar = models;
+      scalarNs[1] = result ? result->Median : 0.0;
+    }
+    AddComparison(suite, result, scalarNs[1], MaxError(models[0].Data(), modelsScalar[0].Data(), count * 16));
+
+    result = suite.Run("math", "MultiplyMatrices" + suffix, count, [&]() {
+      MultiplyMatrices(viewProjection, modelsScalar.data(), mvps.data(), count);
+    });
+    if (scalar)
+    {
+      mvpsScalar = mvps;
+      scalarNs[2] = result ? result->Median : 0.0;
+    }
+    AddComparison(suite, result, scalarNs[2], MaxError(mvps[0].Data(), mvpsScalar[0].Data(), count * 16));
+
+    // One operation is one box, not one call
+    result = suite.Run("math", "FrustumTestBoxes" + suffix, nodes.size() * 8, [&]() {
+      for (size_t i = 0; i < nodes.size(); i++)
+        masks[i * 2] = FrustumTestBoxes(frustum, nodes[i].Bounds, masks[i * 2 + 1]);
+    });
+    if (scalar)
+    {
+      masksScalar = masks;
+      scalarNs[3] = result ? result->Median : 0.0;
+    }
+    AddComparison(suite, result, scalarNs[3], masks == masksScalar ? 0.0f : 1.0f);
+    if (result && masks != masksScalar)
+      suite.Fail(std::string("FrustumTestBoxes at ") + GetSimdLevelName(level) + " disagrees with the scalar kernel");
+  }
+
+  // The kernels must agree with the single element operations as well
+  SetSimdLevel(supported);
+  TransformPoints(model, points.data(), transformed.data(), count);
+  ComposeTransforms(translations.data(), rotations.data(), scales.data(), models.data(), count);
+  float error = 0.0f;
+  for (size_t i = 0; i < count; i++)
+  {
+    Vec3 point = TransformPoint(model, points[i]);
+    error = std::max(error, MaxError(&point.x, &transformed[i].x, 3));
+    Mat4 composed = Mat4::Translate(translations[i]) * Mat4::FromQuat(rotations[i]) * Mat4::Scale(scales[i]);
+    error = std::max(error, MaxError(composed.Data(), models[i].Data(), 16));
+  }
+  suite.GetLog() << "  Max error against Mat4 operations: " << error << std::endl;
+  if (error >= 1e-3f)
+    suite.Fail("batch kernels disagree with the Mat4 operations");
+}
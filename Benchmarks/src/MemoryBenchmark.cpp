@@ -0,0 +1,259 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "Benchmark.h"
+#include "FrameArena.h"
+#include "GLDebug.h"
+#include "GeometryPool.h"
+#include "Memory.h"
+#include "RenderQueue.h"
+#include "Renderer.h"
+#include "ResourceManager.h"
+#include "ThreadPool.h"
+#include "VertexBufferLayout.h"
+
+// The engine's allocators against the heap, and a whole frame of the
+// renderer that has to run without a single heap allocation once it's
+// warmed up.
+
+// ------------------------ Heap allocation counter -----------------------
+// Replaces the global operator new of the whole executable, so the frame
+// benchmark can tell whether anything allocated. It costs one relaxed
+// increment per allocation, the other benchmarks don't notice.
+static std::atomic<uint64_t> s_HeapAllocations{ 0 };
+
+static void* HeapAllocate(size_t size)
+{
+  s_HeapAllocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* memory = malloc(size ? size : 1))
+    return memory;
+  throw std::bad_alloc();
+}
+
+static void* HeapAllocateAligned(size_t size, std::align_val_t alignment)
+{
+  s_HeapAllocations.fetch_add(1, std::memory_order_relaxed);
+  size_t align = (size_t)alignment;
+#ifdef _WIN32
+  void* memory = _aligned_malloc(size ? size : 1, align);
+#else
+  void* memory = aligned_alloc(align, (size + align - 1) / align * align);
+#endif
+  if (memory)
+    return memory;
+  throw std::bad_alloc();
+}
+
+static void HeapFreeAligned(void* memory)
+{
+#ifdef _WIN32
+  _aligned_free(memory);
+#else
+  free(memory);
+#endif
+}
+
+void* operator new(size_t size) { return HeapAllocate(size); }
+void* operator new[](size_t size) { return HeapAllocate(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return HeapAllocateAligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return HeapAllocateAligned(size, alignment); }
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete[](void* memory) noexcept { free(memory); }
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+void operator delete[](void* memory, size_t) noexcept { free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { HeapFreeAligned(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { HeapFreeAligned(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { HeapFreeAligned(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { HeapFreeAligned(memory); }
+// ------------------------------------------------------------------------
+
+static const unsigned int AllocationCount = 10000;
+static const unsigned int AllocationSize = 64;
+
+struct PoolObject
+{
+  unsigned char Bytes[AllocationSize];
+};
+
+static void RunAllocatorBenchmarks(BenchmarkSuite& suite)
+{
+  FrameArena arena;
+  suite.Run("memory", "FrameArena/Allocate", AllocationCount, [&]() {
+    for (unsigned int i = 0; i < AllocationCount; i++)
+      DoNotOptimize(arena.Allocate(AllocationSize));
+    arena.Reset();
+  });
+
+  ObjectPool<PoolObject> pool(MemoryTag::General);
+  std::vector<uint32_t> indices(AllocationCount);
+  suite.Run("memory", "ObjectPool/AllocateFree", AllocationCount, [&]() {
+    for (unsigned int i = 0; i < AllocationCount; i++)
+      indices[i] = pool.Allocate();
+    for (unsigned int i = 0; i < AllocationCount; i++)
+      pool.Free(indices[i]);
+  });
+
+  std::vector<PoolObject*> objects(AllocationCount);
+  suite.Run("memory", "new_delete", AllocationCount, [&]() {
+    for (unsigned int i = 0; i < AllocationCount; i++)
+      objects[i] = new PoolObject;
+    for (unsigned int i = 0; i < AllocationCount; i++)
+      delete objects[i];
+  });
+}
+
+// --------------------------- Steady-state frame -------------------------
+static const unsigned int QueueDraws = 1000;
+static const unsigned int QueueJobs = 4;
+static const unsigned int BatchQuads = 1000;
+static const unsigned int PoolMeshes = 64;
+static const unsigned int WarmupFrames = 10;
+
+struct QuadVertex
+{
+  float Position[2];
+  float TexCoord[2];
+};
+
+// Quad of the given width in the pool, built in frame arena scratch
+static GeometryHandle AddQuad(GeometryPool& pool, const VertexBufferLayout& layout, float width)
+{
+  FrameArena& arena = Memory::GetFrameArena();
+  FrameArena::Marker marker = arena.GetMarker();
+  QuadVertex* vertices = arena.NewArray<QuadVertex>(4);
+  const float corners[4][2] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+  for (int i = 0; i < 4; i++)
+    vertices[i] = { { corners[i][0] * width - 0.5f, corners[i][1] - 0.5f }, { corners[i][0], corners[i][1] } };
+  const unsigned short indices[] = { 0, 1, 2, 2, 3, 0 };
+  GeometryHandle mesh = pool.Add(layout, vertices, 4, indices, 6, IndexType::UnsignedShort);
+  arena.Rewind(marker);
+  return mesh;
+}
+
+static void RunFrameBenchmark(BenchmarkSuite& suite)
+{
+  if (!suite.IsEnabled("memory", "SteadyStateFrame"))
+    return;
+
+  Renderer renderer;
+  ResourceManager resources;
+  RenderQueue queue(QueueJobs);
+  ThreadPool threads;
+
+  unsigned int checker[8 * 8];
+  for (unsigned int i = 0; i < 8 * 8; i++)
+    checker[i] = ((i / 8 + i % 8) % 2) ? 0xffffffff : 0xff404040;
+  TextureHandle texture = resources.CreateTexture(8, 8, checker);
+  ShaderHandle basic = resources.LoadShader("OpenGL/res/shaders/Basic.shader");
+  ShaderHandle batch = resources.LoadShader("OpenGL/res/shaders/Batch.shader");
+  Shader& shader = *resources.Get(basic);
+  shader.Bind();
+  shader.SetUniform1i("u_Texture", 0);
+  UniformHandle mvp = shader.GetUniformHandle("u_MVP");
+
+  const float quad[] = { -0.5f, -0.5f, 0.0f, 0.0f,   0.5f, -0.5f, 1.0f, 0.0f,   0.5f, 0.5f, 1.0f, 1.0f,   -0.5f, 0.5f, 0.0f, 1.0f };
+  const unsigned int quadIndices[] = { 0, 1, 2, 2, 3, 0 };
+  VertexBufferHandle vb = resources.CreateVertexBuffer(quad, sizeof(quad));
+  IndexBufferHandle ib = resources.CreateIndexBuffer(quadIndices, 6, IndexType::UnsignedInt);
+  VertexBufferLayout layout;
+  layout.Push<float>(2);
+  layout.Push<float>(2);
+  VertexArray va;
+  va.AddBuffer(*resources.Get(vb), layout);
+  va.Unbind();
+
+  // Meshes of the pool are replaced one per frame, by one of the same
+  // size, so the pool reuses the freed range
+  GeometryPool geometry;
+  std::vector<GeometryHandle> meshes(PoolMeshes);
+  for (unsigned int i = 0; i < PoolMeshes; i++)
+    meshes[i] = AddQuad(geometry, layout, 1.0f);
+
+  unsigned int frame = 0;
+  uint64_t heapAllocations = 0;
+  auto renderFrame = [&]() {
+    uint64_t start = s_HeapAllocations.load(std::memory_order_relaxed);
+    frame++;
+    renderer.BeginFrame();
+    renderer.Clear();
+
+    // Transforms live until the end of the frame, the jobs read them
+    Mat4* transforms = Memory::GetFrameArena().NewArray<Mat4>(QueueDraws);
+    for (unsigned int i = 0; i < QueueDraws; i++)
+    {
+      float x = (i % 40) / 20.0f - 0.975f + 0.001f * (frame % 10), y = (i / 40) / 20.0f - 0.975f;
+      transforms[i] = Mat4::Translate(Vec3(x, y, 0.0f)) * Mat4::Scale(Vec3(0.02f, 0.02f, 1.0f));
+    }
+
+    queue.BeginFrame();
+    threads.Run(QueueJobs, [&](unsigned int job, unsigned int thread) {
+      CommandBuffer& commands = queue.GetCommandBuffer(job);
+      for (unsigned int i = job; i < QueueDraws; i += QueueJobs)
+      {
+        DrawCommand* command = commands.Draw(RenderPass::Opaque, i / (float)QueueDraws, shader, va, *resources.Get(ib), resources.Get(texture));
+        commands.SetUniformMat4(command, mvp, transforms[i].Data());
+      }
+    });
+    queue.Execute(renderer);
+
+    unsigned int replaced = frame % PoolMeshes;
+    geometry.Remove(meshes[replaced]);
+    meshes[replaced] = AddQuad(geometry, layout, 1.0f);
+    shader.Bind();
+    for (unsigned int i = 0; i < PoolMeshes; i++)
+    {
+      Mat4 transform = Mat4::Translate(Vec3(-0.9f + 0.025f * i, 0.9f, 0.0f)) * Mat4::Scale(Vec3(0.02f, 0.02f, 1.0f));
+      shader.SetUniformMat4(mvp, transform);
+      renderer.Draw(geometry, meshes[i], shader);
+    }
+
+    renderer.BeginBatch(*resources.Get(batch));
+    for (unsigned int i = 0; i < BatchQuads; i++)
+    {
+      float x = (i % 50) / 25.0f - 1.0f, y = (i / 50) / 25.0f - 1.0f;
+      if (i & 1)
+        renderer.SubmitQuad(x, y, 0.03f, 0.03f, *resources.Get(texture));
+      else
+        renderer.SubmitQuad(x, y, 0.03f, 0.03f, 0.25f, 0.5f, 1.0f, 1.0f);
+    }
+    renderer.EndBatch();
+
+    renderer.EndFrame();
+    resources.EndFrame();
+    Memory::EndFrame();
+    GLCall(glFinish());
+    heapAllocations += s_HeapAllocations.load(std::memory_order_relaxed) - start;
+  };
+
+  // Lets every container and arena reach its high-water mark
+  for (unsigned int i = 0; i < WarmupFrames; i++)
+    renderFrame();
+  heapAllocations = 0;
+  frame = 0;
+
+  BenchmarkResult* result = suite.Run("memory", "SteadyStateFrame", 1, renderFrame);
+  unsigned int frames = suite.GetOptions().Warmup + suite.GetOptions().Repetitions;
+  suite.AddMetric(result, "heap_allocations_per_frame", (double)heapAllocations / frames);
+  suite.AddMetric(result, "frame_arena_kib", Memory::GetFrameArena().GetHighWater() / 1024.0);
+  suite.AddMetric(result, "command_kib", queue.GetStats().ArenaBytes / 1024.0);
+  if (heapAllocations)
+    suite.Fail("the steady-state frame made " + std::to_string(heapAllocations) + " heap allocations in " + std::to_string(frames) + " frames");
+
+  for (GeometryHandle mesh : meshes)
+    geometry.Remove(mesh);
+  resources.Release(texture);
+  resources.Release(basic);
+  resources.Release(batch);
+  resources.Release(vb);
+  resources.Release(ib);
+}
+// ------------------------------------------------------------------------
+
+void RunMemoryBenchmarks(BenchmarkSuite& suite, bool hasContext)
+{
+  RunAllocatorBenchmarks(suite);
+  if (hasContext)
+    RunFrameBenchmark(suite);
+}
@@ -0,0 +1,202 @@
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "Benchmark.h"
+#include "GLDebug.h"
+#include "GLState.h"
+#include "IndexBuffer.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include "StreamBuffer.h"
+#include "Texture.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+
+// Whole-frame throughput on the current context, meant for a software
+// rasterizer like llvmpipe: draw calls, state changes and uploads. Every
+// repetition ends with glFinish, so the driver's share of the work is
+// measured too and not left queued for the next benchmark.
+
+static const unsigned int DrawCount = 1000;
+static const unsigned int QuadCount = 10000;
+static const unsigned int UploadSize = 1024 * 1024;
+static const unsigned int UploadCount = 16;
+static const int TextureSize = 512;
+
+struct QuadMesh
+{
+  VertexBuffer VB;
+  VertexArray VA;
+  IndexBuffer IB;
+
+  QuadMesh(const float* vertices, unsigned int size, const unsigned int* indices)
+    : VB(vertices, size), IB(indices, 6)
+  {
+    VertexBufferLayout layout;
+    layout.Push<float>(2);
+    layout.Push<float>(2);
+    VA.AddBuffer(VB, layout);
+  }
+};
+
+// Metrics of the last repetition, per operation
+static void AddFrameMetrics(BenchmarkSuite& suite, BenchmarkResult* result, const Renderer& renderer, unsigned int operations)
+{
+  if (!result)
+    return;
+  Renderer::Stats stats = renderer.GetStats();
+  suite.AddMetric(result, "gl_calls_per_op", (double)stats.GLCalls / operations);
+  suite.AddMetric(result, "state_changes_per_op", (double)stats.StateChanges / operations);
+  suite.AddMetric(result, "state_changes_skipped_per_op", (double)stats.StateChangesSkipped / operations);
+}
+
+static void AddBandwidth(BenchmarkSuite& suite, BenchmarkResult* result, double bytesPerOperation)
+{
+  if (result)
+    suite.AddMetric(result, "mib_per_second", bytesPerOperation * result->GetThroughput() / (1024.0 * 1024.0));
+}
+
+void RunSceneBenchmarks(BenchmarkSuite& suite)
+{
+  Renderer renderer;
+  renderer.SetClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+  const float quad[] = { -1.0f, -1.0f, 0.0f, 0.0f,   1.0f, -1.0f, 1.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,   -1.0f, 1.0f, 0.0f, 1.0f };
+  const float diamond[] = { 0.0f, -1.0f, 0.5f, 0.0f,   1.0f, 0.0f, 1.0f, 0.5f,   0.0f, 1.0f, 0.5f, 1.0f,   -1.0f, 0.0f, 0.0f, 0.5f };
+  const unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+  QuadMesh meshes[2] = { { quad, sizeof(quad), indices }, { diamond, sizeof(diamond), indices } };
+
+  unsigned int white = 0xffffffff;
+  unsigned int checker[8 * 8];
+  for (unsigned int i = 0; i < 8 * 8; i++)
+    checker[i] = ((i / 8 + i % 8) % 2) ? 0xffffffff : 0xff404040;
+  Texture textures[2] = { Texture(1, 1, &white), Texture(8, 8, checker) };
+
+  // Two programs of the same source, so switching costs a real bind
+  Shader shaders[2] = { Shader("OpenGL/res/shaders/Basic.shader"), Shader("OpenGL/res/shaders/Basic.shader", { "SECOND_PROGRAM" }) };
+  UniformHandle mvps[2];
+  for (int i = 0; i < 2; i++)
+  {
+    shaders[i].Bind();
+    shaders[i].SetUniform1i("u_Texture", 0);
+    mvps[i] = shaders[i].GetUniformHandle("u_MVP");
+  }
+
+  // Small quads over a grid, so rasterization stays a minor part
+  std::vector<Mat4> transforms(DrawCount);
+  for (unsigned int i = 0; i < DrawCount; i++)
+  {
+    float x = (i % 40) / 20.0f - 0.975f, y = (i / 40) / 20.0f - 0.975f;
+    transforms[i] = Mat4::Translate(Vec3(x, y, 0.0f)) * Mat4::Scale(Vec3(0.02f, 0.02f, 1.0f));
+  }
+
+  // Same mesh, shader and texture every draw, only the matrix changes
+  textures[0].Bind(0);
+  BenchmarkResult* result = suite.Run("scene", "DrawCalls/same_state", DrawCount, [&]() {
+    renderer.BeginFrame();
+    renderer.Clear();
+    for (unsigned int i = 0; i < DrawCount; i++)
+    {
+      shaders[0].Bind();
+      shaders[0].SetUniformMat4(mvps[0], transforms[i]);
+      renderer.Draw(meshes[0].VA, meshes[0].IB, shaders[0]);
+    }
+    renderer.EndFrame();
+    GLCall(glFinish());
+  });
+  AddFrameMetrics(suite, result, renderer, DrawCount);
+
+  // Mesh, shader and texture all differ from the previous draw
+  result = suite.Run("scene", "DrawCalls/state_change", DrawCount, [&]() {
+    renderer.BeginFrame();
+    renderer.Clear();
+    for (unsigned int i = 0; i < DrawCount; i++)
+    {
+      unsigned int k = i & 1;
+      textures[k].Bind(0);
+      shaders[k].Bind();
+      shaders[k].SetUniformMat4(mvps[k], transforms[i]);
+      renderer.Draw(meshes[k].VA, meshes[k].IB, shaders[k]);
+    }
+    renderer.EndFrame();
+    GLCall(glFinish());
+  });
+  AddFrameMetrics(suite, result, renderer, DrawCount);
+
+  // The same number of quads as above times ten, batched into a few draws
+  if (suite.IsEnabled("scene", "BatchedQuads"))
+  {
+    Shader batchShader("OpenGL/res/shaders/Batch.shader");
+    result = suite.Run("scene", "BatchedQuads", QuadCount, [&]() {
+      renderer.BeginFrame();
+      renderer.Clear();
+      renderer.BeginBatch(batchShader);
+      for (unsigned int i = 0; i < QuadCount; i++)
+      {
+        float x = (i % 100) / 50.0f - 1.0f, y = (i / 100) / 50.0f - 1.0f;
+        if (i & 1)
+          renderer.SubmitQuad(x, y, 0.015f, 0.015f, textures[1]);
+        else
+          renderer.SubmitQuad(x, y, 0.015f, 0.015f, 1.0f, 0.5f, 0.25f, 1.0f);
+      }
+      renderer.EndBatch();
+      renderer.EndFrame();
+      GLCall(glFinish());
+    });
+    AddFrameMetrics(suite, result, renderer, QuadCount);
+    if (result)
+      suite.AddMetric(result, "draw_calls", renderer.GetStats().Flushes);
+  }
+
+  // One operation is one MiB uploaded
+  std::vector<unsigned char> data(UploadSize);
+  for (unsigned int i = 0; i < UploadSize; i++)
+    data[i] = (unsigned char)(i * 7);
+
+  if (suite.IsEnabled("scene", "Upload/BufferSubData"))
+  {
+    VertexBuffer buffer(UploadSize, BufferUsage::Dynamic);
+    result = suite.Run("scene", "Upload/BufferSubData", UploadCount, [&]() {
+      for (unsigned int i = 0; i < UploadCount; i++)
+        buffer.SetData(data.data(), UploadSize);
+      GLCall(glFinish());
+    });
+    AddBandwidth(suite, result, UploadSize);
+  }
+
+  if (suite.IsEnabled("scene", "Upload/StreamBuffer"))
+  {
+    StreamBuffer stream(GL_ARRAY_BUFFER, UploadSize * UploadCount);
+    result = suite.Run("scene", "Upload/StreamBuffer", UploadCount, [&]() {
+      for (unsigned int i = 0; i < UploadCount; i++)
+      {
+        unsigned int offset;
+        void* memory = stream.Allocate(UploadSize, 4, offset);
+        memcpy(memory, data.data(), UploadSize);
+      }
+      stream.Flush();
+      stream.EndFrame();
+      GLCall(glFinish());
+    });
+    AddBandwidth(suite, result, UploadSize);
+    if (result)
+      suite.AddMetric(result, "stalls", stream.GetStats().Stalls);
+  }
+
+  if (suite.IsEnabled("scene", "Upload/TexSubImage"))
+  {
+    std::vector<unsigned int> pixels((size_t)TextureSize * TextureSize);
+    for (size_t i = 0; i < pixels.size(); i++)
+      pixels[i] = 0xff000000 | (unsigned int)(i * 2654435761u >> 8);
+    Texture texture(TextureSize, TextureSize, nullptr);
+    const unsigned int uploads = 4;
+    result = suite.Run("scene", "Upload/TexSubImage", uploads, [&]() {
+      for (unsigned int i = 0; i < uploads; i++)
+        texture.SetSubImage(0, TextureSize, pixels.data());
+      GLCall(glFinish());
+    });
+    AddBandwidth(suite, result, (double)TextureSize * TextureSize * 4);
+  }
+}
@@ -0,0 +1,1283 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "VertexBufferLayout.h"
+#include "CookedMesh.h"
+
+// Offline converter from Wavefront OBJ and glTF 2.0 (.gltf/.glb) to a
+// .cmesh file. Identical vertices are merged, triangles are reordered for
+// the post-transform vertex cache (Forsyth) and then in clusters to
+// reduce overdraw (the second pass of Tipsify), and vertices are stored
+// in the order the indices first use them. Meshes with at most 65536
+// vertices get 16-bit indices.
+
+struct Vertex
+{
+  float Position[3];
+  float Normal[3];
+  float TexCoord[2];
+};
+
+struct MeshData
+{
+  std::vector<Vertex> Vertices;  // Three per triangle until Deduplicate
+  std::vector<uint32_t> Indices;
+  bool HasNormals = true;
+};
+
+// ------------------------------ Vertex formats ------------------------------
+// 20 bytes, the default
+struct CompactVertex
+{
+  float Position[3];
+  PackedNormal Normal;
+  Half TexCoord[2];
+};
+
+using CompactVertexLayout = StaticVertexLayout<CompactVertex,
+  VERTEX_ATTRIB(CompactVertex, Position),
+  VERTEX_ATTRIB(CompactVertex, Normal),
+  VERTEX_ATTRIB(CompactVertex, TexCoord)>;
+
+// 32 bytes, with --float
+struct FloatVertex
+{
+  float Position[3];
+  float Normal[3];
+  float TexCoord[2];
+};
+
+using FloatVertexLayout = StaticVertexLayout<FloatVertex,
+  VERTEX_ATTRIB(FloatVertex, Position),
+  VERTEX_ATTRIB(FloatVertex, Normal),
+  VERTEX_ATTRIB(FloatVertex, TexCoord)>;
+// ----------------------------------------------------------------------------
+
+static bool ReadFile(const std::string& path, std::string& contents)
+{
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream)
+    return false;
+  std::stringstream ss;
+  ss << stream.rdbuf();
+  contents = ss.str();
+  return true;
+}
+
+static std::string GetDirectory(const std::string& path)
+{
+  size_t slash = path.find_last_of("/\\");
+  return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+static bool EndsWith(const std::string& string, const char* suffix)
+{
+  size_t length = strlen(suffix);
+  return string.size() >= length && string.compare(string.size() - length, length, suffix) == 0;
+}
+
+// ----------------------------------- OBJ ------------------------------------
+// Resolves a 1-based or negative (relative to the end) OBJ index, -1 if absent or out of range
+static int ResolveObjIndex(const char*& cursor, size_t count)
+{
+  char* end;
+  long index = strtol(cursor, &end, 10);
+  if (end == cursor)
+    return -1;
+  cursor = end;
+  long resolved = index < 0 ? (long)count + index : index - 1;
+  return resolved >= 0 && resolved < (long)count ? (int)resolved : -1;
+}
+
+static bool LoadObj(const std::string& path, MeshData& mesh)
+{
+  std::ifstream stream(path);
+  if (!stream)
+  {
+    std::cout << "Failed to open '" << path << "'" << std::endl;
+    return false;
+  }
+
+  std::vector<float> positions, normals, texCoords;
+  std::vector<Vertex> polygon;
+  std::string line;
+  while (std::getline(stream, line))
+  {
+    const char* cursor = line.c_str();
+    while (*cursor == ' ' || *cursor == '\t')
+      cursor++;
+
+    if (cursor[0] == 'v' && (cursor[1] == ' ' || cursor[1] == 't' || cursor[1] == 'n'))
+    {
+      std::vector<float>& target = cursor[1] == ' ' ? positions : cursor[1] == 't' ? texCoords : normals;
+      unsigned int components = cursor[1] == 't' ? 2 : 3;
+      cursor += 2;
+      for (unsigned int i = 0; i < components; i++)
+      {
+        char* end;
+        float value = strtof(cursor, &end);
+        cursor = end;
+        target.push_back(value);
+      }
+    }
+    else if (cursor[0] == 'f' && cursor[1] == ' ')
+    {
+      // v, v/vt, v//vn or v/vt/vn per corner, polygons become triangle fans
+      polygon.clear();
+      cursor += 2;
+      while (true)
+      {
+        while (*cursor == ' ' || *cursor == '\t')
+          cursor++;
+        if (*cursor == '\0' || *cursor == '\r')
+          break;
+
+        Vertex vertex = {};
+        int position = ResolveObjIndex(cursor, positions.size() / 3);
+        int texCoord = -1, normal = -1;
+        if (*cursor == '/')
+        {
+          cursor++;
+          if (*cursor != '/')
+            texCoord = ResolveObjIndex(cursor, texCoords.size() / 2);
+          if (*cursor == '/')
+          {
+            cursor++;
+            normal = ResolveObjIndex(cursor, normals.size() / 3);
+          }
+        }
+        if (position < 0)
+        {
+          std::cout << "Invalid face in '" << path << "': " << line << std::endl;
+          return false;
+        }
+        while (*cursor && *cursor != ' ' && *cursor != '\t')
+          cursor++;
+
+        memcpy(vertex.Position, &positions[position * 3], sizeof(vertex.Position));
+        if (texCoord >= 0)
+          memcpy(vertex.TexCoord, &texCoords[texCoord * 2], sizeof(vertex.TexCoord));
+        if (normal >= 0)
+          memcpy(vertex.Normal, &normals[normal * 3], sizeof(vertex.Normal));
+        else
+          mesh.HasNormals = false;
+        polygon.push_back(vertex);
+      }
+
+      for (size_t i = 2; i < polygon.size(); i++)
+      {
+        mesh.Vertices.push_back(polygon[0]);
+        mesh.Vertices.push_back(polygon[i - 1]);
+        mesh.Vertices.push_back(polygon[i]);
+      }
+    }
+  }
+  return true;
+}
+// ----------------------------------------------------------------------------
+
+// ----------------------------------- JSON -----------------------------------
+// Just enough JSON for glTF, objects keep their keys in file order
+struct JsonValue
+{
+  enum class Kind { Null, Bool, Number, String, Array, Object };
+
+  Kind Type = Kind::Null;
+  double Number = 0.0;
+  std::string String;
+  std::vector<std::string> Keys;   // Objects only
+  std::vector<JsonValue> Values;   // Array elements or object members
+
+  const JsonValue& operator[](const char* key) const
+  {
+    static const JsonValue null;
+    for (size_t i = 0; i < Keys.size(); i++)
+    {
+      if (Keys[i] == key)
+        return Values[i];
+    }
+    return null;
+  }
+
+  const JsonValue& operator[](int index) const
+  {
+    static const JsonValue null;
+    return index >= 0 && (size_t)index < Values.size() ? Values[index] : null;
+  }
+
+  inline bool IsNull() const { return Type == Kind::Null; }
+  inline size_t Size() const { return Values.size(); }
+  inline double AsNumber(double fallback = 0.0) const { return Type == Kind::Number ? Number : fallback; }
+  inline int AsInt(int fallback = -1) const { return Type == Kind::Number ? (int)Number : fallback; }
+};
+
+class JsonParser
+{
+private:
+  const char* m_Cursor;
+  const char* m_End;
+public:
+  JsonParser(const char* begin, const char* end)
+    : m_Cursor(begin), m_End(end) {}
+
+  bool Parse(JsonValue& value)
+  {
+    return ParseValue(value, 0) && (SkipWhitespace(), m_Cursor == m_End);
+  }
+
+private:
+  void SkipWhitespace()
+  {
+    while (m_Cursor < m_End && (*m_Cursor == ' ' || *m_Cursor == '\t' || *m_Cursor == '\n' || *m_Cursor == '\r'))
+      m_Cursor++;
+  }
+
+  bool Match(const char* literal)
+  {
+    size_t length = strlen(literal);
+    if ((size_t)(m_End - m_Cursor) < length || strncmp(m_Cursor, literal, length) != 0)
+      return false;
+    m_Cursor += length;
+    return true;
+  }
+
+  static void AppendUtf8(std::string& string, unsigned int codePoint)
+  {
+    if (codePoint < 0x80)
+      string += (char)codePoint;
+    else if (codePoint < 0x800)
+    {
+      string += (char)(0xc0 | (codePoint >> 6));
+      string += (char)(0x80 | (codePoint & 0x3f));
+    }
+    else if (codePoint < 0x10000)
+    {
+      string += (char)(0xe0 | (codePoint >> 12));
+      string += (char)(0x80 | ((codePoint >> 6) & 0x3f));
+      string += (char)(0x80 | (codePoint & 0x3f));
+    }
+    else
+    {
+      string += (char)(0xf0 | (codePoint >> 18));
+      string += (char)(0x80 | ((codePoint >> 12) & 0x3f));
+      string += (char)(0x80 | ((codePoint >> 6) & 0x3f));
+      string += (char)(0x80 | (codePoint & 0x3f));
+    }
+  }
+
+  bool ParseHex4(unsigned int& value)
+  {
+    if (m_End - m_Cursor < 4)
+      return false;
+    value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+      char c = *m_Cursor++;
+      value <<= 4;
+      if (c >= '0' && c <= '9') value |= c - '0';
+      else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+      else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+      else return false;
+    }
+    return true;
+  }
+
+  bool ParseString(std::string& string)
+  {
+    if (m_Cursor == m_End || *m_Cursor != '"')
+      return false;
+    m_Cursor++;
+    while (m_Cursor < m_End && *m_Cursor != '"')
+    {
+      char c = *m_Cursor++;
+      if (c != '\\')
+      {
+        string += c;
+        continue;
+      }
+      if (m_Cursor == m_End)
+        return false;
+      switch (*m_Cursor++)
+      {
+        case '"':  string += '"'; break;
+        case '\\': string += '\\'; break;
+        case '/':  string += '/'; break;
+        case 'b':  string += '\b'; break;
+        case 'f':  string += '\f'; break;
+        case 'n':  string += '\n'; break;
+        case 'r':  string += '\r'; break;
+        case 't':  string += '\t'; break;
+        case 'u':
+        {
+          unsigned int codePoint, low;
+          if (!ParseHex4(codePoint))
+            return false;
+          // Surrogate pair
+          if (codePoint >= 0xd800 && codePoint < 0xdc00 && Match("\\u") && ParseHex4(low))
+            codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+          AppendUtf8(string, codePoint);
+          break;
+        }
+        default:
+          return false;
+      }
+    }
+    if (m_Cursor == m_End)
+      return false;
+    m_Cursor++;
+    return true;
+  }
+
+  bool ParseValue(JsonValue& value, int depth)
+  {
+    if (depth > 64)
+      return false;
+    SkipWhitespace();
+    if (m_Cursor == m_End)
+      return false;
+
+    switch (*m_Cursor)
+    {
+      case '{':
+      {
+        value.Type = JsonValue::Kind::Object;
+        m_Cursor++;
+        SkipWhitespace();
+        if (m_Cursor < m_End && *m_Cursor == '}')
+        {
+          m_Cursor++;
+          return true;
+        }
+        while (true)
+        {
+          SkipWhitespace();
+          value.Keys.emplace_back();
+          value.Values.emplace_back();
+          if (!ParseString(value.Keys.back()))
+            return false;
+          SkipWhitespace();
+          if (!Match(":") || !ParseValue(value.Values.back(), depth + 1))
+            return false;
+          SkipWhitespace();
+          if (Match("}"))
+            return true;
+          if (!Match(","))
+            return false;
+        }
+      }
+      case '[':
+      {
+        value.Type = JsonValue::Kind::Array;
+        m_Cursor++;
+        SkipWhitespace();
+        if (m_Cursor < m_End && *m_Cursor == ']')
+        {
+          m_Cursor++;
+          return true;
+        }
+        while (true)
+        {
+          value.Values.emplace_back();
+          if (!ParseValue(value.Values.back(), depth + 1))
+            return false;
+          SkipWhitespace();
+          if (Match("]"))
+            return true;
+          if (!Match(","))
+            return false;
+        }
+      }
+      case '"':
+        value.Type = JsonValue::Kind::String;
+        return ParseString(value.String);
+      case 't':
+        value.Type = JsonValue::Kind::Bool;
+        value.Number = 1.0;
+        return Match("true");
+      case 'f':
+        value.Type = JsonValue::Kind::Bool;
+        return Match("false");
+      case 'n':
+        return Match("null");
+      default:
+      {
+        // strtod stops at the first character that can't be part of a number
+        std::string number;
+        while (m_Cursor < m_End && strchr("+-0123456789.eE", *m_Cursor))
+          number += *m_Cursor++;
+        char* end;
+        value.Type = JsonValue::Kind::Number;
+        value.Number = strtod(number.c_str(), &end);
+        return !number.empty() && *end == '\0';
+      }
+    }
+  }
+};
+// ----------------------------------------------------------------------------
+
+// ----------------------------------- glTF -----------------------------------
+struct GltfDocument
+{
+  JsonValue Json;
+  std::vector<std::string> Buffers;
+};
+
+static bool DecodeBase64(const char* text, size_t length, std::string& data)
+{
+  auto decode = [](char c) -> int {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+' || c == '-') return 62;
+    if (c == '/' || c == '_') return 63;
+    return -1;
+  };
+
+  unsigned int bits = 0, bitCount = 0;
+  for (size_t i = 0; i < length && text[i] != '='; i++)
+  {
+    int value = decode(text[i]);
+    if (value < 0)
+      return false;
+    bits = (bits << 6) | (unsigned int)value;
+    bitCount += 6;
+    if (bitCount >= 8)
+    {
+      bitCount -= 8;
+      data += (char)((bits >> bitCount) & 0xff);
+    }
+  }
+  return true;
+}
+
+static bool LoadGltfDocument(const std::string& path, GltfDocument& document)
+{
+  std::string file;
+  if (!ReadFile(path, file))
+  {
+    std::cout << "Failed to open '" << path << "'" << std::endl;
+    return false;
+  }
+
+  // .glb: 12 byte header, then a JSON chunk and an optional binary chunk
+  const char* json = file.data();
+  size_t jsonLength = file.size();
+  std::string binaryChunk;
+  if (file.size() >= 20 && memcmp(file.data(), "glTF", 4) == 0)
+  {
+    uint32_t chunkLength, chunkType;
+    memcpy(&chunkLength, file.data() + 12, 4);
+    memcpy(&chunkType, file.data() + 16, 4);
+    if (chunkType != 0x4e4f534a || 20 + (size_t)chunkLength > file.size())  // "JSON"
+    {
+      std::cout << "Invalid glTF binary '" << path << "'" << std::endl;
+      return false;
+    }
+    json = file.data() + 20;
+    jsonLength = chunkLength;
+
+    size_t binaryOffset = 20 + ((chunkLength + 3) & ~3u);
+    if (binaryOffset + 8 <= file.size())
+    {
+      memcpy(&chunkLength, file.data() + binaryOffset, 4);
+      memcpy(&chunkType, file.data() + binaryOffset + 4, 4);
+      if (chunkType == 0x004e4942 && binaryOffset + 8 + chunkLength <= file.size())  // "BIN\0"
+        binaryChunk.assign(file.data() + binaryOffset + 8, chunkLength);
+    }
+  }
+
+  if (!JsonParser(json, json + jsonLength).Parse(document.Json))
+  {
+    std::cout << "Invalid glTF JSON in '" << path << "'" << std::endl;
+    return false;
+  }
+
+  const JsonValue& buffers = document.Json["buffers"];
+  for (size_t i = 0; i < buffers.Size(); i++)
+  {
+    const JsonValue& uri = buffers[i]["uri"];
+    document.Buffers.emplace_back();
+    std::string& data = document.Buffers.back();
+    if (uri.IsNull())
+      data = binaryChunk;
+    else if (uri.String.compare(0, 5, "data:") == 0)
+    {
+      size_t comma = uri.String.find(',');
+      if (comma == std::string::npos || uri.String.find(";base64") > comma
+        || !DecodeBase64(uri.String.data() + comma + 1, uri.String.size() - comma - 1, data))
+      {
+        std::cout << "Unsupported data URI in buffer " << i << " of '" << path << "'" << std::endl;
+        return false;
+      }
+    }
+    else if (!ReadFile(GetDirectory(path) + uri.String, data))
+    {
+      std::cout << "Failed to open buffer '" << uri.String << "' of '" << path << "'" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Reads a float, or an integer component normalized to [0, 1] or [-1, 1]
+static float ReadComponent(const unsigned char* data, int componentType, bool normalized)
+{
+  switch (componentType)
+  {
+    case GL_FLOAT:          { float v; memcpy(&v, data, 4); return v; }
+    case GL_UNSIGNED_BYTE:  return normalized ? data[0] / 255.0f : data[0];
+    case GL_BYTE:           return normalized ? std::max((signed char)data[0] / 127.0f, -1.0f) : (signed char)data[0];
+    case GL_UNSIGNED_SHORT: { uint16_t v; memcpy(&v, data, 2); return normalized ? v / 65535.0f : v; }
+    case GL_SHORT:          { int16_t v; memcpy(&v, data, 2); return normalized ? std::max(v / 32767.0f, -1.0f) : v; }
+    case GL_UNSIGNED_INT:   { uint32_t v; memcpy(&v, data, 4); return (float)v; }
+  }
+  return 0.0f;
+}
+
+// Reads components values of every element of an accessor as floats
+static bool ReadAccessor(const GltfDocument& document, int index, unsigned int components, std::vector<float>& values)
+{
+  const JsonValue& accessor = document.Json["accessors"][index];
+  const JsonValue& view = document.Json["bufferViews"][accessor["bufferView"].AsInt()];
+  int buffer = view["buffer"].AsInt();
+  int componentType = accessor["componentType"].AsInt(0);
+  if (accessor.IsNull() || view.IsNull() || buffer < 0 || buffer >= (int)document.Buffers.size() || !accessor["sparse"].IsNull())
+    return false;
+  if (componentType != GL_FLOAT && componentType != GL_UNSIGNED_BYTE && componentType != GL_BYTE
+    && componentType != GL_UNSIGNED_SHORT && componentType != GL_SHORT && componentType != GL_UNSIGNED_INT)
+    return false;
+
+  unsigned int componentSize = VertexBufferElement::GetSizeOfType(componentType);
+  size_t count = (size_t)accessor["count"].AsNumber();
+  size_t stride = (size_t)view["byteStride"].AsNumber(components * componentSize);
+  size_t offset = (size_t)view["byteOffset"].AsNumber() + (size_t)accessor["byteOffset"].AsNumber();
+  const std::string& data = document.Buffers[buffer];
+  if (count > 0 && offset + (count - 1) * stride + components * componentSize > data.size())
+    return false;
+
+  bool normalized = accessor["normalized"].Number != 0.0;
+  values.resize(count * components);
+  for (size_t i = 0; i < count; i++)
+  {
+    const unsigned char* element = (const unsigned char*)data.data() + offset + i * stride;
+    for (unsigned int c = 0; c < components; c++)
+      values[i * components + c] = ReadComponent(element + c * componentSize, componentType, normalized);
+  }
+  return true;
+}
+
+// Column-major 4x4 product a * b
+static void Multiply(const float* a, const float* b, float* result)
+{
+  float product[16];
+  for (int column = 0; column < 4; column++)
+  {
+    for (int row = 0; row < 4; row++)
+    {
+      float sum = 0.0f;
+      for (int k = 0; k < 4; k++)
+        sum += a[k * 4 + row] * b[column * 4 + k];
+      product[column * 4 + row] = sum;
+    }
+  }
+  memcpy(result, product, sizeof(product));
+}
+
+static void GetNodeTransform(const JsonValue& node, float* transform)
+{
+  const JsonValue& matrix = node["matrix"];
+  if (matrix.Size() == 16)
+  {
+    for (size_t i = 0; i < 16; i++)
+      transform[i] = (float)matrix[i].AsNumber();
+    return;
+  }
+
+  // T * R * S, the rotation is a unit quaternion (x, y, z, w)
+  const JsonValue& t = node["translation"];
+  const JsonValue& r = node["rotation"];
+  const JsonValue& s = node["scale"];
+  float x = (float)r[0].AsNumber(0.0), y = (float)r[1].AsNumber(0.0), z = (float)r[2].AsNumber(0.0), w = (float)r[3].AsNumber(1.0);
+  float sx = (float)s[0].AsNumber(1.0), sy = (float)s[1].AsNumber(1.0), sz = (float)s[2].AsNumber(1.0);
+  const float result[16] = {
+    (1 - 2 * (y * y + z * z)) * sx, (2 * (x * y + z * w)) * sx,     (2 * (x * z - y * w)) * sx,     0.0f,
+    (2 * (x * y - z * w)) * sy,     (1 - 2 * (x * x + z * z)) * sy, (2 * (y * z + x * w)) * sy,     0.0f,
+    (2 * (x * z + y * w)) * sz,     (2 * (y * z - x * w)) * sz,     (1 - 2 * (x * x + y * y)) * sz, 0.0f,
+    (float)t[0].AsNumber(0.0),      (float)t[1].AsNumber(0.0),      (float)t[2].AsNumber(0.0),      1.0f
+  };
+  memcpy(transform, result, sizeof(result));
+}
+
+static bool AppendGltfMesh(const GltfDocument& document, const JsonValue& gltfMesh, const float* transform, MeshData& mesh)
+{
+  const JsonValue& primitives = gltfMesh["primitives"];
+  for (size_t p = 0; p < primitives.Size(); p++)
+  {
+    const JsonValue& primitive = primitives[p];
+    if (primitive["mode"].AsInt(4) != 4)  // GL_TRIANGLES
+    {
+      std::cout << "Skipping a primitive with mode " << primitive["mode"].AsInt() << ", only triangles are supported" << std::endl;
+      continue;
+    }
+
+    const JsonValue& attributes = primitive["attributes"];
+    std::vector<float> positions, normals, texCoords, indexValues;
+    if (!ReadAccessor(document, attributes["POSITION"].AsInt(), 3, positions))
+      return false;
+    size_t vertexCount = positions.size() / 3;
+    if (!attributes["NORMAL"].IsNull() && !ReadAccessor(document, attributes["NORMAL"].AsInt(), 3, normals))
+      return false;
+    if (!attributes["TEXCOORD_0"].IsNull() && !ReadAccessor(document, attributes["TEXCOORD_0"].AsInt(), 2, texCoords))
+      return false;
+    if (!primitive["indices"].IsNull() && !ReadAccessor(document, primitive["indices"].AsInt(), 1, indexValues))
+      return false;
+    if (normals.size() != positions.size())
+      mesh.HasNormals = false;
+
+    // Normals use the upper 3x3, exact for rotations and uniform scales
+    size_t cornerCount = indexValues.empty() ? vertexCount : indexValues.size();
+    for (size_t i = 0; i + 2 < cornerCount; i += 3)
+    {
+      for (size_t corner = 0; corner < 3; corner++)
+      {
+        size_t index = indexValues.empty() ? i + corner : (size_t)indexValues[i + corner];
+        if (index >= vertexCount)
+          return false;
+
+        Vertex vertex = {};
+        const float* position = &positions[index * 3];
+        for (int row = 0; row < 3; row++)
+          vertex.Position[row] = transform[row] * position[0] + transform[4 + row] * position[1] + transform[8 + row] * position[2] + transform[12 + row];
+        if (normals.size() == positions.size())
+        {
+          const float* normal = &normals[index * 3];
+          for (int row = 0; row < 3; row++)
+            vertex.Normal[row] = transform[row] * normal[0] + transform[4 + row] * normal[1] + transform[8 + row] * normal[2];
+        }
+        if (texCoords.size() == vertexCount * 2)
+        {
+          // glTF puts the origin at the top left, GL at the bottom left
+          vertex.TexCoord[0] = texCoords[index * 2];
+          vertex.TexCoord[1] = 1.0f - texCoords[index * 2 + 1];
+        }
+        mesh.Vertices.push_back(vertex);
+      }
+    }
+  }
+  return true;
+}
+
+static bool AppendGltfNode(const GltfDocument& document, int index, const float* parent, MeshData& mesh, int depth)
+{
+  const JsonValue& node = document.Json["nodes"][index];
+  if (node.IsNull() || depth > 64)
+    return false;
+
+  float local[16], transform[16];
+  GetNodeTransform(node, local);
+  Multiply(parent, local, transform);
+
+  int meshIndex = node["mesh"].AsInt();
+  if (meshIndex >= 0 && !AppendGltfMesh(document, document.Json["meshes"][meshIndex], transform, mesh))
+    return false;
+
+  const JsonValue& children = node["children"];
+  for (size_t i = 0; i < children.Size(); i++)
+  {
+    if (!AppendGltfNode(document, children[i].AsInt(), transform, mesh, depth + 1))
+      return false;
+  }
+  return true;
+}
+
+// Flattens every mesh instance of the default scene into one mesh. Files
+// without scenes have all their meshes merged untransformed.
+static bool LoadGltf(const std::string& path, MeshData& mesh)
+{
+  GltfDocument document;
+  if (!LoadGltfDocument(path, document))
+    return false;
+
+  static const float identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+  const JsonValue& scenes = document.Json["scenes"];
+  bool success = true;
+  if (scenes.Size() > 0)
+  {
+    const JsonValue& nodes = scenes[document.Json["scene"].AsInt(0)]["nodes"];
+    for (size_t i = 0; i < nodes.Size() && success; i++)
+      success = AppendGltfNode(document, nodes[i].AsInt(), identity, mesh, 0);
+  }
+  else
+  {
+    const JsonValue& meshes = document.Json["meshes"];
+    for (size_t i = 0; i < meshes.Size() && success; i++)
+      success = AppendGltfMesh(document, meshes[i], identity, mesh);
+  }
+
+  if (!success)
+    std::cout << "Invalid or unsupported mesh data in '" << path << "'" << std::endl;
+  return success;
+}
+// ----------------------------------------------------------------------------
+
+// ------------------------------ Optimization --------------------------------
+struct VertexHash
+{
+  size_t operator()(const Vertex& vertex) const
+  {
+    // FNV-1a over the bytes, Vertex has no padding
+    const unsigned char* bytes = (const unsigned char*)&vertex;
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < sizeof(Vertex); i++)
+      hash = (hash ^ bytes[i]) * 1099511628211ull;
+    return (size_t)hash;
+  }
+};
+
+struct VertexEqual
+{
+  bool operator()(const Vertex& a, const Vertex& b) const
+  {
+    return memcmp(&a, &b, sizeof(Vertex)) == 0;
+  }
+};
+
+// Merges identical vertices and drops triangles that became degenerate
+static void Deduplicate(MeshData& mesh)
+{
+  std::vector<Vertex> corners;
+  corners.swap(mesh.Vertices);
+  std::unordered_map<Vertex, uint32_t, VertexHash, VertexEqual> unique;
+  unique.reserve(corners.size());
+
+  mesh.Indices.clear();
+  for (size_t i = 0; i + 2 < corners.size(); i += 3)
+  {
+    uint32_t triangle[3];
+    for (size_t corner = 0; corner < 3; corner++)
+    {
+      // -0.0 and 0.0 are the same vertex
+      Vertex vertex = corners[i + corner];
+      float* values = (float*)&vertex;
+      for (size_t v = 0; v < sizeof(Vertex) / sizeof(float); v++)
+        values[v] += 0.0f;
+
+      auto result = unique.emplace(vertex, (uint32_t)mesh.Vertices.size());
+      if (result.second)
+        mesh.Vertices.push_back(vertex);
+      triangle[corner] = result.first->second;
+    }
+    if (triangle[0] != triangle[1] && triangle[1] != triangle[2] && triangle[0] != triangle[2])
+      mesh.Indices.insert(mesh.Indices.end(), triangle, triangle + 3);
+  }
+}
+
+static void Cross(const float* a, const float* b, const float* c, float* result)
+{
+  float e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+  float e1[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+  result[0] = e0[1] * e1[2] - e0[2] * e1[1];
+  result[1] = e0[2] * e1[0] - e0[0] * e1[2];
+  result[2] = e0[0] * e1[1] - e0[1] * e1[0];
+}
+
+static void Normalize(float* v)
+{
+  float length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+  if (length > 0.0f)
+  {
+    v[0] /= length;
+    v[1] /= length;
+    v[2] /= length;
+  }
+}
+
+// Area weighted smooth normals, shared by every vertex at the same position
+// so texture seams don't show up as lighting seams
+static void GenerateNormals(MeshData& mesh)
+{
+  struct Position
+  {
+    float Value[3];
+    bool operator==(const Position& other) const { return memcmp(Value, other.Value, sizeof(Value)) == 0; }
+  };
+  struct PositionHash
+  {
+    size_t operator()(const Position& position) const
+    {
+      uint32_t bits[3];
+      memcpy(bits, position.Value, sizeof(bits));
+      return ((size_t)bits[0] * 73856093u) ^ ((size_t)bits[1] * 19349663u) ^ ((size_t)bits[2] * 83492791u);
+    }
+  };
+  struct Sum
+  {
+    float Value[3] = {};
+  };
+  std::unordered_map<Position, Sum, PositionHash> sums;
+  auto key = [](const Vertex& vertex) { Position position; memcpy(position.Value, vertex.Position, sizeof(position.Value)); return position; };
+
+  for (size_t i = 0; i < mesh.Indices.size(); i += 3)
+  {
+    float normal[3];
+    Cross(mesh.Vertices[mesh.Indices[i]].Position, mesh.Vertices[mesh.Indices[i + 1]].Position,
+      mesh.Vertices[mesh.Indices[i + 2]].Position, normal);
+    for (size_t corner = 0; corner < 3; corner++)
+    {
+      Sum& sum = sums[key(mesh.Vertices[mesh.Indices[i + corner]])];
+      for (int c = 0; c < 3; c++)
+        sum.Value[c] += normal[c];
+    }
+  }
+
+  for (Vertex& vertex : mesh.Vertices)
+  {
+    auto it = sums.find(key(vertex));
+    if (it != sums.end())
+      memcpy(vertex.Normal, it->second.Value, sizeof(vertex.Normal));
+    Normalize(vertex.Normal);
+  }
+}
+
+// FIFO model of the post-transform cache, the common hardware behavior
+class FifoCache
+{
+private:
+  std::vector<uint32_t> m_Timestamps;
+  uint32_t m_Time;
+  uint32_t m_Size;
+public:
+  FifoCache(size_t vertexCount, uint32_t size)
+    : m_Timestamps(vertexCount, 0), m_Time(size + 1), m_Size(size) {}
+
+  // True on a miss, which transforms the vertex and pushes it in
+  bool Access(uint32_t vertex)
+  {
+    if (m_Time - m_Timestamps[vertex] <= m_Size)
+      return false;
+    m_Timestamps[vertex] = m_Time++;
+    return true;
+  }
+
+  void Flush() { m_Time += m_Size + 1; }
+};
+
+static const uint32_t FifoCacheSize = 16;
+
+// Average cache miss ratio: vertices transformed per triangle, 0.5 at best
+static float GetAcmr(const std::vector<uint32_t>& indices, size_t vertexCount)
+{
+  FifoCache cache(vertexCount, FifoCacheSize);
+  size_t misses = 0;
+  for (uint32_t index : indices)
+    misses += cache.Access(index);
+  return indices.empty() ? 0.0f : misses / (indices.size() / 3.0f);
+}
+
+// Tom Forsyth, "Linear-Speed Vertex Cache Optimisation": greedily emits the
+// triangle with the highest score, where vertices score for being recently
+// used and for having few triangles left, against a 32 entry LRU cache.
+static const int ForsythCacheSize = 32;
+
+static float ForsythVertexScore(int cachePosition, uint32_t remaining)
+{
+  if (remaining == 0)
+    return -1.0f;
+
+  float score = 0.0f;
+  if (cachePosition >= 0)
+  {
+    // The last triangle's vertices get a fixed score so its neighbors aren't favored too much
+    if (cachePosition < 3)
+      score = 0.75f;
+    else
+      score = powf(1.0f - (cachePosition - 3) / (float)(ForsythCacheSize - 3), 1.5f);
+  }
+  // Vertices with few triangles left are finished off first
+  return score + 2.0f * powf((float)remaining, -0.5f);
+}
+
+static std::vector<uint32_t> OptimizeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount)
+{
+  size_t triangleCount = indices.size() / 3;
+
+  // Triangles of each vertex, the first Remaining ones are still to be emitted
+  std::vector<uint32_t> remaining(vertexCount, 0), offsets(vertexCount + 1, 0);
+  for (uint32_t index : indices)
+    remaining[index]++;
+  for (size_t v = 0; v < vertexCount; v++)
+    offsets[v + 1] = offsets[v] + remaining[v];
+  std::vector<uint32_t> adjacency(indices.size()), fill(offsets.begin(), offsets.end() - 1);
+  for (size_t i = 0; i < indices.size(); i++)
+    adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+
+  std::vector<int> cachePositions(vertexCount, -1);
+  std::vector<float> vertexScores(vertexCount), triangleScores(triangleCount, 0.0f);
+  std::vector<bool> emitted(triangleCount, false);
+  for (size_t v = 0; v < vertexCount; v++)
+    vertexScores[v] = ForsythVertexScore(-1, remaining[v]);
+  for (size_t t = 0; t < triangleCount; t++)
+    triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+
+  std::vector<uint32_t> cache, newCache, result;
+  result.reserve(indices.size());
+  size_t cursor = 0;
+  int best = -1;
+  while (result.size() < indices.size())
+  {
+    // Nothing in the cache has triangles left, continue with the next unused one
+    if (best < 0)
+    {
+      while (emitted[cursor])
+        cursor++;
+      best = (int)cursor;
+    }
+
+    const uint32_t* triangle = &indices[best * 3];
+    result.insert(result.end(), triangle, triangle + 3);
+    emitted[best] = true;
+
+    newCache.assign(triangle, triangle + 3);
+    for (int corner = 0; corner < 3; corner++)
+    {
+      uint32_t v = triangle[corner];
+      uint32_t* list = &adjacency[offsets[v]];
+      uint32_t* last = list + remaining[v] - 1;
+      *std::find(list, last + 1, (uint32_t)best) = *last;
+      remaining[v]--;
+    }
+    for (uint32_t v : cache)
+    {
+      if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+        newCache.push_back(v);
+    }
+
+    // Vertices pushed out of the cache score as uncached again
+    for (size_t i = 0; i < newCache.size(); i++)
+    {
+      uint32_t v = newCache[i];
+      cachePositions[v] = i < (size_t)ForsythCacheSize ? (int)i : -1;
+      vertexScores[v] = ForsythVertexScore(cachePositions[v], remaining[v]);
+    }
+
+    best = -1;
+    float bestScore = -1.0f;
+    for (uint32_t v : newCache)
+    {
+      for (uint32_t i = 0; i < remaining[v]; i++)
+      {
+        uint32_t t = adjacency[offsets[v] + i];
+        float score = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+        triangleScores[t] = score;
+        if (score > bestScore)
+        {
+          bestScore = score;
+          best = (int)t;
+        }
+      }
+    }
+
+    if (newCache.size() > (size_t)ForsythCacheSize)
+      newCache.resize(ForsythCacheSize);
+    cache.swap(newCache);
+  }
+  return result;
+}
+
+// Second pass of Tipsify (Sander, Nehab and Barczak, "Fast Triangle
+// Reordering for Vertex Locality and Reduced Overdraw"): the cache
+// optimized order is cut into clusters wherever the cache was flushed
+// anyway or the miss ratio allows it, and the clusters are sorted so
+// those facing away from the mesh center, which are the likely
+// occluders, are drawn first. threshold is the ACMR increase accepted
+// for smaller clusters.
+static std::vector<uint32_t> OptimizeOverdraw(const std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices,
+  float threshold, size_t& clusterCount)
+{
+  size_t triangleCount = indices.size() / 3;
+
+  // Hard boundaries, where a triangle missed the cache with all three vertices
+  std::vector<size_t> hard;
+  {
+    FifoCache cache(vertices.size(), FifoCacheSize);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+      unsigned int misses = cache.Access(indices[t * 3]) + cache.Access(indices[t * 3 + 1]) + cache.Access(indices[t * 3 + 2]);
+      if (misses == 3 || t == 0)
+        hard.push_back(t);
+    }
+    hard.push_back(triangleCount);
+  }
+
+  // Soft boundaries, wherever the running ACMR since the last cut is
+  // within threshold of the whole hard cluster's
+  std::vector<size_t> clusters;
+  for (size_t h = 0; h + 1 < hard.size(); h++)
+  {
+    size_t start = hard[h], end = hard[h + 1];
+    FifoCache cache(vertices.size(), FifoCacheSize);
+    size_t clusterMisses = 0;
+    for (size_t i = start * 3; i < end * 3; i++)
+      clusterMisses += cache.Access(indices[i]);
+    float clusterThreshold = threshold * clusterMisses / (end - start);
+
+    clusters.push_back(start);
+    cache.Flush();
+    size_t misses = 0, clusterStart = start;
+    for (size_t t = start; t < end; t++)
+    {
+      misses += cache.Access(indices[t * 3]) + cache.Access(indices[t * 3 + 1]) + cache.Access(indices[t * 3 + 2]);
+      if (t + 1 < end && misses / (float)(t - clusterStart + 1) <= clusterThreshold)
+      {
+        clusters.push_back(t + 1);
+        clusterStart = t + 1;
+        misses = 0;
+        cache.Flush();
+      }
+    }
+  }
+  clusters.push_back(triangleCount);
+  clusterCount = clusters.size() - 1;
+
+  // Area weighted centroids and normals
+  struct Cluster
+  {
+    size_t Start, End;
+    float Centroid[3], Normal[3], Area;
+    float SortKey;
+  };
+  std::vector<Cluster> sorted(clusterCount);
+  float meshCentroid[3] = {}, meshArea = 0.0f;
+  for (size_t c = 0; c < clusterCount; c++)
+  {
+    Cluster& cluster = sorted[c];
+    cluster = { clusters[c], clusters[c + 1], {}, {}, 0.0f, 0.0f };
+    for (size_t t = cluster.Start; t < cluster.End; t++)
+    {
+      const float* a = vertices[indices[t * 3]].Position;
+      const float* b = vertices[indices[t * 3 + 1]].Position;
+      const float* p = vertices[indices[t * 3 + 2]].Position;
+      float normal[3];
+      Cross(a, b, p, normal);
+      float area = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+      for (int i = 0; i < 3; i++)
+      {
+        cluster.Centroid[i] += (a[i] + b[i] + p[i]) / 3.0f * area;
+        cluster.Normal[i] += normal[i];
+      }
+      cluster.Area += area;
+    }
+    for (int i = 0; i < 3; i++)
+      meshCentroid[i] += cluster.Centroid[i];
+    meshArea += cluster.Area;
+    if (cluster.Area > 0.0f)
+    {
+      for (int i = 0; i < 3; i++)
+        cluster.Centroid[i] /= cluster.Area;
+    }
+    Normalize(cluster.Normal);
+  }
+  for (int i = 0; i < 3; i++)
+    meshCentroid[i] = meshArea > 0.0f ? meshCentroid[i] / meshArea : 0.0f;
+
+  for (Cluster& cluster : sorted)
+  {
+    cluster.SortKey = 0.0f;
+    for (int i = 0; i < 3; i++)
+      cluster.SortKey += (cluster.Centroid[i] - meshCentroid[i]) * cluster.Normal[i];
+  }
+  std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) { return a.SortKey > b.SortKey; });
+
+  std::vector<uint32_t> result;
+  result.reserve(indices.size());
+  for (const Cluster& cluster : sorted)
+    result.insert(result.end(), indices.begin() + cluster.Start * 3, indices.begin() + cluster.End * 3);
+  return result;
+}
+
+// Renumbers vertices in the order the indices first reference them, so
+// vertex fetches walk the buffer mostly forward
+static void OptimizeVertexFetch(MeshData& mesh)
+{
+  std::vector<uint32_t> remap(mesh.Vertices.size(), UINT32_MAX);
+  std::vector<Vertex> vertices;
+  vertices.reserve(mesh.Vertices.size());
+  for (uint32_t& index : mesh.Indices)
+  {
+    if (remap[index] == UINT32_MAX)
+    {
+      remap[index] = (uint32_t)vertices.size();
+      vertices.push_back(mesh.Vertices[index]);
+    }
+    index = remap[index];
+  }
+  mesh.Vertices.swap(vertices);
+}
+// ----------------------------------------------------------------------------
+
+template<typename Layout, typename T>
+static std::vector<unsigned char> Encode(const std::vector<T>& vertices, std::vector<CookedMeshAttribute>& attributes)
+{
+  for (unsigned int i = 0; i < Layout::ElementCount; i++)
+  {
+    const VertexBufferElement& element = Layout::Elements[i];
+    attributes.push_back({ element.type, element.count, element.normalized, element.offset });
+  }
+  std::vector<unsigned char> data(vertices.size() * sizeof(T));
+  memcpy(data.data(), vertices.data(), data.size());
+  return data;
+}
+
+static bool Write(const std::string& path, const MeshData& mesh, bool floatVertices, size_t& fileSize)
+{
+  std::vector<CookedMeshAttribute> attributes;
+  std::vector<unsigned char> vertexData;
+  if (floatVertices)
+  {
+    std::vector<FloatVertex> vertices(mesh.Vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+      memcpy(&vertices[i], &mesh.Vertices[i], sizeof(FloatVertex));
+    vertexData = Encode<FloatVertexLayout>(vertices, attributes);
+  }
+  else
+  {
+    std::vector<CompactVertex> vertices(mesh.Vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+      const Vertex& source = mesh.Vertices[i];
+      memcpy(vertices[i].Position, source.Position, sizeof(source.Position));
+      vertices[i].Normal = PackedNormal(source.Normal[0], source.Normal[1], source.Normal[2]);
+      vertices[i].TexCoord[0] = Half(source.TexCoord[0]);
+      vertices[i].TexCoord[1] = Half(source.TexCoord[1]);
+    }
+    vertexData = Encode<CompactVertexLayout>(vertices, attributes);
+  }
+
+  // Any index fits in 16 bits when there are at most 65536 vertices
+  std::vector<unsigned char> indexData;
+  bool shortIndices = mesh.Vertices.size() <= 65536;
+  if (shortIndices)
+  {
+    std::vector<uint16_t> indices(mesh.Indices.begin(), mesh.Indices.end());
+    indexData.resize(indices.size() * sizeof(uint16_t));
+    memcpy(indexData.data(), indices.data(), indexData.size());
+  }
+  else
+  {
+    indexData.resize(mesh.Indices.size() * sizeof(uint32_t));
+    memcpy(indexData.data(), mesh.Indices.data(), indexData.size());
+  }
+
+  CookedMeshHeader header = {};
+  header.Magic = CookedMeshMagic;
+  header.Version = CookedMeshVersion;
+  header.VertexCount = (uint32_t)mesh.Vertices.size();
+  header.VertexStride = floatVertices ? sizeof(FloatVertex) : sizeof(CompactVertex);
+  header.AttributeCount = (uint32_t)attributes.size();
+  header.IndexCount = (uint32_t)mesh.Indices.size();
+  header.IndexType = shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+  header.VertexOffset = (sizeof(header) + attributes.size() * sizeof(CookedMeshAttribute) + 15) & ~(uint64_t)15;
+  header.IndexOffset = (header.VertexOffset + vertexData.size() + 15) & ~(uint64_t)15;
+  for (int i = 0; i < 3; i++)
+  {
+    header.BoundsMin[i] = mesh.Vertices.empty() ? 0.0f : INFINITY;
+    header.BoundsMax[i] = mesh.Vertices.empty() ? 0.0f : -INFINITY;
+  }
+  for (const Vertex& vertex : mesh.Vertices)
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      header.BoundsMin[i] = std::min(header.BoundsMin[i], vertex.Position[i]);
+      header.BoundsMax[i] = std::max(header.BoundsMax[i], vertex.Position[i]);
+    }
+  }
+
+  std::ofstream stream(path, std::ios::binary);
+  if (!stream)
+    return false;
+
+  static const char padding[16] = {};
+  stream.write((const char*)&header, sizeof(header));
+  stream.write((const char*)attributes.data(), attributes.size() * sizeof(CookedMeshAttribute));
+  stream.write(padding, header.VertexOffset - stream.tellp());
+  stream.write((const char*)vertexData.data(), vertexData.size());
+  stream.write(padding, header.IndexOffset - stream.tellp());
+  stream.write((const char*)indexData.data(), indexData.size());
+  fileSize = (size_t)stream.tellp();
+  return (bool)stream;
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 3)
+  {
+    std::cout << "Usage: MeshCooker <input.obj|.gltf|.glb> <output" << CookedMeshExtension
+      << "> [--float] [--no-optimize] [--overdraw-threshold 1.05]" << std::endl;
+    return -1;
+  }
+
+  std::string input = argv[1], output = argv[2];
+  bool floatVertices = false, optimize = true;
+  float overdrawThreshold = 1.05f;
+  for (int i = 3; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--float") == 0)
+      floatVertices = true;
+    else if (strcmp(argv[i], "--no-optimize") == 0)
+      optimize = false;
+    else if (strcmp(argv[i], "--overdraw-threshold") == 0 && i + 1 < argc)
+      overdrawThreshold = (float)atof(argv[++i]);
+    else
+      std::cout << "Unknown option '" << argv[i] << "'" << std::endl;
+  }
+
+  MeshData mesh;
+  bool loaded = EndsWith(input, ".obj") ? LoadObj(input, mesh) : LoadGltf(input, mesh);
+  if (!loaded)
+    return -1;
+
+  size_t corners = mesh.Vertices.size();
+  Deduplicate(mesh);
+  if (mesh.Indices.empty())
+  {
+    std::cout << "'" << input << "' has no triangles" << std::endl;
+    return -1;
+  }
+  if (!mesh.HasNormals)
+    GenerateNormals(mesh);
+  std::cout << "Merged " << corners << " corners into " << mesh.Vertices.size() << " vertices, "
+    << mesh.Indices.size() / 3 << " triangles" << std::endl;
+
+  if (optimize)
+  {
+    float acmrBefore = GetAcmr(mesh.Indices, mesh.Vertices.size());
+    mesh.Indices = OptimizeVertexCache(mesh.Indices, mesh.Vertices.size());
+    float acmrCache = GetAcmr(mesh.Indices, mesh.Vertices.size());
+    size_t clusterCount = 0;
+    mesh.Indices = OptimizeOverdraw(mesh.Indices, mesh.Vertices, overdrawThreshold, clusterCount);
+    float acmrAfter = GetAcmr(mesh.Indices, mesh.Vertices.size());
+    OptimizeVertexFetch(mesh);
+
+    std::cout << "ACMR (" << FifoCacheSize << " entry FIFO): " << acmrBefore << " -> " << acmrCache
+      << " after cache ordering -> " << acmrAfter << " after sorting " << clusterCount << " overdraw clusters" << std::endl;
+  }
+
+  size_t fileSize = 0;
+  if (!Write(output, mesh, floatVertices, fileSize))
+  {
+    std::cout << "Failed to write '" << output << "'" << std::endl;
+    return -1;
+  }
+
+  std::cout << "Cooked '" << input << "' (" << mesh.Vertices.size() << " vertices, " << mesh.Indices.size() / 3 << " triangles, "
+    << (mesh.Vertices.size() <= 65536 ? 16 : 32) << "-bit indices, "
+    << (floatVertices ? sizeof(FloatVertex) : sizeof(CompactVertex)) << " bytes per vertex, " << fileSize / 1024 << " KiB)" << std::endl;
+  return 0;
+}
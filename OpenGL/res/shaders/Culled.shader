@@ -0,0 +1,48 @@
+#shader vertex
+#version 330 core
+
+// Unit cube scaled into an object's bounding box
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+
+layout(std140) uniform Frame
+{
+  mat4 u_ViewProjection;
+};
+
+// One slot per visible object in a dynamic uniform buffer
+layout(std140) uniform Object
+{
+  vec4 u_Center;  // w unused
+  vec4 u_Extent;  // Half size, w unused
+  vec4 u_Color;
+};
+
+out vec3 v_Normal;
+
+void main()
+{
+  gl_Position = u_ViewProjection * vec4(u_Center.xyz + position * u_Extent.xyz, 1.0);
+  v_Normal = normal;
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec3 v_Normal;
+
+layout(std140) uniform Object
+{
+  vec4 u_Center;
+  vec4 u_Extent;
+  vec4 u_Color;
+};
+
+void main()
+{
+  vec3 light = normalize(vec3(0.4, 0.7, 0.6));
+  float diffuse = max(dot(normalize(v_Normal), light), 0.0);
+  color = vec4(u_Color.rgb * (0.25 + 0.75 * diffuse), 1.0);
+}
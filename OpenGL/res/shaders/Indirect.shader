@@ -0,0 +1,43 @@
+#shader vertex
+#version 330 core
+
+// Object of an IndirectScene. Meshes fit into the unit sphere, the object
+// scales one into its bounding sphere and spins it about y.
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec4 normal;
+layout(location = 2) in vec4 sphere;  // Per instance: center and radius
+layout(location = 3) in vec4 color;
+// Location 4 is the mesh index, only the cull shader reads it
+layout(location = 5) in vec2 spin;    // Angle and angular velocity
+
+uniform mat4 u_ViewProjection;
+uniform float u_Time;
+
+out vec3 v_Normal;
+out vec4 v_Color;
+
+void main()
+{
+  float angle = spin.x + spin.y * u_Time;
+  float c = cos(angle), s = sin(angle);
+  mat3 rotation = mat3(c, 0.0, -s, 0.0, 1.0, 0.0, s, 0.0, c);
+
+  gl_Position = u_ViewProjection * vec4(sphere.xyz + rotation * position * sphere.w, 1.0);
+  v_Normal = rotation * normal.xyz;
+  v_Color = color;
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec3 v_Normal;
+in vec4 v_Color;
+
+void main()
+{
+  vec3 light = normalize(vec3(0.4, 0.7, 0.6));
+  float diffuse = max(dot(normalize(v_Normal), light), 0.0);
+  color = vec4(v_Color.rgb * (0.25 + 0.75 * diffuse), 1.0);
+}
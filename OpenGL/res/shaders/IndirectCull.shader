@@ -0,0 +1,70 @@
+#shader compute
+#version 430 core
+
+// Frustum culling for IndirectScene: one invocation per object writes
+// the object's draw command. With COMPACT the visible objects' commands
+// are packed to the front and the count is the draw count of
+// glMultiDrawElementsIndirectCount, without it every object keeps its
+// slot and culled ones get no instances.
+
+layout(local_size_x = 64) in;
+
+// IndirectObject, also the per-instance vertex data of the draw shader
+struct Object
+{
+  vec4 Sphere;  // Center and radius
+  uint Color;
+  uint Mesh;
+  vec2 Spin;
+};
+
+struct Mesh
+{
+  uint IndexCount;
+  uint FirstIndex;
+  int BaseVertex;
+};
+
+// DrawElementsIndirectCommand
+struct Command
+{
+  uint Count;
+  uint InstanceCount;
+  uint FirstIndex;
+  int BaseVertex;
+  uint BaseInstance;
+};
+
+layout(std430, binding = 0) readonly buffer Objects { Object objects[]; };
+layout(std430, binding = 1) readonly buffer Meshes { Mesh meshes[]; };
+layout(std430, binding = 2) writeonly buffer Commands { Command commands[]; };
+layout(std430, binding = 3) buffer VisibleCount { uint visibleCount; };
+
+uniform vec4 u_Planes[6];  // Facing inwards, unit normals
+uniform int u_ObjectCount;
+
+void main()
+{
+  uint index = gl_GlobalInvocationID.x;
+  if (index >= uint(u_ObjectCount))
+    return;
+
+  vec4 sphere = objects[index].Sphere;
+  bool visible = true;
+  for (int i = 0; i < 6; i++)
+    visible = visible && dot(u_Planes[i].xyz, sphere.xyz) + u_Planes[i].w >= -sphere.w;
+
+#ifdef COMPACT
+  if (!visible)
+    return;
+  uint slot = atomicAdd(visibleCount, 1u);
+#else
+  uint slot = index;
+  if (visible)
+    atomicAdd(visibleCount, 1u);
+#endif
+
+  // The base instance picks the object's attributes in the draw
+  Mesh mesh = meshes[objects[index].Mesh];
+  commands[slot] = Command(mesh.IndexCount, visible ? 1u : 0u, mesh.FirstIndex, mesh.BaseVertex, index);
+}
@@ -0,0 +1,31 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec4 i_Color;
+layout(location = 2) in mat4 i_Transform;
+
+uniform float u_Time;
+
+out vec4 v_Color;
+
+void main()
+{
+  // Spin every instance around its own center
+  float angle = u_Time + float(gl_InstanceID) * 0.001;
+  mat2 spin = mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+  gl_Position = i_Transform * vec4(spin * position, 0.0, 1.0);
+  v_Color = i_Color;
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+
+void main()
+{
+  color = v_Color;
+}
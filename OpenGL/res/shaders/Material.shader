@@ -0,0 +1,51 @@
+#version 330 core
+#include "include/Math.glsl"
+
+// Compiled as ShaderVariants, keywords:
+//   PATTERN:  STRIPES, CHECKER, RINGS, DOTS
+//   COLOR:    WARM, COOL, MONO, RAINBOW
+//   ANIMATED, VIGNETTE, OUTLINE
+
+#shader vertex
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 texCoord;
+
+uniform vec4 u_Rect;  // Center in xy, half extents in zw
+
+out vec2 v_TexCoord;
+
+void main()
+{
+  gl_Position = vec4(u_Rect.xy + position * u_Rect.zw, 0.0, 1.0);
+  v_TexCoord = texCoord;
+}
+
+#shader fragment
+#include "include/Patterns.glsl"
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+#ifdef ANIMATED
+uniform float u_Time;
+#endif
+
+void main()
+{
+  vec2 uv = v_TexCoord;
+#ifdef ANIMATED
+  uv = Rotate(uv - 0.5, u_Time * 0.5) + 0.5;
+#endif
+  vec3 rgb = Palette(Pattern(uv));
+#ifdef VIGNETTE
+  vec2 offset = v_TexCoord - 0.5;
+  rgb *= 1.0 - 1.6 * dot(offset, offset);
+#endif
+#ifdef OUTLINE
+  vec2 edge = min(v_TexCoord, 1.0 - v_TexCoord);
+  if (min(edge.x, edge.y) < 0.05)
+    rgb = vec3(1.0);
+#endif
+  color = vec4(rgb, 1.0);
+}
@@ -0,0 +1,39 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 texCoord;
+
+uniform mat4 u_Transform;
+uniform mat3 u_NormalMatrix;
+
+out vec3 v_Normal;
+out vec2 v_TexCoord;
+
+void main()
+{
+  gl_Position = u_Transform * vec4(position, 1.0);
+  v_Normal = u_NormalMatrix * normal;
+  v_TexCoord = texCoord;
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec3 v_Normal;
+in vec2 v_TexCoord;
+
+void main()
+{
+  // Checker on the texture coordinates so the UV mapping is visible
+  vec2 cell = floor(v_TexCoord * 16.0);
+  float checker = mod(cell.x + cell.y, 2.0);
+  vec3 albedo = mix(vec3(0.9, 0.55, 0.2), vec3(0.95, 0.85, 0.7), checker);
+
+  vec3 light = normalize(vec3(0.4, 0.7, 0.6));
+  float diffuse = max(dot(normalize(v_Normal), light), 0.0);
+  color = vec4(albedo * (0.2 + 0.8 * diffuse), 1.0);
+}
@@ -0,0 +1,27 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec4 color;
+
+uniform vec4 u_Rect;  // Center in xy, half extents in zw
+
+out vec4 v_Color;
+
+void main()
+{
+  gl_Position = vec4(u_Rect.xy + position * u_Rect.zw, 0.0, 1.0);
+  v_Color = color;
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+
+void main()
+{
+  color = v_Color;
+}
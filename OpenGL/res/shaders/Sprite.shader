@@ -0,0 +1,45 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 texCoord;
+
+layout(std140) uniform Frame
+{
+  mat4 u_ViewProjection;
+};
+
+// One slot per sprite in a dynamic uniform buffer
+layout(std140) uniform Sprite
+{
+  vec4 u_Rect;  // Center in xy, half extents in zw
+  vec4 u_Color;
+};
+
+out vec2 v_TexCoord;
+
+void main()
+{
+  gl_Position = u_ViewProjection * vec4(u_Rect.xy + position * u_Rect.zw, 0.0, 1.0);
+  v_TexCoord = texCoord;
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+layout(std140) uniform Sprite
+{
+  vec4 u_Rect;
+  vec4 u_Color;
+};
+
+uniform sampler2D u_Texture;
+
+void main()
+{
+  color = texture(u_Texture, v_TexCoord) * u_Color;
+}
@@ -0,0 +1,8 @@
+const float PI = 3.14159265;
+const float TAU = 6.28318531;
+
+vec2 Rotate(vec2 v, float angle)
+{
+  float s = sin(angle), c = cos(angle);
+  return vec2(c * v.x - s * v.y, s * v.x + c * v.y);
+}
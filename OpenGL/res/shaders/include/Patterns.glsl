@@ -0,0 +1,34 @@
+// Material building blocks, selected by the PATTERN and COLOR keywords
+#include "Math.glsl"
+
+// Pattern intensity in [0, 1] at a texture coordinate
+float Pattern(vec2 uv)
+{
+#if defined(STRIPES)
+  return step(0.5, fract(uv.x * 6.0));
+#elif defined(CHECKER)
+  vec2 cell = floor(uv * 4.0);
+  return mod(cell.x + cell.y, 2.0);
+#elif defined(RINGS)
+  return 0.5 + 0.5 * cos(length(uv - 0.5) * 4.0 * TAU);
+#elif defined(DOTS)
+  return 1.0 - step(0.3, length(fract(uv * 4.0) - 0.5));
+#else
+  return uv.y;
+#endif
+}
+
+vec3 Palette(float t)
+{
+#if defined(WARM)
+  return mix(vec3(0.5, 0.1, 0.05), vec3(1.0, 0.8, 0.3), t);
+#elif defined(COOL)
+  return mix(vec3(0.05, 0.1, 0.4), vec3(0.4, 0.9, 1.0), t);
+#elif defined(MONO)
+  return vec3(t);
+#elif defined(RAINBOW)
+  return 0.5 + 0.5 * cos(TAU * (0.75 * t + vec3(0.0, 0.33, 0.67)));
+#else
+  return mix(vec3(0.2), vec3(0.2, 0.5, 0.9), t);
+#endif
+}
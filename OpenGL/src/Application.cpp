@@ -1,131 +1,333 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
 #include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
 
 #include "Renderer.h"
 
-#include "VertexBuffer.h"
-#include "VertexBufferLayout.h"
-#include "IndexBuffer.h"
-#include "VertexArray.h"
-#include "Shader.h"
-#include "Texture.h"
+#include "GLState.h"
+#include "ShaderCache.h"
+#include "Framebuffer.h"
+#include "HeadlessContext.h"
+#include "Profiler.h"
+#include "FramePacer.h"
+#include "ResourceManager.h"
+#include "Memory.h"
 
-int main(void)
-{
-  // --------------------- Initialize GLFW and GLEW ---------------------
-  GLFWwindow* window;
+#include "demos/DemoBasic.h"
+#include "demos/DemoInstancing.h"
+#include "demos/DemoRenderQueue.h"
+#include "demos/DemoSimulation.h"
+#include "demos/DemoMesh.h"
+#include "demos/DemoShaderVariants.h"
+#include "demos/DemoGeometryPool.h"
+#include "demos/DemoIndirect.h"
+#include "demos/DemoBvh.h"
 
-  if (!glfwInit())
-    return -1;
+struct Options
+{
+  bool Headless = false;
+  int Width = 640, Height = 480;
+  // Number of frames to render, 0 runs until the window is closed
+  unsigned int Frames = 0;
+  // Directory to write every rendered frame to (headless only)
+  std::string DumpDirectory;
+  // Directory for linked program binaries, empty to always compile
+  std::string ShaderCacheDirectory = "shadercache";
+  // Scene to run, see CreateDemo
+  std::string Demo = "basic";
+  // Cooked mesh shown by the mesh demo
+  std::string MeshPath = "OpenGL/res/meshes/torus.cmesh";
+  // Objects of the indirect and bvh demos, and how the indirect demo
+  // draws them, empty for the fastest path the context supports
+  unsigned int ObjectCount = 100000;
+  std::string IndirectPath;
+  // Chrome trace of the first ProfileFrames frames, empty for none
+  std::string ProfilePath;
+  unsigned int ProfileFrames = 60;
+  // vsync by default with a window, uncapped without
+  PresentMode Present = PresentMode::VSync;
+  bool PresentSet = false;
+  double FrameRateCap = 60.0;
+};
 
-  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+static void PrintUsage()
+{
+  std::cerr << "Usage: OpenGL [--headless] [--width n] [--height n] [--frames n] [--dump directory]"
+    " [--shader-cache directory] [--no-shader-cache] [--demo name] [--mesh path] [--objects n]"
+    " [--indirect gpu|cpu|loop] [--profile path] [--profile-frames n] [--present vsync|uncapped|cap]"
+    " [--fps n]" << std::endl;
+}
 
-  window = glfwCreateWindow(640, 480, "Hello World!", NULL, NULL);
-  if (!window)
+// False on an unknown option, one missing its value or an unknown present
+// mode, so a typo in a headless run fails instead of running with defaults
+static bool ParseOptions(int argc, char** argv, Options& options)
+{
+  for (int i = 1; i < argc; i++)
   {
-    glfwTerminate();
-    return -1;
+    bool hasValue = i + 1 < argc;
+    if (strcmp(argv[i], "--headless") == 0)
+      options.Headless = true;
+    else if (strcmp(argv[i], "--width") == 0 && hasValue)
+      options.Width = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--height") == 0 && hasValue)
+      options.Height = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--frames") == 0 && hasValue)
+      options.Frames = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--dump") == 0 && hasValue)
+      options.DumpDirectory = argv[++i];
+    else if (strcmp(argv[i], "--shader-cache") == 0 && hasValue)
+      options.ShaderCacheDirectory = argv[++i];
+    else if (strcmp(argv[i], "--no-shader-cache") == 0)
+      options.ShaderCacheDirectory.clear();
+    else if (strcmp(argv[i], "--demo") == 0 && hasValue)
+      options.Demo = argv[++i];
+    else if (strcmp(argv[i], "--mesh") == 0 && hasValue)
+      options.MeshPath = argv[++i];
+    else if (strcmp(argv[i], "--objects") == 0 && hasValue)
+      options.ObjectCount = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--indirect") == 0 && hasValue)
+      options.IndirectPath = argv[++i];
+    else if (strcmp(argv[i], "--profile") == 0 && hasValue)
+      options.ProfilePath = argv[++i];
+    else if (strcmp(argv[i], "--profile-frames") == 0 && hasValue)
+      options.ProfileFrames = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--present") == 0 && hasValue)
+    {
+      if (!FramePacer::ParseMode(argv[++i], options.Present))
+      {
+        std::cerr << "Unknown present mode '" << argv[i] << "', expected vsync, uncapped or cap" << std::endl;
+        PrintUsage();
+        return false;
+      }
+      options.PresentSet = true;
+    }
+    else if (strcmp(argv[i], "--fps") == 0 && hasValue)
+      options.FrameRateCap = atof(argv[++i]);
+    else
+    {
+      bool takesValue = false;
+      for (const char* name : { "--width", "--height", "--frames", "--dump", "--shader-cache", "--demo", "--mesh",
+        "--objects", "--indirect", "--profile", "--profile-frames", "--present", "--fps" })
+        takesValue |= strcmp(argv[i], name) == 0;
+      if (takesValue)
+        std::cerr << "Missing value for '" << argv[i] << "'" << std::endl;
+      else
+        std::cerr << "Unknown option '" << argv[i] << "'" << std::endl;
+      PrintUsage();
+      return false;
+    }
   }
 
-  glfwMakeContextCurrent(window);
+  if (options.Headless && options.Frames == 0)
+    options.Frames = 300;
+  if (options.Headless && !options.PresentSet)
+    options.Present = PresentMode::Uncapped;
+  return true;
+}
+
+static std::unique_ptr<demo::Demo> CreateDemo(const Options& options, ResourceManager& resources)
+{
+  const std::string& name = options.Demo;
+  if (name == "basic")
+    return std::unique_ptr<demo::Demo>(new demo::DemoBasic());
+  if (name == "instancing")
+    return std::unique_ptr<demo::Demo>(new demo::DemoInstancing());
+  if (name == "queue")
+    return std::unique_ptr<demo::Demo>(new demo::DemoRenderQueue(resources));
+  if (name == "simulation")
+    return std::unique_ptr<demo::Demo>(new demo::DemoSimulation());
+  if (name == "mesh")
+    return std::unique_ptr<demo::Demo>(new demo::DemoMesh(options.MeshPath, (float)options.Width / options.Height));
+  if (name == "variants")
+    return std::unique_ptr<demo::Demo>(new demo::DemoShaderVariants());
+  if (name == "pool")
+    return std::unique_ptr<demo::Demo>(new demo::DemoGeometryPool());
+  if (name == "indirect")
+  {
+    IndirectPath path = IndirectScene::GetBestPath();
+    if (!options.IndirectPath.empty() && !IndirectScene::ParsePath(options.IndirectPath.c_str(), path))
+      std::cout << "Unknown indirect path '" << options.IndirectPath << "', expected gpu, cpu or loop" << std::endl;
+    return std::unique_ptr<demo::Demo>(new demo::DemoIndirect(std::max(options.ObjectCount, 1u), path, (float)options.Width / options.Height));
+  }
+  if (name == "bvh")
+    return std::unique_ptr<demo::Demo>(new demo::DemoBvh(std::max(options.ObjectCount, 1u), (float)options.Width / options.Height));
+  return nullptr;
+}
 
-  // Set glfwSwapBuffers to run once per frame render.
-  // Implies, set FPS = max supported FPS
-  glfwSwapInterval(1);
+int main(int argc, char** argv)
+{
+  Options options;
+  if (!ParseOptions(argc, argv, options))
+    return 2;
 
-  if (glewInit() != GLEW_OK)
-    std::cout << "Error!" << std::endl;
+  FramePacer pacer(options.Present, options.FrameRateCap, !options.Headless);
 
-  std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
-  // --------------------------------------------------------------------
+  // --------------------- Initialize GLFW and GLEW ---------------------
+  GLFWwindow* window = nullptr;
+  std::unique_ptr<HeadlessContext> headless;
 
-  // -------------------- Data to be sent to the GPU --------------------
-  float positions[] = {
-    -0.5f, -0.5f, 0.0f, 0.0f, // 0
-     0.5f, -0.5f, 1.0f, 0.0f, // 1
-     0.5f,  0.5f, 0.0f, 1.0f, // 2
-    -0.5f,  0.5f, 1.0f, 1.0f  // 3
-  };
-
-  // Has to be unsigned
-  unsigned int indices[] = {
-    0, 1, 2,
-    2, 3, 0
-  };
-  // --------------------------------------------------------------------
+  if (options.Headless)
+  {
+    headless.reset(new HeadlessContext(3, 3, GL_ERROR_CHECKS == 1));
+    if (!headless->IsValid())
+      return -1;
+  }
+  else
+  {
+    if (!glfwInit())
+      return -1;
 
-  GLCall(glEnable(GL_BLEND));
-  GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_ERROR_CHECKS == 1 ? GLFW_TRUE : GLFW_FALSE);
 
-  // ---------------------- Creating Vertex Array -----------------------
-  VertexArray va;
-  // --------------------------------------------------------------------
+    window = glfwCreateWindow(options.Width, options.Height, "Hello World!", NULL, NULL);
+    if (!window)
+    {
+      glfwTerminate();
+      return -1;
+    }
 
-  // -------- Creating Vertex Buffers and storing the above data --------
-  VertexBuffer vb(positions, 4 * 4 * sizeof(float));
+    glfwMakeContextCurrent(window);
 
-  VertexBufferLayout layout;
-  layout.Push<float>(2);
-  layout.Push<float>(2);
-  va.AddBuffer(vb, layout);
-  // --------------------------------------------------------------------
+    // With vsync glfwSwapBuffers waits for the display, so the loop runs at
+    // its refresh rate; other modes are paced by the FramePacer
+    glfwSwapInterval(pacer.GetSwapInterval());
+  }
 
-  // -------- Creating Index Buffers and storing the above data ---------
-  // Tip: Index Buffers can also be bound to vao before doing glVertexAttribPointer
-  IndexBuffer ib(indices, 6);
-  // --------------------------------------------------------------------
+  // EGL contexts have no GLX display, which GLEW reports even though
+  // every GL entry point was loaded
+  glewExperimental = GL_TRUE;
+  GLenum glewStatus = glewInit();
+  if (glewStatus != GLEW_OK && !(options.Headless && glewStatus == GLEW_ERROR_NO_GLX_DISPLAY))
+    std::cout << "Error!" << std::endl;
 
-  // --------------------------- Load Shaders ---------------------------
-  Shader shader("OpenGL/res/shaders/Basic.shader");
-  shader.Bind();
-  // --------------------------------------------------------------------
+  std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
+  GLDebugInit();
+  Profiler::Init();
+  if (!options.ProfilePath.empty())
+    Profiler::BeginCapture(options.ProfilePath, options.ProfileFrames);
+  ShaderCache::SetDirectory(options.ShaderCacheDirectory);
 
-  // --------------------------- Set Uniforms ---------------------------
-  shader.SetUniform4f("u_Color", 0.0f, 0.5f, 0.9f, 1.0f);
+  // Without a window everything is rendered into an offscreen framebuffer
+  std::unique_ptr<Framebuffer> framebuffer;
+  if (options.Headless)
+  {
+    std::cout << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
+    framebuffer.reset(new Framebuffer(options.Width, options.Height));
+    framebuffer->Bind();
+  }
   // --------------------------------------------------------------------
 
-  Texture texture("res/textures/pic.png");
-  texture.Bind();
-  shader.SetUniform1i("u_Texture", 0);
+  GLState::Get().SetBlend(true);
+  GLState::Get().BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-  // ------------------------ Unbind everything -------------------------
-  va.Unbind();
-  vb.Unbind();
-  ib.Unbind();
-  shader.Unbind();
-  // --------------------------------------------------------------------
+  // Declared before the demo, which releases its resources on destruction.
+  // The renderer owns its batch buffers, so with a window it's released
+  // by hand before the context goes.
+  ResourceManager resources;
+  std::unique_ptr<Renderer> renderer(new Renderer());
+  std::unique_ptr<demo::Demo> demo = CreateDemo(options, resources);
+  if (!demo)
+  {
+    std::cout << "Unknown demo '" << options.Demo << "'" << std::endl;
+    return -1;
+  }
 
-  Renderer renderer;
+  const ShaderCache::Stats& cacheStats = ShaderCache::GetStats();
+  std::cout << "Shader cache: " << cacheStats.Hits << " hits, " << cacheStats.Misses << " misses ("
+    << cacheStats.Rejected << " rejected), " << cacheStats.SavedMs << " ms saved" << std::endl;
 
-  // Variables to change Uniforms
-  float r = 0.0f;
-  float increment = 0.05f;
-  while (!glfwWindowShouldClose(window))
+  unsigned int frame = 0;
+  auto startTime = std::chrono::steady_clock::now();
+  auto lastTime = startTime;
+  while (window ? !glfwWindowShouldClose(window) : frame < options.Frames)
   {
-    renderer.Clear();
+    auto now = std::chrono::steady_clock::now();
+    std::chrono::duration<float> deltaTime = now - lastTime;
+    lastTime = now;
 
-    // Bind everything before drawing (in case stuff changed)
-    shader.Bind();
-    shader.SetUniform4f("u_Color", r, 0.5f, 0.9f, 1.0f);
+    Profiler::BeginFrame();
+    renderer->BeginFrame();
+    {
+      PROFILE_SCOPE("Demo::OnUpdate");
+      demo->OnUpdate(deltaTime.count());
+    }
+    renderer->Clear();
+    {
+      PROFILE_GPU_SCOPE("Demo::OnRender");
+      demo->OnRender(*renderer);
+    }
 
-    renderer.Draw(va, ib, shader);
+    if (++frame % 60 == 0 && !options.Headless)
+    {
+      Renderer::Stats stats = renderer->GetStats();
+      std::cout << "Batches: " << stats.Batches << " Quads: " << stats.Quads << " Draw calls: " << stats.Flushes
+        << " GL calls: " << stats.GLCalls << " State changes: " << stats.StateChanges
+        << " (" << stats.StateChangesSkipped << " skipped) Stream stalls: " << stats.StreamStalls
+        << " (" << stats.StreamWaitMs << " ms)" << std::endl;
+      Profiler::PrintSummary();
+      pacer.PrintStats();
+    }
 
-    if (r > 1.0f)
-      increment = -0.05f;
-    if (r < 0.0f)
-      increment = 0.05f;
+    renderer->EndFrame();
+    resources.EndFrame();
+    Memory::EndFrame();
+    pacer.Wait();
 
-    r += increment;
+    if (window)
+    {
+      PROFILE_SCOPE("SwapBuffers");
+      glfwSwapBuffers(window);
 
-    glfwSwapBuffers(window);
+      glfwPollEvents();
 
-    glfwPollEvents();
+      if (options.Frames && frame >= options.Frames)
+        glfwSetWindowShouldClose(window, GLFW_TRUE);
+    }
+    else if (!options.DumpDirectory.empty())
+    {
+      PROFILE_SCOPE("Framebuffer::SaveToFile");
+      char name[32];
+      snprintf(name, sizeof(name), "/frame_%05u.ppm", frame);
+      framebuffer->SaveToFile(options.DumpDirectory + name);
+    }
+    pacer.Presented(demo->GetRenderedStateTime());
+    Profiler::EndFrame();
   }
-  // Cleanup
+
+  if (options.Headless)
+  {
+    GLCall(glFinish());
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    Renderer::Stats stats = renderer->GetStats();
+    std::cout << "Rendered " << frame << " frames (" << options.Width << "x" << options.Height << ") in "
+      << elapsed.count() << "s, " << frame / elapsed.count() << " FPS, "
+      << stats.Flushes << " batched draw calls for " << stats.Quads << " quads and "
+      << stats.GLCalls << " GL calls per frame, " << stats.StateChanges << " state changes issued, "
+      << stats.StateChangesSkipped << " skipped" << std::endl;
+    Profiler::PrintSummary();
+    pacer.PrintStats();
+    resources.PrintStats();
+    Memory::PrintStats();
+    Profiler::Shutdown();
+    return 0;
+  }
+
+  // Cleanup, GL objects go before the context
+  demo.reset();
+  renderer.reset();
+  resources.Clear();
+  Profiler::Shutdown();
   glfwTerminate();
   return 0;
 }
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+// GPU-ready mesh container written by the MeshCooker tool. The header is
+// followed by AttributeCount CookedMeshAttributes, then the interleaved
+// vertex data and the index data, each starting at a 16 byte aligned
+// offset. Both are stored exactly as glBufferData consumes them, so a
+// memory-mapped file is uploaded without any processing.
+//   IndexType: GL_UNSIGNED_SHORT when VertexCount <= 65536, GL_UNSIGNED_INT otherwise
+//   Indices are ordered for the post-transform vertex cache, and the
+//   vertices in order of first use.
+struct CookedMeshHeader
+{
+  uint32_t Magic;
+  uint32_t Version;
+  uint32_t VertexCount;
+  uint32_t VertexStride;
+  uint32_t AttributeCount;
+  uint32_t IndexCount;
+  uint32_t IndexType;
+  uint32_t Reserved;
+  uint64_t VertexOffset;  // From the start of the file
+  uint64_t IndexOffset;
+  float BoundsMin[3];
+  float BoundsMax[3];
+};
+
+// One vertex attribute, in shader location order
+struct CookedMeshAttribute
+{
+  uint32_t Type;        // GL component type
+  uint32_t Count;       // Components, GL_INT_2_10_10_10_REV packs all 4 in one word
+  uint32_t Normalized;
+  uint32_t Offset;      // Within the vertex
+};
+
+static const uint32_t CookedMeshMagic = 0x4853454d; // "MESH"
+static const uint32_t CookedMeshVersion = 1;
+static const char* const CookedMeshExtension = ".cmesh";
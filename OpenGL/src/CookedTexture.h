@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+// GPU-ready texture container written by the TextureCooker tool. The
+// header is followed by one CookedTextureLevel per mip level and the
+// level payloads, each starting at a 16 byte aligned offset. Payloads
+// are stored exactly as glTexImage2D/glCompressedTexImage2D consume
+// them, so a memory-mapped file can be uploaded without any processing.
+//   InternalFormat: GL_RGBA8 or a compressed GL format
+//   Format/Type:    upload format for uncompressed data, 0 otherwise
+struct CookedTextureHeader
+{
+  uint32_t Magic;
+  uint32_t Version;
+  uint32_t InternalFormat;
+  uint32_t Format;
+  uint32_t Type;
+  uint32_t Width;
+  uint32_t Height;
+  uint32_t LevelCount;
+};
+
+struct CookedTextureLevel
+{
+  uint64_t Offset;  // From the start of the file
+  uint32_t Size;
+  uint32_t Width;
+  uint32_t Height;
+  uint32_t Reserved;
+};
+
+static const uint32_t CookedTextureMagic = 0x58455443; // "CTEX"
+static const uint32_t CookedTextureVersion = 1;
+static const char* const CookedTextureExtension = ".ctex";
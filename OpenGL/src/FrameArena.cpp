@@ -0,0 +1,81 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+FrameArena::FrameArena(size_t blockSize, MemoryTag tag)
+  : m_BlockSize(blockSize), m_Tag(tag), m_Current(0), m_Offset(0), m_Used(0), m_HighWater(0)
+{
+}
+
+FrameArena::~FrameArena()
+{
+  for (const Block& block : m_Blocks)
+    Memory::Free(block.Data, block.Size, alignof(std::max_align_t), m_Tag);
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+  while (true)
+  {
+    if (m_Current < m_Blocks.size())
+    {
+      Block& block = m_Blocks[m_Current];
+      uintptr_t base = (uintptr_t)block.Data;
+      uintptr_t start = (base + m_Offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+      if (start + size <= base + block.Size)
+      {
+        m_Offset = start + size - base;
+        m_Used += size;
+        return (void*)start;
+      }
+
+      // Doesn't fit, continue in the next block
+      if (m_Current + 1 < m_Blocks.size())
+      {
+        m_Current++;
+        m_Offset = 0;
+        continue;
+      }
+    }
+
+    // Out of blocks, or the remaining ones are too small
+    size_t blockSize = std::max(m_BlockSize, size + alignment);
+    m_Blocks.push_back({ (unsigned char*)Memory::Allocate(blockSize, alignof(std::max_align_t), m_Tag), blockSize });
+    m_Current = m_Blocks.size() - 1;
+    m_Offset = 0;
+  }
+}
+
+void FrameArena::Reset()
+{
+  m_HighWater = std::max(m_HighWater, m_Used);
+  if (m_Blocks.size() > 1)
+  {
+    size_t capacity = GetCapacity();
+    for (const Block& block : m_Blocks)
+      Memory::Free(block.Data, block.Size, alignof(std::max_align_t), m_Tag);
+    m_Blocks.clear();
+    m_Blocks.push_back({ (unsigned char*)Memory::Allocate(capacity, alignof(std::max_align_t), m_Tag), capacity });
+  }
+
+  m_Current = 0;
+  m_Offset = 0;
+  m_Used = 0;
+}
+
+void FrameArena::Rewind(const Marker& marker)
+{
+  m_HighWater = std::max(m_HighWater, m_Used);
+  m_Current = marker.Block;
+  m_Offset = marker.Offset;
+  m_Used = marker.Used;
+}
+
+size_t FrameArena::GetCapacity() const
+{
+  size_t capacity = 0;
+  for (const Block& block : m_Blocks)
+    capacity += block.Size;
+  return capacity;
+}
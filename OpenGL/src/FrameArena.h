@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Memory.h"
+
+// Linear allocator for data that only lives until the end of the frame.
+// Reset() hands all memory back at once but keeps it, so after the first
+// few frames allocating from the arena never touches the heap. Objects are
+// never destroyed and must be trivially destructible. Not thread-safe,
+// give every thread its own arena. Blocks are counted under the arena's
+// MemoryTag; Memory::GetFrameArena() is the one shared by the GL thread.
+class FrameArena
+{
+private:
+  struct Block
+  {
+    unsigned char* Data;
+    size_t Size;
+  };
+
+  std::vector<Block> m_Blocks;
+  size_t m_BlockSize;
+  MemoryTag m_Tag;
+  // Block being filled and the offset into it
+  size_t m_Current;
+  size_t m_Offset;
+  // Bytes handed out since the last Reset, and the most of any frame
+  size_t m_Used;
+  size_t m_HighWater;
+public:
+  // Position to Rewind() to, taken with GetMarker()
+  struct Marker
+  {
+    size_t Block;
+    size_t Offset;
+    size_t Used;
+  };
+public:
+  FrameArena(size_t blockSize = 64 * 1024, MemoryTag tag = MemoryTag::Frame);
+  ~FrameArena();
+
+  FrameArena(const FrameArena&) = delete;
+  FrameArena& operator=(const FrameArena&) = delete;
+
+  void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+  template<typename T, typename... Args>
+  T* New(Args&&... args)
+  {
+    static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+    return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+  }
+
+  // Uninitialized storage for count objects
+  template<typename T>
+  T* NewArray(size_t count)
+  {
+    static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+    return (T*)Allocate(sizeof(T) * count, alignof(T));
+  }
+
+  // Frees everything allocated this frame. If the frame needed more than
+  // one block they're merged, so the next frame fits into one.
+  void Reset();
+
+  // Scratch memory within the frame: everything allocated after the
+  // marker was taken is handed back by Rewind(marker)
+  inline Marker GetMarker() const { return { m_Current, m_Offset, m_Used }; }
+  void Rewind(const Marker& marker);
+
+  inline size_t GetUsed() const { return m_Used; }
+  // Most bytes used in one frame so far
+  inline size_t GetHighWater() const { return m_HighWater > m_Used ? m_HighWater : m_Used; }
+  size_t GetCapacity() const;
+};
@@ -0,0 +1,110 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include "Profiler.h"
+
+// sleep_for overshoots by up to a scheduler tick, the rest is spun
+static const int64_t SpinNs = 1000000;
+
+FramePacer::FramePacer(PresentMode mode, double fps, bool hasDisplay)
+  : m_Mode(mode), m_FrameNs((int64_t)(1e9 / fps)), m_NextPresent(0), m_LastPresent(0), m_LastStateTime(0),
+    m_FrameCount(0)
+{
+  if (m_Mode == PresentMode::VSync && !hasDisplay)
+    m_Mode = PresentMode::Capped;
+}
+
+void FramePacer::Wait()
+{
+  if (m_Mode != PresentMode::Capped)
+    return;
+
+  PROFILE_SCOPE("FramePacer::Wait");
+  int64_t now = Profiler::Now();
+  // Don't try to make up for frames that were late, just start over
+  if (m_NextPresent < now - m_FrameNs)
+    m_NextPresent = now;
+
+  if (m_NextPresent - now > SpinNs)
+    std::this_thread::sleep_for(std::chrono::nanoseconds(m_NextPresent - now - SpinNs));
+  while (Profiler::Now() < m_NextPresent)
+    std::this_thread::yield();
+
+  m_NextPresent += m_FrameNs;
+}
+
+void FramePacer::Presented(int64_t stateTime)
+{
+  int64_t now = Profiler::Now();
+  unsigned int index = m_FrameCount % WindowFrames;
+  m_Intervals[index] = m_LastPresent ? (now - m_LastPresent) / 1e6 : 0.0;
+  m_Latencies[index] = stateTime ? (now - stateTime) / 1e6 : -1.0;
+  m_Repeats[index] = stateTime && stateTime == m_LastStateTime;
+
+  m_LastPresent = now;
+  m_LastStateTime = stateTime;
+  m_FrameCount++;
+}
+
+FramePacer::Stats FramePacer::GetStats() const
+{
+  Stats stats;
+  stats.Frames = m_FrameCount < WindowFrames ? m_FrameCount : WindowFrames;
+  // The first frame has no interval
+  unsigned int intervals = 0, latencies = 0;
+  double sum = 0.0, sumSquares = 0.0, latency = 0.0;
+  for (unsigned int i = 0; i < stats.Frames; i++)
+  {
+    if (m_Intervals[i] > 0.0)
+    {
+      intervals++;
+      sum += m_Intervals[i];
+      sumSquares += m_Intervals[i] * m_Intervals[i];
+      stats.MaxIntervalMs = std::max(stats.MaxIntervalMs, m_Intervals[i]);
+    }
+    if (m_Latencies[i] >= 0.0)
+    {
+      latencies++;
+      latency += m_Latencies[i];
+      stats.MaxLatencyMs = std::max(stats.MaxLatencyMs, m_Latencies[i]);
+    }
+    stats.Repeated += m_Repeats[i];
+  }
+
+  if (intervals)
+  {
+    stats.IntervalMs = sum / intervals;
+    stats.JitterMs = sqrt(std::max(0.0, sumSquares / intervals - stats.IntervalMs * stats.IntervalMs));
+  }
+  if (latencies)
+    stats.LatencyMs = latency / latencies;
+  return stats;
+}
+
+void FramePacer::PrintStats() const
+{
+  static const char* modeNames[] = { "vsync", "uncapped", "capped" };
+  Stats stats = GetStats();
+  std::cout << "Present (" << modeNames[(int)m_Mode] << ", last " << stats.Frames << "): interval " << stats.IntervalMs
+    << " ms, jitter " << stats.JitterMs << " ms, max " << stats.MaxIntervalMs << " ms, latency " << stats.LatencyMs
+    << " ms (max " << stats.MaxLatencyMs << " ms), " << stats.Repeated << " repeated states" << std::endl;
+}
+
+bool FramePacer::ParseMode(const char* name, PresentMode& mode)
+{
+  if (strcmp(name, "vsync") == 0)
+    mode = PresentMode::VSync;
+  else if (strcmp(name, "uncapped") == 0)
+    mode = PresentMode::Uncapped;
+  else if (strcmp(name, "cap") == 0)
+    mode = PresentMode::Capped;
+  else
+    return false;
+  return true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+enum class PresentMode
+{
+  VSync,      // Swap interval 1, paced by the display
+  Uncapped,   // Swap interval 0, as fast as possible
+  Capped      // Swap interval 0, sleeps to a fixed frame rate
+};
+
+// Paces presents according to a PresentMode and measures the result:
+// present-to-present intervals and their jitter, and the latency from
+// a simulation snapshot being published to the frame showing it.
+class FramePacer
+{
+public:
+  // Over the last WindowFrames frames
+  struct Stats
+  {
+    unsigned int Frames = 0;
+    double IntervalMs = 0.0;      // Average time between presents
+    double JitterMs = 0.0;        // Standard deviation of the interval
+    double MaxIntervalMs = 0.0;
+    double LatencyMs = 0.0;       // Average snapshot publish to present, frames with a snapshot only
+    double MaxLatencyMs = 0.0;
+    unsigned int Repeated = 0;    // Frames that showed an already shown state
+  };
+
+  static const unsigned int WindowFrames = 240;
+private:
+  PresentMode m_Mode;
+  int64_t m_FrameNs;
+  int64_t m_NextPresent;
+  int64_t m_LastPresent;
+  int64_t m_LastStateTime;
+
+  double m_Intervals[WindowFrames];
+  double m_Latencies[WindowFrames];
+  bool m_Repeats[WindowFrames];
+  unsigned int m_FrameCount;
+public:
+  // fps is the cap for Capped. Without a display to sync to, VSync is
+  // emulated as a cap at fps too.
+  FramePacer(PresentMode mode, double fps = 60.0, bool hasDisplay = true);
+
+  inline PresentMode GetMode() const { return m_Mode; }
+  inline int GetSwapInterval() const { return m_Mode == PresentMode::VSync ? 1 : 0; }
+
+  // Call right before presenting, sleeps until the frame is due
+  void Wait();
+  // Call right after presenting. stateTime is the publish time of the
+  // simulation snapshot the frame showed, 0 if there is none.
+  void Presented(int64_t stateTime);
+
+  Stats GetStats() const;
+  void PrintStats() const;
+
+  static bool ParseMode(const char* name, PresentMode& mode);
+};
@@ -0,0 +1,85 @@
+#include "Framebuffer.h"
+
+#include <iostream>
+#include <fstream>
+
+#include "Renderer.h"
+
+Framebuffer::Framebuffer(int width, int height)
+  : m_RendererID(0), m_ColorAttachment(0), m_DepthAttachment(0), m_Width(width), m_Height(height)
+{
+  GLCall(glGenFramebuffers(1, &m_RendererID));
+  GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+
+  GLCall(glGenRenderbuffers(1, &m_ColorAttachment));
+  GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_ColorAttachment));
+  GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height));
+  GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_ColorAttachment));
+
+  GLCall(glGenRenderbuffers(1, &m_DepthAttachment));
+  GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_DepthAttachment));
+  GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height));
+  GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_DepthAttachment));
+
+  GLenum status;
+  GLCall(status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+  if (status != GL_FRAMEBUFFER_COMPLETE)
+    std::cout << "Framebuffer is incomplete (" << std::hex << status << std::dec << ")" << std::endl;
+
+  GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+Framebuffer::~Framebuffer()
+{
+  GLCall(glDeleteRenderbuffers(1, &m_DepthAttachment));
+  GLCall(glDeleteRenderbuffers(1, &m_ColorAttachment));
+  GLCall(glDeleteFramebuffers(1, &m_RendererID));
+}
+
+void Framebuffer::Bind() const
+{
+  GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+  GLCall(glViewport(0, 0, m_Width, m_Height));
+}
+
+void Framebuffer::Unbind() const
+{
+  GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void Framebuffer::ReadPixels(std::vector<unsigned char>& pixels) const
+{
+  pixels.resize((size_t)m_Width * m_Height * 4);
+  GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_RendererID));
+  GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+  GLCall(glReadPixels(0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()));
+}
+
+bool Framebuffer::SaveToFile(const std::string& path) const
+{
+  std::vector<unsigned char> pixels;
+  ReadPixels(pixels);
+
+  std::ofstream stream(path, std::ios::binary);
+  if (!stream)
+  {
+    std::cout << "Failed to open '" << path << "' for writing" << std::endl;
+    return false;
+  }
+
+  stream << "P6\n" << m_Width << " " << m_Height << "\n255\n";
+  // GL rows start at the bottom, image rows at the top
+  std::vector<unsigned char> row((size_t)m_Width * 3);
+  for (int y = m_Height - 1; y >= 0; y--)
+  {
+    const unsigned char* src = &pixels[(size_t)y * m_Width * 4];
+    for (int x = 0; x < m_Width; x++)
+    {
+      row[x * 3 + 0] = src[x * 4 + 0];
+      row[x * 3 + 1] = src[x * 4 + 1];
+      row[x * 3 + 2] = src[x * 4 + 2];
+    }
+    stream.write((const char*)row.data(), row.size());
+  }
+  return true;
+}
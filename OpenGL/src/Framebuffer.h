@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Offscreen render target with an RGBA8 color and a 24-bit depth attachment
+class Framebuffer
+{
+private:
+  unsigned int m_RendererID;
+  unsigned int m_ColorAttachment;
+  unsigned int m_DepthAttachment;
+  int m_Width, m_Height;
+public:
+  Framebuffer(int width, int height);
+  ~Framebuffer();
+
+  Framebuffer(const Framebuffer&) = delete;
+  Framebuffer& operator=(const Framebuffer&) = delete;
+
+  void Bind() const;
+  void Unbind() const;
+
+  // Reads back the color attachment, bottom row first
+  void ReadPixels(std::vector<unsigned char>& pixels) const;
+  // Writes the color attachment as a binary PPM image
+  bool SaveToFile(const std::string& path) const;
+
+  inline int GetWidth() const { return m_Width; }
+  inline int GetHeight() const { return m_Height; }
+};
@@ -0,0 +1,70 @@
+#include "GLDebug.h"
+
+#include <iostream>
+
+unsigned int g_GLCallCount = 0;
+GLCallSite g_GLCallSite = { "", "", 0 };
+
+static bool s_DebugCallbackActive = false;
+
+void GLClearError()
+{
+  while (glGetError() != GL_NO_ERROR);
+}
+
+bool GLLogCall(const char* function, const char* file, int line)
+{
+  while (GLenum error = glGetError())
+  {
+    std::cout << "[OpenGL Error] (" << std::hex << error << std::dec << "): " << function << " " << file << ": " << line << std::endl;
+    return false;
+  }
+  return true;
+}
+
+#if GL_ERROR_CHECKS == 1
+static void GLAPIENTRY GLDebugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
+  GLsizei length, const GLchar* message, const void* userParam)
+{
+  const char* severityName = "low";
+  if (severity == GL_DEBUG_SEVERITY_HIGH)
+    severityName = "high";
+  else if (severity == GL_DEBUG_SEVERITY_MEDIUM)
+    severityName = "medium";
+
+  // Output is synchronous, so the last recorded GLCall issued the message
+  std::cout << "[OpenGL " << (type == GL_DEBUG_TYPE_ERROR ? "Error" : "Debug") << "] (" << severityName << ", "
+    << std::hex << id << std::dec << "): " << message << std::endl
+    << "  at " << g_GLCallSite.Function << " " << g_GLCallSite.File << ": " << g_GLCallSite.Line << std::endl;
+}
+#endif
+
+bool GLDebugInit()
+{
+#if GL_ERROR_CHECKS == 1
+  if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug)
+  {
+    std::cout << "KHR_debug not supported, checking GL errors once per frame" << std::endl;
+    return false;
+  }
+
+  glEnable(GL_DEBUG_OUTPUT);
+  glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+  glDebugMessageCallback(GLDebugMessageCallback, nullptr);
+  glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+  s_DebugCallbackActive = true;
+#endif
+  return s_DebugCallbackActive;
+}
+
+void GLCheckFrameErrors()
+{
+#if GL_ERROR_CHECKS == 1
+  if (s_DebugCallbackActive)
+    return;
+
+  while (GLenum error = glGetError())
+    std::cout << "[OpenGL Error] (" << std::hex << error << std::dec << ") during frame, last call: "
+      << g_GLCallSite.Function << " " << g_GLCallSite.File << ": " << g_GLCallSite.Line << std::endl;
+#endif
+}
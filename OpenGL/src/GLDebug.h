@@ -0,0 +1,69 @@
+#pragma once
+
+#include <GL/glew.h>
+
+// -------------------------- GL Error Logging --------------------------
+// How GLCall checks for errors. Set per configuration in premake5.lua:
+//   2 (Debug):   glGetError before and after every call, traps on error
+//   1 (Release): no glGetError, a KHR_debug message callback reports
+//                errors together with the last GLCall site. Contexts
+//                without KHR_debug get one glGetError check per frame.
+//   0 (Dist):    no checking at all
+// Every level counts the calls so the renderer can report them per frame.
+#ifndef GL_ERROR_CHECKS
+  #define GL_ERROR_CHECKS 2
+#endif
+
+#include <signal.h>
+
+#define ASSERT(x) if (!(x)) raise(SIGTRAP);
+
+#if GL_ERROR_CHECKS >= 2
+  #define GLCall(x) GLCountCall();\
+    GLClearError();\
+    x;\
+    ASSERT(GLLogCall(#x, __FILE__, __LINE__))
+#elif GL_ERROR_CHECKS == 1
+  #define GLCall(x) GLSetCallSite(#x, __FILE__, __LINE__);\
+    x
+#else
+  #define GLCall(x) GLCountCall();\
+    x
+#endif
+
+struct GLCallSite
+{
+  const char* Function;
+  const char* File;
+  int Line;
+};
+
+extern unsigned int g_GLCallCount;
+extern GLCallSite g_GLCallSite;
+
+inline void GLCountCall()
+{
+  g_GLCallCount++;
+}
+
+inline void GLSetCallSite(const char* function, const char* file, int line)
+{
+  g_GLCallCount++;
+  g_GLCallSite = { function, file, line };
+}
+
+void GLClearError();
+
+bool GLLogCall(const char* function, const char* file, int line);
+
+// Installs the KHR_debug callback when GL_ERROR_CHECKS == 1 and the
+// context supports it. Returns true if the callback is active.
+bool GLDebugInit();
+
+// Reports errors raised since the last check. Only does work when
+// GL_ERROR_CHECKS == 1 and no debug callback could be installed.
+void GLCheckFrameErrors();
+
+inline unsigned int GLGetCallCount() { return g_GLCallCount; }
+inline void GLResetCallCount() { g_GLCallCount = 0; }
+// ----------------------------------------------------------------------
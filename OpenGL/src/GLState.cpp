@@ -0,0 +1,258 @@
+#include "GLState.h"
+
+#include "GLDebug.h"
+
+// Marks a cached value as unknown, no GL name or enum uses it
+static const unsigned int Unknown = 0xffffffff;
+
+static GLState s_DefaultState;
+static GLState* s_CurrentState = &s_DefaultState;
+
+GLState::GLState()
+  : m_Program(0), m_VertexArray(0), m_ArrayBuffer(0), m_ElementBuffers(1, 0),
+    m_ActiveTexture(0), m_Blend(0), m_BlendSrc(GL_ONE), m_BlendDst(GL_ZERO),
+    m_DepthTest(0), m_ClearColor{ 0.0f, 0.0f, 0.0f, 0.0f }
+{
+  for (unsigned int i = 0; i < MaxTextureUnits; i++)
+    m_Textures[i] = 0;
+  for (unsigned int i = 0; i < MaxUniformBindings; i++)
+    m_UniformBuffers[i] = { 0, 0, 0 };
+}
+
+GLState& GLState::Get()
+{
+  return *s_CurrentState;
+}
+
+void GLState::SetCurrent(GLState* state)
+{
+  s_CurrentState = state ? state : &s_DefaultState;
+}
+
+unsigned int& GLState::ElementBuffer(unsigned int vertexArray)
+{
+  if (vertexArray >= m_ElementBuffers.size())
+    m_ElementBuffers.resize(vertexArray + 1, 0);
+  return m_ElementBuffers[vertexArray];
+}
+
+void GLState::UseProgram(unsigned int program)
+{
+  if (m_Program == program)
+  {
+    m_Stats.Skipped++;
+    return;
+  }
+  GLCall(glUseProgram(program));
+  m_Program = program;
+  m_Stats.Issued++;
+}
+
+void GLState::BindVertexArray(unsigned int vertexArray)
+{
+  if (m_VertexArray == vertexArray)
+  {
+    m_Stats.Skipped++;
+    return;
+  }
+  GLCall(glBindVertexArray(vertexArray));
+  m_VertexArray = vertexArray;
+  m_Stats.Issued++;
+}
+
+void GLState::BindBuffer(unsigned int target, unsigned int buffer)
+{
+  unsigned int* cached = nullptr;
+  if (target == GL_ARRAY_BUFFER)
+    cached = &m_ArrayBuffer;
+  else if (target == GL_ELEMENT_ARRAY_BUFFER && m_VertexArray != Unknown)
+    cached = &ElementBuffer(m_VertexArray);
+
+  if (cached && *cached == buffer)
+  {
+    m_Stats.Skipped++;
+    return;
+  }
+  GLCall(glBindBuffer(target, buffer));
+  if (cached)
+    *cached = buffer;
+  m_Stats.Issued++;
+}
+
+void GLState::BindUniformBuffer(unsigned int index, unsigned int buffer, unsigned int offset, unsigned int size)
+{
+  ASSERT(index < MaxUniformBindings);
+  BufferRange& cached = m_UniformBuffers[index];
+  if (cached.Buffer == buffer && cached.Offset == offset && cached.Size == size)
+  {
+    m_Stats.Skipped++;
+    return;
+  }
+  if (size == 0)
+  {
+    GLCall(glBindBufferBase(GL_UNIFORM_BUFFER, index, buffer));
+  }
+  else
+  {
+    GLCall(glBindBufferRange(GL_UNIFORM_BUFFER, index, buffer, offset, size));
+  }
+  cached = { buffer, offset, size };
+  m_Stats.Issued++;
+}
+
+void GLState::ActiveTexture(unsigned int unit)
+{
+  if (m_ActiveTexture == unit)
+  {
+    m_Stats.Skipped++;
+    return;
+  }
+  GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+  m_ActiveTexture = unit;
+  m_Stats.Issued++;
+}
+
+void GLState::BindTexture(unsigned int unit, unsigned int target, unsigned int texture)
+{
+  // Only 2D bindings are tracked
+  bool tracked = target == GL_TEXTURE_2D && unit < MaxTextureUnits;
+  if (tracked && m_Textures[unit] == texture)
+  {
+    m_Stats.Skipped++;
+    return;
+  }
+  ActiveTexture(unit);
+  GLCall(glBindTexture(target, texture));
+  if (tracked)
+    m_Textures[unit] = texture;
+  m_Stats.Issued++;
+}
+
+void GLState::SetBlend(bool enabled)
+{
+  if (m_Blend == (int)enabled)
+  {
+    m_Stats.Skipped++;
+    return;
+  }
+  if (enabled)
+  {
+    GLCall(glEnable(GL_BLEND));
+  }
+  else
+  {
+    GLCall(glDisable(GL_BLEND));
+  }
+  m_Blend = (int)enabled;
+  m_Stats.Issued++;
+}
+
+void GLState::BlendFunc(unsigned int src, unsigned int dst)
+{
+  if (m_BlendSrc == src && m_BlendDst == dst)
+  {
+    m_Stats.Skipped++;
+    return;
+  }
+  GLCall(glBlendFunc(src, dst));
+  m_BlendSrc = src;
+  m_BlendDst = dst;
+  m_Stats.Issued++;
+}
+
+void GLState::SetDepthTest(bool enabled)
+{
+  if (m_DepthTest == (int)enabled)
+  {
+    m_Stats.Skipped++;
+    return;
+  }
+  if (enabled)
+  {
+    GLCall(glEnable(GL_DEPTH_TEST));
+  }
+  else
+  {
+    GLCall(glDisable(GL_DEPTH_TEST));
+  }
+  m_DepthTest = (int)enabled;
+  m_Stats.Issued++;
+}
+
+void GLState::ClearColor(float r, float g, float b, float a)
+{
+  if (m_ClearColor[0] == r && m_ClearColor[1] == g && m_ClearColor[2] == b && m_ClearColor[3] == a)
+  {
+    m_Stats.Skipped++;
+    return;
+  }
+  GLCall(glClearColor(r, g, b, a));
+  m_ClearColor[0] = r;
+  m_ClearColor[1] = g;
+  m_ClearColor[2] = b;
+  m_ClearColor[3] = a;
+  m_Stats.Issued++;
+}
+
+void GLState::OnDeleteProgram(unsigned int program)
+{
+  // A deleted program stays in use until another one is bound, but its
+  // name may be reused by the next glCreateProgram
+  if (m_Program == program)
+    m_Program = Unknown;
+}
+
+void GLState::OnDeleteVertexArray(unsigned int vertexArray)
+{
+  if (m_VertexArray == vertexArray)
+    m_VertexArray = 0;
+  if (vertexArray < m_ElementBuffers.size())
+    m_ElementBuffers[vertexArray] = 0;
+}
+
+void GLState::OnDeleteBuffer(unsigned int buffer)
+{
+  if (m_ArrayBuffer == buffer)
+    m_ArrayBuffer = 0;
+  // Only the current VAO drops the binding, other VAOs keep referencing
+  // the orphaned buffer. Forget it everywhere since the name can be reused.
+  for (unsigned int& elementBuffer : m_ElementBuffers)
+  {
+    if (elementBuffer == buffer)
+      elementBuffer = Unknown;
+  }
+  if (m_VertexArray != Unknown && ElementBuffer(m_VertexArray) == Unknown)
+    ElementBuffer(m_VertexArray) = 0;
+  for (unsigned int i = 0; i < MaxUniformBindings; i++)
+  {
+    if (m_UniformBuffers[i].Buffer == buffer)
+      m_UniformBuffers[i] = { 0, 0, 0 };
+  }
+}
+
+void GLState::OnDeleteTexture(unsigned int texture)
+{
+  for (unsigned int i = 0; i < MaxTextureUnits; i++)
+  {
+    if (m_Textures[i] == texture)
+      m_Textures[i] = 0;
+  }
+}
+
+void GLState::Invalidate()
+{
+  m_Program = Unknown;
+  m_VertexArray = Unknown;
+  m_ArrayBuffer = Unknown;
+  m_ElementBuffers.assign(m_ElementBuffers.size(), Unknown);
+  m_ActiveTexture = Unknown;
+  for (unsigned int i = 0; i < MaxTextureUnits; i++)
+    m_Textures[i] = Unknown;
+  m_Blend = -1;
+  m_BlendSrc = Unknown;
+  m_BlendDst = Unknown;
+  m_DepthTest = -1;
+  for (unsigned int i = 0; i < MaxUniformBindings; i++)
+    m_UniformBuffers[i] = { Unknown, Unknown, Unknown };
+  m_ClearColor[0] = -1.0f;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+
+// Shadows the GL binding state of a context so that binding an object
+// which is already bound costs no GL call. All binds of Shader,
+// VertexArray, VertexBuffer, IndexBuffer and Texture go through the
+// tracker of the current context, so anything that changes these
+// bindings with raw GL calls must call Invalidate() afterwards.
+// The tracker starts out with the default state of a fresh context.
+class GLState
+{
+public:
+  struct Stats
+  {
+    unsigned int Issued = 0;   // State changes sent to GL
+    unsigned int Skipped = 0;  // State changes that matched the cache
+  };
+
+  static const unsigned int MaxTextureUnits = 32;
+  // GL_MAX_UNIFORM_BUFFER_BINDINGS is at least 24 from GL 3.1 on
+  static const unsigned int MaxUniformBindings = 24;
+private:
+  struct BufferRange
+  {
+    unsigned int Buffer, Offset, Size;
+  };
+
+  unsigned int m_Program;
+  unsigned int m_VertexArray;
+  unsigned int m_ArrayBuffer;
+  // The element buffer binding is part of the VAO, indexed by VAO name
+  std::vector<unsigned int> m_ElementBuffers;
+  unsigned int m_ActiveTexture;
+  unsigned int m_Textures[MaxTextureUnits];
+  int m_Blend;  // -1 when unknown
+  unsigned int m_BlendSrc, m_BlendDst;
+  int m_DepthTest;  // -1 when unknown
+  BufferRange m_UniformBuffers[MaxUniformBindings];
+  float m_ClearColor[4];
+  Stats m_Stats;
+public:
+  GLState();
+
+  // Tracker of the current context
+  static GLState& Get();
+  // Switches trackers together with the GL context
+  static void SetCurrent(GLState* state);
+
+  void UseProgram(unsigned int program);
+  void BindVertexArray(unsigned int vertexArray);
+  void BindBuffer(unsigned int target, unsigned int buffer);
+  // Indexed GL_UNIFORM_BUFFER binding, a size of 0 binds the whole buffer.
+  // Leaves the generic GL_UNIFORM_BUFFER binding undefined.
+  void BindUniformBuffer(unsigned int index, unsigned int buffer, unsigned int offset = 0, unsigned int size = 0);
+  void ActiveTexture(unsigned int unit);
+  void BindTexture(unsigned int unit, unsigned int target, unsigned int texture);
+  void SetBlend(bool enabled);
+  void BlendFunc(unsigned int src, unsigned int dst);
+  void SetDepthTest(bool enabled);
+  void ClearColor(float r, float g, float b, float a);
+
+  // GL drops bindings of deleted objects, the cache has to follow
+  void OnDeleteProgram(unsigned int program);
+  void OnDeleteVertexArray(unsigned int vertexArray);
+  void OnDeleteBuffer(unsigned int buffer);
+  void OnDeleteTexture(unsigned int texture);
+
+  // Forgets everything, the next change of each state is always issued
+  void Invalidate();
+
+  inline unsigned int GetActiveTexture() const { return m_ActiveTexture; }
+  inline const Stats& GetStats() const { return m_Stats; }
+  inline void ResetStats() { m_Stats = Stats(); }
+private:
+  unsigned int& ElementBuffer(unsigned int vertexArray);
+};
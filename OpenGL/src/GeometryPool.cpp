@@ -0,0 +1,384 @@
+#include "GeometryPool.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "Renderer.h"
+#include "Profiler.h"
+
+// ---------------------------- RangeAllocator ----------------------------
+RangeAllocator::RangeAllocator(unsigned int capacity)
+  : m_Capacity(0), m_Used(0)
+{
+  Grow(capacity);
+}
+
+bool RangeAllocator::Allocate(unsigned int size, unsigned int& offset)
+{
+  if (size == 0)
+  {
+    offset = 0;
+    return true;
+  }
+
+  size_t best = m_Free.size();
+  for (size_t i = 0; i < m_Free.size(); i++)
+  {
+    if (m_Free[i].Size >= size && (best == m_Free.size() || m_Free[i].Size < m_Free[best].Size))
+    {
+      best = i;
+      if (m_Free[i].Size == size)
+        break;
+    }
+  }
+  if (best == m_Free.size())
+    return false;
+
+  Range& range = m_Free[best];
+  offset = range.Offset;
+  range.Offset += size;
+  range.Size -= size;
+  if (range.Size == 0)
+    m_Free.erase(m_Free.begin() + best);
+  m_Used += size;
+  return true;
+}
+
+void RangeAllocator::Free(unsigned int offset, unsigned int size)
+{
+  if (size == 0)
+    return;
+  m_Used -= size;
+
+  auto next = std::lower_bound(m_Free.begin(), m_Free.end(), offset,
+    [](const Range& range, unsigned int offset) { return range.Offset < offset; });
+  bool joinsPrevious = next != m_Free.begin() && (next - 1)->Offset + (next - 1)->Size == offset;
+  bool joinsNext = next != m_Free.end() && offset + size == next->Offset;
+
+  if (joinsPrevious && joinsNext)
+  {
+    (next - 1)->Size += size + next->Size;
+    m_Free.erase(next);
+  }
+  else if (joinsPrevious)
+  {
+    (next - 1)->Size += size;
+  }
+  else if (joinsNext)
+  {
+    next->Offset = offset;
+    next->Size += size;
+  }
+  else
+  {
+    m_Free.insert(next, { offset, size });
+  }
+}
+
+void RangeAllocator::Grow(unsigned int capacity)
+{
+  if (capacity <= m_Capacity)
+    return;
+  unsigned int added = capacity - m_Capacity;
+  // Counted as used by Free, which takes it back off
+  m_Used += added;
+  Free(m_Capacity, added);
+  m_Capacity = capacity;
+}
+
+void RangeAllocator::Reset(unsigned int capacity, unsigned int used)
+{
+  m_Free.clear();
+  m_Capacity = capacity;
+  m_Used = used;
+  if (used < capacity)
+    m_Free.push_back({ used, capacity - used });
+}
+
+bool RangeAllocator::IsPacked() const
+{
+  return m_Free.empty() || (m_Free.size() == 1 && m_Free[0].Offset + m_Free[0].Size == m_Capacity);
+}
+
+unsigned int RangeAllocator::GetLargestFreeRange() const
+{
+  unsigned int largest = 0;
+  for (const Range& range : m_Free)
+    largest = std::max(largest, range.Size);
+  return largest;
+}
+// ------------------------------------------------------------------------
+
+// ---------------------------- GeometryArena -----------------------------
+GeometryArena::GeometryArena(const VertexBufferLayout& layout, IndexType indexType, unsigned int vertexCapacity, unsigned int indexCapacity)
+  : m_Layout(layout), m_IndexType(indexType), m_Reallocations(0)
+{
+  Reallocate(vertexCapacity, indexCapacity, {}, {});
+  m_Vertices.Reset(vertexCapacity, 0);
+  m_Indices.Reset(indexCapacity, 0);
+}
+
+bool GeometryArena::Matches(const VertexBufferLayout& layout, IndexType indexType) const
+{
+  const auto& a = m_Layout.GetElements();
+  const auto& b = layout.GetElements();
+  if (indexType != m_IndexType || layout.GetStride() != m_Layout.GetStride() || a.size() != b.size())
+    return false;
+  for (size_t i = 0; i < a.size(); i++)
+  {
+    if (a[i].type != b[i].type || a[i].count != b[i].count || a[i].normalized != b[i].normalized || a[i].divisor != b[i].divisor
+      || a[i].columns != b[i].columns || a[i].integer != b[i].integer || a[i].offset != b[i].offset)
+      return false;
+  }
+  return true;
+}
+
+void GeometryArena::Reallocate(unsigned int vertexCapacity, unsigned int indexCapacity,
+  const std::vector<Move>& vertexMoves, const std::vector<Move>& indexMoves)
+{
+  PROFILE_SCOPE("GeometryArena::Reallocate");
+  const unsigned int stride = m_Layout.GetStride();
+  const unsigned int indexSize = IndexBuffer::GetIndexSize(m_IndexType);
+
+  // The new index buffer attaches itself to whatever VAO is bound, so the
+  // new VAO goes first
+  std::unique_ptr<VertexArray> va(new VertexArray());
+  va->Bind();
+  std::unique_ptr<IndexBuffer> ib(new IndexBuffer(indexCapacity, BufferUsage::Dynamic, m_IndexType));
+  std::unique_ptr<VertexBuffer> vb(new VertexBuffer(vertexCapacity * stride, BufferUsage::Dynamic));
+  va->AddBuffer(*vb, m_Layout);
+  va->Unbind();
+
+  if (m_VB)
+  {
+    GLCall(glBindBuffer(GL_COPY_READ_BUFFER, m_VB->GetRendererID()));
+    GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, vb->GetRendererID()));
+    for (const Move& move : vertexMoves)
+    {
+      GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)move.From * stride, (GLintptr)move.To * stride, (GLsizeiptr)move.Size * stride));
+    }
+    GLCall(glBindBuffer(GL_COPY_READ_BUFFER, m_IB->GetRendererID()));
+    GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, ib->GetRendererID()));
+    for (const Move& move : indexMoves)
+    {
+      GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)move.From * indexSize, (GLintptr)move.To * indexSize, (GLsizeiptr)move.Size * indexSize));
+    }
+    GLCall(glBindBuffer(GL_COPY_READ_BUFFER, 0));
+    GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+  }
+
+  m_VA = std::move(va);
+  m_VB = std::move(vb);
+  m_IB = std::move(ib);
+  m_Reallocations++;
+}
+
+void GeometryArena::Upload(const void* vertices, unsigned int vertexOffset, unsigned int vertexCount,
+  const void* indices, unsigned int indexOffset, unsigned int indexCount)
+{
+  // Through GL_COPY_WRITE_BUFFER, which leaves the VAO's element buffer alone
+  const unsigned int stride = m_Layout.GetStride();
+  const unsigned int indexSize = IndexBuffer::GetIndexSize(m_IndexType);
+  GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_VB->GetRendererID()));
+  GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)vertexOffset * stride, (GLsizeiptr)vertexCount * stride, vertices));
+  GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_IB->GetRendererID()));
+  GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)indexOffset * indexSize, (GLsizeiptr)indexCount * indexSize, indices));
+  GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+  Profiler::AddCounter(ProfileCounter::BytesUploaded, (uint64_t)vertexCount * stride + (uint64_t)indexCount * indexSize);
+}
+// ------------------------------------------------------------------------
+
+// ----------------------------- GeometryPool -----------------------------
+GeometryPool::GeometryPool(unsigned int vertexCapacity, unsigned int indexCapacity)
+  : m_VertexCapacity(vertexCapacity), m_IndexCapacity(indexCapacity), m_Grows(0), m_Defragments(0), m_BytesMoved(0)
+{
+}
+
+GeometryHandle GeometryPool::Add(const VertexBufferLayout& layout, const void* vertices, unsigned int vertexCount,
+  const void* indices, unsigned int indexCount, IndexType indexType)
+{
+  PROFILE_SCOPE("GeometryPool::Add");
+  unsigned int arenaIndex = 0;
+  while (arenaIndex < m_Arenas.size() && !m_Arenas[arenaIndex]->Matches(layout, indexType))
+    arenaIndex++;
+  if (arenaIndex == m_Arenas.size())
+  {
+    m_Arenas.emplace_back(new GeometryArena(layout, indexType,
+      std::max(m_VertexCapacity, vertexCount), std::max(m_IndexCapacity, indexCount)));
+  }
+  GeometryArena& arena = *m_Arenas[arenaIndex];
+
+  unsigned int vertexOffset, indexOffset;
+  bool fits = arena.m_Vertices.Allocate(vertexCount, vertexOffset);
+  if (fits && !arena.m_Indices.Allocate(indexCount, indexOffset))
+  {
+    arena.m_Vertices.Free(vertexOffset, vertexCount);
+    fits = false;
+  }
+
+  if (!fits)
+  {
+    // Packing may make room without growing. Otherwise at least double,
+    // copying the old contents as they are.
+    const RangeAllocator& v = arena.m_Vertices;
+    const RangeAllocator& i = arena.m_Indices;
+    bool roomAfterPacking = v.GetCapacity() - v.GetUsed() >= vertexCount && i.GetCapacity() - i.GetUsed() >= indexCount;
+    if (roomAfterPacking && (!v.IsPacked() || !i.IsPacked()))
+    {
+      Defragment(arenaIndex);
+    }
+    else
+    {
+      unsigned int vertexCapacity = std::max(v.GetCapacity() * 2, v.GetUsed() + vertexCount);
+      unsigned int indexCapacity = std::max(i.GetCapacity() * 2, i.GetUsed() + indexCount);
+      arena.Reallocate(vertexCapacity, indexCapacity, { { 0, 0, v.GetCapacity() } }, { { 0, 0, i.GetCapacity() } });
+      m_BytesMoved += (unsigned long long)v.GetCapacity() * layout.GetStride() + (unsigned long long)i.GetCapacity() * IndexBuffer::GetIndexSize(indexType);
+      arena.m_Vertices.Grow(vertexCapacity);
+      arena.m_Indices.Grow(indexCapacity);
+      m_Grows++;
+    }
+
+    bool allocated = arena.m_Vertices.Allocate(vertexCount, vertexOffset) && arena.m_Indices.Allocate(indexCount, indexOffset);
+    ASSERT(allocated);
+  }
+
+  arena.Upload(vertices, vertexOffset, vertexCount, indices, indexOffset, indexCount);
+
+  uint32_t index;
+  if (!m_FreeSlots.empty())
+  {
+    index = m_FreeSlots.back();
+    m_FreeSlots.pop_back();
+  }
+  else
+  {
+    index = (uint32_t)m_Slots.size();
+    m_Slots.emplace_back();
+  }
+  Slot& slot = m_Slots[index];
+  slot.Live = true;
+  slot.Arena = arenaIndex;
+  slot.VertexOffset = vertexOffset;
+  slot.VertexCount = vertexCount;
+  slot.IndexOffset = indexOffset;
+  slot.IndexCount = indexCount;
+  return { index, slot.Generation };
+}
+
+void GeometryPool::Remove(GeometryHandle mesh)
+{
+  if (mesh.Index >= m_Slots.size() || !m_Slots[mesh.Index].Live || m_Slots[mesh.Index].Generation != mesh.Generation)
+    return;
+
+  Slot& slot = m_Slots[mesh.Index];
+  GeometryArena& arena = *m_Arenas[slot.Arena];
+  arena.m_Vertices.Free(slot.VertexOffset, slot.VertexCount);
+  arena.m_Indices.Free(slot.IndexOffset, slot.IndexCount);
+  slot.Live = false;
+  // Skips 0, which would make handles to the slot look null
+  if (++slot.Generation == 0)
+    slot.Generation = 1;
+  m_FreeSlots.push_back(mesh.Index);
+}
+
+const GeometryArena* GeometryPool::Get(GeometryHandle mesh, GeometryRange& range) const
+{
+  if (mesh.Index >= m_Slots.size() || !m_Slots[mesh.Index].Live || m_Slots[mesh.Index].Generation != mesh.Generation)
+    return nullptr;
+
+  const Slot& slot = m_Slots[mesh.Index];
+  range.FirstIndex = slot.IndexOffset;
+  range.IndexCount = slot.IndexCount;
+  range.BaseVertex = (int)slot.VertexOffset;
+  return m_Arenas[slot.Arena].get();
+}
+
+unsigned int GeometryPool::Defragment()
+{
+  unsigned int packed = 0;
+  for (unsigned int i = 0; i < m_Arenas.size(); i++)
+  {
+    const GeometryArena& arena = *m_Arenas[i];
+    if (arena.m_Vertices.IsPacked() && arena.m_Indices.IsPacked())
+      continue;
+    Defragment(i);
+    packed++;
+  }
+  return packed;
+}
+
+void GeometryPool::Defragment(unsigned int arenaIndex)
+{
+  PROFILE_SCOPE("GeometryPool::Defragment");
+  GeometryArena& arena = *m_Arenas[arenaIndex];
+
+  std::vector<Slot*> slots;
+  for (Slot& slot : m_Slots)
+  {
+    if (slot.Live && slot.Arena == arenaIndex)
+      slots.push_back(&slot);
+  }
+
+  // Meshes keep their order, so each one only ever moves down
+  std::vector<GeometryArena::Move> vertexMoves, indexMoves;
+  unsigned int vertexEnd = 0, indexEnd = 0;
+  std::sort(slots.begin(), slots.end(), [](const Slot* a, const Slot* b) { return a->VertexOffset < b->VertexOffset; });
+  for (Slot* slot : slots)
+  {
+    vertexMoves.push_back({ slot->VertexOffset, vertexEnd, slot->VertexCount });
+    slot->VertexOffset = vertexEnd;
+    vertexEnd += slot->VertexCount;
+  }
+  std::sort(slots.begin(), slots.end(), [](const Slot* a, const Slot* b) { return a->IndexOffset < b->IndexOffset; });
+  for (Slot* slot : slots)
+  {
+    indexMoves.push_back({ slot->IndexOffset, indexEnd, slot->IndexCount });
+    slot->IndexOffset = indexEnd;
+    indexEnd += slot->IndexCount;
+  }
+
+  unsigned int vertexCapacity = arena.m_Vertices.GetCapacity();
+  unsigned int indexCapacity = arena.m_Indices.GetCapacity();
+  arena.Reallocate(vertexCapacity, indexCapacity, vertexMoves, indexMoves);
+  arena.m_Vertices.Reset(vertexCapacity, vertexEnd);
+  arena.m_Indices.Reset(indexCapacity, indexEnd);
+
+  m_BytesMoved += (unsigned long long)vertexEnd * arena.m_Layout.GetStride() + (unsigned long long)indexEnd * IndexBuffer::GetIndexSize(arena.m_IndexType);
+  m_Defragments++;
+}
+
+float GeometryPool::GetFragmentation() const
+{
+  unsigned long long free = 0, largest = 0;
+  for (const auto& arena : m_Arenas)
+  {
+    for (const RangeAllocator* allocator : { &arena->m_Vertices, &arena->m_Indices })
+    {
+      free += allocator->GetCapacity() - allocator->GetUsed();
+      largest += allocator->GetLargestFreeRange();
+    }
+  }
+  return free ? 1.0f - (float)largest / free : 0.0f;
+}
+
+GeometryPool::Stats GeometryPool::GetStats() const
+{
+  Stats stats;
+  stats.Meshes = (unsigned int)(m_Slots.size() - m_FreeSlots.size());
+  stats.Arenas = (unsigned int)m_Arenas.size();
+  for (const auto& arena : m_Arenas)
+  {
+    unsigned int stride = arena->m_Layout.GetStride();
+    unsigned int indexSize = IndexBuffer::GetIndexSize(arena->m_IndexType);
+    stats.VertexBytes += (unsigned long long)arena->m_Vertices.GetUsed() * stride;
+    stats.VertexCapacity += (unsigned long long)arena->m_Vertices.GetCapacity() * stride;
+    stats.IndexBytes += (unsigned long long)arena->m_Indices.GetUsed() * indexSize;
+    stats.IndexCapacity += (unsigned long long)arena->m_Indices.GetCapacity() * indexSize;
+    stats.FreeRanges += arena->m_Vertices.GetFreeRangeCount() + arena->m_Indices.GetFreeRangeCount();
+  }
+  stats.Grows = m_Grows;
+  stats.Defragments = m_Defragments;
+  stats.BytesMoved = m_BytesMoved;
+  return stats;
+}
+// ------------------------------------------------------------------------
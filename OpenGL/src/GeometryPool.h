@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexBufferLayout.h"
+
+// Best-fit allocator over [0, capacity) in abstract units (vertices
+// or indices). Free ranges are kept sorted by offset and merged with their
+// neighbours when freed, so the list only grows with real fragmentation.
+class RangeAllocator
+{
+public:
+  struct Range
+  {
+    unsigned int Offset, Size;
+  };
+private:
+  std::vector<Range> m_Free;
+  unsigned int m_Capacity;
+  unsigned int m_Used;
+public:
+  RangeAllocator(unsigned int capacity = 0);
+
+  // Smallest free range that fits, false if none does
+  bool Allocate(unsigned int size, unsigned int& offset);
+  void Free(unsigned int offset, unsigned int size);
+  // Adds [old capacity, capacity) as free space
+  void Grow(unsigned int capacity);
+  // Everything below used is allocated, the rest free
+  void Reset(unsigned int capacity, unsigned int used);
+
+  inline unsigned int GetCapacity() const { return m_Capacity; }
+  inline unsigned int GetUsed() const { return m_Used; }
+  inline unsigned int GetFreeRangeCount() const { return (unsigned int)m_Free.size(); }
+  unsigned int GetLargestFreeRange() const;
+  // True if all free space is one range at the end
+  bool IsPacked() const;
+};
+
+// Mesh stored in a GeometryPool. The generation catches handles of
+// removed meshes whose slot was reused. Generation 0 is the null handle.
+struct GeometryHandle
+{
+  uint32_t Index = 0;
+  uint32_t Generation = 0;
+
+  inline bool IsValid() const { return Generation != 0; }
+};
+
+// Part of an arena's buffers taken by one mesh, as glDrawElementsBaseVertex
+// wants it
+struct GeometryRange
+{
+  unsigned int FirstIndex;
+  unsigned int IndexCount;
+  int BaseVertex;
+};
+
+// Meshes with the same vertex layout and index type packed into one
+// vertex and one index buffer, behind a single VAO. Indices stay relative
+// to their mesh, so meshes can move without rewriting them.
+class GeometryArena
+{
+private:
+  VertexBufferLayout m_Layout;
+  IndexType m_IndexType;
+  // Replaced together whenever the arena is reallocated
+  std::unique_ptr<VertexArray> m_VA;
+  std::unique_ptr<VertexBuffer> m_VB;
+  std::unique_ptr<IndexBuffer> m_IB;
+  RangeAllocator m_Vertices;
+  RangeAllocator m_Indices;
+  unsigned int m_Reallocations;
+public:
+  GeometryArena(const VertexBufferLayout& layout, IndexType indexType, unsigned int vertexCapacity, unsigned int indexCapacity);
+
+  inline const VertexBufferLayout& GetLayout() const { return m_Layout; }
+  inline IndexType GetIndexType() const { return m_IndexType; }
+  inline const VertexArray& GetVertexArray() const { return *m_VA; }
+  inline const VertexBuffer& GetVertexBuffer() const { return *m_VB; }
+  inline const IndexBuffer& GetIndexBuffer() const { return *m_IB; }
+  inline const RangeAllocator& GetVertexAllocator() const { return m_Vertices; }
+  inline const RangeAllocator& GetIndexAllocator() const { return m_Indices; }
+  // Changes whenever the VAO and buffers are replaced, so anything built
+  // on them can tell it has to be rebuilt. Buffer names don't do, GL
+  // reuses them.
+  inline unsigned int GetReallocations() const { return m_Reallocations; }
+  bool Matches(const VertexBufferLayout& layout, IndexType indexType) const;
+private:
+  friend class GeometryPool;
+  // Range copied to a new offset by Reallocate, in vertices or indices
+  struct Move
+  {
+    unsigned int From, To, Size;
+  };
+  // Moves the contents into new buffers of the given capacities, copying
+  // only the listed ranges. GL can't copy between overlapping ranges of
+  // one buffer, so even compacting in place needs the second buffer.
+  void Reallocate(unsigned int vertexCapacity, unsigned int indexCapacity,
+    const std::vector<Move>& vertexMoves, const std::vector<Move>& indexMoves);
+  void Upload(const void* vertices, unsigned int vertexOffset, unsigned int vertexCount,
+    const void* indices, unsigned int indexOffset, unsigned int indexCount);
+};
+
+// Suballocates meshes out of a few large buffers instead of giving each
+// its own VertexBuffer, IndexBuffer and VertexArray. Meshes sharing a
+// layout and index type share an arena, so drawing one after another
+// switches no buffers or VAOs, only the range passed to
+// glDrawElementsBaseVertex (see Renderer::Draw). Arenas grow by copying
+// into bigger buffers when full; Defragment() packs the meshes of every
+// arena back together. Both keep handles valid but move the data, so
+// ranges fetched earlier are stale afterwards. GL thread only.
+class GeometryPool
+{
+public:
+  struct Stats
+  {
+    unsigned int Meshes = 0;
+    unsigned int Arenas = 0;
+    unsigned long long VertexBytes = 0;     // In use
+    unsigned long long VertexCapacity = 0;  // Allocated, bytes
+    unsigned long long IndexBytes = 0;
+    unsigned long long IndexCapacity = 0;
+    unsigned int FreeRanges = 0;            // Holes in all arenas, vertex and index
+    unsigned int Grows = 0;
+    unsigned int Defragments = 0;
+    unsigned long long BytesMoved = 0;      // Copied by grows and defragments
+  };
+private:
+  struct Slot
+  {
+    uint32_t Generation = 1;
+    bool Live = false;
+    unsigned int Arena = 0;
+    unsigned int VertexOffset = 0, VertexCount = 0;
+    unsigned int IndexOffset = 0, IndexCount = 0;
+  };
+
+  std::vector<std::unique_ptr<GeometryArena>> m_Arenas;
+  std::vector<Slot> m_Slots;
+  std::vector<uint32_t> m_FreeSlots;
+  unsigned int m_VertexCapacity;
+  unsigned int m_IndexCapacity;
+  unsigned int m_Grows;
+  unsigned int m_Defragments;
+  unsigned long long m_BytesMoved;
+public:
+  // Initial capacity of each arena, in vertices and indices
+  GeometryPool(unsigned int vertexCapacity = 64 * 1024, unsigned int indexCapacity = 256 * 1024);
+
+  GeometryPool(const GeometryPool&) = delete;
+  GeometryPool& operator=(const GeometryPool&) = delete;
+
+  // Copies a mesh into the arena for its layout and index type, creating
+  // or growing that arena as needed. indices index into vertices.
+  GeometryHandle Add(const VertexBufferLayout& layout, const void* vertices, unsigned int vertexCount,
+    const void* indices, unsigned int indexCount, IndexType indexType);
+  // Frees the mesh's ranges right away; they're reused by later Adds
+  void Remove(GeometryHandle mesh);
+
+  // Arena and range of a mesh, nullptr for removed meshes
+  const GeometryArena* Get(GeometryHandle mesh, GeometryRange& range) const;
+
+  // Packs the meshes of every arena to the start of its buffers. Returns
+  // the number of arenas that had holes.
+  unsigned int Defragment();
+  // 0 when every arena's free space is one range, towards 1 as it splits
+  // into many small holes
+  float GetFragmentation() const;
+
+  Stats GetStats() const;
+private:
+  void Defragment(unsigned int arena);
+};
@@ -0,0 +1,85 @@
+#include "HeadlessContext.h"
+
+#include <iostream>
+
+#ifdef __linux__
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+HeadlessContext::HeadlessContext(int majorVersion, int minorVersion, bool debug)
+  : m_Display(nullptr), m_Context(nullptr), m_Valid(false)
+{
+  EGLDisplay display = EGL_NO_DISPLAY;
+
+  // Prefer the surfaceless platform, it needs neither X11 nor a DRM device
+  auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+  if (getPlatformDisplay)
+    display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+  if (display == EGL_NO_DISPLAY)
+    display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+  EGLint major, minor;
+  if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+  {
+    std::cout << "[EGL Error] Failed to initialize display (" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+    return;
+  }
+  m_Display = display;
+
+  if (!eglBindAPI(EGL_OPENGL_API))
+  {
+    std::cout << "[EGL Error] OpenGL API not supported" << std::endl;
+    return;
+  }
+
+  EGLint contextAttribs[] = {
+    EGL_CONTEXT_MAJOR_VERSION, majorVersion,
+    EGL_CONTEXT_MINOR_VERSION, minorVersion,
+    EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+    EGL_CONTEXT_OPENGL_DEBUG, debug ? EGL_TRUE : EGL_FALSE,
+    EGL_NONE
+  };
+
+  // Configless + surfaceless: the context never gets a default framebuffer
+  EGLContext context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttribs);
+  if (context == EGL_NO_CONTEXT)
+  {
+    std::cout << "[EGL Error] Failed to create OpenGL " << majorVersion << "." << minorVersion
+      << " context (" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+    return;
+  }
+  m_Context = context;
+
+  m_Valid = eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context) == EGL_TRUE;
+}
+
+HeadlessContext::~HeadlessContext()
+{
+  if (m_Context)
+  {
+    eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(m_Display, m_Context);
+  }
+  if (m_Display)
+    eglTerminate(m_Display);
+}
+
+void HeadlessContext::MakeCurrent() const
+{
+  eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, m_Context);
+}
+#else
+HeadlessContext::HeadlessContext(int majorVersion, int minorVersion, bool debug)
+  : m_Display(nullptr), m_Context(nullptr), m_Valid(false)
+{
+  std::cout << "Headless rendering is only supported on Linux" << std::endl;
+}
+
+HeadlessContext::~HeadlessContext()
+{
+}
+
+void HeadlessContext::MakeCurrent() const
+{
+}
+#endif
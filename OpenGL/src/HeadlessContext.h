@@ -0,0 +1,20 @@
+#pragma once
+
+// Creates an OpenGL context without a window or display server, using EGL
+// on the surfaceless Mesa platform (falls back to the default display).
+// Rendering has to go to a Framebuffer since there is no default one.
+// Only available on Linux.
+class HeadlessContext
+{
+private:
+  void* m_Display;
+  void* m_Context;
+  bool m_Valid;
+public:
+  HeadlessContext(int majorVersion = 3, int minorVersion = 3, bool debug = false);
+  ~HeadlessContext();
+
+  void MakeCurrent() const;
+
+  inline bool IsValid() const { return m_Valid; }
+};
@@ -1,26 +1,112 @@
 #include "IndexBuffer.h"
+
+#include <utility>
+
 #include "Renderer.h"
+#include "GLState.h"
 
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
-  : m_Count(count)
+  : IndexBuffer(data, count, IndexType::UnsignedInt)
 {
   ASSERT(sizeof(unsigned int) == sizeof(GLuint));
+}
+
+IndexBuffer::IndexBuffer(const unsigned short* data, unsigned int count)
+  : IndexBuffer(data, count, IndexType::UnsignedShort)
+{
+  ASSERT(sizeof(unsigned short) == sizeof(GLushort));
+}
+
+IndexBuffer::IndexBuffer(const void* data, unsigned int count, IndexType type)
+  : m_Count(count), m_Size(count * GetIndexSize(type)), m_Type(type)
+{
+  GLCall(glGenBuffers(1, &m_RendererID));
+  GLState::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+  GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * GetIndexSize(), data, GL_STATIC_DRAW));
+}
+
+IndexBuffer::IndexBuffer(unsigned int count, BufferUsage usage, IndexType type)
+  : m_Count(count), m_Size(count * GetIndexSize(type)), m_Type(type)
+{
+  if (usage == BufferUsage::Stream)
+  {
+    m_Stream.reset(new StreamBuffer(GL_ELEMENT_ARRAY_BUFFER, count * GetIndexSize()));
+    m_RendererID = m_Stream->GetRendererID();
+    // The orphaning fallback allocates a single region
+    if (m_Stream->IsPersistent())
+      m_Size *= StreamBuffer::RegionCount;
+    return;
+  }
+
   GLCall(glGenBuffers(1, &m_RendererID));
-  GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
-  GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+  GLState::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+  GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * GetIndexSize(), nullptr,
+    usage == BufferUsage::Static ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW));
 }
 
 IndexBuffer::~IndexBuffer()
 {
+  // The stream owns its buffer
+  if (m_Stream || !m_RendererID)
+    return;
+
   GLCall(glDeleteBuffers(1, &m_RendererID));
+  GLState::Get().OnDeleteBuffer(m_RendererID);
+}
+
+IndexBuffer::IndexBuffer(IndexBuffer&& other) noexcept
+  : m_RendererID(0), m_Count(0), m_Size(0), m_Type(IndexType::UnsignedInt)
+{
+  Swap(other);
+}
+
+IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other) noexcept
+{
+  // Our old buffer is deleted along with the temporary
+  IndexBuffer moved(std::move(other));
+  Swap(moved);
+  return *this;
+}
+
+void IndexBuffer::Swap(IndexBuffer& other)
+{
+  std::swap(m_RendererID, other.m_RendererID);
+  std::swap(m_Count, other.m_Count);
+  std::swap(m_Size, other.m_Size);
+  std::swap(m_Type, other.m_Type);
+  std::swap(m_Stream, other.m_Stream);
+}
+
+void IndexBuffer::SetData(const unsigned int* data, unsigned int count, unsigned int offset)
+{
+  ASSERT(m_Type == IndexType::UnsignedInt);
+  SetData((const void*)data, count, offset);
+}
+
+void IndexBuffer::SetData(const unsigned short* data, unsigned int count, unsigned int offset)
+{
+  ASSERT(m_Type == IndexType::UnsignedShort);
+  SetData((const void*)data, count, offset);
+}
+
+void IndexBuffer::SetData(const void* data, unsigned int count, unsigned int offset)
+{
+  ASSERT(!m_Stream);
+  Bind();
+  GLCall(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset * GetIndexSize(), count * GetIndexSize(), data));
+}
+
+unsigned int IndexBuffer::GetGLType() const
+{
+  return m_Type == IndexType::UnsignedShort ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
 }
 
 void IndexBuffer::Bind() const
 {
-  GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
+  GLState::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
 }
 
 void IndexBuffer::Unbind() const
 {
-  GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+  GLState::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
@@ -1,16 +1,62 @@
 #pragma once
 
+#include <memory>
+
+#include "StreamBuffer.h"
+
+// Width of the indices in an IndexBuffer. 16-bit indices halve the index
+// memory and fetch bandwidth of meshes with at most 65536 vertices.
+enum class IndexType
+{
+  UnsignedShort,
+  UnsignedInt
+};
+
 class IndexBuffer
 {
 private:
   unsigned int m_RendererID;
   unsigned int m_Count;
+  unsigned int m_Size;
+  IndexType m_Type;
+  std::unique_ptr<StreamBuffer> m_Stream;
 public:
   IndexBuffer(const unsigned int* data, unsigned int count);
+  IndexBuffer(const unsigned short* data, unsigned int count);
+  // Indices of the given type, e.g. straight from a mapped mesh file
+  IndexBuffer(const void* data, unsigned int count, IndexType type);
+  // Allocates room for count indices that change. With BufferUsage::Stream,
+  // count is the number of indices per frame.
+  IndexBuffer(unsigned int count, BufferUsage usage, IndexType type = IndexType::UnsignedInt);
   ~IndexBuffer();
 
+  // Move-only, a moved-from buffer owns nothing
+  IndexBuffer(IndexBuffer&& other) noexcept;
+  IndexBuffer& operator=(IndexBuffer&& other) noexcept;
+  IndexBuffer(const IndexBuffer&) = delete;
+  IndexBuffer& operator=(const IndexBuffer&) = delete;
+
+  // Dynamic buffers only, the data has to match the buffer's index type
+  void SetData(const unsigned int* data, unsigned int count, unsigned int offset = 0);
+  void SetData(const unsigned short* data, unsigned int count, unsigned int offset = 0);
+  // Ring to write per-frame indices to, nullptr unless BufferUsage::Stream
+  inline StreamBuffer* GetStream() const { return m_Stream.get(); }
+
   void Bind() const;
   void Unbind() const;
 
+  inline unsigned int GetRendererID() const { return m_RendererID; }
   inline unsigned int GetCount() const { return m_Count; }
+  inline IndexType GetType() const { return m_Type; }
+  // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, for glDrawElements
+  unsigned int GetGLType() const;
+  inline unsigned int GetIndexSize() const { return GetIndexSize(m_Type); }
+  // Bytes of buffer storage, every region of a stream
+  inline unsigned int GetSize() const { return m_Size; }
+
+  static inline unsigned int GetIndexSize(IndexType type) { return type == IndexType::UnsignedShort ? 2 : 4; }
+
+private:
+  void SetData(const void* data, unsigned int count, unsigned int offset);
+  void Swap(IndexBuffer& other);
 };
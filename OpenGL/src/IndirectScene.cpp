@@ -0,0 +1,356 @@
+#include "IndirectScene.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "GLState.h"
+#include "Profiler.h"
+
+// local_size_x of the cull shader
+static const unsigned int CullGroupSize = 64;
+
+// Mesh struct of the cull shader, std430 packs it into 12 bytes
+struct CullMesh
+{
+  uint32_t IndexCount;
+  uint32_t FirstIndex;
+  int32_t BaseVertex;
+};
+
+// Storage the CPU never maps, bound through the copy target so no other
+// binding is disturbed
+static unsigned int CreateBuffer(unsigned int size, unsigned int usage)
+{
+  unsigned int buffer;
+  GLCall(glGenBuffers(1, &buffer));
+  GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, buffer));
+  GLCall(glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, usage));
+  GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+  return buffer;
+}
+
+static void DeleteBuffer(unsigned int buffer)
+{
+  if (!buffer)
+    return;
+  GLCall(glDeleteBuffers(1, &buffer));
+  GLState::Get().OnDeleteBuffer(buffer);
+}
+
+IndirectScene::IndirectScene(GeometryPool& pool, const std::vector<GeometryHandle>& meshes, const std::vector<IndirectObject>& objects,
+  IndirectPath path, const std::string& cullShaderPath)
+  : m_Pool(pool), m_Meshes(meshes), m_Objects(objects), m_Path(IsSupported(path) ? path : GetBestPath()),
+    m_DrawIndirectCount(nullptr), m_Arena(nullptr), m_ArenaReallocations(0), m_InstanceAttrib(0),
+    m_MeshBuffer(0), m_CommandBuffer(0), m_CountBuffer(0)
+{
+  ASSERT(!m_Meshes.empty() && !m_Objects.empty());
+  if (m_Path != path)
+    std::cout << "Indirect path '" << GetPathName(path) << "' isn't supported, using '" << GetPathName(m_Path) << "'" << std::endl;
+
+  const unsigned int objectBytes = (unsigned int)(m_Objects.size() * sizeof(IndirectObject));
+  if (m_Path == IndirectPath::GpuCulling)
+  {
+    if (GLEW_VERSION_4_6)
+      m_DrawIndirectCount = glMultiDrawElementsIndirectCount;
+    else if (GLEW_ARB_indirect_parameters)
+      m_DrawIndirectCount = (PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC)glMultiDrawElementsIndirectCountARB;
+
+    // Without indirect count every object keeps its command, culled ones
+    // with no instances, since the CPU has to name the number of draws
+    ShaderDefines defines;
+    if (m_DrawIndirectCount)
+      defines.push_back("COMPACT");
+    m_CullShader.reset(new Shader(cullShaderPath, defines));
+    m_PlanesUniform = m_CullShader->GetUniformHandle("u_Planes");
+    m_ObjectCountUniform = m_CullShader->GetUniformHandle("u_ObjectCount");
+
+    // Read both as storage by the cull shader and as instance attributes
+    m_ObjectBuffer.reset(new VertexBuffer(m_Objects.data(), objectBytes));
+    m_MeshBuffer = CreateBuffer((unsigned int)(m_Meshes.size() * sizeof(CullMesh)), GL_STATIC_DRAW);
+    m_CommandBuffer = CreateBuffer((unsigned int)(m_Objects.size() * sizeof(DrawElementsIndirectCommand)), GL_DYNAMIC_COPY);
+    m_CountBuffer = CreateBuffer(sizeof(uint32_t), GL_DYNAMIC_COPY);
+  }
+  else
+  {
+    // Room for every object each frame, so culling never runs out
+    m_Instances.reset(new VertexBuffer(objectBytes, BufferUsage::Stream));
+    if (m_Path == IndirectPath::CpuCulling)
+      m_CommandStream.reset(new StreamBuffer(GL_DRAW_INDIRECT_BUFFER, (unsigned int)(m_Meshes.size() * sizeof(DrawElementsIndirectCommand))));
+    m_Visible.reserve(m_Objects.size());
+    m_MeshStarts.resize(m_Meshes.size() + 1);
+    m_Commands.reserve(m_Meshes.size());
+  }
+}
+
+IndirectScene::~IndirectScene()
+{
+  DeleteBuffer(m_MeshBuffer);
+  DeleteBuffer(m_CommandBuffer);
+  DeleteBuffer(m_CountBuffer);
+}
+
+void IndirectScene::Draw(const Shader& shader, const Frustum& frustum)
+{
+  GeometryRange range;
+  const GeometryArena* arena = m_Pool.Get(m_Meshes[0], range);
+  if (!arena)
+    return;
+  if (arena != m_Arena || arena->GetReallocations() != m_ArenaReallocations)
+    Rebuild(*arena);
+
+  if (m_Path == IndirectPath::GpuCulling)
+    DrawGpuCulling(shader, frustum, *arena);
+  else
+    DrawCpuCulling(shader, frustum, *arena);
+}
+
+void IndirectScene::Rebuild(const GeometryArena& arena)
+{
+  m_Ranges.resize(m_Meshes.size());
+  for (size_t i = 0; i < m_Meshes.size(); i++)
+  {
+    const GeometryArena* meshArena = m_Pool.Get(m_Meshes[i], m_Ranges[i]);
+    ASSERT(meshArena == &arena);
+  }
+
+  // The index buffer attaches itself to whatever VAO is bound, so the
+  // VAO goes first
+  m_VA.reset(new VertexArray());
+  m_VA->Bind();
+  arena.GetIndexBuffer().Bind();
+  m_VA->AddBuffer(arena.GetVertexBuffer(), arena.GetLayout());
+  m_InstanceAttrib = 0;
+  for (const VertexBufferElement& element : arena.GetLayout().GetElements())
+    m_InstanceAttrib += element.columns;
+  m_VA->AddBuffer(m_ObjectBuffer ? *m_ObjectBuffer : *m_Instances, IndirectObjectLayout());
+
+  if (m_MeshBuffer)
+  {
+    std::vector<CullMesh> meshes(m_Ranges.size());
+    for (size_t i = 0; i < m_Ranges.size(); i++)
+      meshes[i] = { m_Ranges[i].IndexCount, m_Ranges[i].FirstIndex, m_Ranges[i].BaseVertex };
+    GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_MeshBuffer));
+    GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, 0, meshes.size() * sizeof(CullMesh), meshes.data()));
+    GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+  }
+
+  m_Arena = &arena;
+  m_ArenaReallocations = arena.GetReallocations();
+}
+
+void IndirectScene::DrawGpuCulling(const Shader& shader, const Frustum& frustum, const GeometryArena& arena)
+{
+  auto start = std::chrono::steady_clock::now();
+  const unsigned int objectCount = (unsigned int)m_Objects.size();
+  {
+    PROFILE_GPU_SCOPE("IndirectScene::Cull");
+    // GL orders this after the previous frame's draw that reads the count
+    const uint32_t zero = 0;
+    GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_CountBuffer));
+    GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, 0, sizeof(zero), &zero));
+    GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+
+    m_CullShader->Bind();
+    m_CullShader->SetUniform4fv(m_PlanesUniform, 6, &frustum.Planes[0].x);
+    m_CullShader->SetUniform1i(m_ObjectCountUniform, (int)objectCount);
+    GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ObjectBinding, m_ObjectBuffer->GetRendererID()));
+    GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MeshBinding, m_MeshBuffer));
+    GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CommandBinding, m_CommandBuffer));
+    GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CountBinding, m_CountBuffer));
+    GLCall(glDispatchCompute((objectCount + CullGroupSize - 1) / CullGroupSize, 1, 1));
+    // The draw reads what the shader wrote as indirect parameters, the
+    // count is also cleared and read back with buffer calls
+    GLCall(glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT));
+  }
+  m_Stats.CullMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  PROFILE_GPU_SCOPE("IndirectScene::Draw");
+  Profiler::AddCounter(ProfileCounter::DrawCalls, 1);
+  shader.Bind();
+  m_VA->Bind();
+  const IndexBuffer& ib = arena.GetIndexBuffer();
+  ib.Bind();
+  GLCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandBuffer));
+  if (m_DrawIndirectCount)
+  {
+    GLCall(glBindBuffer(GL_PARAMETER_BUFFER, m_CountBuffer));
+    GLCall(m_DrawIndirectCount(GL_TRIANGLES, ib.GetGLType(), nullptr, 0, objectCount, 0));
+  }
+  else
+  {
+    GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, ib.GetGLType(), nullptr, objectCount, 0));
+  }
+
+  m_Stats.Commands = objectCount;
+  m_Stats.DrawCalls = 1;
+}
+
+void IndirectScene::DrawCpuCulling(const Shader& shader, const Frustum& frustum, const GeometryArena& arena)
+{
+  auto start = std::chrono::steady_clock::now();
+  const unsigned int meshCount = (unsigned int)m_Meshes.size();
+  {
+    PROFILE_SCOPE("IndirectScene::Cull");
+    m_Visible.clear();
+    std::fill(m_MeshStarts.begin(), m_MeshStarts.end(), 0);
+    for (uint32_t i = 0; i < (uint32_t)m_Objects.size(); i++)
+    {
+      const IndirectObject& object = m_Objects[i];
+      if (frustum.IntersectsSphere(Vec3(object.Sphere[0], object.Sphere[1], object.Sphere[2]), object.Sphere[3]))
+      {
+        m_Visible.push_back(i);
+        m_MeshStarts[object.Mesh + 1]++;
+      }
+    }
+    for (unsigned int mesh = 0; mesh < meshCount; mesh++)
+      m_MeshStarts[mesh + 1] += m_MeshStarts[mesh];
+  }
+
+  m_Commands.clear();
+  if (!m_Visible.empty())
+  {
+    PROFILE_SCOPE("IndirectScene::WriteInstances");
+    StreamBuffer& stream = *m_Instances->GetStream();
+    unsigned int offset;
+    IndirectObject* instances = (IndirectObject*)stream.Allocate((unsigned int)(m_Visible.size() * sizeof(IndirectObject)),
+      sizeof(IndirectObject), offset);
+    // Grouped by mesh, m_MeshStarts[m] is left at the end of mesh m
+    for (uint32_t index : m_Visible)
+    {
+      const IndirectObject& object = m_Objects[index];
+      instances[m_MeshStarts[object.Mesh]++] = object;
+    }
+    stream.Flush();
+
+    // Base instances count from the start of the buffer, which the
+    // attributes point at
+    unsigned int first = offset / sizeof(IndirectObject);
+    unsigned int begin = 0;
+    for (unsigned int mesh = 0; mesh < meshCount; mesh++)
+    {
+      unsigned int end = m_MeshStarts[mesh];
+      const GeometryRange& range = m_Ranges[mesh];
+      if (end > begin)
+        m_Commands.push_back({ range.IndexCount, end - begin, range.FirstIndex, range.BaseVertex, first + begin });
+      begin = end;
+    }
+    Profiler::AddCounter(ProfileCounter::BytesUploaded, m_Visible.size() * sizeof(IndirectObject));
+  }
+  m_Stats.Visible = (unsigned int)m_Visible.size();
+  m_Stats.Commands = (unsigned int)m_Commands.size();
+  m_Stats.DrawCalls = 0;
+  m_Stats.CullMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  if (!m_Commands.empty())
+  {
+    PROFILE_GPU_SCOPE("IndirectScene::Draw");
+    shader.Bind();
+    m_VA->Bind();
+    const IndexBuffer& ib = arena.GetIndexBuffer();
+    ib.Bind();
+    if (m_Path == IndirectPath::CpuCulling)
+    {
+      unsigned int size = (unsigned int)(m_Commands.size() * sizeof(DrawElementsIndirectCommand)), offset;
+      void* commands = m_CommandStream->Allocate(size, sizeof(DrawElementsIndirectCommand), offset);
+      memcpy(commands, m_Commands.data(), size);
+      m_CommandStream->Flush();
+      GLCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandStream->GetRendererID()));
+      GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, ib.GetGLType(), (void*)(uintptr_t)offset, (GLsizei)m_Commands.size(), 0));
+      m_Stats.DrawCalls = 1;
+    }
+    else
+    {
+      for (const DrawElementsIndirectCommand& command : m_Commands)
+      {
+        SetInstanceOffset(command.BaseInstance * sizeof(IndirectObject));
+        GLCall(glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.Count, ib.GetGLType(),
+          (void*)(uintptr_t)(command.FirstIndex * ib.GetIndexSize()), command.InstanceCount, command.BaseVertex));
+      }
+      m_Stats.DrawCalls = (unsigned int)m_Commands.size();
+    }
+    Profiler::AddCounter(ProfileCounter::DrawCalls, m_Stats.DrawCalls);
+  }
+
+  m_Instances->GetStream()->EndFrame();
+  if (m_CommandStream)
+    m_CommandStream->EndFrame();
+}
+
+void IndirectScene::SetInstanceOffset(unsigned int offset)
+{
+  // What a base instance would do, with the VAO bound
+  m_Instances->Bind();
+  for (unsigned int i = 0; i < IndirectObjectLayout::ElementCount; i++)
+  {
+    const VertexBufferElement& element = IndirectObjectLayout::Elements[i];
+    const void* pointer = (const void*)(uintptr_t)(offset + element.offset);
+    if (element.integer)
+    {
+      GLCall(glVertexAttribIPointer(m_InstanceAttrib + i, element.count, element.type, IndirectObjectLayout::Stride, pointer));
+    }
+    else
+    {
+      GLCall(glVertexAttribPointer(m_InstanceAttrib + i, element.count, element.type, element.normalized, IndirectObjectLayout::Stride, pointer));
+    }
+  }
+}
+
+unsigned int IndirectScene::ReadVisibleCount()
+{
+  if (m_Path != IndirectPath::GpuCulling)
+    return m_Stats.Visible;
+
+  uint32_t count = 0;
+  GLCall(glBindBuffer(GL_COPY_READ_BUFFER, m_CountBuffer));
+  GLCall(glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(count), &count));
+  GLCall(glBindBuffer(GL_COPY_READ_BUFFER, 0));
+  m_Stats.Visible = count;
+  return count;
+}
+
+bool IndirectScene::IsSupported(IndirectPath path)
+{
+  switch (path)
+  {
+    // The cull shader is GLSL 4.30, extensions alone won't do
+    case IndirectPath::GpuCulling: return GLEW_VERSION_4_3;
+    case IndirectPath::CpuCulling: return GLEW_VERSION_4_3 || (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance);
+    case IndirectPath::CpuLoop:    return true;
+  }
+  return false;
+}
+
+IndirectPath IndirectScene::GetBestPath()
+{
+  if (IsSupported(IndirectPath::GpuCulling))
+    return IndirectPath::GpuCulling;
+  if (IsSupported(IndirectPath::CpuCulling))
+    return IndirectPath::CpuCulling;
+  return IndirectPath::CpuLoop;
+}
+
+const char* IndirectScene::GetPathName(IndirectPath path)
+{
+  switch (path)
+  {
+    case IndirectPath::GpuCulling: return "gpu";
+    case IndirectPath::CpuCulling: return "cpu";
+    case IndirectPath::CpuLoop:    return "loop";
+  }
+  return "unknown";
+}
+
+bool IndirectScene::ParsePath(const char* name, IndirectPath& path)
+{
+  for (IndirectPath candidate : { IndirectPath::GpuCulling, IndirectPath::CpuCulling, IndirectPath::CpuLoop })
+  {
+    if (strcmp(name, GetPathName(candidate)) == 0)
+    {
+      path = candidate;
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "GeometryPool.h"
+#include "Math3D.h"
+#include "Shader.h"
+
+// One object of an IndirectScene. The same 32 bytes are the per-instance
+// vertex data of the draw shader and the std430 Object struct of
+// res/shaders/IndirectCull.shader.
+struct IndirectObject
+{
+  float Sphere[4];          // Center and radius, the mesh is scaled to fill it
+  unsigned char Color[4];
+  unsigned int Mesh;        // Index into the scene's meshes
+  float Spin[2];            // Angle about y and angular velocity
+};
+
+static_assert(sizeof(IndirectObject) == 32, "IndirectObject must match the std430 Object struct of the cull shader");
+
+using IndirectObjectLayout = StaticVertexLayout<IndirectObject,
+  VERTEX_ATTRIB_INSTANCED(IndirectObject, Sphere, 1),
+  VERTEX_ATTRIB_INSTANCED(IndirectObject, Color, 1),
+  VERTEX_ATTRIB_INSTANCED(IndirectObject, Mesh, 1),
+  VERTEX_ATTRIB_INSTANCED(IndirectObject, Spin, 1)>;
+
+// Command read by glMultiDrawElementsIndirect, laid out as GL defines it
+struct DrawElementsIndirectCommand
+{
+  uint32_t Count;
+  uint32_t InstanceCount;
+  uint32_t FirstIndex;
+  int32_t BaseVertex;
+  uint32_t BaseInstance;
+};
+
+enum class IndirectPath
+{
+  // A compute shader culls every object and writes one command per
+  // object, the scene is one glMultiDrawElementsIndirect. GL 4.3.
+  GpuCulling,
+  // Culled on the CPU, visible objects are copied into a stream grouped
+  // by mesh and drawn with one command per mesh from a streamed indirect
+  // buffer. GL 4.3 or ARB_multi_draw_indirect with ARB_base_instance.
+  CpuCulling,
+  // Plain GL 3.3, which has no indirect buffers or base instances: the
+  // CPU culling path's commands are replayed as one instanced draw each
+  CpuLoop
+};
+
+// Static set of objects drawn without a draw call per object. Every
+// object is an instance of one of a few meshes of a GeometryPool, which
+// all have to be in the same arena so one VAO serves the whole scene.
+// Objects are given at construction and uploaded once; culling and
+// submission happen in Draw(), once per frame. GL thread only.
+class IndirectScene
+{
+public:
+  struct Stats
+  {
+    unsigned int Visible = 0;    // Objects that passed culling, see ReadVisibleCount
+    unsigned int Commands = 0;   // Indirect commands submitted, empty ones included
+    unsigned int DrawCalls = 0;  // GL draw calls issued for them
+    double CullMs = 0.0;         // CPU time of the last Draw before submitting
+  };
+
+  // Shader storage bindings used by the cull shader
+  enum StorageBinding
+  {
+    ObjectBinding = 0, MeshBinding = 1, CommandBinding = 2, CountBinding = 3
+  };
+private:
+  GeometryPool& m_Pool;
+  std::vector<GeometryHandle> m_Meshes;
+  std::vector<IndirectObject> m_Objects;
+  IndirectPath m_Path;
+  // glMultiDrawElementsIndirectCount or the ARB entry point, nullptr if neither exists
+  PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC m_DrawIndirectCount;
+
+  // Rebuilt whenever the arena's buffers are reallocated
+  std::unique_ptr<VertexArray> m_VA;
+  const GeometryArena* m_Arena;
+  unsigned int m_ArenaReallocations;
+  std::vector<GeometryRange> m_Ranges;
+  unsigned int m_InstanceAttrib;  // First attribute index of IndirectObjectLayout
+
+  // GpuCulling
+  std::unique_ptr<VertexBuffer> m_ObjectBuffer;
+  std::unique_ptr<Shader> m_CullShader;
+  UniformHandle m_PlanesUniform;
+  UniformHandle m_ObjectCountUniform;
+  unsigned int m_MeshBuffer;
+  unsigned int m_CommandBuffer;
+  unsigned int m_CountBuffer;
+
+  // CpuCulling and CpuLoop
+  std::unique_ptr<VertexBuffer> m_Instances;
+  std::unique_ptr<StreamBuffer> m_CommandStream;
+  std::vector<uint32_t> m_Visible;
+  std::vector<unsigned int> m_MeshStarts;
+  std::vector<DrawElementsIndirectCommand> m_Commands;
+
+  Stats m_Stats;
+public:
+  // objects[i].Mesh indexes meshes. Falls back to the best supported path
+  // when path isn't available.
+  IndirectScene(GeometryPool& pool, const std::vector<GeometryHandle>& meshes, const std::vector<IndirectObject>& objects,
+    IndirectPath path, const std::string& cullShaderPath = "OpenGL/res/shaders/IndirectCull.shader");
+  ~IndirectScene();
+
+  IndirectScene(const IndirectScene&) = delete;
+  IndirectScene& operator=(const IndirectScene&) = delete;
+
+  // Culls against frustum and draws what's left with shader, which gets
+  // IndirectObjectLayout's attributes after the arena layout's. Binds
+  // shader last, so its uniforms can be set before or after.
+  void Draw(const Shader& shader, const Frustum& frustum);
+
+  // Visible objects of the last Draw. Waits for the GPU on the GPU
+  // culling path, so keep it to statistics every now and then.
+  unsigned int ReadVisibleCount();
+
+  inline IndirectPath GetPath() const { return m_Path; }
+  // Whether GPU culling compacts its commands and draws with indirect count
+  inline bool UsesIndirectCount() const { return m_Path == IndirectPath::GpuCulling && m_DrawIndirectCount; }
+  inline unsigned int GetObjectCount() const { return (unsigned int)m_Objects.size(); }
+  inline const Stats& GetStats() const { return m_Stats; }
+
+  static bool IsSupported(IndirectPath path);
+  // Fastest path the context supports
+  static IndirectPath GetBestPath();
+  static const char* GetPathName(IndirectPath path);
+  // "gpu", "cpu" or "loop"
+  static bool ParsePath(const char* name, IndirectPath& path);
+private:
+  // Builds the VAO and mesh ranges for the arena's current buffers
+  void Rebuild(const GeometryArena& arena);
+  void DrawGpuCulling(const Shader& shader, const Frustum& frustum, const GeometryArena& arena);
+  void DrawCpuCulling(const Shader& shader, const Frustum& frustum, const GeometryArena& arena);
+  // Points the instance attributes at offset into m_Instances
+  void SetInstanceOffset(unsigned int offset);
+};
@@ -0,0 +1,77 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+MappedFile::MappedFile(const std::string& path)
+  : m_Data(nullptr), m_Size(0), m_File(INVALID_HANDLE_VALUE), m_Mapping(nullptr)
+{
+  m_File = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (m_File == INVALID_HANDLE_VALUE)
+    return;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(m_File, &size) || size.QuadPart == 0)
+    return;
+
+  m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!m_Mapping)
+    return;
+
+  m_Data = (const unsigned char*)MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+  if (m_Data)
+    m_Size = (size_t)size.QuadPart;
+}
+
+MappedFile::~MappedFile()
+{
+  if (m_Data)
+    UnmapViewOfFile(m_Data);
+  if (m_Mapping)
+    CloseHandle(m_Mapping);
+  if (m_File != INVALID_HANDLE_VALUE)
+    CloseHandle(m_File);
+}
+#else
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& path)
+  : m_Data(nullptr), m_Size(0)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return;
+
+  struct stat info;
+  if (fstat(fd, &info) == 0 && info.st_size > 0)
+  {
+    void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED)
+    {
+      // The whole file is read front to back exactly once. Advice values
+      // aren't flags, so each takes its own call; both are only hints.
+      if (madvise(data, info.st_size, MADV_SEQUENTIAL) != 0 || madvise(data, info.st_size, MADV_WILLNEED) != 0)
+        std::cout << "[MappedFile] madvise failed for '" << path << "': " << strerror(errno) << std::endl;
+      m_Data = (const unsigned char*)data;
+      m_Size = info.st_size;
+    }
+  }
+  // The mapping stays valid after the descriptor is closed
+  close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+  if (m_Data)
+    munmap((void*)m_Data, m_Size);
+}
+#endif
@@ -0,0 +1,509 @@
+#include "Math3D.h"
+
+#if MATH_SSE
+  #include <immintrin.h>
+  #ifdef _MSC_VER
+    #include <intrin.h>
+    // MSVC compiles intrinsics of any instruction set without flags
+    #define MATH_TARGET_AVX
+  #else
+    #define MATH_TARGET_AVX __attribute__((target("avx")))
+  #endif
+#endif
+
+Mat4 Transpose(const Mat4& m)
+{
+  return Mat4(
+    Vec4(m[0].x, m[1].x, m[2].x, m[3].x),
+    Vec4(m[0].y, m[1].y, m[2].y, m[3].y),
+    Vec4(m[0].z, m[1].z, m[2].z, m[3].z),
+    Vec4(m[0].w, m[1].w, m[2].w, m[3].w));
+}
+
+Mat4 Inverse(const Mat4& m)
+{
+  // Cofactor expansion through the 2x2 minors of the top and bottom rows
+  const float* a = m.Data();
+  float s0 = a[0] * a[5] - a[4] * a[1];
+  float s1 = a[0] * a[9] - a[8] * a[1];
+  float s2 = a[0] * a[13] - a[12] * a[1];
+  float s3 = a[4] * a[9] - a[8] * a[5];
+  float s4 = a[4] * a[13] - a[12] * a[5];
+  float s5 = a[8] * a[13] - a[12] * a[9];
+  float c5 = a[10] * a[15] - a[14] * a[11];
+  float c4 = a[6] * a[15] - a[14] * a[7];
+  float c3 = a[6] * a[11] - a[10] * a[7];
+  float c2 = a[2] * a[15] - a[14] * a[3];
+  float c1 = a[2] * a[11] - a[10] * a[3];
+  float c0 = a[2] * a[7] - a[6] * a[3];
+
+  float determinant = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+  float d = determinant != 0.0f ? 1.0f / determinant : 0.0f;
+
+  return Mat4(
+    Vec4(( a[5] * c5 - a[9] * c4 + a[13] * c3) * d,
+         (-a[1] * c5 + a[9] * c2 - a[13] * c1) * d,
+         ( a[1] * c4 - a[5] * c2 + a[13] * c0) * d,
+         (-a[1] * c3 + a[5] * c1 - a[9] * c0) * d),
+    Vec4((-a[4] * c5 + a[8] * c4 - a[12] * c3) * d,
+         ( a[0] * c5 - a[8] * c2 + a[12] * c1) * d,
+         (-a[0] * c4 + a[4] * c2 - a[12] * c0) * d,
+         ( a[0] * c3 - a[4] * c1 + a[8] * c0) * d),
+    Vec4(( a[7] * s5 - a[11] * s4 + a[15] * s3) * d,
+         (-a[3] * s5 + a[11] * s2 - a[15] * s1) * d,
+         ( a[3] * s4 - a[7] * s2 + a[15] * s0) * d,
+         (-a[3] * s3 + a[7] * s1 - a[11] * s0) * d),
+    Vec4((-a[6] * s5 + a[10] * s4 - a[14] * s3) * d,
+         ( a[2] * s5 - a[10] * s2 + a[14] * s1) * d,
+         (-a[2] * s4 + a[6] * s2 - a[14] * s0) * d,
+         ( a[2] * s3 - a[6] * s1 + a[10] * s0) * d));
+}
+
+Frustum Frustum::FromMatrix(const Mat4& viewProjection)
+{
+  // Gribb and Hartmann: -w <= x, y, z <= w in clip space, so each plane
+  // is the last row of the matrix plus or minus one of the others
+  Mat4 rows = Transpose(viewProjection);
+  Frustum frustum;
+  frustum.Planes[0] = rows[3] + rows[0];
+  frustum.Planes[1] = rows[3] - rows[0];
+  frustum.Planes[2] = rows[3] + rows[1];
+  frustum.Planes[3] = rows[3] - rows[1];
+  frustum.Planes[4] = rows[3] + rows[2];
+  frustum.Planes[5] = rows[3] - rows[2];
+  for (Vec4& plane : frustum.Planes)
+    plane = plane / Length(plane.xyz());
+  return frustum;
+}
+
+// ------------------------------ SIMD level ------------------------------
+static SimdLevel DetectSimdLevel()
+{
+#if MATH_SSE
+  #ifdef _MSC_VER
+  // AVX needs the CPU flag and the OS saving the YMM registers (OSXSAVE + XCR0)
+  int info[4];
+  __cpuid(info, 1);
+  bool avx = (info[2] & (1 << 28)) && (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+  #else
+  __builtin_cpu_init();
+  bool avx = __builtin_cpu_supports("avx");
+  #endif
+  return avx ? SimdLevel::AVX : SimdLevel::SSE;
+#elif MATH_NEON
+  return SimdLevel::NEON;
+#else
+  return SimdLevel::Scalar;
+#endif
+}
+
+static const SimdLevel s_SupportedLevel = DetectSimdLevel();
+static SimdLevel s_Level = s_SupportedLevel;
+
+SimdLevel GetSimdLevel()
+{
+  return s_Level;
+}
+
+SimdLevel SetSimdLevel(SimdLevel level)
+{
+  // SSE and AVX share a build, NEON stands alone
+  bool supported = level == SimdLevel::Scalar || level == s_SupportedLevel
+    || (level == SimdLevel::SSE && s_SupportedLevel == SimdLevel::AVX);
+  s_Level = supported ? level : s_SupportedLevel;
+  return s_Level;
+}
+
+const char* GetSimdLevelName(SimdLevel level)
+{
+  switch (level)
+  {
+    case SimdLevel::Scalar: return "scalar";
+    case SimdLevel::SSE:    return "sse";
+    case SimdLevel::AVX:    return "avx";
+    case SimdLevel::NEON:   return "neon";
+  }
+  return "unknown";
+}
+// ------------------------------------------------------------------------
+
+// ---------------------------- Scalar kernels ----------------------------
+// Plain loops over the same operations in the same order as the SIMD
+// kernels, so every level gives identical results. Also the NEON path
+// until it gets kernels of its own.
+static void TransformPointsScalar(const Mat4& m, const Vec3* points, Vec3* out, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    Vec3 p = points[i];
+    out[i] = Vec3(
+      m[0].x * p.x + m[1].x * p.y + m[2].x * p.z + m[3].x,
+      m[0].y * p.x + m[1].y * p.y + m[2].y * p.z + m[3].y,
+      m[0].z * p.x + m[1].z * p.y + m[2].z * p.z + m[3].z);
+  }
+}
+
+static void ComposeTransformsScalar(const Vec3* translations, const Quat* rotations, const Vec3* scales, Mat4* out, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+    out[i] = Mat4::Compose(translations[i], rotations[i], scales[i]);
+}
+
+static void MultiplyMatricesScalar(const Mat4& a, const Mat4* b, Mat4* out, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    Mat4 r;
+    for (int c = 0; c < 4; c++)
+    {
+      const Vec4& v = b[i][c];
+      r[c] = Vec4(
+        a[0].x * v.x + a[1].x * v.y + a[2].x * v.z + a[3].x * v.w,
+        a[0].y * v.x + a[1].y * v.y + a[2].y * v.z + a[3].y * v.w,
+        a[0].z * v.x + a[1].z * v.y + a[2].z * v.z + a[3].z * v.w,
+        a[0].w * v.x + a[1].w * v.y + a[2].w * v.z + a[3].w * v.w);
+    }
+    out[i] = r;
+  }
+}
+
+// Rows of the box corners furthest along and against a plane's normal.
+// A box is outside the plane if its far corner is, inside if the near one is.
+struct BoxCornerRows
+{
+  int Far[3], Near[3];
+
+  BoxCornerRows(const Vec4& plane)
+  {
+    const float normal[3] = { plane.x, plane.y, plane.z };
+    for (int i = 0; i < 3; i++)
+    {
+      Far[i] = normal[i] >= 0.0f ? BoxMaxX + i : BoxMinX + i;
+      Near[i] = normal[i] >= 0.0f ? BoxMinX + i : BoxMaxX + i;
+    }
+  }
+};
+
+static unsigned int FrustumTestBoxesScalar(const Frustum& frustum, const float boxes[BoxRowCount][8], unsigned int& inside)
+{
+  unsigned int outside = 0, partial = 0;
+  for (const Vec4& p : frustum.Planes)
+  {
+    BoxCornerRows rows(p);
+    for (int i = 0; i < 8; i++)
+    {
+      float farDistance = p.x * boxes[rows.Far[0]][i] + p.y * boxes[rows.Far[1]][i] + p.z * boxes[rows.Far[2]][i] + p.w;
+      float nearDistance = p.x * boxes[rows.Near[0]][i] + p.y * boxes[rows.Near[1]][i] + p.z * boxes[rows.Near[2]][i] + p.w;
+      outside |= (unsigned int)(farDistance < 0.0f) << i;
+      partial |= (unsigned int)(nearDistance < 0.0f) << i;
+    }
+  }
+  inside = ~(outside | partial) & 0xff;
+  return ~outside & 0xff;
+}
+// ------------------------------------------------------------------------
+
+#if MATH_SSE
+// ------------------------------ SSE kernels -----------------------------
+// Four Vec3s (12 floats in a, b, c) to x, y and z registers and back
+static inline void Deinterleave3(__m128 a, __m128 b, __m128 c, __m128& x, __m128& y, __m128& z)
+{
+  __m128 tx = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+  x = _mm_shuffle_ps(a, tx, _MM_SHUFFLE(2, 0, 3, 0));
+  y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+  z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+static inline void Interleave3(__m128 x, __m128 y, __m128 z, __m128& a, __m128& b, __m128& c)
+{
+  __m128 xy01 = _mm_unpacklo_ps(x, y), xy23 = _mm_unpackhi_ps(x, y);
+  a = _mm_shuffle_ps(xy01, _mm_shuffle_ps(z, xy01, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0));
+  b = _mm_shuffle_ps(_mm_shuffle_ps(xy01, z, _MM_SHUFFLE(1, 1, 3, 3)), xy23, _MM_SHUFFLE(1, 0, 2, 0));
+  c = _mm_shuffle_ps(_mm_shuffle_ps(z, xy23, _MM_SHUFFLE(2, 2, 2, 2)), _mm_shuffle_ps(xy23, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+static inline void Transpose4(__m128& r0, __m128& r1, __m128& r2, __m128& r3)
+{
+  __m128 t0 = _mm_unpacklo_ps(r0, r1), t1 = _mm_unpacklo_ps(r2, r3);
+  __m128 t2 = _mm_unpackhi_ps(r0, r1), t3 = _mm_unpackhi_ps(r2, r3);
+  r0 = _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+  r1 = _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+  r2 = _mm_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  r3 = _mm_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+// Four points per iteration in structure-of-arrays form, one matrix
+// element per multiply for all four
+static void TransformPointsSSE(const Mat4& m, const Vec3* points, Vec3* out, size_t count)
+{
+  __m128 m00 = _mm_set1_ps(m[0].x), m01 = _mm_set1_ps(m[0].y), m02 = _mm_set1_ps(m[0].z);
+  __m128 m10 = _mm_set1_ps(m[1].x), m11 = _mm_set1_ps(m[1].y), m12 = _mm_set1_ps(m[1].z);
+  __m128 m20 = _mm_set1_ps(m[2].x), m21 = _mm_set1_ps(m[2].y), m22 = _mm_set1_ps(m[2].z);
+  __m128 m30 = _mm_set1_ps(m[3].x), m31 = _mm_set1_ps(m[3].y), m32 = _mm_set1_ps(m[3].z);
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    const float* p = &points[i].x;
+    __m128 x, y, z;
+    Deinterleave3(_mm_loadu_ps(p), _mm_loadu_ps(p + 4), _mm_loadu_ps(p + 8), x, y, z);
+
+    __m128 rx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m10, y)), _mm_mul_ps(m20, z)), m30);
+    __m128 ry = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, x), _mm_mul_ps(m11, y)), _mm_mul_ps(m21, z)), m31);
+    __m128 rz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m02, x), _mm_mul_ps(m12, y)), _mm_mul_ps(m22, z)), m32);
+
+    __m128 a, b, c;
+    Interleave3(rx, ry, rz, a, b, c);
+    float* o = &out[i].x;
+    _mm_storeu_ps(o, a);
+    _mm_storeu_ps(o + 4, b);
+    _mm_storeu_ps(o + 8, c);
+  }
+  TransformPointsScalar(m, points + i, out + i, count - i);
+}
+
+// Four objects per iteration: their quaternions are transposed so every
+// matrix element is computed for all four at once
+static void ComposeTransformsSSE(const Vec3* translations, const Quat* rotations, const Vec3* scales, Mat4* out, size_t count)
+{
+  const __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f), zero = _mm_setzero_ps();
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 qx = _mm_load_ps(&rotations[i].x), qy = _mm_load_ps(&rotations[i + 1].x);
+    __m128 qz = _mm_load_ps(&rotations[i + 2].x), qw = _mm_load_ps(&rotations[i + 3].x);
+    Transpose4(qx, qy, qz, qw);
+
+    __m128 tx, ty, tz, sx, sy, sz;
+    const float* t = &translations[i].x;
+    const float* s = &scales[i].x;
+    Deinterleave3(_mm_loadu_ps(t), _mm_loadu_ps(t + 4), _mm_loadu_ps(t + 8), tx, ty, tz);
+    Deinterleave3(_mm_loadu_ps(s), _mm_loadu_ps(s + 4), _mm_loadu_ps(s + 8), sx, sy, sz);
+
+    __m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+    __m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+    __m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+
+    // cNk holds element k of column N for all four objects, transposing
+    // each group of four gives column N of every object
+    __m128 c0x = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+    __m128 c0y = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+    __m128 c0z = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+    __m128 c1x = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+    __m128 c1y = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+    __m128 c1z = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+    __m128 c2x = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+    __m128 c2y = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+    __m128 c2z = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+
+    __m128 c0w = zero, c1w = zero, c2w = zero, c3w = one;
+    Transpose4(c0x, c0y, c0z, c0w);
+    Transpose4(c1x, c1y, c1z, c1w);
+    Transpose4(c2x, c2y, c2z, c2w);
+    Transpose4(tx, ty, tz, c3w);
+
+    __m128 columns[4][4] = {
+      { c0x, c1x, c2x, tx }, { c0y, c1y, c2y, ty }, { c0z, c1z, c2z, tz }, { c0w, c1w, c2w, c3w }
+    };
+    for (int object = 0; object < 4; object++)
+    {
+      for (int column = 0; column < 4; column++)
+        _mm_store_ps(&out[i + object][column].x, columns[object][column]);
+    }
+  }
+  ComposeTransformsScalar(translations + i, rotations + i, scales + i, out + i, count - i);
+}
+
+static void MultiplyMatricesSSE(const Mat4& a, const Mat4* b, Mat4* out, size_t count)
+{
+  __m128 a0 = LoadVec4(a[0]), a1 = LoadVec4(a[1]), a2 = LoadVec4(a[2]), a3 = LoadVec4(a[3]);
+  for (size_t i = 0; i < count; i++)
+  {
+    __m128 r[4];
+    for (int c = 0; c < 4; c++)
+    {
+      __m128 v = LoadVec4(b[i][c]);
+      __m128 sum = _mm_mul_ps(a0, _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+      sum = _mm_add_ps(sum, _mm_mul_ps(a1, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+      sum = _mm_add_ps(sum, _mm_mul_ps(a2, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+      r[c] = _mm_add_ps(sum, _mm_mul_ps(a3, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+    }
+    for (int c = 0; c < 4; c++)
+      _mm_store_ps(&out[i][c].x, r[c]);
+  }
+}
+
+// Two halves of four boxes
+static unsigned int FrustumTestBoxesSSE(const Frustum& frustum, const float boxes[BoxRowCount][8], unsigned int& inside)
+{
+  __m128 zero = _mm_setzero_ps();
+  unsigned int outside = 0, partial = 0;
+  for (int half = 0; half < 8; half += 4)
+  {
+    __m128 out = zero, part = zero;
+    for (const Vec4& p : frustum.Planes)
+    {
+      BoxCornerRows rows(p);
+      __m128 nx = _mm_set1_ps(p.x), ny = _mm_set1_ps(p.y), nz = _mm_set1_ps(p.z), d = _mm_set1_ps(p.w);
+      __m128 farDistance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, _mm_loadu_ps(boxes[rows.Far[0]] + half)),
+        _mm_mul_ps(ny, _mm_loadu_ps(boxes[rows.Far[1]] + half))), _mm_mul_ps(nz, _mm_loadu_ps(boxes[rows.Far[2]] + half))), d);
+      __m128 nearDistance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, _mm_loadu_ps(boxes[rows.Near[0]] + half)),
+        _mm_mul_ps(ny, _mm_loadu_ps(boxes[rows.Near[1]] + half))), _mm_mul_ps(nz, _mm_loadu_ps(boxes[rows.Near[2]] + half))), d);
+      out = _mm_or_ps(out, _mm_cmplt_ps(farDistance, zero));
+      part = _mm_or_ps(part, _mm_cmplt_ps(nearDistance, zero));
+    }
+    outside |= (unsigned int)_mm_movemask_ps(out) << half;
+    partial |= (unsigned int)_mm_movemask_ps(part) << half;
+  }
+  inside = ~(outside | partial) & 0xff;
+  return ~outside & 0xff;
+}
+// ------------------------------------------------------------------------
+
+// ------------------------------ AVX kernels -----------------------------
+// The SSE kernels with both 128-bit lanes doing the work of one SSE
+// iteration, since AVX shuffles stay within their lane
+MATH_TARGET_AVX static inline void Deinterleave3(__m256 a, __m256 b, __m256 c, __m256& x, __m256& y, __m256& z)
+{
+  __m256 tx = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+  x = _mm256_shuffle_ps(a, tx, _MM_SHUFFLE(2, 0, 3, 0));
+  y = _mm256_shuffle_ps(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm256_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+  z = _mm256_shuffle_ps(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm256_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+MATH_TARGET_AVX static inline void Interleave3(__m256 x, __m256 y, __m256 z, __m256& a, __m256& b, __m256& c)
+{
+  __m256 xy01 = _mm256_unpacklo_ps(x, y), xy23 = _mm256_unpackhi_ps(x, y);
+  a = _mm256_shuffle_ps(xy01, _mm256_shuffle_ps(z, xy01, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0));
+  b = _mm256_shuffle_ps(_mm256_shuffle_ps(xy01, z, _MM_SHUFFLE(1, 1, 3, 3)), xy23, _MM_SHUFFLE(1, 0, 2, 0));
+  c = _mm256_shuffle_ps(_mm256_shuffle_ps(z, xy23, _MM_SHUFFLE(2, 2, 2, 2)), _mm256_shuffle_ps(xy23, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+MATH_TARGET_AVX static inline __m256 Load2(const float* low, const float* high)
+{
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(low)), _mm_loadu_ps(high), 1);
+}
+
+MATH_TARGET_AVX static inline void Store2(float* low, float* high, __m256 v)
+{
+  _mm_storeu_ps(low, _mm256_castps256_ps128(v));
+  _mm_storeu_ps(high, _mm256_extractf128_ps(v, 1));
+}
+
+// Points i..i+3 in the low lane, i+4..i+7 in the high one
+MATH_TARGET_AVX static void TransformPointsAVX(const Mat4& m, const Vec3* points, Vec3* out, size_t count)
+{
+  __m256 m00 = _mm256_set1_ps(m[0].x), m01 = _mm256_set1_ps(m[0].y), m02 = _mm256_set1_ps(m[0].z);
+  __m256 m10 = _mm256_set1_ps(m[1].x), m11 = _mm256_set1_ps(m[1].y), m12 = _mm256_set1_ps(m[1].z);
+  __m256 m20 = _mm256_set1_ps(m[2].x), m21 = _mm256_set1_ps(m[2].y), m22 = _mm256_set1_ps(m[2].z);
+  __m256 m30 = _mm256_set1_ps(m[3].x), m31 = _mm256_set1_ps(m[3].y), m32 = _mm256_set1_ps(m[3].z);
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    const float* p = &points[i].x;
+    __m256 x, y, z;
+    Deinterleave3(Load2(p, p + 12), Load2(p + 4, p + 16), Load2(p + 8, p + 20), x, y, z);
+
+    __m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, x), _mm256_mul_ps(m10, y)), _mm256_mul_ps(m20, z)), m30);
+    __m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m01, x), _mm256_mul_ps(m11, y)), _mm256_mul_ps(m21, z)), m31);
+    __m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m02, x), _mm256_mul_ps(m12, y)), _mm256_mul_ps(m22, z)), m32);
+
+    __m256 a, b, c;
+    Interleave3(rx, ry, rz, a, b, c);
+    float* o = &out[i].x;
+    Store2(o, o + 12, a);
+    Store2(o + 4, o + 16, b);
+    Store2(o + 8, o + 20, c);
+  }
+  TransformPointsSSE(m, points + i, out + i, count - i);
+}
+
+// Two columns per register, each lane multiplies one column by a. Mat4
+// is only 16 byte aligned, hence the unaligned loads.
+MATH_TARGET_AVX static void MultiplyMatricesAVX(const Mat4& a, const Mat4* b, Mat4* out, size_t count)
+{
+  __m256 a0 = _mm256_broadcast_ps((const __m128*)&a[0].x), a1 = _mm256_broadcast_ps((const __m128*)&a[1].x);
+  __m256 a2 = _mm256_broadcast_ps((const __m128*)&a[2].x), a3 = _mm256_broadcast_ps((const __m128*)&a[3].x);
+  for (size_t i = 0; i < count; i++)
+  {
+    __m256 r[2];
+    for (int c = 0; c < 2; c++)
+    {
+      __m256 v = _mm256_loadu_ps(&b[i][c * 2].x);
+      __m256 sum = _mm256_mul_ps(a0, _mm256_permute_ps(v, _MM_SHUFFLE(0, 0, 0, 0)));
+      sum = _mm256_add_ps(sum, _mm256_mul_ps(a1, _mm256_permute_ps(v, _MM_SHUFFLE(1, 1, 1, 1))));
+      sum = _mm256_add_ps(sum, _mm256_mul_ps(a2, _mm256_permute_ps(v, _MM_SHUFFLE(2, 2, 2, 2))));
+      r[c] = _mm256_add_ps(sum, _mm256_mul_ps(a3, _mm256_permute_ps(v, _MM_SHUFFLE(3, 3, 3, 3))));
+    }
+    _mm256_storeu_ps(&out[i][0].x, r[0]);
+    _mm256_storeu_ps(&out[i][2].x, r[1]);
+  }
+}
+
+// All eight boxes in one register per row
+MATH_TARGET_AVX static unsigned int FrustumTestBoxesAVX(const Frustum& frustum, const float boxes[BoxRowCount][8], unsigned int& inside)
+{
+  __m256 zero = _mm256_setzero_ps();
+  __m256 out = zero, part = zero;
+  for (const Vec4& p : frustum.Planes)
+  {
+    BoxCornerRows rows(p);
+    __m256 nx = _mm256_set1_ps(p.x), ny = _mm256_set1_ps(p.y), nz = _mm256_set1_ps(p.z), d = _mm256_set1_ps(p.w);
+    __m256 farDistance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, _mm256_loadu_ps(boxes[rows.Far[0]])),
+      _mm256_mul_ps(ny, _mm256_loadu_ps(boxes[rows.Far[1]]))), _mm256_mul_ps(nz, _mm256_loadu_ps(boxes[rows.Far[2]]))), d);
+    __m256 nearDistance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, _mm256_loadu_ps(boxes[rows.Near[0]])),
+      _mm256_mul_ps(ny, _mm256_loadu_ps(boxes[rows.Near[1]]))), _mm256_mul_ps(nz, _mm256_loadu_ps(boxes[rows.Near[2]]))), d);
+    out = _mm256_or_ps(out, _mm256_cmp_ps(farDistance, zero, _CMP_LT_OQ));
+    part = _mm256_or_ps(part, _mm256_cmp_ps(nearDistance, zero, _CMP_LT_OQ));
+  }
+  unsigned int outside = (unsigned int)_mm256_movemask_ps(out), partial = (unsigned int)_mm256_movemask_ps(part);
+  inside = ~(outside | partial) & 0xff;
+  return ~outside & 0xff;
+}
+// ------------------------------------------------------------------------
+#endif
+
+void TransformPoints(const Mat4& m, const Vec3* points, Vec3* out, size_t count)
+{
+#if MATH_SSE
+  if (s_Level == SimdLevel::AVX)
+    return TransformPointsAVX(m, points, out, count);
+  if (s_Level == SimdLevel::SSE)
+    return TransformPointsSSE(m, points, out, count);
+#endif
+  TransformPointsScalar(m, points, out, count);
+}
+
+void ComposeTransforms(const Vec3* translations, const Quat* rotations, const Vec3* scales, Mat4* out, size_t count)
+{
+#if MATH_SSE
+  // Bound by the transposes, eight lanes don't pay off
+  if (s_Level != SimdLevel::Scalar)
+    return ComposeTransformsSSE(translations, rotations, scales, out, count);
+#endif
+  ComposeTransformsScalar(translations, rotations, scales, out, count);
+}
+
+void MultiplyMatrices(const Mat4& a, const Mat4* b, Mat4* out, size_t count)
+{
+#if MATH_SSE
+  if (s_Level == SimdLevel::AVX)
+    return MultiplyMatricesAVX(a, b, out, count);
+  if (s_Level == SimdLevel::SSE)
+    return MultiplyMatricesSSE(a, b, out, count);
+#endif
+  MultiplyMatricesScalar(a, b, out, count);
+}
+
+unsigned int FrustumTestBoxes(const Frustum& frustum, const float boxes[BoxRowCount][8], unsigned int& inside)
+{
+#if MATH_SSE
+  if (s_Level == SimdLevel::AVX)
+    return FrustumTestBoxesAVX(frustum, boxes, inside);
+  if (s_Level == SimdLevel::SSE)
+    return FrustumTestBoxesSSE(frustum, boxes, inside);
+#endif
+  return FrustumTestBoxesScalar(frustum, boxes, inside);
+}
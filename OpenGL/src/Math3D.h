@@ -0,0 +1,476 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+// MATH_SIMD 1 uses SSE on x86 and NEON on ARM for Vec4, Mat4 and Quat
+// and lets the batch functions pick the widest kernels the CPU runs
+// (AVX is detected at runtime), 0 keeps everything scalar.
+#ifndef MATH_SIMD
+#define MATH_SIMD 1
+#endif
+
+#if MATH_SIMD && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+  #define MATH_SSE 1
+  #include <emmintrin.h>
+#elif MATH_SIMD && (defined(__ARM_NEON) || defined(_M_ARM64))
+  #define MATH_NEON 1
+  #include <arm_neon.h>
+#endif
+
+// Column-major matrices acting on column vectors, like GLSL: the
+// translation is in column 3 and Mat4 data goes to glUniformMatrix4fv
+// without transposing. Angles are in radians, projections map depth
+// to GL's [-1, 1] clip range.
+
+// ------------------------------- Vectors --------------------------------
+struct Vec2
+{
+  float x, y;
+
+  Vec2() = default;
+  constexpr Vec2(float x, float y)
+    : x(x), y(y) {}
+  explicit constexpr Vec2(float s)
+    : x(s), y(s) {}
+};
+
+struct Vec3
+{
+  float x, y, z;
+
+  Vec3() = default;
+  constexpr Vec3(float x, float y, float z)
+    : x(x), y(y), z(z) {}
+  explicit constexpr Vec3(float s)
+    : x(s), y(s), z(s) {}
+};
+
+struct alignas(16) Vec4
+{
+  float x, y, z, w;
+
+  Vec4() = default;
+  constexpr Vec4(float x, float y, float z, float w)
+    : x(x), y(y), z(z), w(w) {}
+  constexpr Vec4(const Vec3& v, float w)
+    : x(v.x), y(v.y), z(v.z), w(w) {}
+  explicit constexpr Vec4(float s)
+    : x(s), y(s), z(s), w(s) {}
+
+  inline Vec3 xyz() const { return Vec3(x, y, z); }
+};
+
+inline Vec2 operator+(const Vec2& a, const Vec2& b) { return Vec2(a.x + b.x, a.y + b.y); }
+inline Vec2 operator-(const Vec2& a, const Vec2& b) { return Vec2(a.x - b.x, a.y - b.y); }
+inline Vec2 operator*(const Vec2& a, const Vec2& b) { return Vec2(a.x * b.x, a.y * b.y); }
+inline Vec2 operator*(const Vec2& v, float s) { return Vec2(v.x * s, v.y * s); }
+inline Vec2 operator*(float s, const Vec2& v) { return v * s; }
+inline Vec2 operator/(const Vec2& v, float s) { return v * (1.0f / s); }
+inline Vec2 operator-(const Vec2& v) { return Vec2(-v.x, -v.y); }
+
+inline Vec3 operator+(const Vec3& a, const Vec3& b) { return Vec3(a.x + b.x, a.y + b.y, a.z + b.z); }
+inline Vec3 operator-(const Vec3& a, const Vec3& b) { return Vec3(a.x - b.x, a.y - b.y, a.z - b.z); }
+inline Vec3 operator*(const Vec3& a, const Vec3& b) { return Vec3(a.x * b.x, a.y * b.y, a.z * b.z); }
+inline Vec3 operator*(const Vec3& v, float s) { return Vec3(v.x * s, v.y * s, v.z * s); }
+inline Vec3 operator*(float s, const Vec3& v) { return v * s; }
+inline Vec3 operator/(const Vec3& v, float s) { return v * (1.0f / s); }
+inline Vec3 operator-(const Vec3& v) { return Vec3(-v.x, -v.y, -v.z); }
+
+#if MATH_SSE
+inline __m128 LoadVec4(const Vec4& v) { return _mm_load_ps(&v.x); }
+inline Vec4 StoreVec4(__m128 m) { Vec4 v; _mm_store_ps(&v.x, m); return v; }
+
+inline Vec4 operator+(const Vec4& a, const Vec4& b) { return StoreVec4(_mm_add_ps(LoadVec4(a), LoadVec4(b))); }
+inline Vec4 operator-(const Vec4& a, const Vec4& b) { return StoreVec4(_mm_sub_ps(LoadVec4(a), LoadVec4(b))); }
+inline Vec4 operator*(const Vec4& a, const Vec4& b) { return StoreVec4(_mm_mul_ps(LoadVec4(a), LoadVec4(b))); }
+inline Vec4 operator*(const Vec4& v, float s) { return StoreVec4(_mm_mul_ps(LoadVec4(v), _mm_set1_ps(s))); }
+#elif MATH_NEON
+inline float32x4_t LoadVec4(const Vec4& v) { return vld1q_f32(&v.x); }
+inline Vec4 StoreVec4(float32x4_t m) { Vec4 v; vst1q_f32(&v.x, m); return v; }
+
+inline Vec4 operator+(const Vec4& a, const Vec4& b) { return StoreVec4(vaddq_f32(LoadVec4(a), LoadVec4(b))); }
+inline Vec4 operator-(const Vec4& a, const Vec4& b) { return StoreVec4(vsubq_f32(LoadVec4(a), LoadVec4(b))); }
+inline Vec4 operator*(const Vec4& a, const Vec4& b) { return StoreVec4(vmulq_f32(LoadVec4(a), LoadVec4(b))); }
+inline Vec4 operator*(const Vec4& v, float s) { return StoreVec4(vmulq_n_f32(LoadVec4(v), s)); }
+#else
+inline Vec4 operator+(const Vec4& a, const Vec4& b) { return Vec4(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w); }
+inline Vec4 operator-(const Vec4& a, const Vec4& b) { return Vec4(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w); }
+inline Vec4 operator*(const Vec4& a, const Vec4& b) { return Vec4(a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w); }
+inline Vec4 operator*(const Vec4& v, float s) { return Vec4(v.x * s, v.y * s, v.z * s, v.w * s); }
+#endif
+inline Vec4 operator*(float s, const Vec4& v) { return v * s; }
+inline Vec4 operator/(const Vec4& v, float s) { return v * (1.0f / s); }
+inline Vec4 operator-(const Vec4& v) { return v * -1.0f; }
+
+inline Vec2& operator+=(Vec2& a, const Vec2& b) { return a = a + b; }
+inline Vec2& operator-=(Vec2& a, const Vec2& b) { return a = a - b; }
+inline Vec2& operator*=(Vec2& v, float s) { return v = v * s; }
+inline Vec3& operator+=(Vec3& a, const Vec3& b) { return a = a + b; }
+inline Vec3& operator-=(Vec3& a, const Vec3& b) { return a = a - b; }
+inline Vec3& operator*=(Vec3& v, float s) { return v = v * s; }
+inline Vec4& operator+=(Vec4& a, const Vec4& b) { return a = a + b; }
+inline Vec4& operator-=(Vec4& a, const Vec4& b) { return a = a - b; }
+inline Vec4& operator*=(Vec4& v, float s) { return v = v * s; }
+
+inline float Dot(const Vec2& a, const Vec2& b) { return a.x * b.x + a.y * b.y; }
+inline float Dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float Dot(const Vec4& a, const Vec4& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+inline Vec3 Cross(const Vec3& a, const Vec3& b)
+{
+  return Vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+template<typename T> inline float Length(const T& v) { return sqrtf(Dot(v, v)); }
+// Zero vectors stay zero
+template<typename T> inline T Normalize(const T& v)
+{
+  float length = Length(v);
+  return length > 0.0f ? v * (1.0f / length) : v;
+}
+template<typename T> inline T Lerp(const T& a, const T& b, float t) { return a + (b - a) * t; }
+// ------------------------------------------------------------------------
+
+// ------------------------------ Quaternion ------------------------------
+// Unit quaternion (x, y, z, w) for rotations, w is the real part
+struct alignas(16) Quat
+{
+  float x, y, z, w;
+
+  Quat() = default;
+  constexpr Quat(float x, float y, float z, float w)
+    : x(x), y(y), z(z), w(w) {}
+
+  static constexpr Quat Identity() { return Quat(0.0f, 0.0f, 0.0f, 1.0f); }
+
+  // axis has to be normalized
+  static Quat FromAxisAngle(const Vec3& axis, float angle)
+  {
+    float s = sinf(angle * 0.5f);
+    return Quat(axis.x * s, axis.y * s, axis.z * s, cosf(angle * 0.5f));
+  }
+};
+
+// a * b rotates by b first, then by a
+inline Quat operator*(const Quat& a, const Quat& b)
+{
+  return Quat(
+    a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+    a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+    a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+    a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+}
+
+inline Quat Conjugate(const Quat& q) { return Quat(-q.x, -q.y, -q.z, q.w); }
+inline float Dot(const Quat& a, const Quat& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+inline Quat Normalize(const Quat& q)
+{
+  float length = sqrtf(Dot(q, q));
+  float s = length > 0.0f ? 1.0f / length : 0.0f;
+  return Quat(q.x * s, q.y * s, q.z * s, q.w * s);
+}
+
+inline Vec3 Rotate(const Quat& q, const Vec3& v)
+{
+  // v + 2w(u x v) + 2u x (u x v), with u the vector part
+  Vec3 u(q.x, q.y, q.z);
+  Vec3 t = Cross(u, v) * 2.0f;
+  return v + t * q.w + Cross(u, t);
+}
+
+// Normalized linear interpolation along the shorter arc, fine for small angles
+inline Quat Nlerp(const Quat& a, const Quat& b, float t)
+{
+  float sign = Dot(a, b) < 0.0f ? -1.0f : 1.0f;
+  return Normalize(Quat(a.x + (b.x * sign - a.x) * t, a.y + (b.y * sign - a.y) * t,
+    a.z + (b.z * sign - a.z) * t, a.w + (b.w * sign - a.w) * t));
+}
+
+// Constant angular velocity along the shorter arc
+inline Quat Slerp(const Quat& a, const Quat& b, float t)
+{
+  float cosTheta = Dot(a, b);
+  float sign = cosTheta < 0.0f ? -1.0f : 1.0f;
+  cosTheta *= sign;
+  if (cosTheta > 0.9995f)
+    return Nlerp(a, b, t);
+
+  float theta = acosf(cosTheta);
+  float sinTheta = sinf(theta);
+  float wa = sinf((1.0f - t) * theta) / sinTheta;
+  float wb = sinf(t * theta) / sinTheta * sign;
+  return Quat(a.x * wa + b.x * wb, a.y * wa + b.y * wb, a.z * wa + b.z * wb, a.w * wa + b.w * wb);
+}
+// ------------------------------------------------------------------------
+
+// ------------------------------- Matrices -------------------------------
+struct alignas(16) Mat4
+{
+  Vec4 Columns[4];
+
+  Mat4() = default;
+  constexpr Mat4(const Vec4& c0, const Vec4& c1, const Vec4& c2, const Vec4& c3)
+    : Columns{ c0, c1, c2, c3 } {}
+  // s on the diagonal
+  explicit constexpr Mat4(float s)
+    : Columns{ Vec4(s, 0.0f, 0.0f, 0.0f), Vec4(0.0f, s, 0.0f, 0.0f), Vec4(0.0f, 0.0f, s, 0.0f), Vec4(0.0f, 0.0f, 0.0f, s) } {}
+
+  inline Vec4& operator[](int column) { return Columns[column]; }
+  inline const Vec4& operator[](int column) const { return Columns[column]; }
+  // 16 floats, column by column
+  inline const float* Data() const { return &Columns[0].x; }
+
+  static constexpr Mat4 Identity() { return Mat4(1.0f); }
+
+  static Mat4 Translate(const Vec3& t)
+  {
+    Mat4 m(1.0f);
+    m[3] = Vec4(t, 1.0f);
+    return m;
+  }
+
+  static Mat4 Scale(const Vec3& s)
+  {
+    Mat4 m(1.0f);
+    m[0].x = s.x;
+    m[1].y = s.y;
+    m[2].z = s.z;
+    return m;
+  }
+
+  static Mat4 FromQuat(const Quat& q)
+  {
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+    return Mat4(
+      Vec4(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f),
+      Vec4(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f),
+      Vec4(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f),
+      Vec4(0.0f, 0.0f, 0.0f, 1.0f));
+  }
+
+  // axis has to be normalized
+  static Mat4 Rotate(const Vec3& axis, float angle) { return FromQuat(Quat::FromAxisAngle(axis, angle)); }
+
+  // Translate(t) * FromQuat(r) * Scale(s), the usual model matrix
+  static Mat4 Compose(const Vec3& t, const Quat& r, const Vec3& s)
+  {
+    Mat4 m = FromQuat(r);
+    m[0] = m[0] * s.x;
+    m[1] = m[1] * s.y;
+    m[2] = m[2] * s.z;
+    m[3] = Vec4(t, 1.0f);
+    return m;
+  }
+
+  static Mat4 Perspective(float fovY, float aspect, float zNear, float zFar)
+  {
+    float f = 1.0f / tanf(fovY * 0.5f);
+    return Mat4(
+      Vec4(f / aspect, 0.0f, 0.0f, 0.0f),
+      Vec4(0.0f, f, 0.0f, 0.0f),
+      Vec4(0.0f, 0.0f, (zFar + zNear) / (zNear - zFar), -1.0f),
+      Vec4(0.0f, 0.0f, 2.0f * zFar * zNear / (zNear - zFar), 0.0f));
+  }
+
+  static Mat4 Orthographic(float left, float right, float bottom, float top, float zNear, float zFar)
+  {
+    return Mat4(
+      Vec4(2.0f / (right - left), 0.0f, 0.0f, 0.0f),
+      Vec4(0.0f, 2.0f / (top - bottom), 0.0f, 0.0f),
+      Vec4(0.0f, 0.0f, -2.0f / (zFar - zNear), 0.0f),
+      Vec4(-(right + left) / (right - left), -(top + bottom) / (top - bottom), -(zFar + zNear) / (zFar - zNear), 1.0f));
+  }
+
+  // View matrix of a camera at eye looking at target
+  static Mat4 LookAt(const Vec3& eye, const Vec3& target, const Vec3& up)
+  {
+    Vec3 f = Normalize(target - eye);
+    Vec3 s = Normalize(Cross(f, up));
+    Vec3 u = Cross(s, f);
+    return Mat4(
+      Vec4(s.x, u.x, -f.x, 0.0f),
+      Vec4(s.y, u.y, -f.y, 0.0f),
+      Vec4(s.z, u.z, -f.z, 0.0f),
+      Vec4(-Dot(s, eye), -Dot(u, eye), Dot(f, eye), 1.0f));
+  }
+};
+
+#if MATH_SSE
+inline __m128 TransformVec4(const Mat4& m, __m128 v)
+{
+  __m128 r = _mm_mul_ps(LoadVec4(m[0]), _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+  r = _mm_add_ps(r, _mm_mul_ps(LoadVec4(m[1]), _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+  r = _mm_add_ps(r, _mm_mul_ps(LoadVec4(m[2]), _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+  return _mm_add_ps(r, _mm_mul_ps(LoadVec4(m[3]), _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+}
+
+inline Vec4 operator*(const Mat4& m, const Vec4& v) { return StoreVec4(TransformVec4(m, LoadVec4(v))); }
+#elif MATH_NEON
+inline Vec4 operator*(const Mat4& m, const Vec4& v)
+{
+  float32x4_t r = vmulq_n_f32(LoadVec4(m[0]), v.x);
+  r = vmlaq_n_f32(r, LoadVec4(m[1]), v.y);
+  r = vmlaq_n_f32(r, LoadVec4(m[2]), v.z);
+  return StoreVec4(vmlaq_n_f32(r, LoadVec4(m[3]), v.w));
+}
+#else
+inline Vec4 operator*(const Mat4& m, const Vec4& v)
+{
+  return m[0] * v.x + m[1] * v.y + m[2] * v.z + m[3] * v.w;
+}
+#endif
+
+inline Mat4 operator*(const Mat4& a, const Mat4& b)
+{
+  return Mat4(a * b[0], a * b[1], a * b[2], a * b[3]);
+}
+
+// Point (w = 1) and direction (w = 0) through an affine matrix
+inline Vec3 TransformPoint(const Mat4& m, const Vec3& p) { return (m * Vec4(p, 1.0f)).xyz(); }
+inline Vec3 TransformDirection(const Mat4& m, const Vec3& d) { return (m * Vec4(d, 0.0f)).xyz(); }
+
+Mat4 Transpose(const Mat4& m);
+// General inverse, singular matrices give the zero matrix
+Mat4 Inverse(const Mat4& m);
+
+struct Mat3
+{
+  Vec3 Columns[3];
+
+  Mat3() = default;
+  constexpr Mat3(const Vec3& c0, const Vec3& c1, const Vec3& c2)
+    : Columns{ c0, c1, c2 } {}
+  explicit constexpr Mat3(float s)
+    : Columns{ Vec3(s, 0.0f, 0.0f), Vec3(0.0f, s, 0.0f), Vec3(0.0f, 0.0f, s) } {}
+  // Upper left 3x3
+  explicit Mat3(const Mat4& m)
+    : Columns{ m[0].xyz(), m[1].xyz(), m[2].xyz() } {}
+
+  inline Vec3& operator[](int column) { return Columns[column]; }
+  inline const Vec3& operator[](int column) const { return Columns[column]; }
+  inline const float* Data() const { return &Columns[0].x; }
+};
+
+inline Vec3 operator*(const Mat3& m, const Vec3& v) { return m[0] * v.x + m[1] * v.y + m[2] * v.z; }
+inline Mat3 operator*(const Mat3& a, const Mat3& b) { return Mat3(a * b[0], a * b[1], a * b[2]); }
+
+inline Mat3 Transpose(const Mat3& m)
+{
+  return Mat3(Vec3(m[0].x, m[1].x, m[2].x), Vec3(m[0].y, m[1].y, m[2].y), Vec3(m[0].z, m[1].z, m[2].z));
+}
+
+// Singular matrices give the zero matrix
+inline Mat3 Inverse(const Mat3& m)
+{
+  // The rows of the inverse are the cross products of the columns
+  Vec3 r0 = Cross(m[1], m[2]), r1 = Cross(m[2], m[0]), r2 = Cross(m[0], m[1]);
+  float determinant = Dot(m[0], r0);
+  float s = determinant != 0.0f ? 1.0f / determinant : 0.0f;
+  return Transpose(Mat3(r0 * s, r1 * s, r2 * s));
+}
+
+// Transforms normals by model, correct for non-uniform scales as well
+inline Mat3 NormalMatrix(const Mat4& model) { return Transpose(Inverse(Mat3(model))); }
+// ------------------------------------------------------------------------
+
+// ---------------------------- Bounding boxes ----------------------------
+struct Aabb
+{
+  Vec3 Min, Max;
+
+  Aabb() = default;
+  constexpr Aabb(const Vec3& min, const Vec3& max)
+    : Min(min), Max(max) {}
+
+  // Inside out, so growing it by a box gives that box. Never intersects
+  // a frustum, which makes it the filler for unused SIMD lanes.
+  static constexpr Aabb Empty() { return Aabb(Vec3(1e30f), Vec3(-1e30f)); }
+
+  inline Vec3 GetCenter() const { return (Min + Max) * 0.5f; }
+  inline Vec3 GetExtent() const { return (Max - Min) * 0.5f; }
+
+  inline void Grow(const Aabb& box)
+  {
+    Min = Vec3(fminf(Min.x, box.Min.x), fminf(Min.y, box.Min.y), fminf(Min.z, box.Min.z));
+    Max = Vec3(fmaxf(Max.x, box.Max.x), fmaxf(Max.y, box.Max.y), fmaxf(Max.z, box.Max.z));
+  }
+};
+// ------------------------------------------------------------------------
+
+// ------------------------------- Frustum --------------------------------
+// Clip volume of a view projection as six planes facing inwards, in the
+// order left, right, bottom, top, near, far. A point p is inside a plane
+// when Dot(plane.xyz(), p) + plane.w >= 0; the normals are unit length so
+// that value is a distance.
+struct Frustum
+{
+  Vec4 Planes[6];
+
+  static Frustum FromMatrix(const Mat4& viewProjection);
+
+  // False only if the sphere is entirely outside one plane. Spheres near
+  // the corners can pass while being outside, which is fine for culling.
+  inline bool IntersectsSphere(const Vec3& center, float radius) const
+  {
+    for (int i = 0; i < 6; i++)
+    {
+      if (Dot(Planes[i].xyz(), center) + Planes[i].w < -radius)
+        return false;
+    }
+    return true;
+  }
+
+  // False only if the box is entirely outside one plane, tested with the
+  // corner furthest along each plane's normal
+  inline bool IntersectsBox(const Aabb& box) const
+  {
+    for (int i = 0; i < 6; i++)
+    {
+      const Vec4& p = Planes[i];
+      Vec3 corner(p.x >= 0.0f ? box.Max.x : box.Min.x, p.y >= 0.0f ? box.Max.y : box.Min.y, p.z >= 0.0f ? box.Max.z : box.Min.z);
+      if (Dot(p.xyz(), corner) + p.w < 0.0f)
+        return false;
+    }
+    return true;
+  }
+};
+// ------------------------------------------------------------------------
+
+// -------------------------- Batch operations ----------------------------
+// Kernels that process arrays, several elements per instruction. They
+// run the widest implementation the CPU supports unless overridden with
+// SetSimdLevel, which is what the benchmarks use to compare them.
+enum class SimdLevel
+{
+  Scalar, SSE, AVX, NEON
+};
+
+SimdLevel GetSimdLevel();
+// Clamped to what the CPU and build support, returns the level in use
+SimdLevel SetSimdLevel(SimdLevel level);
+const char* GetSimdLevelName(SimdLevel level);
+
+// out[i] = m * (points[i], 1) for an affine m. out may alias points.
+void TransformPoints(const Mat4& m, const Vec3* points, Vec3* out, size_t count);
+// out[i] = Mat4::Compose(translations[i], rotations[i], scales[i])
+void ComposeTransforms(const Vec3* translations, const Quat* rotations, const Vec3* scales, Mat4* out, size_t count);
+// out[i] = a * b[i], e.g. the view projection times every model matrix. out may alias b.
+void MultiplyMatrices(const Mat4& a, const Mat4* b, Mat4* out, size_t count);
+
+// Boxes of FrustumTestBoxes, eight at a time in structure-of-arrays form:
+// rows 0-2 hold the min x, y and z of every box, rows 3-5 the max
+enum BoxRow
+{
+  BoxMinX, BoxMinY, BoxMinZ, BoxMaxX, BoxMaxY, BoxMaxZ, BoxRowCount
+};
+
+// Frustum.IntersectsBox for eight boxes at once. Returns a mask with bit
+// i set if box i intersects; bits of inside are set for the intersecting
+// boxes that are entirely inside all six planes. Fill unused columns with
+// Aabb::Empty(), which never intersects.
+unsigned int FrustumTestBoxes(const Frustum& frustum, const float boxes[BoxRowCount][8], unsigned int& inside);
+// ------------------------------------------------------------------------
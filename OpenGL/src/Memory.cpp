@@ -0,0 +1,94 @@
+#include "Memory.h"
+
+#include <atomic>
+#include <iostream>
+
+#include "FrameArena.h"
+
+struct AtomicTagStats
+{
+  std::atomic<uint64_t> Allocations{ 0 };
+  std::atomic<uint64_t> Bytes{ 0 };
+  std::atomic<uint64_t> PeakBytes{ 0 };
+  std::atomic<uint64_t> TotalAllocations{ 0 };
+};
+
+static AtomicTagStats s_Stats[(int)MemoryTag::Count];
+
+static const char* s_TagNames[(int)MemoryTag::Count] = {
+  "General", "Frame", "Commands", "Resources", "Scene"
+};
+
+void* Memory::Allocate(size_t size, size_t alignment, MemoryTag tag)
+{
+  void* memory = alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__
+    ? ::operator new(size, std::align_val_t(alignment))
+    : ::operator new(size);
+
+  AtomicTagStats& stats = s_Stats[(int)tag];
+  stats.Allocations.fetch_add(1, std::memory_order_relaxed);
+  stats.TotalAllocations.fetch_add(1, std::memory_order_relaxed);
+  uint64_t bytes = stats.Bytes.fetch_add(size, std::memory_order_relaxed) + size;
+  uint64_t peak = stats.PeakBytes.load(std::memory_order_relaxed);
+  while (bytes > peak && !stats.PeakBytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed))
+  {
+  }
+  return memory;
+}
+
+void Memory::Free(void* memory, size_t size, size_t alignment, MemoryTag tag)
+{
+  if (!memory)
+    return;
+
+  if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    ::operator delete(memory, std::align_val_t(alignment));
+  else
+    ::operator delete(memory);
+
+  AtomicTagStats& stats = s_Stats[(int)tag];
+  stats.Allocations.fetch_sub(1, std::memory_order_relaxed);
+  stats.Bytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+Memory::TagStats Memory::GetStats(MemoryTag tag)
+{
+  const AtomicTagStats& stats = s_Stats[(int)tag];
+  TagStats result;
+  result.Allocations = stats.Allocations.load(std::memory_order_relaxed);
+  result.Bytes = stats.Bytes.load(std::memory_order_relaxed);
+  result.PeakBytes = stats.PeakBytes.load(std::memory_order_relaxed);
+  result.TotalAllocations = stats.TotalAllocations.load(std::memory_order_relaxed);
+  return result;
+}
+
+const char* Memory::GetTagName(MemoryTag tag)
+{
+  return s_TagNames[(int)tag];
+}
+
+void Memory::PrintStats()
+{
+  for (int i = 0; i < (int)MemoryTag::Count; i++)
+  {
+    TagStats stats = GetStats((MemoryTag)i);
+    if (stats.TotalAllocations == 0)
+      continue;
+    std::cout << "Memory " << GetTagName((MemoryTag)i) << ": " << stats.Bytes / 1024 << " KiB in "
+      << stats.Allocations << " allocations (peak " << stats.PeakBytes / 1024 << " KiB, "
+      << stats.TotalAllocations << " allocations in total)" << std::endl;
+  }
+  std::cout << "Frame arena: " << GetFrameArena().GetHighWater() / 1024 << " KiB used at most, "
+    << GetFrameArena().GetCapacity() / 1024 << " KiB reserved" << std::endl;
+}
+
+FrameArena& Memory::GetFrameArena()
+{
+  static FrameArena s_FrameArena(256 * 1024, MemoryTag::Frame);
+  return s_FrameArena;
+}
+
+void Memory::EndFrame()
+{
+  GetFrameArena().Reset();
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+class FrameArena;
+
+// What memory is used for. Every allocation made through Memory is
+// counted under its tag, so the stats show which system holds how much.
+enum class MemoryTag
+{
+  General, Frame, Commands, Resources, Scene, Count
+};
+
+// Tagged allocations, the per-frame arena and their statistics. The
+// engine's long-lived and per-frame containers allocate through here
+// instead of new, either directly, through a FrameArena or ObjectPool, or
+// with TrackedAllocator. Allocating and the stats are thread-safe, the
+// frame arena belongs to the GL thread.
+class Memory
+{
+public:
+  struct TagStats
+  {
+    uint64_t Allocations = 0;       // Live
+    uint64_t Bytes = 0;             // Live
+    uint64_t PeakBytes = 0;         // High-water mark of Bytes
+    uint64_t TotalAllocations = 0;  // Since startup
+  };
+public:
+  // Aligned to at least alignof(std::max_align_t). Free has to get the
+  // same size, alignment and tag.
+  static void* Allocate(size_t size, size_t alignment, MemoryTag tag);
+  static void Free(void* memory, size_t size, size_t alignment, MemoryTag tag);
+
+  static TagStats GetStats(MemoryTag tag);
+  static const char* GetTagName(MemoryTag tag);
+  static void PrintStats();
+
+  // Scratch memory for the current frame, everything in it is released
+  // at once by EndFrame(). GL thread only.
+  static FrameArena& GetFrameArena();
+  // Frame boundary, right before the buffers are swapped
+  static void EndFrame();
+};
+
+// Standard allocator counting its memory under Tag, for containers that
+// belong to one system:
+//
+//   TrackedVector<RenderSortEntry, MemoryTag::Commands> m_Entries;
+template<typename T, MemoryTag Tag>
+struct TrackedAllocator
+{
+  using value_type = T;
+
+  template<typename U>
+  struct rebind
+  {
+    using other = TrackedAllocator<U, Tag>;
+  };
+
+  TrackedAllocator() = default;
+  template<typename U>
+  TrackedAllocator(const TrackedAllocator<U, Tag>&) {}
+
+  T* allocate(size_t count)
+  {
+    return (T*)Memory::Allocate(count * sizeof(T), alignof(T), Tag);
+  }
+
+  void deallocate(T* memory, size_t count)
+  {
+    Memory::Free(memory, count * sizeof(T), alignof(T), Tag);
+  }
+
+  template<typename U>
+  inline bool operator==(const TrackedAllocator<U, Tag>&) const { return true; }
+  template<typename U>
+  inline bool operator!=(const TrackedAllocator<U, Tag>&) const { return false; }
+};
+
+template<typename T, MemoryTag Tag>
+using TrackedVector = std::vector<T, TrackedAllocator<T, Tag>>;
+
+// Fixed-size slots for objects of type T, in pages of PageSize that never
+// move. Freed slots are reused before a new page is allocated, so once a
+// pool reached its high-water mark it doesn't allocate anymore. It only
+// hands out storage, constructing and destroying the objects is up to the
+// owner. Slots are addressed by index, which owners can keep in 32 bits.
+// Not thread-safe.
+template<typename T, uint32_t PageSize = 64>
+class ObjectPool
+{
+private:
+  struct alignas(T) Storage
+  {
+    unsigned char Bytes[sizeof(T)];
+  };
+
+  MemoryTag m_Tag;
+  std::vector<Storage*> m_Pages;
+  std::vector<uint32_t> m_FreeSlots;
+  // Slots handed out at least once, the next new slot
+  uint32_t m_Used;
+  uint32_t m_Live;
+public:
+  explicit ObjectPool(MemoryTag tag)
+    : m_Tag(tag), m_Used(0), m_Live(0) {}
+  ~ObjectPool() { Clear(); }
+
+  ObjectPool(const ObjectPool&) = delete;
+  ObjectPool& operator=(const ObjectPool&) = delete;
+
+  // Index of an unused slot, which stays uninitialized
+  uint32_t Allocate()
+  {
+    m_Live++;
+    if (!m_FreeSlots.empty())
+    {
+      uint32_t index = m_FreeSlots.back();
+      m_FreeSlots.pop_back();
+      return index;
+    }
+
+    if (m_Used == m_Pages.size() * PageSize)
+      m_Pages.push_back((Storage*)Memory::Allocate(sizeof(Storage) * PageSize, alignof(Storage), m_Tag));
+    return m_Used++;
+  }
+
+  // The object in the slot has to be destroyed already
+  void Free(uint32_t index)
+  {
+    m_FreeSlots.push_back(index);
+    m_Live--;
+  }
+
+  inline T* Get(uint32_t index) const
+  {
+    return reinterpret_cast<T*>(m_Pages[index / PageSize][index % PageSize].Bytes);
+  }
+
+  // Releases every page, all objects have to be destroyed already
+  void Clear()
+  {
+    for (Storage* page : m_Pages)
+      Memory::Free(page, sizeof(Storage) * PageSize, alignof(Storage), m_Tag);
+    m_Pages.clear();
+    m_FreeSlots.clear();
+    m_Used = 0;
+    m_Live = 0;
+  }
+
+  inline uint32_t GetLive() const { return m_Live; }
+  // Slots allocated so far, live or not
+  inline uint32_t GetCapacity() const { return (uint32_t)m_Pages.size() * PageSize; }
+};
@@ -0,0 +1,70 @@
+#include "Mesh.h"
+
+#include <iostream>
+
+#include "Renderer.h"
+#include "VertexBufferLayout.h"
+#include "CookedMesh.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+
+Mesh::Mesh(const std::string& path)
+  : m_VertexCount(0), m_BoundsMin{}, m_BoundsMax{}
+{
+  MappedFile file(path);
+  if (!file.IsValid() || file.GetSize() < sizeof(CookedMeshHeader))
+  {
+    std::cout << "Failed to open mesh '" << path << "'" << std::endl;
+    return;
+  }
+
+  const CookedMeshHeader& header = *(const CookedMeshHeader*)file.GetData();
+  if (header.Magic != CookedMeshMagic || header.Version != CookedMeshVersion || header.AttributeCount == 0
+    || (header.IndexType != GL_UNSIGNED_SHORT && header.IndexType != GL_UNSIGNED_INT)
+    || file.GetSize() < sizeof(CookedMeshHeader) + header.AttributeCount * sizeof(CookedMeshAttribute))
+  {
+    std::cout << "Invalid cooked mesh '" << path << "'" << std::endl;
+    return;
+  }
+
+  IndexType indexType = header.IndexType == GL_UNSIGNED_SHORT ? IndexType::UnsignedShort : IndexType::UnsignedInt;
+  uint64_t vertexSize = (uint64_t)header.VertexCount * header.VertexStride;
+  uint64_t indexSize = (uint64_t)header.IndexCount * IndexBuffer::GetIndexSize(indexType);
+  if (header.VertexOffset + vertexSize > file.GetSize() || header.IndexOffset + indexSize > file.GetSize())
+  {
+    std::cout << "Truncated cooked mesh '" << path << "'" << std::endl;
+    return;
+  }
+
+  // Attributes are written back to back, which is how the layout lays them out too
+  const CookedMeshAttribute* attributes = (const CookedMeshAttribute*)(file.GetData() + sizeof(CookedMeshHeader));
+  VertexBufferLayout layout;
+  for (unsigned int i = 0; i < header.AttributeCount; i++)
+  {
+    if (attributes[i].Offset != layout.GetStride())
+    {
+      std::cout << "Cooked mesh '" << path << "' has padded attributes" << std::endl;
+      return;
+    }
+    layout.Push(attributes[i].Type, attributes[i].Count, attributes[i].Normalized != 0);
+  }
+  if (layout.GetStride() != header.VertexStride)
+  {
+    std::cout << "Cooked mesh '" << path << "' has a stride of " << header.VertexStride
+      << " bytes, its attributes take " << layout.GetStride() << std::endl;
+    return;
+  }
+
+  m_VB.reset(new VertexBuffer(file.GetData() + header.VertexOffset, (unsigned int)vertexSize));
+  m_VA.AddBuffer(*m_VB, layout);
+  m_IB.reset(new IndexBuffer(file.GetData() + header.IndexOffset, header.IndexCount, indexType));
+  m_VA.Unbind();
+  Profiler::AddCounter(ProfileCounter::BytesUploaded, vertexSize + indexSize);
+
+  m_VertexCount = header.VertexCount;
+  for (int i = 0; i < 3; i++)
+  {
+    m_BoundsMin[i] = header.BoundsMin[i];
+    m_BoundsMax[i] = header.BoundsMax[i];
+  }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+
+// Mesh loaded from a cooked .cmesh file (see CookedMesh.h). The file is
+// memory-mapped and its vertex and index data handed to GL as they are.
+// The attributes take locations 0, 1, ... in file order; MeshCooker
+// writes position, normal and texture coordinates.
+class Mesh
+{
+private:
+  VertexArray m_VA;
+  std::unique_ptr<VertexBuffer> m_VB;
+  std::unique_ptr<IndexBuffer> m_IB;
+  unsigned int m_VertexCount;
+  float m_BoundsMin[3], m_BoundsMax[3];
+public:
+  Mesh(const std::string& path);
+
+  // False if the file was missing or invalid, nothing can be drawn then
+  inline bool IsValid() const { return m_IB != nullptr; }
+
+  inline const VertexArray& GetVertexArray() const { return m_VA; }
+  inline const IndexBuffer& GetIndexBuffer() const { return *m_IB; }
+  inline unsigned int GetVertexCount() const { return m_VertexCount; }
+  inline const float* GetBoundsMin() const { return m_BoundsMin; }
+  inline const float* GetBoundsMax() const { return m_BoundsMax; }
+};
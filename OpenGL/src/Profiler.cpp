@@ -0,0 +1,451 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Renderer.h"
+
+// ----------------------------- CPU markers -----------------------------
+struct CpuEvent
+{
+  const char* Name;
+  int64_t Start, End;
+};
+
+// The lock is only ever contended when a capture is written out
+struct ThreadBuffer
+{
+  std::mutex Mutex;
+  std::vector<CpuEvent> Events;
+  unsigned int Id;
+  std::string Name;
+};
+
+static std::mutex s_ThreadsMutex;
+// Kept after their thread exits so its events still make it into the trace
+static std::vector<std::unique_ptr<ThreadBuffer>> s_Threads;
+static thread_local ThreadBuffer* t_Buffer = nullptr;
+
+static ThreadBuffer& GetThreadBuffer()
+{
+  if (!t_Buffer)
+  {
+    std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+    s_Threads.emplace_back(new ThreadBuffer());
+    t_Buffer = s_Threads.back().get();
+    // Thread 0 is the GPU row
+    t_Buffer->Id = (unsigned int)s_Threads.size();
+    t_Buffer->Name = "Thread " + std::to_string(t_Buffer->Id);
+  }
+  return *t_Buffer;
+}
+// -----------------------------------------------------------------------
+
+// ----------------------------- GPU markers -----------------------------
+struct GpuScope
+{
+  const char* Name;
+  unsigned int Begin, End;  // Indices into GpuFrame::Queries
+};
+
+// Timestamp queries of one frame. The first and last one time the whole frame.
+struct GpuFrame
+{
+  std::vector<unsigned int> Queries;
+  unsigned int QueryCount = 0;
+  std::vector<GpuScope> Scopes;
+  // Slot in the summary ring that receives the GPU frame time
+  unsigned int SummaryIndex = 0;
+  bool Pending = false;
+  bool Captured = false;
+};
+
+struct GpuEvent
+{
+  const char* Name;
+  int64_t Start, End;  // On the CPU clock
+};
+
+static GpuFrame s_GpuFrames[Profiler::FrameLatency];
+static bool s_Initialized = false;
+// CPU clock minus GPU clock, for putting GPU events on the CPU timeline
+static int64_t s_GpuClockOffset = 0;
+static std::vector<uint64_t> s_QueryResults;
+// -----------------------------------------------------------------------
+
+// ------------------------ Frames and counters --------------------------
+struct FrameRecord
+{
+  double CpuMs;
+  double GpuMs;  // Negative until read back
+  uint64_t Counters[(int)ProfileCounter::Count];
+};
+
+static std::atomic<uint64_t> s_Counters[(int)ProfileCounter::Count];
+static FrameRecord s_Frames[Profiler::SummaryFrames];
+static unsigned int s_FrameCount = 0;
+static unsigned int s_GpuFramesDropped = 0;
+static int64_t s_FrameStart = 0;
+
+// Capture state. Markers are recorded while s_Capturing is set; after the
+// last frame the file is written once its GPU results have arrived.
+static std::atomic<bool> s_Capturing(false);
+static std::string s_CapturePath;
+static unsigned int s_CaptureFramesLeft = 0;
+static unsigned int s_CaptureDrainFrames = 0;
+static int64_t s_CaptureStart = 0;
+static std::vector<GpuEvent> s_GpuEvents;
+// Counter values with the end time of their frame
+static std::vector<std::pair<int64_t, FrameRecord>> s_CapturedFrames;
+// -----------------------------------------------------------------------
+
+static const char* GetCounterName(ProfileCounter counter)
+{
+  switch (counter)
+  {
+    case ProfileCounter::DrawCalls:      return "Draw calls";
+    case ProfileCounter::BytesUploaded:  return "Bytes uploaded";
+    case ProfileCounter::VisibleObjects: return "Visible objects";
+    case ProfileCounter::CulledObjects:  return "Culled objects";
+    default:                             return "";
+  }
+}
+
+static void CalibrateGpuClock()
+{
+  GLint64 gpuTime = 0;
+  GLCall(glGetInteger64v(GL_TIMESTAMP, &gpuTime));
+  s_GpuClockOffset = Profiler::Now() - gpuTime;
+}
+
+static unsigned int AllocateQuery(GpuFrame& frame)
+{
+  if (frame.QueryCount == frame.Queries.size())
+  {
+    size_t count = frame.Queries.size();
+    frame.Queries.resize(count + 64);
+    GLCall(glGenQueries(64, &frame.Queries[count]));
+  }
+  unsigned int index = frame.QueryCount++;
+  GLCall(glQueryCounter(frame.Queries[index], GL_TIMESTAMP));
+  return index;
+}
+
+static void ReadBack(GpuFrame& frame)
+{
+  frame.Pending = false;
+
+  // Queries complete in order, so the last one being ready means all are
+  int available = 0;
+  GLCall(glGetQueryObjectiv(frame.Queries[frame.QueryCount - 1], GL_QUERY_RESULT_AVAILABLE, &available));
+  if (!available)
+  {
+    s_GpuFramesDropped++;
+    return;
+  }
+
+  s_QueryResults.resize(frame.QueryCount);
+  for (unsigned int i = 0; i < frame.QueryCount; i++)
+  {
+    GLCall(glGetQueryObjectui64v(frame.Queries[i], GL_QUERY_RESULT, &s_QueryResults[i]));
+  }
+
+  uint64_t frameEnd = s_QueryResults[frame.QueryCount - 1];
+  s_Frames[frame.SummaryIndex].GpuMs = (frameEnd - s_QueryResults[0]) / 1e6;
+
+  if (frame.Captured)
+  {
+    s_GpuEvents.push_back({ "Frame", (int64_t)s_QueryResults[0] + s_GpuClockOffset, (int64_t)frameEnd + s_GpuClockOffset });
+    for (const GpuScope& scope : frame.Scopes)
+    {
+      if (scope.End == 0)
+        continue;
+      s_GpuEvents.push_back({ scope.Name, (int64_t)s_QueryResults[scope.Begin] + s_GpuClockOffset,
+        (int64_t)s_QueryResults[scope.End] + s_GpuClockOffset });
+    }
+  }
+}
+
+static void WriteEscaped(std::ofstream& stream, const char* text)
+{
+  for (; *text; text++)
+  {
+    if (*text == '"' || *text == '\\')
+      stream << '\\';
+    stream << *text;
+  }
+}
+
+static void WriteEvent(std::ofstream& stream, const char* name, unsigned int thread, int64_t start, int64_t end)
+{
+  stream << ",\n{\"name\":\"";
+  WriteEscaped(stream, name);
+  stream << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+    << ",\"ts\":" << (start - s_CaptureStart) / 1000.0 << ",\"dur\":" << (end - start) / 1000.0 << "}";
+}
+
+static void WriteCapture()
+{
+  std::ofstream stream(s_CapturePath);
+  if (!stream)
+  {
+    std::cout << "Failed to write trace '" << s_CapturePath << "'" << std::endl;
+    return;
+  }
+
+  size_t eventCount = 0;
+  stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  // Metadata first, every event after it starts with a comma
+  stream << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}";
+
+  for (const GpuEvent& event : s_GpuEvents)
+    WriteEvent(stream, event.Name, 0, event.Start, event.End);
+  eventCount += s_GpuEvents.size();
+
+  {
+    std::lock_guard<std::mutex> threadsLock(s_ThreadsMutex);
+    for (auto& thread : s_Threads)
+    {
+      std::lock_guard<std::mutex> lock(thread->Mutex);
+      stream << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->Id << ",\"args\":{\"name\":\"";
+      WriteEscaped(stream, thread->Name.c_str());
+      stream << "\"}}";
+      for (const CpuEvent& event : thread->Events)
+        WriteEvent(stream, event.Name, thread->Id, event.Start, event.End);
+      eventCount += thread->Events.size();
+      thread->Events.clear();
+    }
+  }
+
+  for (auto& frame : s_CapturedFrames)
+  {
+    for (int i = 0; i < (int)ProfileCounter::Count; i++)
+    {
+      stream << ",\n{\"name\":\"" << GetCounterName((ProfileCounter)i) << "\",\"ph\":\"C\",\"pid\":1,\"ts\":"
+        << (frame.first - s_CaptureStart) / 1000.0 << ",\"args\":{\"value\":" << frame.second.Counters[i] << "}}";
+    }
+  }
+  stream << "\n]}\n";
+
+  std::cout << "Wrote " << eventCount << " events from " << s_CapturedFrames.size() << " frames to '" << s_CapturePath << "'" << std::endl;
+  s_GpuEvents.clear();
+  s_CapturedFrames.clear();
+}
+
+void Profiler::Init()
+{
+  CalibrateGpuClock();
+  SetThreadName("Main");
+  s_Initialized = true;
+}
+
+void Profiler::Shutdown()
+{
+  if (!s_Initialized)
+    return;
+
+  // Write a capture that hasn't finished yet, waiting for its GPU results
+  if (s_Capturing || s_CaptureDrainFrames)
+  {
+    s_Capturing = false;
+    s_CaptureDrainFrames = 0;
+    GLCall(glFinish());
+    for (unsigned int i = 0; i < FrameLatency; i++)
+    {
+      GpuFrame& frame = s_GpuFrames[(s_FrameCount + i) % FrameLatency];
+      if (frame.Pending && frame.Captured)
+        ReadBack(frame);
+    }
+    WriteCapture();
+  }
+
+  for (GpuFrame& frame : s_GpuFrames)
+  {
+    if (!frame.Queries.empty())
+    {
+      GLCall(glDeleteQueries((GLsizei)frame.Queries.size(), frame.Queries.data()));
+    }
+    frame = GpuFrame();
+  }
+  s_Initialized = false;
+}
+
+void Profiler::BeginFrame()
+{
+  s_FrameStart = Now();
+  if (!s_Initialized)
+    return;
+
+  // Results of the frame that last used this slot, FrameLatency frames ago
+  GpuFrame& frame = s_GpuFrames[s_FrameCount % FrameLatency];
+  if (frame.Pending)
+    ReadBack(frame);
+
+  frame.QueryCount = 0;
+  frame.Scopes.clear();
+  frame.SummaryIndex = s_FrameCount % SummaryFrames;
+  frame.Captured = s_Capturing;
+  AllocateQuery(frame);
+}
+
+void Profiler::EndFrame()
+{
+  int64_t end = Now();
+  FrameRecord& record = s_Frames[s_FrameCount % SummaryFrames];
+  record.CpuMs = (end - s_FrameStart) / 1e6;
+  record.GpuMs = -1.0;
+  for (int i = 0; i < (int)ProfileCounter::Count; i++)
+    record.Counters[i] = s_Counters[i].exchange(0, std::memory_order_relaxed);
+
+  if (s_Initialized)
+  {
+    GpuFrame& frame = s_GpuFrames[s_FrameCount % FrameLatency];
+    AllocateQuery(frame);
+    frame.Pending = true;
+  }
+
+  if (s_Capturing)
+  {
+    RecordCpu("Frame", s_FrameStart, end);
+    s_CapturedFrames.push_back({ end, record });
+    if (--s_CaptureFramesLeft == 0)
+    {
+      s_Capturing = false;
+      s_CaptureDrainFrames = FrameLatency;
+    }
+  }
+  else if (s_CaptureDrainFrames && --s_CaptureDrainFrames == 0)
+  {
+    // BeginFrame has read back the last captured frame by now
+    WriteCapture();
+  }
+
+  s_FrameCount++;
+}
+
+void Profiler::BeginCapture(const std::string& path, unsigned int frameCount)
+{
+  if (!PROFILING)
+    std::cout << "Warning: built with PROFILING=0, the trace only contains frames" << std::endl;
+
+  {
+    std::lock_guard<std::mutex> threadsLock(s_ThreadsMutex);
+    for (auto& thread : s_Threads)
+    {
+      std::lock_guard<std::mutex> lock(thread->Mutex);
+      thread->Events.clear();
+    }
+  }
+  s_GpuEvents.clear();
+  s_CapturedFrames.clear();
+
+  if (s_Initialized)
+    CalibrateGpuClock();
+  s_CapturePath = path;
+  s_CaptureFramesLeft = std::max(frameCount, 1u);
+  s_CaptureDrainFrames = 0;
+  s_CaptureStart = Now();
+  s_Capturing = true;
+}
+
+bool Profiler::IsCapturing()
+{
+  return s_Capturing.load(std::memory_order_relaxed);
+}
+
+Profiler::Summary Profiler::GetSummary()
+{
+  Summary summary;
+  summary.Frames = s_FrameCount < SummaryFrames ? s_FrameCount : SummaryFrames;
+  summary.GpuFramesDropped = s_GpuFramesDropped;
+  if (summary.Frames == 0)
+    return summary;
+
+  double cpu[SummaryFrames], gpu[SummaryFrames];
+  for (unsigned int i = 0; i < summary.Frames; i++)
+  {
+    const FrameRecord& record = s_Frames[i];
+    cpu[i] = record.CpuMs;
+    if (record.GpuMs >= 0.0)
+      gpu[summary.GpuFrames++] = record.GpuMs;
+    summary.DrawCalls += record.Counters[(int)ProfileCounter::DrawCalls];
+    summary.BytesUploaded += record.Counters[(int)ProfileCounter::BytesUploaded];
+  }
+  summary.DrawCalls /= summary.Frames;
+  summary.BytesUploaded /= summary.Frames;
+
+  // Nearest-rank percentiles
+  auto percentiles = [](double* values, unsigned int count, double* result) {
+    std::sort(values, values + count);
+    const double ranks[] = { 0.5, 0.95, 0.99, 1.0 };
+    for (int i = 0; i < 4; i++)
+      result[i] = values[std::min(count - 1, (unsigned int)ceil(ranks[i] * count) - 1)];
+  };
+  percentiles(cpu, summary.Frames, summary.CpuMs);
+  if (summary.GpuFrames)
+    percentiles(gpu, summary.GpuFrames, summary.GpuMs);
+  return summary;
+}
+
+void Profiler::PrintSummary()
+{
+  Summary summary = GetSummary();
+  std::cout << "Frame (last " << summary.Frames << "): CPU p50 " << summary.CpuMs[0] << " p95 " << summary.CpuMs[1]
+    << " p99 " << summary.CpuMs[2] << " max " << summary.CpuMs[3] << " ms, GPU p50 " << summary.GpuMs[0]
+    << " p95 " << summary.GpuMs[1] << " p99 " << summary.GpuMs[2] << " max " << summary.GpuMs[3] << " ms ("
+    << summary.GpuFrames << " read back, " << summary.GpuFramesDropped << " dropped), " << summary.DrawCalls
+    << " draws, " << summary.BytesUploaded / 1024.0 << " KiB uploaded per frame" << std::endl;
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+  ThreadBuffer& buffer = GetThreadBuffer();
+  std::lock_guard<std::mutex> lock(buffer.Mutex);
+  buffer.Name = name;
+}
+
+void Profiler::AddCounter(ProfileCounter counter, uint64_t value)
+{
+  s_Counters[(int)counter].fetch_add(value, std::memory_order_relaxed);
+}
+
+int64_t Profiler::Now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::RecordCpu(const char* name, int64_t start, int64_t end)
+{
+  ThreadBuffer& buffer = GetThreadBuffer();
+  std::lock_guard<std::mutex> lock(buffer.Mutex);
+  buffer.Events.push_back({ name, start, end });
+}
+
+int Profiler::BeginGpu(const char* name)
+{
+  if (!s_Initialized)
+    return -1;
+
+  GpuFrame& frame = s_GpuFrames[s_FrameCount % FrameLatency];
+  if (frame.Scopes.size() >= MaxGpuScopesPerFrame)
+    return -1;
+
+  frame.Scopes.push_back({ name, AllocateQuery(frame), 0 });
+  return (int)frame.Scopes.size() - 1;
+}
+
+void Profiler::EndGpu(int scope)
+{
+  GpuFrame& frame = s_GpuFrames[s_FrameCount % FrameLatency];
+  // GPU scopes must not span EndFrame, this only catches the worst case
+  if (scope >= (int)frame.Scopes.size())
+    return;
+  frame.Scopes[scope].End = AllocateQuery(frame);
+}
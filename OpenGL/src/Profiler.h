@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// PROFILING 1 compiles the PROFILE_* markers in, 0 removes them entirely.
+// Frame timing and counters stay available either way.
+#ifndef PROFILING
+#define PROFILING 1
+#endif
+
+enum class ProfileCounter
+{
+  DrawCalls, BytesUploaded, VisibleObjects, CulledObjects, Count
+};
+
+// CPU and GPU frame profiler. CPU markers are stored per thread while a
+// capture is running, GPU markers are timestamp queries from a pool per
+// frame that is read back FrameLatency frames later, so reading never
+// waits for the GPU. Captures are written as Chrome trace JSON, which
+// chrome://tracing and ui.perfetto.dev open.
+//
+// Init/Shutdown/BeginFrame/EndFrame and GPU markers belong on the GL
+// thread, CPU markers and counters work on any thread.
+class Profiler
+{
+public:
+  // Frame statistics over the last SummaryFrames frames
+  struct Summary
+  {
+    unsigned int Frames = 0;
+    double CpuMs[4] = {};        // p50, p95, p99, max of the CPU frame time
+    unsigned int GpuFrames = 0;  // Frames whose GPU time has been read back
+    double GpuMs[4] = {};
+    double DrawCalls = 0.0;      // Average per frame
+    double BytesUploaded = 0.0;
+    unsigned int GpuFramesDropped = 0;  // Results not ready when their queries were reused
+  };
+
+  static const unsigned int FrameLatency = 4;
+  static const unsigned int SummaryFrames = 240;
+  static const unsigned int MaxGpuScopesPerFrame = 256;
+public:
+  static void Init();
+  // Writes an unfinished capture and frees the queries, needs the context
+  static void Shutdown();
+
+  static void BeginFrame();
+  static void EndFrame();
+
+  // Records every marker for the next frameCount frames, then writes them to path
+  static void BeginCapture(const std::string& path, unsigned int frameCount);
+  static bool IsCapturing();
+
+  static Summary GetSummary();
+  static void PrintSummary();
+
+  // Names the calling thread's row in the trace
+  static void SetThreadName(const char* name);
+
+  static void AddCounter(ProfileCounter counter, uint64_t value);
+
+  // Used by the scope classes
+  static int64_t Now();
+  static void RecordCpu(const char* name, int64_t start, int64_t end);
+  static int BeginGpu(const char* name);
+  static void EndGpu(int scope);
+};
+
+class CpuProfileScope
+{
+private:
+  const char* m_Name;
+  int64_t m_Start;
+public:
+  CpuProfileScope(const char* name)
+    : m_Name(name), m_Start(Profiler::IsCapturing() ? Profiler::Now() : -1) {}
+  ~CpuProfileScope()
+  {
+    if (m_Start >= 0)
+      Profiler::RecordCpu(m_Name, m_Start, Profiler::Now());
+  }
+};
+
+class GpuProfileScope
+{
+private:
+  int m_Scope;
+public:
+  GpuProfileScope(const char* name)
+    : m_Scope(Profiler::IsCapturing() ? Profiler::BeginGpu(name) : -1) {}
+  ~GpuProfileScope()
+  {
+    if (m_Scope >= 0)
+      Profiler::EndGpu(m_Scope);
+  }
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#if PROFILING
+// Names must be string literals or otherwise outlive the capture
+#define PROFILE_SCOPE(name) CpuProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+// Times the GL commands issued in the scope on the GPU, and the scope itself on the CPU
+#define PROFILE_GPU_SCOPE(name) PROFILE_SCOPE(name); GpuProfileScope PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_GPU_SCOPE(name)
+#endif
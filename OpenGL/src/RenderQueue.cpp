@@ -0,0 +1,239 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Renderer.h"
+#include "Texture.h"
+#include "UniformBuffer.h"
+
+// ------------------------------ CommandBuffer ------------------------------
+CommandBuffer::CommandBuffer()
+  : m_Arena(64 * 1024, MemoryTag::Commands), m_RecordMs(0.0)
+{
+}
+
+void CommandBuffer::Begin()
+{
+  m_RecordStart = std::chrono::steady_clock::now();
+}
+
+void CommandBuffer::End()
+{
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - m_RecordStart;
+  m_RecordMs += elapsed.count();
+}
+
+DrawCommand* CommandBuffer::Draw(RenderPass pass, float depth, Shader& shader, const VertexArray& va, const IndexBuffer& ib,
+  const Texture* texture, unsigned int instanceCount)
+{
+  DrawCommand* command = m_Arena.New<DrawCommand>();
+  command->Program = &shader;
+  command->VA = &va;
+  command->IB = &ib;
+  command->Texture0 = texture;
+  command->InstanceCount = instanceCount;
+  command->Uniforms = nullptr;
+  command->UniformBlock = nullptr;
+  command->UniformBlockOffset = 0;
+
+  uint64_t key = RenderQueue::MakeSortKey(pass, depth, shader.GetRendererID(),
+    texture ? texture->GetRendererID() : 0, va.GetRendererID());
+  m_Entries.push_back({ key, command });
+  return command;
+}
+
+void CommandBuffer::SetUniform1i(DrawCommand* command, UniformHandle uniform, int value)
+{
+  AddUniform(command, uniform, GL_INT, &value, sizeof(value));
+}
+
+void CommandBuffer::SetUniform1f(DrawCommand* command, UniformHandle uniform, float value)
+{
+  AddUniform(command, uniform, GL_FLOAT, &value, sizeof(value));
+}
+
+void CommandBuffer::SetUniform2f(DrawCommand* command, UniformHandle uniform, float v0, float v1)
+{
+  const float values[] = { v0, v1 };
+  AddUniform(command, uniform, GL_FLOAT_VEC2, values, sizeof(values));
+}
+
+void CommandBuffer::SetUniform4f(DrawCommand* command, UniformHandle uniform, float v0, float v1, float v2, float v3)
+{
+  const float values[] = { v0, v1, v2, v3 };
+  AddUniform(command, uniform, GL_FLOAT_VEC4, values, sizeof(values));
+}
+
+void CommandBuffer::SetUniformMat4(DrawCommand* command, UniformHandle uniform, const float* matrix)
+{
+  AddUniform(command, uniform, GL_FLOAT_MAT4, matrix, 16 * sizeof(float));
+}
+
+void CommandBuffer::SetUniformBlock(DrawCommand* command, const DynamicUniformBuffer& buffer, unsigned int offset)
+{
+  command->UniformBlock = &buffer;
+  command->UniformBlockOffset = offset;
+}
+
+void CommandBuffer::Reset()
+{
+  m_Arena.Reset();
+  m_Entries.clear();
+  m_RecordMs = 0.0;
+}
+
+void CommandBuffer::AddUniform(DrawCommand* command, UniformHandle uniform, unsigned int type, const void* data, size_t size)
+{
+  void* copy = m_Arena.Allocate(size, alignof(float));
+  memcpy(copy, data, size);
+
+  // Prepended, uniforms are independent of each other so order doesn't matter
+  UniformCommand* entry = m_Arena.New<UniformCommand>();
+  entry->Next = command->Uniforms;
+  entry->Uniform = uniform;
+  entry->Type = type;
+  entry->Data = copy;
+  command->Uniforms = entry;
+}
+// ---------------------------------------------------------------------------
+
+// ------------------------------- RenderQueue -------------------------------
+RenderQueue::RenderQueue(unsigned int bufferCount)
+{
+  for (unsigned int i = 0; i < bufferCount; i++)
+    m_Buffers.emplace_back(new CommandBuffer());
+}
+
+void RenderQueue::BeginFrame()
+{
+  for (auto& buffer : m_Buffers)
+    buffer->Reset();
+}
+
+CommandBuffer& RenderQueue::GetCommandBuffer(unsigned int index)
+{
+  ASSERT(index < m_Buffers.size());
+  return *m_Buffers[index];
+}
+
+uint64_t RenderQueue::MakeSortKey(RenderPass pass, float depth, unsigned int shader, unsigned int texture, unsigned int vertexArray)
+{
+  uint64_t depthBits = (uint64_t)(std::min(std::max(depth, 0.0f), 1.0f) * 0xffffff);
+  uint64_t key = (uint64_t)pass << 60;
+  if (pass == RenderPass::Transparent)
+  {
+    key |= (0xffffff - depthBits) << 36;
+    key |= (uint64_t)(shader & 0xfff) << 24;
+    key |= (uint64_t)(texture & 0xfff) << 12;
+    key |= (uint64_t)(vertexArray & 0xfff);
+  }
+  else
+  {
+    key |= (uint64_t)(shader & 0xfff) << 48;
+    key |= (uint64_t)(texture & 0xfff) << 36;
+    key |= (uint64_t)(vertexArray & 0xfff) << 24;
+    key |= depthBits;
+  }
+  return key;
+}
+
+void RenderQueue::Sort()
+{
+  size_t count = m_Entries.size();
+  m_Scratch.resize(count);
+
+  // Histograms of all eight bytes in one pass over the keys
+  unsigned int histograms[8][256] = {};
+  for (const RenderSortEntry& entry : m_Entries)
+  {
+    for (int byte = 0; byte < 8; byte++)
+      histograms[byte][(entry.Key >> (byte * 8)) & 0xff]++;
+  }
+
+  RenderSortEntry* source = m_Entries.data();
+  RenderSortEntry* destination = m_Scratch.data();
+  for (int byte = 0; byte < 8; byte++)
+  {
+    unsigned int* histogram = histograms[byte];
+    // Every key has the same value in this byte, nothing to reorder
+    if (histogram[(source[0].Key >> (byte * 8)) & 0xff] == count)
+      continue;
+
+    unsigned int offset = 0;
+    for (int i = 0; i < 256; i++)
+    {
+      unsigned int n = histogram[i];
+      histogram[i] = offset;
+      offset += n;
+    }
+
+    for (size_t i = 0; i < count; i++)
+      destination[histogram[(source[i].Key >> (byte * 8)) & 0xff]++] = source[i];
+    std::swap(source, destination);
+  }
+
+  if (source != m_Entries.data())
+    m_Entries.swap(m_Scratch);
+}
+
+void RenderQueue::Execute(Renderer& renderer)
+{
+  m_Stats = Stats();
+
+  auto start = std::chrono::steady_clock::now();
+
+  // Buffers are appended in index order and the sort is stable, so
+  // commands with equal keys draw in the order they were recorded
+  m_Entries.clear();
+  for (auto& buffer : m_Buffers)
+  {
+    m_Entries.insert(m_Entries.end(), buffer->m_Entries.begin(), buffer->m_Entries.end());
+    m_Stats.RecordMs += buffer->m_RecordMs;
+    m_Stats.RecordMaxMs = std::max(m_Stats.RecordMaxMs, buffer->m_RecordMs);
+    m_Stats.ArenaBytes += buffer->m_Arena.GetUsed();
+    if (!buffer->m_Entries.empty())
+      m_Stats.Buffers++;
+  }
+  m_Stats.Commands = (unsigned int)m_Entries.size();
+  if (m_Entries.empty())
+    return;
+
+  Sort();
+  auto sorted = std::chrono::steady_clock::now();
+
+  // Binds go through GLState, which drops the ones sorting made redundant
+  for (const RenderSortEntry& entry : m_Entries)
+  {
+    const DrawCommand& command = *entry.Command;
+    Shader& shader = *command.Program;
+    shader.Bind();
+    for (const UniformCommand* uniform = command.Uniforms; uniform; uniform = uniform->Next)
+    {
+      const float* values = (const float*)uniform->Data;
+      switch (uniform->Type)
+      {
+        case GL_INT:        shader.SetUniform1i(uniform->Uniform, *(const int*)uniform->Data); break;
+        case GL_FLOAT:      shader.SetUniform1f(uniform->Uniform, values[0]); break;
+        case GL_FLOAT_VEC2: shader.SetUniform2f(uniform->Uniform, values[0], values[1]); break;
+        case GL_FLOAT_VEC4: shader.SetUniform4f(uniform->Uniform, values[0], values[1], values[2], values[3]); break;
+        case GL_FLOAT_MAT4: shader.SetUniformMat4(uniform->Uniform, values); break;
+      }
+    }
+
+    if (command.UniformBlock)
+      command.UniformBlock->Bind(command.UniformBlockOffset);
+    if (command.Texture0)
+      command.Texture0->Bind(0);
+
+    if (command.InstanceCount)
+      renderer.DrawInstanced(*command.VA, *command.IB, shader, command.InstanceCount);
+    else
+      renderer.Draw(*command.VA, *command.IB, shader);
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  m_Stats.SortMs = std::chrono::duration<double, std::milli>(sorted - start).count();
+  m_Stats.SubmitMs = std::chrono::duration<double, std::milli>(end - sorted).count();
+}
+// ---------------------------------------------------------------------------
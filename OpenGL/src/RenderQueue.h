@@ -0,0 +1,142 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "FrameArena.h"
+#include "Shader.h"
+
+class Renderer;
+class VertexArray;
+class IndexBuffer;
+class Texture;
+class DynamicUniformBuffer;
+
+// Passes execute in this order. Transparent commands are drawn back to
+// front, the others grouped by state and then front to back.
+enum class RenderPass : uint8_t
+{
+  Opaque = 0, Transparent = 1, Overlay = 2
+};
+
+// Uniform value recorded with a draw, Type is the GL type (GL_FLOAT_VEC4, ...)
+struct UniformCommand
+{
+  UniformCommand* Next;
+  UniformHandle Uniform;
+  unsigned int Type;
+  const void* Data;
+};
+
+struct DrawCommand
+{
+  Shader* Program;
+  const VertexArray* VA;
+  const IndexBuffer* IB;
+  // Bound to slot 0, may be null
+  const Texture* Texture0;
+  // 0 for a regular draw
+  unsigned int InstanceCount;
+  UniformCommand* Uniforms;
+  // Slot of a per-draw uniform block, bound before drawing. May be null.
+  const DynamicUniformBuffer* UniformBlock;
+  unsigned int UniformBlockOffset;
+};
+
+struct RenderSortEntry
+{
+  uint64_t Key;
+  const DrawCommand* Command;
+};
+
+// Commands recorded by one thread. Recording doesn't touch GL, so any
+// thread can fill a buffer as long as no other thread uses it at the
+// same time; everything lives in the buffer's frame arena.
+class CommandBuffer
+{
+private:
+  friend class RenderQueue;
+
+  FrameArena m_Arena;
+  TrackedVector<RenderSortEntry, MemoryTag::Commands> m_Entries;
+  std::chrono::steady_clock::time_point m_RecordStart;
+  double m_RecordMs;
+public:
+  CommandBuffer();
+
+  // Optional, the time between them is reported as recording time
+  void Begin();
+  void End();
+
+  // Depth is the view depth in [0, 1], used for ordering within the pass.
+  // Uniform handles must have been resolved beforehand.
+  DrawCommand* Draw(RenderPass pass, float depth, Shader& shader, const VertexArray& va, const IndexBuffer& ib,
+    const Texture* texture = nullptr, unsigned int instanceCount = 0);
+
+  void SetUniform1i(DrawCommand* command, UniformHandle uniform, int value);
+  void SetUniform1f(DrawCommand* command, UniformHandle uniform, float value);
+  void SetUniform2f(DrawCommand* command, UniformHandle uniform, float v0, float v1);
+  void SetUniform4f(DrawCommand* command, UniformHandle uniform, float v0, float v1, float v2, float v3);
+  void SetUniformMat4(DrawCommand* command, UniformHandle uniform, const float* matrix);
+  // Binds the slot at offset of buffer, which has to stay allocated until Execute
+  void SetUniformBlock(DrawCommand* command, const DynamicUniformBuffer& buffer, unsigned int offset);
+
+  inline unsigned int GetCommandCount() const { return (unsigned int)m_Entries.size(); }
+private:
+  void Reset();
+  void AddUniform(DrawCommand* command, UniformHandle uniform, unsigned int type, const void* data, size_t size);
+};
+
+// Sorted draw queue. Worker threads record into their own CommandBuffer,
+// then the GL thread merges them, radix-sorts by key and executes:
+//
+//   queue.BeginFrame();
+//   pool.Run(jobs, [&](unsigned int job, unsigned int thread) {
+//     CommandBuffer& commands = queue.GetCommandBuffer(job); ... });
+//   queue.Execute(renderer);
+//
+// One buffer per job keeps the result independent of which thread ran
+// which job; one per thread works too but only orders equal keys per
+// thread.
+class RenderQueue
+{
+public:
+  // Per-frame counters, updated by Execute()
+  struct Stats
+  {
+    unsigned int Commands = 0;
+    unsigned int Buffers = 0;       // Buffers with at least one command
+    double RecordMs = 0.0;          // Summed over all buffers
+    double RecordMaxMs = 0.0;       // Slowest buffer
+    double SortMs = 0.0;            // Merge and radix sort
+    double SubmitMs = 0.0;          // Issuing the GL calls
+    size_t ArenaBytes = 0;          // Command memory used this frame
+  };
+private:
+  std::vector<std::unique_ptr<CommandBuffer>> m_Buffers;
+  TrackedVector<RenderSortEntry, MemoryTag::Commands> m_Entries;
+  TrackedVector<RenderSortEntry, MemoryTag::Commands> m_Scratch;
+  Stats m_Stats;
+public:
+  RenderQueue(unsigned int bufferCount);
+
+  // Clears last frame's commands, call before recording starts
+  void BeginFrame();
+  CommandBuffer& GetCommandBuffer(unsigned int index);
+  inline unsigned int GetCommandBufferCount() const { return (unsigned int)m_Buffers.size(); }
+
+  // Sorts and draws everything recorded this frame, GL thread only
+  void Execute(Renderer& renderer);
+
+  inline const Stats& GetStats() const { return m_Stats; }
+
+  // [63:60] pass, then for state-sorted passes [59:48] shader, [47:36]
+  // texture, [35:24] vertex array and [23:0] depth; for transparent
+  // commands the inverted depth comes right after the pass instead.
+  static uint64_t MakeSortKey(RenderPass pass, float depth, unsigned int shader, unsigned int texture, unsigned int vertexArray);
+private:
+  // Stable LSD radix sort on the key, one pass per byte that differs
+  void Sort();
+};
@@ -1,33 +1,307 @@
 #include "Renderer.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 
-// -------------------------- GL Error Logging --------------------------
-void GLClearError()
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+#include "Texture.h"
+#include "GeometryPool.h"
+#include "GLState.h"
+#include "Profiler.h"
+
+// ------------------------------ Batching ------------------------------
+// 20 bytes, down from 36 with float attributes
+struct QuadVertex
 {
-  while (glGetError() != GL_NO_ERROR);
-}
+  float Position[2];
+  unsigned char Color[4];
+  NormUShort TexCoord[2];
+  int TexIndex;
+};
+
+using QuadVertexLayout = StaticVertexLayout<QuadVertex,
+  VERTEX_ATTRIB(QuadVertex, Position),
+  VERTEX_ATTRIB(QuadVertex, Color),
+  VERTEX_ATTRIB(QuadVertex, TexCoord),
+  VERTEX_ATTRIB(QuadVertex, TexIndex)>;
 
-bool GLLogCall(const char* function, const char* file, int line)
+struct BatchData
 {
-  while (GLenum error = glGetError())
+  VertexArray VA;
+  VertexBuffer VB;
+  std::unique_ptr<IndexBuffer> IB;
+  Texture WhiteTexture;
+
+  std::unique_ptr<QuadVertex[]> Vertices;
+  QuadVertex* VertexPtr = nullptr;
+  unsigned int QuadCount = 0;
+
+  // Slot 0 always holds the white texture used by untextured quads
+  const Texture* TextureSlots[Renderer::MaxTextureSlots];
+  unsigned int TextureSlotCount = 1;
+
+  Shader* BatchShader = nullptr;
+
+  BatchData(const unsigned int* white)
+    : VB(Renderer::MaxQuadsPerBatch * 4 * sizeof(QuadVertex) * Renderer::BatchesPerFrame, BufferUsage::Stream),
+      WhiteTexture(1, 1, white),
+      Vertices(new QuadVertex[Renderer::MaxQuadsPerBatch * 4])
   {
-    std::cout << "[OpenGL Error] (" << std::hex << error << std::dec << "): " << function << " " << file << ": " << line << std::endl;
-    return false;
   }
-  return true;
-}
+};
 // ----------------------------------------------------------------------
 
+Renderer::Renderer()
+{
+}
+
+Renderer::~Renderer()
+{
+}
+
+void Renderer::SetClearColor(float r, float g, float b, float a) const
+{
+  GLState::Get().ClearColor(r, g, b, a);
+}
+
 void Renderer::Clear() const
 {
-  GLCall(glClear(GL_COLOR_BUFFER_BIT));
+  PROFILE_GPU_SCOPE("Renderer::Clear");
+  GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
 }
 
 void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const
 {
+  PROFILE_GPU_SCOPE("Renderer::Draw");
+  Profiler::AddCounter(ProfileCounter::DrawCalls, 1);
+  shader.Bind();
+  va.Bind();
+  ib.Bind();
+  GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), ib.GetGLType(), nullptr));
+}
+
+void Renderer::DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const
+{
+  PROFILE_GPU_SCOPE("Renderer::DrawInstanced");
+  Profiler::AddCounter(ProfileCounter::DrawCalls, 1);
   shader.Bind();
   va.Bind();
   ib.Bind();
-  GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
+  GLCall(glDrawElementsInstanced(GL_TRIANGLES, ib.GetCount(), ib.GetGLType(), nullptr, instanceCount));
+}
+
+void Renderer::Draw(const GeometryPool& pool, GeometryHandle mesh, const Shader& shader) const
+{
+  GeometryRange range;
+  const GeometryArena* arena = pool.Get(mesh, range);
+  if (!arena)
+    return;
+
+  PROFILE_GPU_SCOPE("Renderer::Draw");
+  Profiler::AddCounter(ProfileCounter::DrawCalls, 1);
+  shader.Bind();
+  arena->GetVertexArray().Bind();
+  arena->GetIndexBuffer().Bind();
+  const IndexBuffer& ib = arena->GetIndexBuffer();
+  GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, range.IndexCount, ib.GetGLType(),
+    (void*)(uintptr_t)(range.FirstIndex * ib.GetIndexSize()), range.BaseVertex));
+}
+
+void Renderer::InitBatch()
+{
+  const unsigned int white = 0xffffffff;
+  m_Batch.reset(new BatchData(&white));
+
+  m_Batch->VA.AddBuffer(m_Batch->VB, QuadVertexLayout());
+
+  // Every quad uses the same index pattern, so the index buffer is built
+  // once. Batches are drawn with a base vertex, so 16-bit indices suffice.
+  static_assert(MaxQuadsPerBatch * 4 <= 65536, "batch vertices must be addressable with 16-bit indices");
+  std::unique_ptr<unsigned short[]> indices(new unsigned short[MaxQuadsPerBatch * 6]);
+  unsigned short offset = 0;
+  for (unsigned int i = 0; i < MaxQuadsPerBatch * 6; i += 6)
+  {
+    indices[i + 0] = offset + 0;
+    indices[i + 1] = offset + 1;
+    indices[i + 2] = offset + 2;
+
+    indices[i + 3] = offset + 2;
+    indices[i + 4] = offset + 3;
+    indices[i + 5] = offset + 0;
+
+    offset += 4;
+  }
+  m_Batch->IB.reset(new IndexBuffer(indices.get(), MaxQuadsPerBatch * 6));
+
+  m_Batch->TextureSlots[0] = &m_Batch->WhiteTexture;
+  m_Batch->VA.Unbind();
+}
+
+void Renderer::BeginBatch(Shader& shader)
+{
+  if (!m_Batch)
+    InitBatch();
+
+  if (m_Batch->BatchShader != &shader)
+  {
+    int samplers[MaxTextureSlots];
+    for (unsigned int i = 0; i < MaxTextureSlots; i++)
+      samplers[i] = i;
+    shader.Bind();
+    shader.SetUniform1iv("u_Textures", MaxTextureSlots, samplers);
+  }
+
+  m_Batch->BatchShader = &shader;
+  m_Batch->VertexPtr = m_Batch->Vertices.get();
+  m_Batch->QuadCount = 0;
+  m_Batch->TextureSlotCount = 1;
+  m_Stats.Batches++;
+}
+
+void Renderer::EndBatch()
+{
+  FlushBatch();
+}
+
+void Renderer::FlushBatch()
+{
+  ASSERT(m_Batch && m_Batch->BatchShader);
+  if (m_Batch->QuadCount == 0)
+    return;
+
+  PROFILE_GPU_SCOPE("Renderer::FlushBatch");
+
+  unsigned int size = (unsigned int)((unsigned char*)m_Batch->VertexPtr - (unsigned char*)m_Batch->Vertices.get());
+  StreamBuffer& stream = *m_Batch->VB.GetStream();
+  unsigned int offset;
+  memcpy(stream.Allocate(size, sizeof(QuadVertex), offset), m_Batch->Vertices.get(), size);
+  stream.Flush();
+  Profiler::AddCounter(ProfileCounter::BytesUploaded, size);
+  Profiler::AddCounter(ProfileCounter::DrawCalls, 1);
+
+  for (unsigned int i = 0; i < m_Batch->TextureSlotCount; i++)
+    m_Batch->TextureSlots[i]->Bind(i);
+
+  m_Batch->BatchShader->Bind();
+  m_Batch->VA.Bind();
+  m_Batch->IB->Bind();
+  // The shared index buffer starts at vertex 0, so offset it to this batch's slice of the ring
+  GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, m_Batch->QuadCount * 6, m_Batch->IB->GetGLType(), nullptr, offset / sizeof(QuadVertex)));
+  m_Stats.Flushes++;
+
+  m_Batch->VertexPtr = m_Batch->Vertices.get();
+  m_Batch->QuadCount = 0;
+  m_Batch->TextureSlotCount = 1;
+}
+
+int Renderer::GetTextureSlot(const Texture& texture)
+{
+  for (unsigned int i = 1; i < m_Batch->TextureSlotCount; i++)
+  {
+    if (m_Batch->TextureSlots[i]->GetRendererID() == texture.GetRendererID())
+      return (int)i;
+  }
+
+  if (m_Batch->TextureSlotCount == MaxTextureSlots)
+    FlushBatch();
+
+  m_Batch->TextureSlots[m_Batch->TextureSlotCount] = &texture;
+  return (int)m_Batch->TextureSlotCount++;
+}
+
+static unsigned char ToUnorm8(float value)
+{
+  return (unsigned char)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+void Renderer::WriteQuad(float x, float y, float width, float height, const unsigned char color[4], int textureSlot)
+{
+  const float positions[4][2] = {
+    { x,         y          },
+    { x + width, y          },
+    { x + width, y + height },
+    { x,         y + height }
+  };
+  const unsigned short texCoords[4][2] = {
+    { 0, 0 }, { 65535, 0 }, { 65535, 65535 }, { 0, 65535 }
+  };
+
+  QuadVertex* v = m_Batch->VertexPtr;
+  for (int i = 0; i < 4; i++)
+  {
+    v[i].Position[0] = positions[i][0];
+    v[i].Position[1] = positions[i][1];
+    v[i].Color[0] = color[0];
+    v[i].Color[1] = color[1];
+    v[i].Color[2] = color[2];
+    v[i].Color[3] = color[3];
+    v[i].TexCoord[0].Value = texCoords[i][0];
+    v[i].TexCoord[1].Value = texCoords[i][1];
+    v[i].TexIndex = textureSlot;
+  }
+
+  m_Batch->VertexPtr += 4;
+  m_Batch->QuadCount++;
+  m_Stats.Quads++;
+}
+
+void Renderer::SubmitQuad(float x, float y, float width, float height, float r, float g, float b, float a)
+{
+  ASSERT(m_Batch && m_Batch->BatchShader);
+  if (m_Batch->QuadCount == MaxQuadsPerBatch)
+    FlushBatch();
+
+  const unsigned char color[4] = { ToUnorm8(r), ToUnorm8(g), ToUnorm8(b), ToUnorm8(a) };
+  WriteQuad(x, y, width, height, color, 0);
+}
+
+void Renderer::SubmitQuad(float x, float y, float width, float height, const Texture& texture)
+{
+  ASSERT(m_Batch && m_Batch->BatchShader);
+  if (m_Batch->QuadCount == MaxQuadsPerBatch)
+    FlushBatch();
+
+  // May flush as well if every texture slot is taken
+  int slot = GetTextureSlot(texture);
+
+  const unsigned char color[4] = { 255, 255, 255, 255 };
+  WriteQuad(x, y, width, height, color, slot);
+}
+
+void Renderer::BeginFrame()
+{
+  GLCheckFrameErrors();
+  ResetStats();
+}
+
+void Renderer::EndFrame()
+{
+  if (m_Batch)
+    m_Batch->VB.GetStream()->EndFrame();
+}
+
+void Renderer::ResetStats()
+{
+  m_Stats = Stats();
+  GLResetCallCount();
+  GLState::Get().ResetStats();
+  if (m_Batch)
+    m_Batch->VB.GetStream()->ResetStats();
+}
+
+Renderer::Stats Renderer::GetStats() const
+{
+  Stats stats = m_Stats;
+  stats.GLCalls = GLGetCallCount();
+  stats.StateChanges = GLState::Get().GetStats().Issued;
+  stats.StateChangesSkipped = GLState::Get().GetStats().Skipped;
+  if (m_Batch)
+  {
+    stats.StreamStalls = m_Batch->VB.GetStream()->GetStats().Stalls;
+    stats.StreamWaitMs = m_Batch->VB.GetStream()->GetStats().WaitMs;
+  }
+  return stats;
 }
@@ -2,26 +2,75 @@
 
 #include <GL/glew.h>
 
+#include <memory>
+
+#include "GLDebug.h"
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Shader.h"
 
-// -------------------------- GL Error Logging --------------------------
-#include <signal.h>
-
-#define ASSERT(x) if (!(x)) raise(SIGTRAP);
-#define GLCall(x) GLClearError();\
-  x;\
-  ASSERT(GLLogCall(#x, __FILE__, __LINE__))
-
-void GLClearError();
-
-bool GLLogCall(const char* function, const char* file, int line);
-// ----------------------------------------------------------------------
+class Texture;
+class GeometryPool;
+struct GeometryHandle;
+struct BatchData;
 
 class Renderer
 {
 public:
+  // Per-frame counters, cleared by BeginFrame()
+  struct Stats
+  {
+    unsigned int Batches = 0;  // BeginBatch/EndBatch pairs
+    unsigned int Quads = 0;    // Quads submitted to batches
+    unsigned int Flushes = 0;  // glDrawElements calls issued by the batcher
+    unsigned int GLCalls = 0;  // GL calls made through GLCall
+    unsigned int StateChanges = 0;         // Binds and state changes sent to GL
+    unsigned int StateChangesSkipped = 0;  // Redundant ones filtered by GLState
+    unsigned int StreamStalls = 0;  // Waits for the GPU before writing batch vertices
+    double StreamWaitMs = 0.0;
+  };
+
+  static const unsigned int MaxQuadsPerBatch = 10000;
+  static const unsigned int MaxTextureSlots = 16;
+  // Full batches that fit in the vertex ring per frame before it wraps
+  static const unsigned int BatchesPerFrame = 2;
+public:
+  Renderer();
+  ~Renderer();
+
+  void SetClearColor(float r, float g, float b, float a) const;
   void Clear() const;
   void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const;
+  // Draws every index of ib instanceCount times, per-instance attributes
+  // advance according to their divisor
+  void DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const;
+  // Draws a mesh of a GeometryPool, only binding its arena's VAO if the
+  // previous draw came from a different arena
+  void Draw(const GeometryPool& pool, GeometryHandle mesh, const Shader& shader) const;
+
+  // ----------------------------- Batching -----------------------------
+  // Quads submitted between BeginBatch and EndBatch are collected into one
+  // dynamic vertex buffer and drawn with as few glDrawElements as possible.
+  // The shader must follow the layout of res/shaders/Batch.shader.
+  void BeginBatch(Shader& shader);
+  void SubmitQuad(float x, float y, float width, float height, float r, float g, float b, float a);
+  void SubmitQuad(float x, float y, float width, float height, const Texture& texture);
+  void EndBatch();
+  // --------------------------------------------------------------------
+
+  // Resets the per-frame stats and reports errors of the previous frame
+  // when the error checking policy defers them to frame boundaries
+  void BeginFrame();
+  // Call after the last draw of a frame, before swapping buffers
+  void EndFrame();
+  void ResetStats();
+  Stats GetStats() const;
+private:
+  void InitBatch();
+  void FlushBatch();
+  int GetTextureSlot(const Texture& texture);
+  void WriteQuad(float x, float y, float width, float height, const unsigned char color[4], int textureSlot);
+private:
+  std::unique_ptr<BatchData> m_Batch;
+  Stats m_Stats;
 };
@@ -0,0 +1,205 @@
+#include "ResourceManager.h"
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "GLDebug.h"
+#include "GLState.h"
+#include "Profiler.h"
+
+// FNV-1a, the first byte of every key is its kind so a texture path never
+// collides with a shader of the same name
+static uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+{
+  const unsigned char* bytes = (const unsigned char*)data;
+  for (size_t i = 0; i < size; i++)
+  {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ull;
+  }
+  // Separator, so that moving bytes between fields changes the key
+  hash ^= 0xff;
+  hash *= 0x100000001b3ull;
+  return hash;
+}
+
+static uint64_t BeginKey(char kind)
+{
+  return HashBytes(0xcbf29ce484222325ull, &kind, 1);
+}
+
+// 0 means not shared, so real keys avoid it
+static uint64_t EndKey(uint64_t hash)
+{
+  return hash ? hash : 1;
+}
+
+// Content keys are only hashes, so before a buffer or texture is shared
+// its storage is read back and compared with the data asked for. That
+// only happens on a hit, when loading.
+static bool BufferEquals(unsigned int buffer, const void* data, size_t size)
+{
+  std::vector<unsigned char> contents(size);
+  GLCall(glBindBuffer(GL_COPY_READ_BUFFER, buffer));
+  GLCall(glGetBufferSubData(GL_COPY_READ_BUFFER, 0, size, contents.data()));
+  GLCall(glBindBuffer(GL_COPY_READ_BUFFER, 0));
+  return memcmp(contents.data(), data, size) == 0;
+}
+
+static bool TextureEquals(const Texture& texture, int width, int height, const void* data)
+{
+  if (texture.GetWidth() != width || texture.GetHeight() != height)
+    return false;
+
+  std::vector<unsigned char> pixels((size_t)width * height * 4);
+  GLState& state = GLState::Get();
+  state.BindTexture(state.GetActiveTexture(), GL_TEXTURE_2D, texture.GetRendererID());
+  GLCall(glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()));
+  state.BindTexture(state.GetActiveTexture(), GL_TEXTURE_2D, 0);
+  return memcmp(pixels.data(), data, pixels.size()) == 0;
+}
+
+ResourceManager::ResourceManager()
+  : m_Frame(0)
+{
+}
+
+ResourceManager::~ResourceManager()
+{
+  Clear();
+}
+
+TextureHandle ResourceManager::LoadTexture(const std::string& path)
+{
+  uint64_t key = EndKey(HashBytes(BeginKey('t'), path.data(), path.size()));
+  TextureHandle handle = m_Textures.Find(key);
+  if (handle.IsValid())
+    return handle;
+
+  PROFILE_SCOPE("ResourceManager::LoadTexture");
+  Texture texture(path);
+  uint64_t size = texture.GetSize();
+  return m_Textures.Insert(std::move(texture), key, size);
+}
+
+TextureHandle ResourceManager::CreateTexture(int width, int height, const void* data)
+{
+  uint64_t key = 0;
+  if (data)
+  {
+    int size[2] = { width, height };
+    key = EndKey(HashBytes(HashBytes(BeginKey('p'), size, sizeof(size)), data, (size_t)width * height * 4));
+  }
+  TextureHandle handle = m_Textures.Find(key, [&](const Texture& texture) {
+    return TextureEquals(texture, width, height, data);
+  });
+  if (handle.IsValid())
+    return handle;
+
+  Texture texture(width, height, data);
+  uint64_t size = texture.GetSize();
+  return m_Textures.Insert(std::move(texture), key, size);
+}
+
+ShaderHandle ResourceManager::LoadShader(const std::string& path, const ShaderDefines& defines)
+{
+  uint64_t hash = HashBytes(BeginKey('s'), path.data(), path.size());
+  for (const std::string& define : defines)
+    hash = HashBytes(hash, define.data(), define.size());
+  uint64_t key = EndKey(hash);
+  ShaderHandle handle = m_Shaders.Find(key);
+  if (handle.IsValid())
+    return handle;
+
+  PROFILE_SCOPE("ResourceManager::LoadShader");
+  // The program's memory is driver-internal, shaders count as 0 bytes
+  return m_Shaders.Insert(Shader(path, defines), key, 0);
+}
+
+VertexBufferHandle ResourceManager::CreateVertexBuffer(const void* data, unsigned int size)
+{
+  uint64_t key = EndKey(HashBytes(BeginKey('v'), data, size));
+  VertexBufferHandle handle = m_VertexBuffers.Find(key, [&](const VertexBuffer& buffer) {
+    return buffer.GetSize() == size && BufferEquals(buffer.GetRendererID(), data, size);
+  });
+  if (handle.IsValid())
+    return handle;
+
+  return m_VertexBuffers.Insert(VertexBuffer(data, size), key, size);
+}
+
+IndexBufferHandle ResourceManager::CreateIndexBuffer(const void* data, unsigned int count, IndexType type)
+{
+  uint64_t hash = HashBytes(BeginKey('i'), &type, sizeof(type));
+  size_t bytes = (size_t)count * IndexBuffer::GetIndexSize(type);
+  uint64_t key = EndKey(HashBytes(hash, data, bytes));
+  IndexBufferHandle handle = m_IndexBuffers.Find(key, [&](const IndexBuffer& buffer) {
+    return buffer.GetType() == type && buffer.GetCount() == count && BufferEquals(buffer.GetRendererID(), data, bytes);
+  });
+  if (handle.IsValid())
+    return handle;
+
+  IndexBuffer buffer(data, count, type);
+  uint64_t size = buffer.GetSize();
+  return m_IndexBuffers.Insert(std::move(buffer), key, size);
+}
+
+void ResourceManager::EndFrame()
+{
+  m_Textures.Collect(m_Frame);
+  m_Shaders.Collect(m_Frame);
+  m_VertexBuffers.Collect(m_Frame);
+  m_IndexBuffers.Collect(m_Frame);
+  m_Frame++;
+}
+
+void ResourceManager::Clear()
+{
+  unsigned int leaked[(int)ResourceType::Count] = {
+    m_Textures.Clear(), m_Shaders.Clear(), m_VertexBuffers.Clear(), m_IndexBuffers.Clear()
+  };
+  for (int type = 0; type < (int)ResourceType::Count; type++)
+  {
+    if (leaked[type])
+      std::cout << "Warning: " << leaked[type] << " " << GetTypeName((ResourceType)type) << "s were never released!" << std::endl;
+  }
+}
+
+const ResourceStats& ResourceManager::GetStats(ResourceType type) const
+{
+  switch (type)
+  {
+    case ResourceType::Texture:      return m_Textures.GetStats();
+    case ResourceType::Shader:       return m_Shaders.GetStats();
+    case ResourceType::VertexBuffer: return m_VertexBuffers.GetStats();
+    case ResourceType::IndexBuffer:  return m_IndexBuffers.GetStats();
+    case ResourceType::Count:        break;
+  }
+  ASSERT(false);
+  return m_Textures.GetStats();
+}
+
+const char* ResourceManager::GetTypeName(ResourceType type)
+{
+  switch (type)
+  {
+    case ResourceType::Texture:      return "texture";
+    case ResourceType::Shader:       return "shader";
+    case ResourceType::VertexBuffer: return "vertex buffer";
+    case ResourceType::IndexBuffer:  return "index buffer";
+    case ResourceType::Count:        break;
+  }
+  return "unknown";
+}
+
+void ResourceManager::PrintStats() const
+{
+  for (int type = 0; type < (int)ResourceType::Count; type++)
+  {
+    const ResourceStats& stats = GetStats((ResourceType)type);
+    std::cout << "Resources (" << GetTypeName((ResourceType)type) << "s): " << stats.Objects << " objects, "
+      << stats.Bytes / 1024 << " KiB, " << stats.Requests << " requests (" << stats.Hits << " shared), "
+      << stats.PendingDeletes << " pending deletes, " << stats.Deleted << " deleted" << std::endl;
+  }
+}
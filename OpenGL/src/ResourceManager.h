@@ -0,0 +1,291 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Memory.h"
+#include "Texture.h"
+#include "Shader.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+
+// Reference to an object in a ResourcePool. The generation tells a live
+// object from whatever later reuses its slot, so a stale handle resolves
+// to nullptr instead of the wrong object. Index 0 with generation 0 is
+// the null handle.
+template<typename T>
+struct ResourceHandle
+{
+  uint32_t Index = 0;
+  uint32_t Generation = 0;
+
+  inline bool IsValid() const { return Generation != 0; }
+  inline bool operator==(const ResourceHandle& other) const { return Index == other.Index && Generation == other.Generation; }
+  inline bool operator!=(const ResourceHandle& other) const { return !(*this == other); }
+};
+
+using TextureHandle = ResourceHandle<Texture>;
+using ShaderHandle = ResourceHandle<Shader>;
+using VertexBufferHandle = ResourceHandle<VertexBuffer>;
+using IndexBufferHandle = ResourceHandle<IndexBuffer>;
+
+struct ResourceStats
+{
+  unsigned int Objects = 0;         // Live, referenced objects
+  unsigned long long Bytes = 0;     // GL storage of those objects, 0 for shaders
+  unsigned int Requests = 0;        // Loads and creates
+  unsigned int Hits = 0;            // Requests answered by an existing object
+  unsigned int PendingDeletes = 0;  // Released, waiting for the frame boundary
+  unsigned int Deleted = 0;
+};
+
+// Objects of one type in slots that never move: an ObjectPool of pages of
+// PageSize objects next to a flat array of slot headers, so lookups touch
+// one small header and pointers stay valid until the object is deleted. Objects with a
+// non-zero key are shared, asking for the same key again returns the
+// existing one with one more reference. The last Release() invalidates
+// every handle at once, but the object itself is only destroyed by a
+// later Collect(), so commands recorded earlier in the frame can still
+// use it. Everything happens on the GL thread.
+template<typename T>
+class ResourcePool
+{
+public:
+  static const uint32_t PageSize = 64;
+private:
+  struct Slot
+  {
+    uint32_t Generation = 1;
+    uint32_t RefCount = 0;
+    uint64_t Key = 0;
+    uint64_t Size = 0;
+    // Frame of the last Release, while waiting to be collected
+    uint64_t ReleaseFrame = 0;
+    bool Constructed = false;
+  };
+
+  std::vector<Slot> m_Slots;
+  ObjectPool<T, PageSize> m_Objects;
+  std::vector<uint32_t> m_Garbage;
+  std::unordered_map<uint64_t, uint32_t> m_Keys;
+  ResourceStats m_Stats;
+public:
+  ResourcePool()
+    : m_Objects(MemoryTag::Resources) {}
+  ~ResourcePool() { Clear(); }
+
+  ResourcePool(const ResourcePool&) = delete;
+  ResourcePool& operator=(const ResourcePool&) = delete;
+
+  // Shared object with this key, with one more reference. Invalid if
+  // there's none, counting the request either way.
+  ResourceHandle<T> Find(uint64_t key)
+  {
+    return Find(key, [](const T&) { return true; });
+  }
+
+  // Same, for keys that are only a hash of the contents: the object is
+  // only shared if matches(object) confirms it holds them
+  template<typename Matches>
+  ResourceHandle<T> Find(uint64_t key, Matches&& matches)
+  {
+    m_Stats.Requests++;
+    auto it = key ? m_Keys.find(key) : m_Keys.end();
+    if (it == m_Keys.end() || !matches(*m_Objects.Get(it->second)))
+      return ResourceHandle<T>();
+
+    m_Stats.Hits++;
+    Slot& slot = m_Slots[it->second];
+    slot.RefCount++;
+    return { it->second, slot.Generation };
+  }
+
+  // Takes ownership of object with one reference, shared under key unless
+  // it's 0 or the key already belongs to an object with other contents.
+  // size is the object's GL storage for the stats.
+  ResourceHandle<T> Insert(T&& object, uint64_t key, uint64_t size)
+  {
+    uint32_t index = m_Objects.Allocate();
+    if (index == m_Slots.size())
+      m_Slots.emplace_back();
+
+    new (m_Objects.Get(index)) T(std::move(object));
+    Slot& slot = m_Slots[index];
+    slot.RefCount = 1;
+    slot.Key = key && m_Keys.emplace(key, index).second ? key : 0;
+    slot.Size = size;
+    slot.Constructed = true;
+
+    m_Stats.Objects++;
+    m_Stats.Bytes += size;
+    return { index, slot.Generation };
+  }
+
+  // nullptr once the handle's object was released
+  inline T* Get(ResourceHandle<T> handle) const
+  {
+    if (handle.Index >= m_Slots.size() || m_Slots[handle.Index].Generation != handle.Generation || !handle.IsValid())
+      return nullptr;
+    return m_Objects.Get(handle.Index);
+  }
+
+  void AddRef(ResourceHandle<T> handle)
+  {
+    if (Get(handle))
+      m_Slots[handle.Index].RefCount++;
+  }
+
+  // Drops a reference, the last one queues the object for deletion
+  void Release(ResourceHandle<T> handle, uint64_t frame)
+  {
+    if (!Get(handle))
+      return;
+    Slot& slot = m_Slots[handle.Index];
+    if (--slot.RefCount > 0)
+      return;
+
+    if (slot.Key)
+      m_Keys.erase(slot.Key);
+    // Skips 0, which would make handles to the slot look null
+    if (++slot.Generation == 0)
+      slot.Generation = 1;
+    slot.ReleaseFrame = frame;
+    m_Garbage.push_back(handle.Index);
+
+    m_Stats.Objects--;
+    m_Stats.Bytes -= slot.Size;
+    m_Stats.PendingDeletes++;
+  }
+
+  // Destroys objects released in or before the given frame and hands
+  // their slots back
+  void Collect(uint64_t frame)
+  {
+    for (size_t i = 0; i < m_Garbage.size();)
+    {
+      uint32_t index = m_Garbage[i];
+      if (m_Slots[index].ReleaseFrame > frame)
+      {
+        i++;
+        continue;
+      }
+      Destroy(index);
+      m_Objects.Free(index);
+      m_Garbage[i] = m_Garbage.back();
+      m_Garbage.pop_back();
+      m_Stats.PendingDeletes--;
+      m_Stats.Deleted++;
+    }
+  }
+
+  // Destroys everything right away, referenced or not. Returns the number
+  // of objects that were still referenced. The slot headers stay, so the
+  // generations of handles still around keep them from resolving to
+  // objects inserted later.
+  unsigned int Clear()
+  {
+    unsigned int leaked = 0;
+    for (uint32_t i = 0; i < m_Slots.size(); i++)
+    {
+      Slot& slot = m_Slots[i];
+      if (!slot.Constructed)
+        continue;
+      // Released slots already moved to a new generation
+      if (slot.RefCount > 0)
+      {
+        leaked++;
+        if (++slot.Generation == 0)
+          slot.Generation = 1;
+      }
+      Destroy(i);
+      slot.Key = 0;
+      slot.Size = 0;
+    }
+    m_Objects.Clear();
+    m_Garbage.clear();
+    m_Keys.clear();
+    m_Stats.Objects = 0;
+    m_Stats.Bytes = 0;
+    m_Stats.PendingDeletes = 0;
+    return leaked;
+  }
+
+  inline const ResourceStats& GetStats() const { return m_Stats; }
+  // Slots allocated so far, live or not
+  inline unsigned int GetCapacity() const { return m_Objects.GetCapacity(); }
+private:
+  void Destroy(uint32_t index)
+  {
+    m_Objects.Get(index)->~T();
+    m_Slots[index].Constructed = false;
+    m_Slots[index].RefCount = 0;
+  }
+};
+
+enum class ResourceType
+{
+  Texture, Shader, VertexBuffer, IndexBuffer, Count
+};
+
+// Owns the GL objects demos share. Loading the same texture or shader
+// twice, or creating a buffer with the same contents, returns the object
+// that already exists instead of making a second one. Every Load/Create
+// and AddRef has to be matched by a Release; objects are deleted at the
+// EndFrame() after their last Release, so draws recorded in the same
+// frame stay valid. Call Clear() before the context goes away.
+class ResourceManager
+{
+private:
+  ResourcePool<Texture> m_Textures;
+  ResourcePool<Shader> m_Shaders;
+  ResourcePool<VertexBuffer> m_VertexBuffers;
+  ResourcePool<IndexBuffer> m_IndexBuffers;
+  uint64_t m_Frame;
+public:
+  ResourceManager();
+  ~ResourceManager();
+
+  ResourceManager(const ResourceManager&) = delete;
+  ResourceManager& operator=(const ResourceManager&) = delete;
+
+  // Shared by path
+  TextureHandle LoadTexture(const std::string& path);
+  // Shared by the pixels and size
+  TextureHandle CreateTexture(int width, int height, const void* data);
+  // Shared by path and defines, compiled right away
+  ShaderHandle LoadShader(const std::string& path, const ShaderDefines& defines = ShaderDefines());
+  // Static buffers, shared by their contents
+  VertexBufferHandle CreateVertexBuffer(const void* data, unsigned int size);
+  IndexBufferHandle CreateIndexBuffer(const void* data, unsigned int count, IndexType type);
+
+  // nullptr for released handles. Pointers stay valid until the object
+  // is deleted.
+  inline Texture* Get(TextureHandle handle) const { return m_Textures.Get(handle); }
+  inline Shader* Get(ShaderHandle handle) const { return m_Shaders.Get(handle); }
+  inline VertexBuffer* Get(VertexBufferHandle handle) const { return m_VertexBuffers.Get(handle); }
+  inline IndexBuffer* Get(IndexBufferHandle handle) const { return m_IndexBuffers.Get(handle); }
+
+  inline void AddRef(TextureHandle handle) { m_Textures.AddRef(handle); }
+  inline void AddRef(ShaderHandle handle) { m_Shaders.AddRef(handle); }
+  inline void AddRef(VertexBufferHandle handle) { m_VertexBuffers.AddRef(handle); }
+  inline void AddRef(IndexBufferHandle handle) { m_IndexBuffers.AddRef(handle); }
+
+  inline void Release(TextureHandle handle) { m_Textures.Release(handle, m_Frame); }
+  inline void Release(ShaderHandle handle) { m_Shaders.Release(handle, m_Frame); }
+  inline void Release(VertexBufferHandle handle) { m_VertexBuffers.Release(handle, m_Frame); }
+  inline void Release(IndexBufferHandle handle) { m_IndexBuffers.Release(handle, m_Frame); }
+
+  // Frame boundary, deletes everything released during the frame
+  void EndFrame();
+  // Deletes everything now, warning about objects still referenced
+  void Clear();
+
+  const ResourceStats& GetStats(ResourceType type) const;
+  static const char* GetTypeName(ResourceType type);
+  void PrintStats() const;
+};
@@ -0,0 +1,282 @@
+#include "SceneBvh.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "GLDebug.h"
+#include "Profiler.h"
+
+// Subtrees per thread before the top-down pass hands them to the pool,
+// enough for the pool to balance unevenly visible subtrees
+static const unsigned int JobsPerThread = 4;
+
+static float GetCenter(const Aabb& box, int axis)
+{
+  return axis == 0 ? box.Min.x + box.Max.x : axis == 1 ? box.Min.y + box.Max.y : box.Min.z + box.Max.z;
+}
+
+// Reorders order[first, first + count) so that the first split objects
+// have the smaller box centers along the axis the centers spread widest on
+static void SplitAtMedian(const std::vector<Aabb>& boxes, std::vector<uint32_t>& order, uint32_t first, uint32_t count, uint32_t split)
+{
+  Aabb centers = Aabb::Empty();
+  for (uint32_t i = first; i < first + count; i++)
+  {
+    Vec3 center = boxes[order[i]].GetCenter();
+    centers.Grow(Aabb(center, center));
+  }
+  Vec3 size = centers.Max - centers.Min;
+  int axis = size.x >= size.y && size.x >= size.z ? 0 : size.y >= size.z ? 1 : 2;
+
+  std::nth_element(order.begin() + first, order.begin() + first + split, order.begin() + first + count, [&](uint32_t a, uint32_t b) {
+    return GetCenter(boxes[a], axis) < GetCenter(boxes[b], axis);
+  });
+}
+
+// Sorts order[first, first + count) into the groups [firstGroup,
+// lastGroup) of capacity objects each, halving along the widest axis
+void SceneBvh::Partition(uint32_t first, uint32_t count, unsigned int firstGroup, unsigned int lastGroup, uint32_t capacity)
+{
+  if (lastGroup - firstGroup < 2)
+    return;
+  unsigned int middleGroup = (firstGroup + lastGroup) / 2;
+  uint32_t split = (middleGroup - firstGroup) * capacity;
+  SplitAtMedian(m_Boxes, m_Order, first, count, split);
+  Partition(first, split, firstGroup, middleGroup, capacity);
+  Partition(first + split, count - split, middleGroup, lastGroup, capacity);
+}
+
+SceneBvh::SceneBvh(const std::vector<Aabb>& boxes)
+{
+  Build(boxes);
+}
+
+void SceneBvh::Build(const std::vector<Aabb>& boxes)
+{
+  PROFILE_SCOPE("SceneBvh::Build");
+  m_Boxes = boxes;
+  m_Order.resize(boxes.size());
+  for (uint32_t i = 0; i < (uint32_t)boxes.size(); i++)
+    m_Order[i] = i;
+  m_Leaves.assign(boxes.size(), 0);
+
+  m_Nodes.clear();
+  Aabb bounds;
+  BuildNode(0, (uint32_t)boxes.size(), -1, 0, bounds);
+  m_Dirty.assign(m_Nodes.size(), 0);
+}
+
+uint32_t SceneBvh::BuildNode(uint32_t first, uint32_t count, int32_t parent, uint32_t parentSlot, Aabb& bounds)
+{
+  uint32_t index = (uint32_t)m_Nodes.size();
+  m_Nodes.emplace_back();
+  Node& node = m_Nodes.back();
+  node.First = first;
+  node.Count = count;
+  node.Parent = parent;
+  node.ParentSlot = parentSlot;
+  for (unsigned int i = 0; i < NodeWidth; i++)
+  {
+    node.Children[i] = 0;
+    SetChildBounds(node, i, Aabb::Empty());
+  }
+
+  // Children are subtrees of capacity objects each, the smallest power
+  // of eight that needs no more than eight of them, so all but the last
+  // leaf under a node are full. Groups of one are stored as the object.
+  uint32_t capacity = 1;
+  while (capacity * NodeWidth < count)
+    capacity *= NodeWidth;
+  struct Group
+  {
+    uint32_t First, Count;
+  };
+  Group groups[NodeWidth];
+  unsigned int groupCount = (count + capacity - 1) / capacity;
+  for (unsigned int i = 0; i < groupCount; i++)
+    groups[i] = { first + i * capacity, std::min(capacity, count - i * capacity) };
+  if (groupCount > 1)
+    Partition(first, count, 0, groupCount, capacity);
+
+  bounds = Aabb::Empty();
+  for (unsigned int i = 0; i < groupCount; i++)
+  {
+    int32_t child;
+    Aabb childBounds;
+    if (groups[i].Count == 1)
+    {
+      uint32_t object = m_Order[groups[i].First];
+      child = ~(int32_t)object;
+      childBounds = m_Boxes[object];
+      m_Leaves[object] = index * NodeWidth + i;
+    }
+    else
+      child = (int32_t)BuildNode(groups[i].First, groups[i].Count, (int32_t)index, i, childBounds);
+
+    // Fetched again, building the child may have reallocated m_Nodes
+    Node& current = m_Nodes[index];
+    current.Children[i] = child;
+    SetChildBounds(current, i, childBounds);
+    bounds.Grow(childBounds);
+  }
+  return index;
+}
+
+void SceneBvh::SetChildBounds(Node& node, unsigned int child, const Aabb& box)
+{
+  node.Bounds[BoxMinX][child] = box.Min.x;
+  node.Bounds[BoxMinY][child] = box.Min.y;
+  node.Bounds[BoxMinZ][child] = box.Min.z;
+  node.Bounds[BoxMaxX][child] = box.Max.x;
+  node.Bounds[BoxMaxY][child] = box.Max.y;
+  node.Bounds[BoxMaxZ][child] = box.Max.z;
+}
+
+Aabb SceneBvh::GetNodeBounds(const Node& node) const
+{
+  // Row by row, which compiles to a few vector min and max instructions
+  float bounds[BoxRowCount];
+  for (int row = 0; row < BoxRowCount; row++)
+  {
+    const float* values = node.Bounds[row];
+    float value = values[0];
+    for (unsigned int i = 1; i < NodeWidth; i++)
+    {
+      if (row < BoxMaxX)
+        value = values[i] < value ? values[i] : value;
+      else
+        value = values[i] > value ? values[i] : value;
+    }
+    bounds[row] = value;
+  }
+  return Aabb(Vec3(bounds[BoxMinX], bounds[BoxMinY], bounds[BoxMinZ]), Vec3(bounds[BoxMaxX], bounds[BoxMaxY], bounds[BoxMaxZ]));
+}
+
+void SceneBvh::SetBox(uint32_t object, const Aabb& box)
+{
+  ASSERT(object < m_Boxes.size());
+  m_Boxes[object] = box;
+  uint32_t leaf = m_Leaves[object];
+  SetChildBounds(m_Nodes[leaf / NodeWidth], leaf % NodeWidth, box);
+  m_Dirty[leaf / NodeWidth] = 1;
+}
+
+void SceneBvh::Refit()
+{
+  PROFILE_SCOPE("SceneBvh::Refit");
+  auto start = std::chrono::steady_clock::now();
+
+  // Children come after their parents, so walking backwards finishes a
+  // node before its slot in the parent is updated. Parents whose slot
+  // didn't change stay clean, which stops most refits a level or two up.
+  unsigned int refit = 0;
+  for (size_t i = m_Nodes.size(); i-- > 0;)
+  {
+    if (!m_Dirty[i])
+      continue;
+    m_Dirty[i] = 0;
+    refit++;
+
+    const Node& node = m_Nodes[i];
+    if (node.Parent < 0)
+      continue;
+    Node& parent = m_Nodes[node.Parent];
+    Aabb bounds = GetNodeBounds(node);
+    unsigned int slot = node.ParentSlot;
+    if (parent.Bounds[BoxMinX][slot] == bounds.Min.x && parent.Bounds[BoxMinY][slot] == bounds.Min.y && parent.Bounds[BoxMinZ][slot] == bounds.Min.z &&
+      parent.Bounds[BoxMaxX][slot] == bounds.Max.x && parent.Bounds[BoxMaxY][slot] == bounds.Max.y && parent.Bounds[BoxMaxZ][slot] == bounds.Max.z)
+      continue;
+    SetChildBounds(parent, slot, bounds);
+    m_Dirty[node.Parent] = 1;
+  }
+
+  m_Stats.NodesRefit = refit;
+  m_Stats.RefitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void SceneBvh::CullNode(const Frustum& frustum, const Node& node, std::vector<uint32_t>& visible, std::vector<uint32_t>& next) const
+{
+  unsigned int inside;
+  unsigned int intersecting = FrustumTestBoxes(frustum, node.Bounds, inside);
+  for (unsigned int i = 0; i < NodeWidth; i++)
+  {
+    if (!(intersecting & (1u << i)))
+      continue;
+    int32_t child = node.Children[i];
+    if (child < 0)
+      visible.push_back((uint32_t)~child);
+    else if (inside & (1u << i))
+    {
+      const Node& childNode = m_Nodes[child];
+      visible.insert(visible.end(), m_Order.begin() + childNode.First, m_Order.begin() + childNode.First + childNode.Count);
+    }
+    else
+      next.push_back((uint32_t)child);
+  }
+}
+
+void SceneBvh::Cull(const Frustum& frustum, ThreadPool& pool, std::vector<uint32_t>& visible)
+{
+  PROFILE_SCOPE("SceneBvh::Cull");
+  auto start = std::chrono::steady_clock::now();
+
+  visible.clear();
+  m_Stats.NodesTested = 0;
+  m_Stats.Jobs = 0;
+  m_Frontier.clear();
+  if (!m_Nodes.empty())
+    m_Frontier.push_back(0);
+
+  // Breadth first until there are enough subtrees for the pool. Most
+  // frames that's two or three levels; culled branches drop out on the way.
+  const unsigned int targetJobs = pool.GetThreadCount() * JobsPerThread;
+  while (!m_Frontier.empty() && m_Frontier.size() < targetJobs)
+  {
+    m_NextFrontier.clear();
+    for (uint32_t node : m_Frontier)
+      CullNode(frustum, m_Nodes[node], visible, m_NextFrontier);
+    m_Stats.NodesTested += (unsigned int)m_Frontier.size();
+    std::swap(m_Frontier, m_NextFrontier);
+  }
+
+  // Each subtree depth first into its own list, appended in subtree order
+  // so the result doesn't depend on which thread ran what
+  unsigned int jobs = (unsigned int)m_Frontier.size();
+  if (m_JobVisible.size() < jobs)
+  {
+    m_JobVisible.resize(jobs);
+    m_JobStacks.resize(jobs);
+    m_JobNodesTested.resize(jobs);
+  }
+  if (jobs)
+  {
+    pool.Run(jobs, [&](unsigned int job, unsigned int thread) {
+      std::vector<uint32_t>& jobVisible = m_JobVisible[job];
+      std::vector<uint32_t>& stack = m_JobStacks[job];
+      jobVisible.clear();
+      stack.assign(1, m_Frontier[job]);
+      unsigned int tested = 0;
+      while (!stack.empty())
+      {
+        uint32_t node = stack.back();
+        stack.pop_back();
+        CullNode(frustum, m_Nodes[node], jobVisible, stack);
+        tested++;
+      }
+      m_JobNodesTested[job] = tested;
+    });
+  }
+  for (unsigned int job = 0; job < jobs; job++)
+  {
+    visible.insert(visible.end(), m_JobVisible[job].begin(), m_JobVisible[job].end());
+    m_Stats.NodesTested += m_JobNodesTested[job];
+  }
+
+  m_Stats.Jobs = jobs;
+  m_Stats.Visible = (unsigned int)visible.size();
+  m_Stats.Culled = GetObjectCount() - m_Stats.Visible;
+  Profiler::AddCounter(ProfileCounter::VisibleObjects, m_Stats.Visible);
+  Profiler::AddCounter(ProfileCounter::CulledObjects, m_Stats.Culled);
+  m_Stats.CullMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Math3D.h"
+#include "Memory.h"
+#include "ThreadPool.h"
+
+// Bounding volume hierarchy over the boxes of a scene's objects, for
+// frustum culling. Every node has eight children whose boxes are stored
+// in structure-of-arrays form, so one FrustumTestBoxes call tests all of
+// them. Moving objects are handled by refitting: SetBox() updates the
+// object's box, Refit() grows or shrinks the nodes above it. The tree
+// shape stays, so Build() again once objects have wandered far from
+// where they started.
+class SceneBvh
+{
+public:
+  // Per-frame counters, updated by Refit() and Cull()
+  struct Stats
+  {
+    unsigned int Visible = 0;
+    unsigned int Culled = 0;
+    unsigned int NodesTested = 0;   // Eight boxes each
+    unsigned int Jobs = 0;          // Subtrees culled on the thread pool
+    unsigned int NodesRefit = 0;
+    double RefitMs = 0.0;
+    double CullMs = 0.0;
+  };
+
+  static const unsigned int NodeWidth = 8;
+private:
+  struct alignas(32) Node
+  {
+    float Bounds[BoxRowCount][NodeWidth];
+    // >= 0 a child node, < 0 the object ~child. Unused children have
+    // Aabb::Empty() bounds and are never visited.
+    int32_t Children[NodeWidth];
+    // Objects under this node are m_Order[First, First + Count)
+    uint32_t First, Count;
+    int32_t Parent;         // -1 for the root
+    uint32_t ParentSlot;
+  };
+
+  TrackedVector<Node, MemoryTag::Scene> m_Nodes;  // Parents before their children
+  std::vector<Aabb> m_Boxes;
+  std::vector<uint32_t> m_Order;
+  // Node * NodeWidth + child of every object
+  std::vector<uint32_t> m_Leaves;
+  std::vector<uint8_t> m_Dirty;
+
+  // Cull scratch, kept between frames
+  std::vector<uint32_t> m_Frontier, m_NextFrontier;
+  std::vector<std::vector<uint32_t>> m_JobVisible;
+  std::vector<std::vector<uint32_t>> m_JobStacks;
+  std::vector<unsigned int> m_JobNodesTested;
+
+  Stats m_Stats;
+public:
+  SceneBvh() = default;
+  explicit SceneBvh(const std::vector<Aabb>& boxes);
+
+  // Builds the tree for one object per box, splitting along the widest
+  // axis of the box centers so that every leaf but the last is full
+  void Build(const std::vector<Aabb>& boxes);
+
+  // Takes effect in the tree at the next Refit()
+  void SetBox(uint32_t object, const Aabb& box);
+  // Recomputes the bounds of the nodes above every box set since the last
+  // call, and only those
+  void Refit();
+
+  // Indices of the objects intersecting frustum, in the same order every
+  // time for the same tree and frustum. The top of the tree is culled on
+  // the calling thread until there are enough subtrees to keep every
+  // thread of pool busy, then each subtree is a job.
+  void Cull(const Frustum& frustum, ThreadPool& pool, std::vector<uint32_t>& visible);
+
+  inline unsigned int GetObjectCount() const { return (unsigned int)m_Boxes.size(); }
+  inline unsigned int GetNodeCount() const { return (unsigned int)m_Nodes.size(); }
+  inline const Aabb& GetBox(uint32_t object) const { return m_Boxes[object]; }
+  inline const Stats& GetStats() const { return m_Stats; }
+private:
+  // Node for m_Order[first, first + count), returns its index
+  uint32_t BuildNode(uint32_t first, uint32_t count, int32_t parent, uint32_t parentSlot, Aabb& bounds);
+  void Partition(uint32_t first, uint32_t count, unsigned int firstGroup, unsigned int lastGroup, uint32_t capacity);
+  void SetChildBounds(Node& node, unsigned int child, const Aabb& box);
+  Aabb GetNodeBounds(const Node& node) const;
+  // Tests node's children. Objects that intersect, and all objects under
+  // children entirely inside, go to visible; children partly inside go to
+  // next to be tested further.
+  void CullNode(const Frustum& frustum, const Node& node, std::vector<uint32_t>& visible, std::vector<uint32_t>& next) const;
+};
@@ -1,131 +1,460 @@
 #include "Shader.h"
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#include <thread>
+#include <utility>
 
 #include "Renderer.h"
+#include "GLState.h"
+#include "ShaderCache.h"
+#include "Profiler.h"
+#include "UniformBuffer.h"
 
-Shader::Shader(const std::string& filepath)
-  : m_FilePath(filepath), m_RendererID(0)
+static const GLenum StageTypes[(int)ShaderStage::Count] = {
+  GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER, GL_COMPUTE_SHADER
+};
+
+struct Shader::PendingProgram
+{
+  ShaderProgramSource Source;
+  uint64_t CacheKey = 0;
+  unsigned int Stages[(int)ShaderStage::Count] = {};
+};
+
+Shader::Shader(const std::string& filepath, const ShaderDefines& defines)
+  : m_FilePath(filepath), m_Defines(defines), m_RendererID(0), m_FromCache(false), m_CompileMs(0.0)
 {
-  ShaderProgramSource source = ParseShader(filepath);
-  m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
+  ShaderBatch batch;
+  batch.Add(this);
+  batch.Finish();
+}
+
+Shader::Shader(const std::string& filepath, const ShaderDefines& defines, ShaderBatch& batch)
+  : m_FilePath(filepath), m_Defines(defines), m_RendererID(0), m_FromCache(false), m_CompileMs(0.0)
+{
+  batch.Add(this);
 }
 
 Shader::~Shader()
 {
-  GLCall(glDeleteProgram(m_RendererID));
+  if (m_Pending)
+  {
+    for (unsigned int stage : m_Pending->Stages)
+    {
+      if (stage)
+      {
+        GLCall(glDeleteShader(stage));
+      }
+    }
+  }
+  if (m_RendererID)
+  {
+    GLCall(glDeleteProgram(m_RendererID));
+    GLState::Get().OnDeleteProgram(m_RendererID);
+  }
+}
+
+Shader::Shader(Shader&& other) noexcept
+  : m_RendererID(0), m_FromCache(false), m_CompileMs(0.0)
+{
+  Swap(other);
 }
 
-ShaderProgramSource Shader::ParseShader(const std::string& filepath)
+Shader& Shader::operator=(Shader&& other) noexcept
 {
-  std::ifstream stream(filepath);
+  // Our old program is deleted along with the temporary
+  Shader moved(std::move(other));
+  Swap(moved);
+  return *this;
+}
 
-  enum class ShaderType
+void Shader::Swap(Shader& other)
+{
+  // A batch refers to its shaders by address
+  ASSERT(!m_Pending && !other.m_Pending);
+  std::swap(m_FilePath, other.m_FilePath);
+  std::swap(m_Defines, other.m_Defines);
+  std::swap(m_RendererID, other.m_RendererID);
+  std::swap(m_FromCache, other.m_FromCache);
+  std::swap(m_CompileMs, other.m_CompileMs);
+  std::swap(m_Uniforms, other.m_Uniforms);
+  std::swap(m_UniformBlocks, other.m_UniformBlocks);
+  std::swap(m_MissingUniforms, other.m_MissingUniforms);
+}
+
+void Shader::StartCompile()
+{
+  PROFILE_SCOPE("Shader::StartCompile");
+  m_Pending.reset(new PendingProgram());
+  PendingProgram& pending = *m_Pending;
+
+  std::string error;
+  if (!ShaderPreprocessor::Process(m_FilePath, m_Defines, pending.Source, error))
+  {
+    std::cout << "Failed to preprocess shader: " << error << std::endl;
+    return;
+  }
+
+  const ShaderProgramSource& source = pending.Source;
+  if (!source[ShaderStage::Compute].empty() && (!source[ShaderStage::Vertex].empty() || !source[ShaderStage::Fragment].empty()))
+  {
+    std::cout << "Failed to create " << m_FilePath << ": compute shaders can't be combined with other stages" << std::endl;
+    return;
+  }
+  if (!source[ShaderStage::Compute].empty() && !GLEW_VERSION_4_3 && !GLEW_ARB_compute_shader)
   {
-    NONE = -1, VERTEX = 0, FRAGMENT = 1
-  };
+    std::cout << "Failed to create " << m_FilePath << ": compute shaders need GL 4.3 or ARB_compute_shader" << std::endl;
+    return;
+  }
 
-  std::string line;
-  std::stringstream ss[2];
-  ShaderType type = ShaderType::NONE;
-  while (getline(stream, line))
+  if (ShaderCache::IsEnabled())
   {
-    if (line.find("#shader") != std::string::npos)
+    pending.CacheKey = ShaderCache::GetKey(source);
+    m_RendererID = ShaderCache::Load(pending.CacheKey);
+    if (m_RendererID)
     {
-      if (line.find("vertex") != std::string::npos)
-        type = ShaderType::VERTEX;
-      else if (line.find("fragment") != std::string::npos)
-        type = ShaderType::FRAGMENT;
+      m_FromCache = true;
+      return;
     }
-    else
+  }
+
+  // No status queries here, they would wait for the compiler
+  GLCall(m_RendererID = glCreateProgram());
+  if (ShaderCache::IsEnabled())
+  {
+    GLCall(glProgramParameteri(m_RendererID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+  }
+  for (int stage = 0; stage < (int)ShaderStage::Count; stage++)
+  {
+    if (source.Stages[stage].empty())
+      continue;
+    unsigned int id;
+    GLCall(id = glCreateShader(StageTypes[stage]));
+    const char* text = source.Stages[stage].c_str();
+    GLCall(glShaderSource(id, 1, &text, nullptr));
+    GLCall(glCompileShader(id));
+    GLCall(glAttachShader(m_RendererID, id));
+    pending.Stages[stage] = id;
+  }
+  GLCall(glLinkProgram(m_RendererID));
+}
+
+bool Shader::IsCompileComplete() const
+{
+  if (!m_Pending || m_FromCache || !m_RendererID)
+    return true;
+
+  int complete = GL_TRUE;
+  GLCall(glGetProgramiv(m_RendererID, GL_COMPLETION_STATUS_KHR, &complete));
+  return complete == GL_TRUE;
+}
+
+void Shader::FinishCompile()
+{
+  PROFILE_SCOPE("Shader::FinishCompile");
+  auto start = std::chrono::steady_clock::now();
+  PendingProgram& pending = *m_Pending;
+
+  bool linked = m_FromCache;
+  if (m_RendererID && !m_FromCache)
+  {
+    int status;
+    GLCall(glGetProgramiv(m_RendererID, GL_LINK_STATUS, &status));
+    linked = status == GL_TRUE;
+  }
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  m_CompileMs += elapsed.count();
+
+  if (m_RendererID && !linked)
+  {
+    // The compile logs explain most link failures
+    bool compiled = true;
+    for (int stage = 0; stage < (int)ShaderStage::Count; stage++)
     {
-      ss[(int)type] << line << "\n";
+      unsigned int id = pending.Stages[stage];
+      if (!id)
+        continue;
+      int result;
+      GLCall(glGetShaderiv(id, GL_COMPILE_STATUS, &result));
+      if (result == GL_TRUE)
+        continue;
+
+      compiled = false;
+      int length;
+      GLCall(glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length));
+      std::vector<char> message(length + 1);
+      GLCall(glGetShaderInfoLog(id, (GLsizei)message.size(), &length, message.data()));
+      std::cout << "Failed to compile " << ShaderPreprocessor::GetStageName((ShaderStage)stage) << " shader of " << m_FilePath << "!" << std::endl;
+      std::cout << message.data() << std::endl;
+    }
+    if (compiled)
+    {
+      int length;
+      GLCall(glGetProgramiv(m_RendererID, GL_INFO_LOG_LENGTH, &length));
+      std::vector<char> message(length + 1);
+      GLCall(glGetProgramInfoLog(m_RendererID, (GLsizei)message.size(), &length, message.data()));
+      std::cout << "Failed to link " << m_FilePath << "!" << std::endl;
+      std::cout << message.data() << std::endl;
     }
+    // Source string numbers in the logs
+    for (size_t i = 1; i < pending.Source.Files.size(); i++)
+      std::cout << "  " << i << ": " << pending.Source.Files[i] << std::endl;
+
+    GLCall(glDeleteProgram(m_RendererID));
+    m_RendererID = 0;
   }
 
-  return { ss[0].str(), ss[1].str() };
+  for (unsigned int& stage : pending.Stages)
+  {
+    if (stage)
+    {
+      GLCall(glDeleteShader(stage));
+      stage = 0;
+    }
+  }
+
+  if (m_RendererID && !m_FromCache)
+    ShaderCache::Store(pending.CacheKey, m_RendererID, m_CompileMs);
+  m_Pending.reset();
+
+  if (!m_RendererID)
+    return;
+  ReflectUniforms();
+  // Block bindings aren't part of a cached binary, so this runs either way
+  BindUniformBlocks();
+}
+
+void Shader::Bind() const
+{
+  GLState::Get().UseProgram(m_RendererID);
+}
+
+void Shader::Unbind() const
+{
+  GLState::Get().UseProgram(0);
 }
 
-unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
+void Shader::SetUniform1i(UniformHandle uniform, int value)
 {
-  unsigned int id;
-  GLCall(id = glCreateShader(type));
-  const char* src = source.c_str();
-  GLCall(glShaderSource(id, 1, &src, nullptr));
-  GLCall(glCompileShader(id));
+  GLCall(glUniform1i(uniform.Location, value));
+}
 
-  int result;
-  GLCall(glGetShaderiv(id, GL_COMPILE_STATUS, &result));
-  if (result == GL_FALSE)
+void Shader::SetUniform1iv(UniformHandle uniform, int count, const int* values)
+{
+  GLCall(glUniform1iv(uniform.Location, count, values));
+}
+
+void Shader::SetUniform1f(UniformHandle uniform, float value)
+{
+  GLCall(glUniform1f(uniform.Location, value));
+}
+
+void Shader::SetUniform1fv(UniformHandle uniform, int count, const float* values)
+{
+  GLCall(glUniform1fv(uniform.Location, count, values));
+}
+
+void Shader::SetUniform2f(UniformHandle uniform, float v0, float v1)
+{
+  GLCall(glUniform2f(uniform.Location, v0, v1));
+}
+
+void Shader::SetUniform2fv(UniformHandle uniform, int count, const float* values)
+{
+  GLCall(glUniform2fv(uniform.Location, count, values));
+}
+
+void Shader::SetUniform3f(UniformHandle uniform, float v0, float v1, float v2)
+{
+  GLCall(glUniform3f(uniform.Location, v0, v1, v2));
+}
+
+void Shader::SetUniform3fv(UniformHandle uniform, int count, const float* values)
+{
+  GLCall(glUniform3fv(uniform.Location, count, values));
+}
+
+void Shader::SetUniform4f(UniformHandle uniform, float v0, float v1, float v2, float v3)
+{
+  GLCall(glUniform4f(uniform.Location, v0, v1, v2, v3));
+}
+
+void Shader::SetUniform4fv(UniformHandle uniform, int count, const float* values)
+{
+  GLCall(glUniform4fv(uniform.Location, count, values));
+}
+
+void Shader::SetUniformMat3(UniformHandle uniform, const float* matrix, int count)
+{
+  GLCall(glUniformMatrix3fv(uniform.Location, count, GL_FALSE, matrix));
+}
+
+void Shader::SetUniformMat4(UniformHandle uniform, const float* matrix, int count)
+{
+  GLCall(glUniformMatrix4fv(uniform.Location, count, GL_FALSE, matrix));
+}
+
+void Shader::ReflectUniforms()
+{
+  m_Uniforms.clear();
+
+  int count = 0, maxLength = 0;
+  GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORMS, &count));
+  GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength));
+
+  std::vector<char> name(maxLength + 1);
+  for (int i = 0; i < count; i++)
   {
-    int length;
-    GLCall(glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length));
-    char* message = (char*)alloca(length * sizeof(char));
-    GLCall(glGetShaderInfoLog(id, length, &length, message));
-    std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << " shader!" << std::endl;
-    std::cout << message << std::endl;
-    GLCall(glDeleteShader(id));
-    return 0;
+    int length, size;
+    GLenum type;
+    GLCall(glGetActiveUniform(m_RendererID, i, (GLsizei)name.size(), &length, &size, &type, name.data()));
+
+    int location;
+    GLCall(location = glGetUniformLocation(m_RendererID, name.data()));
+    // Members of uniform blocks have no location
+    if (location == -1)
+      continue;
+
+    std::string uniformName(name.data(), length);
+    if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+      uniformName.resize(uniformName.size() - 3);
+
+    m_Uniforms.push_back({ uniformName, HashUniformName(uniformName.c_str()), location, type, size });
   }
 
-  return id;
+  std::sort(m_Uniforms.begin(), m_Uniforms.end(),
+    [](const ShaderUniform& a, const ShaderUniform& b) { return a.Hash < b.Hash; });
 }
 
-unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
+void Shader::BindUniformBlocks()
 {
-  unsigned int program;
-  GLCall(program = glCreateProgram());
-  unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-  unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
+  m_UniformBlocks.clear();
 
-  GLCall(glAttachShader(program, vs));
-  GLCall(glAttachShader(program, fs));
-  GLCall(glLinkProgram(program));
-  GLCall(glValidateProgram(program));
+  int count = 0, maxLength = 0;
+  GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_BLOCKS, &count));
+  GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength));
 
-  GLCall(glDeleteShader(vs));
-  GLCall(glDeleteShader(fs));
+  std::vector<char> name(maxLength + 1);
+  for (int i = 0; i < count; i++)
+  {
+    int length, size;
+    GLCall(glGetActiveUniformBlockName(m_RendererID, i, (GLsizei)name.size(), &length, name.data()));
+    GLCall(glGetActiveUniformBlockiv(m_RendererID, i, GL_UNIFORM_BLOCK_DATA_SIZE, &size));
 
-  return program;
+    std::string blockName(name.data(), length);
+    // A block without a binding point would read point 0 by default. It's
+    // pointed past the ones GLState tracks instead, where nothing is ever
+    // bound; 3.3 contexts have at least 36 points.
+    unsigned int binding = UniformBindings::Get(blockName);
+    GLCall(glUniformBlockBinding(m_RendererID, i, binding != UniformBindings::Invalid ? binding : GLState::MaxUniformBindings));
+    m_UniformBlocks.push_back({ blockName, binding, size });
+  }
 }
 
-void Shader::Bind() const
+UniformHandle Shader::GetUniformHandle(UniformName name) const
 {
-  GLCall(glUseProgram(m_RendererID));
+  auto it = std::lower_bound(m_Uniforms.begin(), m_Uniforms.end(), name.Hash,
+    [](const ShaderUniform& uniform, uint32_t hash) { return uniform.Hash < hash; });
+  for (; it != m_Uniforms.end() && it->Hash == name.Hash; ++it)
+  {
+    if (it->Name == name.Name)
+      return { it->Location };
+  }
+
+  if (std::find(m_MissingUniforms.begin(), m_MissingUniforms.end(), name.Hash) == m_MissingUniforms.end())
+  {
+    std::cout << "Warning: uniform '" << name.Name << "' doesn't exist!" << std::endl;
+    m_MissingUniforms.push_back(name.Hash);
+  }
+  return {};
 }
 
-void Shader::Unbind() const
+// ------------------------------ ShaderBatch ------------------------------
+ShaderBatch::ShaderBatch()
 {
-  GLCall(glUseProgram(0));
 }
 
-void Shader::SetUniform1i(const std::string& name, int value)
+ShaderBatch::~ShaderBatch()
 {
-  GLCall(glUniform1i(GetUniformLocation(name), value));
+  Finish();
 }
 
-void Shader::SetUniform1f(const std::string& name, float value)
+bool ShaderBatch::EnableParallelCompile()
 {
-  GLCall(glUniform1i(GetUniformLocation(name), value));
+  static int s_Enabled = -1;
+  if (s_Enabled < 0)
+  {
+    // Both take the same arguments and share GL_COMPLETION_STATUS
+    s_Enabled = 1;
+    if (GLEW_KHR_parallel_shader_compile)
+    {
+      GLCall(glMaxShaderCompilerThreadsKHR(0xffffffff));
+    }
+    else if (GLEW_ARB_parallel_shader_compile)
+    {
+      GLCall(glMaxShaderCompilerThreadsARB(0xffffffff));
+    }
+    else
+    {
+      s_Enabled = 0;
+    }
+  }
+  return s_Enabled > 0;
 }
 
-void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
+void ShaderBatch::Add(Shader* shader)
 {
-  GLCall(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3));
+  auto start = std::chrono::steady_clock::now();
+  if (m_Pending.empty())
+  {
+    m_Start = start;
+    m_Stats = Stats();
+    m_Stats.Parallel = EnableParallelCompile();
+  }
+
+  shader->StartCompile();
+  m_Pending.push_back(shader);
+
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  shader->m_CompileMs = elapsed.count();
+  m_Stats.StartMs += elapsed.count();
 }
 
-int Shader::GetUniformLocation(const std::string& name)
+void ShaderBatch::Finish()
 {
-  if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
-    return m_UniformLocationCache[name];
+  if (m_Pending.empty())
+    return;
+
+  PROFILE_SCOPE("ShaderBatch::Finish");
+  while (!m_Pending.empty())
+  {
+    // Without parallel compiling each status query just waits in turn
+    bool progress = false;
+    for (size_t i = 0; i < m_Pending.size();)
+    {
+      Shader* shader = m_Pending[i];
+      if (m_Stats.Parallel && !shader->IsCompileComplete())
+      {
+        i++;
+        continue;
+      }
 
-  int location;
-  GLCall(location = glGetUniformLocation(m_RendererID, name.c_str()));
-  if (location == -1)
-    std::cout << "Warning: uniform '" << name << "' doesn't exist!" << std::endl;
+      shader->FinishCompile();
+      m_Stats.Programs++;
+      if (shader->IsFromCache())
+        m_Stats.CacheHits++;
+      if (!shader->IsValid())
+        m_Stats.Failed++;
+      m_Pending.erase(m_Pending.begin() + i);
+      progress = true;
+    }
+    if (!progress)
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
 
-  m_UniformLocationCache[name] = location;
-  return location;
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - m_Start;
+  m_Stats.TotalMs = elapsed.count();
 }
+// -------------------------------------------------------------------------
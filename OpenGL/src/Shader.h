@@ -1,34 +1,205 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
-struct ShaderProgramSource
+#include "Math3D.h"
+#include "ShaderPreprocessor.h"
+
+class ShaderBatch;
+
+// FNV-1a hash of a uniform name
+constexpr uint32_t HashUniformName(const char* name)
+{
+  uint32_t hash = 2166136261u;
+  while (*name)
+  {
+    hash ^= (unsigned char)*name++;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// Uniform name with its hash. Implicitly built from string literals, so
+// SetUniform*("u_Color", ...) neither allocates nor, when the name is a
+// constexpr UniformName, hashes at runtime.
+struct UniformName
+{
+  uint32_t Hash;
+  const char* Name;
+
+  constexpr UniformName(const char* name)
+    : Hash(HashUniformName(name)), Name(name) {}
+  UniformName(const std::string& name)
+    : Hash(HashUniformName(name.c_str())), Name(name.c_str()) {}
+};
+
+// Uniform location resolved once, for the per-frame SetUniform* calls
+struct UniformHandle
 {
-  std::string VertexSource;
-  std::string FragmentSource;
+  int Location = -1;
+
+  inline bool IsValid() const { return Location != -1; }
+};
+
+// Active uniform found by reflection after linking. Arrays are stored
+// under their base name, e.g. "u_Textures" for "u_Textures[0]".
+struct ShaderUniform
+{
+  std::string Name;
+  uint32_t Hash;
+  int Location;
+  unsigned int Type;
+  int Size;
+};
+
+// Active uniform block, bound to the point UniformBindings assigned to its name
+struct ShaderUniformBlock
+{
+  std::string Name;
+  unsigned int Binding;
+  int Size;
 };
 
 class Shader
 {
 private:
+  struct PendingProgram;
+
   std::string m_FilePath;
+  ShaderDefines m_Defines;
   unsigned int m_RendererID;
-  std::unordered_map<std::string, int> m_UniformLocationCache;
+  // Set from construction until the program is linked and reflected
+  std::unique_ptr<PendingProgram> m_Pending;
+  bool m_FromCache;
+  double m_CompileMs;
+  // Sorted by hash
+  std::vector<ShaderUniform> m_Uniforms;
+  std::vector<ShaderUniformBlock> m_UniformBlocks;
+  // Hashes of names that were looked up but don't exist, warned about once
+  mutable std::vector<uint32_t> m_MissingUniforms;
 public:
-  Shader(const std::string& filepath);
+  // Preprocesses, compiles and links right away
+  Shader(const std::string& filepath, const ShaderDefines& defines = ShaderDefines());
+  // Only starts compiling, the shader is usable once batch.Finish() returned
+  Shader(const std::string& filepath, const ShaderDefines& defines, ShaderBatch& batch);
   ~Shader();
 
+  // Move-only, a moved-from shader owns nothing. Shaders still compiling
+  // in a batch can't be moved.
+  Shader(Shader&& other) noexcept;
+  Shader& operator=(Shader&& other) noexcept;
+  Shader(const Shader&) = delete;
+  Shader& operator=(const Shader&) = delete;
+
   void Bind() const;
   void Unbind() const;
 
-  // Set uniforms
-  void SetUniform1i(const std::string& name, int value);
-  void SetUniform1f(const std::string& name, float value);
-  void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
+  inline unsigned int GetRendererID() const { return m_RendererID; }
+  // False if preprocessing, compiling or linking failed
+  inline bool IsValid() const { return m_RendererID != 0; }
+  inline const std::string& GetFilePath() const { return m_FilePath; }
+  inline const ShaderDefines& GetDefines() const { return m_Defines; }
+  // Time the GL thread spent on this program: preprocessing, issuing the
+  // compiles and waiting for the link result, or loading it from the
+  // ShaderCache. Excludes work a parallel compiler did in the background.
+  inline double GetCompileMs() const { return m_CompileMs; }
+  inline bool IsFromCache() const { return m_FromCache; }
+  UniformHandle GetUniformHandle(UniformName name) const;
+  inline const std::vector<ShaderUniform>& GetUniforms() const { return m_Uniforms; }
+  inline const std::vector<ShaderUniformBlock>& GetUniformBlocks() const { return m_UniformBlocks; }
+
+  // Set uniforms, the program has to be bound
+  void SetUniform1i(UniformHandle uniform, int value);
+  void SetUniform1iv(UniformHandle uniform, int count, const int* values);
+  void SetUniform1f(UniformHandle uniform, float value);
+  void SetUniform1fv(UniformHandle uniform, int count, const float* values);
+  void SetUniform2f(UniformHandle uniform, float v0, float v1);
+  void SetUniform2fv(UniformHandle uniform, int count, const float* values);
+  void SetUniform3f(UniformHandle uniform, float v0, float v1, float v2);
+  void SetUniform3fv(UniformHandle uniform, int count, const float* values);
+  void SetUniform4f(UniformHandle uniform, float v0, float v1, float v2, float v3);
+  void SetUniform4fv(UniformHandle uniform, int count, const float* values);
+  // Column-major matrices
+  void SetUniformMat3(UniformHandle uniform, const float* matrix, int count = 1);
+  void SetUniformMat4(UniformHandle uniform, const float* matrix, int count = 1);
+  inline void SetUniformMat3(UniformHandle uniform, const Mat3& matrix) { SetUniformMat3(uniform, matrix.Data()); }
+  inline void SetUniformMat4(UniformHandle uniform, const Mat4& matrix) { SetUniformMat4(uniform, matrix.Data()); }
+
+  inline void SetUniform1i(UniformName name, int value) { SetUniform1i(GetUniformHandle(name), value); }
+  inline void SetUniform1iv(UniformName name, int count, const int* values) { SetUniform1iv(GetUniformHandle(name), count, values); }
+  inline void SetUniform1f(UniformName name, float value) { SetUniform1f(GetUniformHandle(name), value); }
+  inline void SetUniform1fv(UniformName name, int count, const float* values) { SetUniform1fv(GetUniformHandle(name), count, values); }
+  inline void SetUniform2f(UniformName name, float v0, float v1) { SetUniform2f(GetUniformHandle(name), v0, v1); }
+  inline void SetUniform2fv(UniformName name, int count, const float* values) { SetUniform2fv(GetUniformHandle(name), count, values); }
+  inline void SetUniform3f(UniformName name, float v0, float v1, float v2) { SetUniform3f(GetUniformHandle(name), v0, v1, v2); }
+  inline void SetUniform3fv(UniformName name, int count, const float* values) { SetUniform3fv(GetUniformHandle(name), count, values); }
+  inline void SetUniform4f(UniformName name, float v0, float v1, float v2, float v3) { SetUniform4f(GetUniformHandle(name), v0, v1, v2, v3); }
+  inline void SetUniform4fv(UniformName name, int count, const float* values) { SetUniform4fv(GetUniformHandle(name), count, values); }
+  inline void SetUniformMat3(UniformName name, const float* matrix, int count = 1) { SetUniformMat3(GetUniformHandle(name), matrix, count); }
+  inline void SetUniformMat4(UniformName name, const float* matrix, int count = 1) { SetUniformMat4(GetUniformHandle(name), matrix, count); }
+  inline void SetUniformMat3(UniformName name, const Mat3& matrix) { SetUniformMat3(GetUniformHandle(name), matrix); }
+  inline void SetUniformMat4(UniformName name, const Mat4& matrix) { SetUniformMat4(GetUniformHandle(name), matrix); }
+private:
+  friend class ShaderBatch;
+
+  // Issues every compile and the link without querying any status
+  void StartCompile();
+  // Whether the link finished, never blocks with parallel compiling
+  bool IsCompileComplete() const;
+  // Checks the result, stores the binary in the cache and reflects
+  void FinishCompile();
+  void ReflectUniforms();
+  void BindUniformBlocks();
+  void Swap(Shader& other);
+};
+
+// Compiles many programs together. All compiles and links are issued
+// before any status is queried, so a driver with
+// GL_KHR_parallel_shader_compile builds them on its own threads while
+// the others at least avoid a pipeline stall per program:
+//
+//   ShaderBatch batch;
+//   for (...) shaders.emplace_back(new Shader(path, defines, batch));
+//   batch.Finish();
+//
+// Everything is on the GL thread, the shaders must outlive Finish().
+class ShaderBatch
+{
+public:
+  struct Stats
+  {
+    unsigned int Programs = 0;
+    unsigned int CacheHits = 0;
+    unsigned int Failed = 0;
+    bool Parallel = false;  // Compiled with GL_KHR/ARB_parallel_shader_compile
+    double StartMs = 0.0;   // Preprocessing and issuing the compiles
+    double TotalMs = 0.0;   // From the first compile until everything is linked
+  };
+private:
+  std::vector<Shader*> m_Pending;
+  std::chrono::steady_clock::time_point m_Start;
+  Stats m_Stats;
+public:
+  ShaderBatch();
+  // Finishes whatever is still pending
+  ~ShaderBatch();
+
+  ShaderBatch(const ShaderBatch&) = delete;
+  ShaderBatch& operator=(const ShaderBatch&) = delete;
+
+  // Waits for every program started since the last call, checking them
+  // in the order they complete when compiling in parallel
+  void Finish();
+
+  inline const Stats& GetStats() const { return m_Stats; }
+
+  // Lets the driver compile on as many threads as it likes, false if it can't
+  static bool EnableParallelCompile();
 private:
-  ShaderProgramSource ParseShader(const std::string& filepath);
-  unsigned int CompileShader(unsigned int type, const std::string& source);
-  unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
-  int GetUniformLocation(const std::string& name);
+  friend class Shader;
+  void Add(Shader* shader);
 };
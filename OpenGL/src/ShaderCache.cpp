@@ -0,0 +1,190 @@
+#include "ShaderCache.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "Renderer.h"
+#include "ShaderPreprocessor.h"
+
+struct CacheFileHeader
+{
+  uint32_t Magic;
+  uint32_t Version;
+  uint64_t Key;
+  uint32_t BinaryFormat;
+  uint32_t BinaryLength;
+  double CompileMs;
+};
+
+static const uint32_t CacheMagic = 0x43425053; // "SPBC"
+static const uint32_t CacheVersion = 1;
+
+static std::string s_Directory;
+static int s_Supported = -1; // Queried on first use, needs a current context
+static ShaderCache::Stats s_Stats;
+
+static uint64_t HashString(uint64_t hash, const char* data, size_t size)
+{
+  // FNV-1a
+  for (size_t i = 0; i < size; i++)
+  {
+    hash ^= (unsigned char)data[i];
+    hash *= 0x100000001b3ull;
+  }
+  // Separator, so that moving text between fields changes the key
+  hash ^= 0xff;
+  hash *= 0x100000001b3ull;
+  return hash;
+}
+
+static std::string GetPath(uint64_t key)
+{
+  char name[32];
+  snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+  return s_Directory + "/" + name;
+}
+
+static bool IsFormatSupported(GLenum format)
+{
+  GLint count = 0;
+  GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &count));
+  std::vector<GLint> formats(count);
+  if (count > 0)
+  {
+    GLCall(glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data()));
+  }
+  for (GLint supported : formats)
+  {
+    if ((GLenum)supported == format)
+      return true;
+  }
+  return false;
+}
+
+void ShaderCache::SetDirectory(const std::string& directory)
+{
+  s_Directory = directory;
+  if (directory.empty())
+    return;
+
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  if (error)
+  {
+    std::cout << "Failed to create shader cache directory '" << directory << "': " << error.message() << std::endl;
+    s_Directory.clear();
+  }
+}
+
+bool ShaderCache::IsEnabled()
+{
+  if (s_Directory.empty())
+    return false;
+
+  if (s_Supported < 0)
+  {
+    GLint formats = 0;
+    if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+    {
+      GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats));
+    }
+    s_Supported = formats > 0;
+    if (!s_Supported)
+      std::cout << "Program binaries not supported, shader cache disabled" << std::endl;
+  }
+  return s_Supported > 0;
+}
+
+uint64_t ShaderCache::GetKey(const ShaderProgramSource& source)
+{
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (const std::string& stage : source.Stages)
+    hash = HashString(hash, stage.data(), stage.size());
+
+  const GLenum driverStrings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+  for (GLenum name : driverStrings)
+  {
+    const char* value;
+    GLCall(value = (const char*)glGetString(name));
+    if (value)
+      hash = HashString(hash, value, strlen(value));
+  }
+  return hash;
+}
+
+unsigned int ShaderCache::Load(uint64_t key)
+{
+  if (!IsEnabled())
+    return 0;
+
+  auto start = std::chrono::steady_clock::now();
+
+  std::ifstream stream(GetPath(key), std::ios::binary);
+  CacheFileHeader header;
+  if (!stream || !stream.read((char*)&header, sizeof(header))
+    || header.Magic != CacheMagic || header.Version != CacheVersion || header.Key != key)
+  {
+    s_Stats.Misses++;
+    return 0;
+  }
+
+  std::vector<char> binary(header.BinaryLength);
+  if (!stream.read(binary.data(), binary.size()) || !IsFormatSupported(header.BinaryFormat))
+  {
+    s_Stats.Misses++;
+    s_Stats.Rejected++;
+    return 0;
+  }
+
+  unsigned int program;
+  GLCall(program = glCreateProgram());
+  GLCall(glProgramBinary(program, header.BinaryFormat, binary.data(), header.BinaryLength));
+
+  // The driver may still reject a binary of a supported format
+  int linked;
+  GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+  if (linked == GL_FALSE)
+  {
+    GLCall(glDeleteProgram(program));
+    s_Stats.Misses++;
+    s_Stats.Rejected++;
+    return 0;
+  }
+
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  s_Stats.Hits++;
+  s_Stats.LoadMs += elapsed.count();
+  s_Stats.SavedMs += header.CompileMs - elapsed.count();
+  return program;
+}
+
+void ShaderCache::Store(uint64_t key, unsigned int program, double compileMs)
+{
+  s_Stats.CompileMs += compileMs;
+  if (!IsEnabled())
+    return;
+
+  int length = 0;
+  GLCall(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+  if (length <= 0)
+    return;
+
+  std::vector<char> binary(length);
+  GLenum format;
+  GLCall(glGetProgramBinary(program, length, &length, &format, binary.data()));
+
+  CacheFileHeader header = { CacheMagic, CacheVersion, key, format, (uint32_t)length, compileMs };
+  std::ofstream stream(GetPath(key), std::ios::binary);
+  stream.write((const char*)&header, sizeof(header));
+  stream.write(binary.data(), length);
+}
+
+const ShaderCache::Stats& ShaderCache::GetStats()
+{
+  return s_Stats;
+}
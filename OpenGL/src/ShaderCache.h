@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+struct ShaderProgramSource;
+
+// On-disk cache of linked program binaries (glGetProgramBinary). Entries
+// are keyed by a hash of the parsed shader source and the GL vendor,
+// renderer and version strings, so a driver update never loads a stale
+// binary. Disabled until a directory is set or when the context exposes
+// no binary formats.
+class ShaderCache
+{
+public:
+  struct Stats
+  {
+    unsigned int Hits = 0;
+    unsigned int Misses = 0;
+    unsigned int Rejected = 0;  // Binaries the driver refused to load
+    double CompileMs = 0.0;     // Time spent compiling and linking misses
+    double LoadMs = 0.0;        // Time spent loading hits
+    double SavedMs = 0.0;       // Recorded compile time of hits minus LoadMs
+  };
+public:
+  // An empty directory disables the cache
+  static void SetDirectory(const std::string& directory);
+  static bool IsEnabled();
+
+  static uint64_t GetKey(const ShaderProgramSource& source);
+
+  // Returns a linked program, or 0 if there is no usable binary
+  static unsigned int Load(uint64_t key);
+  // Stores the binary of a program linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+  static void Store(uint64_t key, unsigned int program, double compileMs);
+
+  static const Stats& GetStats();
+};
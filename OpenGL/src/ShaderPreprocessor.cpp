@@ -0,0 +1,227 @@
+#include "ShaderPreprocessor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+// Text collected for the shared part or one stage
+struct PreprocessorTarget
+{
+  bool Present = false;
+  std::string Version;
+  std::string Text;
+  std::vector<std::string> Included;
+};
+
+struct PreprocessorState
+{
+  ShaderProgramSource& Source;
+  std::string& Error;
+};
+
+static const unsigned int MaxIncludeDepth = 32;
+
+static std::string Trim(const std::string& line)
+{
+  size_t begin = line.find_first_not_of(" \t\r");
+  if (begin == std::string::npos)
+    return std::string();
+  size_t end = line.find_last_not_of(" \t\r");
+  return line.substr(begin, end - begin + 1);
+}
+
+static bool StartsWith(const std::string& text, const char* prefix)
+{
+  return text.compare(0, strlen(prefix), prefix) == 0;
+}
+
+static std::string GetDirectory(const std::string& path)
+{
+  size_t slash = path.find_last_of("/\\");
+  return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+static bool ReadLines(const std::string& path, std::vector<std::string>& lines)
+{
+  std::ifstream stream(path);
+  if (!stream)
+    return false;
+  std::string line;
+  while (getline(stream, line))
+    lines.push_back(line);
+  return true;
+}
+
+static unsigned int GetFileIndex(PreprocessorState& state, const std::string& path)
+{
+  auto it = std::find(state.Source.Files.begin(), state.Source.Files.end(), path);
+  if (it != state.Source.Files.end())
+    return (unsigned int)(it - state.Source.Files.begin());
+  state.Source.Files.push_back(path);
+  return (unsigned int)state.Source.Files.size() - 1;
+}
+
+static void AppendLine(std::string& text, unsigned int line, unsigned int file)
+{
+  text += "#line " + std::to_string(line) + " " + std::to_string(file) + "\n";
+}
+
+// Handles #version and #include, true if line was one of them
+static bool AppendDirective(PreprocessorState& state, PreprocessorTarget& target, const std::string& line,
+  const std::string& path, unsigned int lineNumber, unsigned int depth);
+
+static bool AppendInclude(PreprocessorState& state, PreprocessorTarget& target, const std::string& path, unsigned int depth)
+{
+  if (std::find(target.Included.begin(), target.Included.end(), path) != target.Included.end())
+    return true;
+  if (depth > MaxIncludeDepth)
+  {
+    state.Error = "includes nested too deeply at '" + path + "'";
+    return false;
+  }
+  target.Included.push_back(path);
+
+  std::vector<std::string> lines;
+  if (!ReadLines(path, lines))
+  {
+    state.Error = "can't open include '" + path + "'";
+    return false;
+  }
+
+  unsigned int file = GetFileIndex(state, path);
+  AppendLine(target.Text, 1, file);
+  for (unsigned int i = 0; i < lines.size(); i++)
+  {
+    std::string trimmed = Trim(lines[i]);
+    if (StartsWith(trimmed, "#shader"))
+    {
+      state.Error = path + ":" + std::to_string(i + 1) + ": #shader tags are only allowed in the .shader file";
+      return false;
+    }
+    if (!AppendDirective(state, target, trimmed, path, i + 1, depth))
+      target.Text += lines[i] + "\n";
+    if (!state.Error.empty())
+      return false;
+  }
+  return true;
+}
+
+static bool AppendDirective(PreprocessorState& state, PreprocessorTarget& target, const std::string& line,
+  const std::string& path, unsigned int lineNumber, unsigned int depth)
+{
+  if (StartsWith(line, "#version"))
+  {
+    // Moved to the top of the stage, a blank line keeps the numbering
+    if (target.Version.empty())
+      target.Version = line;
+    target.Text += "\n";
+    return true;
+  }
+
+  if (!StartsWith(line, "#include"))
+    return false;
+
+  size_t open = line.find('"');
+  size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+  if (close == std::string::npos)
+  {
+    state.Error = path + ":" + std::to_string(lineNumber) + ": expected #include \"file\"";
+    return true;
+  }
+
+  std::string include = GetDirectory(path) + line.substr(open + 1, close - open - 1);
+  if (AppendInclude(state, target, include, depth + 1))
+    AppendLine(target.Text, lineNumber + 1, GetFileIndex(state, path));
+  return true;
+}
+
+const char* ShaderPreprocessor::GetStageName(ShaderStage stage)
+{
+  switch (stage)
+  {
+    case ShaderStage::Vertex:   return "vertex";
+    case ShaderStage::Fragment: return "fragment";
+    case ShaderStage::Geometry: return "geometry";
+    case ShaderStage::Compute:  return "compute";
+    case ShaderStage::Count:    break;
+  }
+  return "unknown";
+}
+
+bool ShaderPreprocessor::Process(const std::string& filepath, const ShaderDefines& defines, ShaderProgramSource& source, std::string& error)
+{
+  source = ShaderProgramSource();
+  error.clear();
+  PreprocessorState state = { source, error };
+
+  std::vector<std::string> lines;
+  if (!ReadLines(filepath, lines))
+  {
+    error = "can't open '" + filepath + "'";
+    return false;
+  }
+  GetFileIndex(state, filepath);
+
+  // Text before the first #shader tag goes to every stage
+  PreprocessorTarget shared;
+  PreprocessorTarget stages[(int)ShaderStage::Count];
+  PreprocessorTarget* target = &shared;
+  AppendLine(shared.Text, 1, 0);
+
+  for (unsigned int i = 0; i < lines.size(); i++)
+  {
+    std::string trimmed = Trim(lines[i]);
+    if (StartsWith(trimmed, "#shader"))
+    {
+      std::string name = Trim(trimmed.substr(7));
+      int stage = 0;
+      while (stage < (int)ShaderStage::Count && name != GetStageName((ShaderStage)stage))
+        stage++;
+      if (stage == (int)ShaderStage::Count)
+      {
+        error = filepath + ":" + std::to_string(i + 1) + ": unknown shader stage '" + name + "'";
+        return false;
+      }
+
+      target = &stages[stage];
+      if (!target->Present)
+        target->Included = shared.Included;
+      target->Present = true;
+      AppendLine(target->Text, i + 2, 0);
+      continue;
+    }
+
+    if (!AppendDirective(state, *target, trimmed, filepath, i + 1, 0))
+      target->Text += lines[i] + "\n";
+    if (!error.empty())
+      return false;
+  }
+
+  std::string defineText;
+  for (const std::string& define : defines)
+  {
+    std::string macro = define;
+    size_t equals = macro.find('=');
+    if (equals != std::string::npos)
+      macro[equals] = ' ';
+    defineText += "#define " + macro + "\n";
+  }
+
+  bool any = false;
+  for (int stage = 0; stage < (int)ShaderStage::Count; stage++)
+  {
+    const PreprocessorTarget& body = stages[stage];
+    if (!body.Present)
+      continue;
+    any = true;
+    std::string version = !body.Version.empty() ? body.Version : !shared.Version.empty() ? shared.Version : "#version 330 core";
+    source.Stages[stage] = version + "\n" + defineText + shared.Text + body.Text;
+  }
+
+  if (!any)
+  {
+    error = filepath + ": no #shader stages";
+    return false;
+  }
+  return true;
+}
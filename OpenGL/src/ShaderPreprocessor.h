@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+enum class ShaderStage
+{
+  Vertex = 0, Fragment = 1, Geometry = 2, Compute = 3, Count = 4
+};
+
+// Preprocessed GLSL of every stage in a .shader file, empty for stages it
+// doesn't have. Files lists the source string numbers used in #line
+// directives, 0 is the .shader file itself; compile errors of the form
+// "1:12(3)" refer to line 12 of Files[1].
+struct ShaderProgramSource
+{
+  std::string Stages[(int)ShaderStage::Count];
+  std::vector<std::string> Files;
+
+  inline std::string& operator[](ShaderStage stage) { return Stages[(int)stage]; }
+  inline const std::string& operator[](ShaderStage stage) const { return Stages[(int)stage]; }
+};
+
+// Macros injected into every stage, "NAME" or "NAME=VALUE"
+using ShaderDefines = std::vector<std::string>;
+
+// Turns a .shader file into per-stage GLSL:
+//
+//   #version 330 core          <- text before the first #shader tag is
+//   #include "Common.glsl"     <- shared by every stage
+//   #shader vertex              (vertex, fragment, geometry or compute)
+//   ...
+//
+// Each stage gets the #version line (its own or the shared one, 330 core
+// by default), then the injected defines, then the shared text and its
+// own. #include "path" is resolved relative to the including file; every
+// file is included at most once per stage, so headers need no guards.
+class ShaderPreprocessor
+{
+public:
+  static const char* GetStageName(ShaderStage stage);
+
+  // false with a message in error on unreadable files, unknown stages or
+  // #shader tags inside included files
+  static bool Process(const std::string& filepath, const ShaderDefines& defines, ShaderProgramSource& source, std::string& error);
+};
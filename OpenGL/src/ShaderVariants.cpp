@@ -0,0 +1,88 @@
+#include "ShaderVariants.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "GLDebug.h"
+
+ShaderVariants::ShaderVariants(const std::string& filepath, const std::vector<KeywordSet>& keywordSets, const ShaderDefines& defines)
+  : m_FilePath(filepath), m_KeywordSets(keywordSets)
+{
+  unsigned int count = 1;
+  for (const KeywordSet& set : m_KeywordSets)
+  {
+    ASSERT(!set.empty());
+    count *= (unsigned int)set.size();
+  }
+
+  ShaderBatch batch;
+  m_Variants.reserve(count);
+  for (unsigned int i = 0; i < count; i++)
+  {
+    ShaderDefines variantDefines = defines;
+    ShaderDefines keywords = GetKeywords(i);
+    variantDefines.insert(variantDefines.end(), keywords.begin(), keywords.end());
+    m_Variants.emplace_back(new Shader(filepath, variantDefines, batch));
+  }
+  batch.Finish();
+  m_Stats = batch.GetStats();
+}
+
+unsigned int ShaderVariants::GetIndex(const std::vector<std::string>& keywords) const
+{
+  unsigned int index = 0, scale = 1;
+  for (const KeywordSet& set : m_KeywordSets)
+  {
+    unsigned int alternative = 0;
+    for (unsigned int i = 0; i < set.size(); i++)
+    {
+      if (!set[i].empty() && std::find(keywords.begin(), keywords.end(), set[i]) != keywords.end())
+        alternative = i;
+    }
+    index += alternative * scale;
+    scale *= (unsigned int)set.size();
+  }
+  return index;
+}
+
+Shader& ShaderVariants::Get(const std::vector<std::string>& keywords)
+{
+  return *m_Variants[GetIndex(keywords)];
+}
+
+ShaderDefines ShaderVariants::GetKeywords(unsigned int index) const
+{
+  ShaderDefines keywords;
+  for (const KeywordSet& set : m_KeywordSets)
+  {
+    const std::string& keyword = set[index % set.size()];
+    index /= (unsigned int)set.size();
+    if (!keyword.empty())
+      keywords.push_back(keyword);
+  }
+  return keywords;
+}
+
+void ShaderVariants::PrintReport(unsigned int maxVariants) const
+{
+  std::cout << m_FilePath << ": " << m_Stats.Programs << " variants in " << m_Stats.TotalMs << " ms ("
+    << m_Stats.StartMs << " ms to start, " << (m_Stats.Parallel ? "parallel" : "serial") << "), "
+    << m_Stats.CacheHits << " from the cache, " << m_Stats.Failed << " failed" << std::endl;
+
+  std::vector<unsigned int> order(m_Variants.size());
+  for (unsigned int i = 0; i < order.size(); i++)
+    order[i] = i;
+  std::sort(order.begin(), order.end(),
+    [&](unsigned int a, unsigned int b) { return m_Variants[a]->GetCompileMs() > m_Variants[b]->GetCompileMs(); });
+
+  for (unsigned int i = 0; i < std::min(maxVariants, (unsigned int)order.size()); i++)
+  {
+    const Shader& variant = *m_Variants[order[i]];
+    std::cout << "  " << variant.GetCompileMs() << " ms " << (variant.IsFromCache() ? "(cached) " : "")
+      << (variant.IsValid() ? "" : "(failed) ") << "[";
+    ShaderDefines keywords = GetKeywords(order[i]);
+    for (size_t k = 0; k < keywords.size(); k++)
+      std::cout << (k ? " " : "") << keywords[k];
+    std::cout << "]" << std::endl;
+  }
+}
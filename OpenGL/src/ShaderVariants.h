@@ -0,0 +1,44 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Shader.h"
+
+// Every permutation of one .shader file over sets of keywords. Each set
+// lists alternatives of which exactly one is defined per variant, an
+// empty string defines nothing:
+//
+//   ShaderVariants variants("Lit.shader", { { "", "FOG" }, { "LIGHTS_1", "LIGHTS_4" } });
+//   Shader& shader = variants.Get({ "FOG", "LIGHTS_4" });
+//
+// makes four variants. All of them are compiled in one ShaderBatch by
+// the constructor.
+class ShaderVariants
+{
+public:
+  using KeywordSet = std::vector<std::string>;
+private:
+  std::string m_FilePath;
+  std::vector<KeywordSet> m_KeywordSets;
+  // Indexed like a mixed-radix number, the first set varies fastest
+  std::vector<std::unique_ptr<Shader>> m_Variants;
+  ShaderBatch::Stats m_Stats;
+public:
+  // defines are added to every variant
+  ShaderVariants(const std::string& filepath, const std::vector<KeywordSet>& keywordSets, const ShaderDefines& defines = ShaderDefines());
+
+  inline unsigned int GetVariantCount() const { return (unsigned int)m_Variants.size(); }
+  inline Shader& GetVariant(unsigned int index) { return *m_Variants[index]; }
+  // Variant defining the given keywords, sets with none of them use their
+  // first alternative. Unknown keywords are ignored.
+  Shader& Get(const std::vector<std::string>& keywords);
+  unsigned int GetIndex(const std::vector<std::string>& keywords) const;
+  // Keywords defined by a variant, without the empty ones
+  ShaderDefines GetKeywords(unsigned int index) const;
+
+  inline const ShaderBatch::Stats& GetStats() const { return m_Stats; }
+  // Batch totals and the slowest variants with their compile times
+  void PrintReport(unsigned int maxVariants = 10) const;
+};
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include "Profiler.h"
+#include "TripleBuffer.h"
+
+// What the simulation thread hands to the renderer. Holding the previous
+// state too lets the renderer interpolate without any shared history.
+template<typename State>
+struct SimulationSnapshot
+{
+  State Previous;
+  State Current;
+  uint64_t Tick = 0;          // Ticks stepped so far, 0 before the first one
+  int64_t TickTime = 0;       // Scheduled time of the last tick, Previous is the state at it
+                              // and Current the state one tick later
+  int64_t PublishTime = 0;    // When the snapshot was published
+};
+
+// Steps a State at a fixed rate on its own thread and publishes immutable
+// snapshots through a TripleBuffer, so neither a slow simulation tick nor
+// waiting for vsync holds up the other side. After a hitch it catches up
+// with at most MaxCatchUpSteps ticks, then drops the remaining time.
+template<typename State>
+class Simulation
+{
+public:
+  typedef std::function<void(State& state, double dt)> StepFunction;
+
+  struct Stats
+  {
+    uint64_t Ticks = 0;
+    uint64_t CatchUpTicks = 0;   // Ticks run back to back because the thread was behind
+    uint64_t DroppedTicks = 0;   // Ticks skipped after falling too far behind
+    double StepMs = 0.0;         // Average time per tick
+    double LateMs = 0.0;         // Average delay of a tick past its scheduled time
+  };
+
+  static const unsigned int MaxCatchUpSteps = 5;
+private:
+  TripleBuffer<SimulationSnapshot<State>> m_Snapshots;
+  StepFunction m_Step;
+  State m_State;
+  int64_t m_TickNs;
+  double m_TickSeconds;
+
+  std::atomic<bool> m_Quit;
+  std::atomic<uint64_t> m_Ticks, m_CatchUpTicks, m_DroppedTicks;
+  std::atomic<int64_t> m_StepNs, m_LateNs;
+  std::thread m_Thread;
+public:
+  Simulation(const State& initial, double tickRate, StepFunction step)
+    : m_Step(step), m_State(initial), m_TickNs((int64_t)(1e9 / tickRate)), m_TickSeconds(1.0 / tickRate),
+      m_Quit(false), m_Ticks(0), m_CatchUpTicks(0), m_DroppedTicks(0), m_StepNs(0), m_LateNs(0)
+  {
+    m_Thread = std::thread(&Simulation::Run, this);
+  }
+
+  ~Simulation()
+  {
+    m_Quit = true;
+    m_Thread.join();
+  }
+
+  Simulation(const Simulation&) = delete;
+  Simulation& operator=(const Simulation&) = delete;
+
+  // Render thread: the latest snapshot, which stays valid until the next call
+  const SimulationSnapshot<State>& Acquire()
+  {
+    m_Snapshots.Update();
+    return m_Snapshots.GetReadBuffer();
+  }
+
+  // How far to blend from Previous to Current to show the state at time
+  // now. Stays below 1 while snapshots arrive on time, beyond that the
+  // renderer holds Current.
+  double GetAlpha(const SimulationSnapshot<State>& snapshot, int64_t now) const
+  {
+    double alpha = (double)(now - snapshot.TickTime) / m_TickNs;
+    return alpha < 0.0 ? 0.0 : (alpha > 1.0 ? 1.0 : alpha);
+  }
+
+  inline double GetTickSeconds() const { return m_TickSeconds; }
+
+  Stats GetStats() const
+  {
+    Stats stats;
+    stats.Ticks = m_Ticks;
+    stats.CatchUpTicks = m_CatchUpTicks;
+    stats.DroppedTicks = m_DroppedTicks;
+    if (stats.Ticks)
+    {
+      stats.StepMs = m_StepNs / 1e6 / stats.Ticks;
+      stats.LateMs = m_LateNs / 1e6 / stats.Ticks;
+    }
+    return stats;
+  }
+private:
+  void Run()
+  {
+    Profiler::SetThreadName("Simulation");
+
+    State previous = m_State;
+    int64_t nextTick = Profiler::Now();
+    while (!m_Quit)
+    {
+      int64_t now = Profiler::Now();
+      int64_t lastTick = 0;
+      unsigned int steps = 0;
+      while (now >= nextTick && steps < MaxCatchUpSteps)
+      {
+        PROFILE_SCOPE("Simulation::Step");
+        m_LateNs += now - nextTick;
+        previous = m_State;
+        m_Step(m_State, m_TickSeconds);
+        lastTick = nextTick;
+        nextTick += m_TickNs;
+        m_Ticks++;
+        if (steps++)
+          m_CatchUpTicks++;
+
+        int64_t end = Profiler::Now();
+        m_StepNs += end - now;
+        now = end;
+      }
+
+      // Give up on the backlog rather than spiral further behind
+      if (now >= nextTick)
+      {
+        int64_t behind = (now - nextTick) / m_TickNs + 1;
+        m_DroppedTicks += behind;
+        nextTick += behind * m_TickNs;
+      }
+
+      if (steps)
+      {
+        SimulationSnapshot<State>& snapshot = m_Snapshots.GetWriteBuffer();
+        snapshot.Previous = previous;
+        snapshot.Current = m_State;
+        snapshot.Tick = m_Ticks;
+        snapshot.TickTime = lastTick;
+        snapshot.PublishTime = Profiler::Now();
+        m_Snapshots.Publish();
+      }
+
+      std::this_thread::sleep_for(std::chrono::nanoseconds(nextTick - Profiler::Now()));
+    }
+  }
+};
@@ -0,0 +1,168 @@
+#include "StreamBuffer.h"
+
+#include <chrono>
+#include <iostream>
+
+#include "Renderer.h"
+#include "GLState.h"
+
+StreamBuffer::StreamBuffer(unsigned int target, unsigned int regionSize)
+  : m_RendererID(0), m_Target(target), m_RegionSize(regionSize), m_Persistent(false),
+    m_Mapped(nullptr), m_MappedOffset(0), m_Region(0), m_Offset(0)
+{
+  for (unsigned int i = 0; i < RegionCount; i++)
+    m_Fences[i] = nullptr;
+
+  GLCall(glGenBuffers(1, &m_RendererID));
+  GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+
+  if (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage)
+  {
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLCall(glBufferStorage(GL_COPY_WRITE_BUFFER, (GLsizeiptr)regionSize * RegionCount, nullptr, flags));
+    GLCall(m_Mapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)regionSize * RegionCount, flags));
+    m_Persistent = m_Mapped != nullptr;
+  }
+
+  if (!m_Persistent)
+  {
+    // Buffer storage is immutable, so the fallback needs a fresh buffer
+    if (m_Mapped == nullptr && (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage))
+    {
+      GLCall(glDeleteBuffers(1, &m_RendererID));
+      GLCall(glGenBuffers(1, &m_RendererID));
+      GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+    }
+    GLCall(glBufferData(GL_COPY_WRITE_BUFFER, regionSize, nullptr, GL_STREAM_DRAW));
+  }
+
+  GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+}
+
+StreamBuffer::~StreamBuffer()
+{
+  for (unsigned int i = 0; i < RegionCount; i++)
+  {
+    if (m_Fences[i])
+    {
+      GLCall(glDeleteSync((GLsync)m_Fences[i]));
+    }
+  }
+  // Deleting a buffer also unmaps it
+  GLCall(glDeleteBuffers(1, &m_RendererID));
+  GLState::Get().OnDeleteBuffer(m_RendererID);
+}
+
+void* StreamBuffer::Allocate(unsigned int size, unsigned int alignment, unsigned int& offset)
+{
+  if (size > m_RegionSize)
+    return nullptr;
+
+  if (m_Persistent)
+    WaitForRegion();
+
+  unsigned int regionStart = m_Persistent ? m_Region * m_RegionSize : 0;
+  unsigned int start = regionStart + m_Offset;
+  start = (start + alignment - 1) / alignment * alignment;
+  if (start + size > regionStart + m_RegionSize)
+  {
+    // Out of space for this frame, keep going in the next region
+    Flush();
+    NextRegion();
+    WaitForRegion();
+    m_Stats.Wraps++;
+    regionStart = m_Persistent ? m_Region * m_RegionSize : 0;
+    start = (regionStart + alignment - 1) / alignment * alignment;
+  }
+
+  m_Offset = start + size - regionStart;
+  m_Stats.BytesWritten += size;
+  offset = start;
+
+  if (m_Persistent)
+    return m_Mapped + start;
+
+  if (!m_Mapped)
+  {
+    // Everything past the write position is unused by queued draws, so it
+    // can be mapped without synchronizing
+    GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+    GLCall(m_Mapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, start, m_RegionSize - start,
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+    GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+    m_MappedOffset = start;
+  }
+  return m_Mapped + (start - m_MappedOffset);
+}
+
+void StreamBuffer::Flush()
+{
+  // Coherent persistent mappings need no flush
+  if (m_Persistent || !m_Mapped)
+    return;
+
+  GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+  GLCall(glUnmapBuffer(GL_COPY_WRITE_BUFFER));
+  GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+  m_Mapped = nullptr;
+}
+
+void StreamBuffer::EndFrame()
+{
+  Flush();
+  NextRegion();
+}
+
+void StreamBuffer::NextRegion()
+{
+  m_Offset = 0;
+
+  if (!m_Persistent)
+  {
+    // Orphan the storage, the driver keeps the old one alive for queued draws
+    GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+    GLCall(glBufferData(GL_COPY_WRITE_BUFFER, m_RegionSize, nullptr, GL_STREAM_DRAW));
+    GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+    return;
+  }
+
+  if (m_Fences[m_Region])
+  {
+    GLCall(glDeleteSync((GLsync)m_Fences[m_Region]));
+  }
+  GLCall(m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+
+  m_Region = (m_Region + 1) % RegionCount;
+}
+
+void StreamBuffer::WaitForRegion()
+{
+  GLsync fence = (GLsync)m_Fences[m_Region];
+  if (!fence)
+    return;
+
+  GLenum result;
+  GLCall(result = glClientWaitSync(fence, 0, 0));
+  if (result == GL_TIMEOUT_EXPIRED)
+  {
+    // The GPU is still reading this region, the ring is too small
+    m_Stats.Stalls++;
+    auto start = std::chrono::steady_clock::now();
+    do
+    {
+      GLCall(result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000));
+    } while (result == GL_TIMEOUT_EXPIRED);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    m_Stats.WaitMs += elapsed.count();
+  }
+  if (result == GL_WAIT_FAILED)
+    std::cout << "[OpenGL Error] glClientWaitSync failed on stream buffer " << m_RendererID << std::endl;
+
+  GLCall(glDeleteSync(fence));
+  m_Fences[m_Region] = nullptr;
+}
+
+void StreamBuffer::Bind() const
+{
+  GLState::Get().BindBuffer(m_Target, m_RendererID);
+}
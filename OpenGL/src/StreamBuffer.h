@@ -0,0 +1,71 @@
+#pragma once
+
+// How often the contents of a VertexBuffer or IndexBuffer change
+enum class BufferUsage
+{
+  Static,   // Uploaded once
+  Dynamic,  // Updated now and then with SetData
+  Stream    // Rewritten every frame through a StreamBuffer ring
+};
+
+// GPU buffer for data that is rewritten every frame. The storage is split
+// into RegionCount regions used round-robin, one per frame, each guarded
+// by a fence so the CPU only ever writes to a region the GPU is done with.
+// Uses a persistently mapped glBufferStorage buffer where available, and
+// falls back to orphaning a single region with glBufferData otherwise.
+// All mapping goes through GL_COPY_WRITE_BUFFER, so VAO and array buffer
+// bindings are never disturbed.
+class StreamBuffer
+{
+public:
+  struct Stats
+  {
+    unsigned int Wraps = 0;         // Regions that filled up before EndFrame
+    unsigned int Stalls = 0;        // Times the CPU had to wait for a fence
+    double WaitMs = 0.0;            // Time spent waiting in those stalls
+    unsigned long long BytesWritten = 0;
+  };
+
+  static const unsigned int RegionCount = 3;
+private:
+  unsigned int m_RendererID;
+  unsigned int m_Target;
+  unsigned int m_RegionSize;
+  bool m_Persistent;
+
+  unsigned char* m_Mapped;      // Whole buffer when persistent, the current map otherwise
+  unsigned int m_MappedOffset;  // Offset of m_Mapped in the fallback path
+  unsigned int m_Region;
+  unsigned int m_Offset;        // Write position within the current region
+  void* m_Fences[RegionCount];
+  Stats m_Stats;
+public:
+  // target is the binding point used by Bind(), regionSize the number of
+  // bytes that can be written per frame before the ring moves on
+  StreamBuffer(unsigned int target, unsigned int regionSize);
+  ~StreamBuffer();
+
+  StreamBuffer(const StreamBuffer&) = delete;
+  StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+  // Returns write-only memory for size bytes and its byte offset in the
+  // buffer, aligned to a multiple of alignment (need not be a power of
+  // two, e.g. a vertex stride). nullptr if size exceeds a region.
+  void* Allocate(unsigned int size, unsigned int alignment, unsigned int& offset);
+  // Makes everything allocated so far visible to GL, call before drawing
+  void Flush();
+  // Fences the region written this frame and moves on to the next one.
+  // Waiting for that region is deferred to the next Allocate.
+  void EndFrame();
+
+  void Bind() const;
+
+  inline unsigned int GetRendererID() const { return m_RendererID; }
+  inline bool IsPersistent() const { return m_Persistent; }
+  inline unsigned int GetRegionSize() const { return m_RegionSize; }
+  inline const Stats& GetStats() const { return m_Stats; }
+  inline void ResetStats() { m_Stats = Stats(); }
+private:
+  void NextRegion();
+  void WaitForRegion();
+};
@@ -1,41 +1,236 @@
 #include "Texture.h"
 
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <utility>
+#include <vector>
+
 #include "stb_image.h"
 
+#include "GLState.h"
+#include "CookedTexture.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+
+static bool EndsWith(const std::string& string, const char* suffix)
+{
+  size_t length = strlen(suffix);
+  return string.size() >= length && string.compare(string.size() - length, length, suffix) == 0;
+}
+
+static bool IsCompressedFormatSupported(GLenum internalFormat)
+{
+  // Drivers leave these families out of GL_COMPRESSED_TEXTURE_FORMATS
+  switch (internalFormat)
+  {
+    case GL_COMPRESSED_RED_RGTC1:
+    case GL_COMPRESSED_SIGNED_RED_RGTC1:
+    case GL_COMPRESSED_RG_RGTC2:
+    case GL_COMPRESSED_SIGNED_RG_RGTC2:
+      return GLEW_VERSION_3_0 || GLEW_ARB_texture_compression_rgtc;
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
+    case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+    case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
+    case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+      return GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+    case GL_COMPRESSED_RGB8_ETC2:
+    case GL_COMPRESSED_RGBA8_ETC2_EAC:
+      return GLEW_VERSION_4_3 || GLEW_ARB_ES3_compatibility;
+  }
+
+  GLint count = 0;
+  GLCall(glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count));
+  std::vector<GLint> formats(count);
+  if (count > 0)
+  {
+    GLCall(glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data()));
+  }
+  for (GLint format : formats)
+  {
+    if ((GLenum)format == internalFormat)
+      return true;
+  }
+  return false;
+}
+
 Texture::Texture(const std::string& path)
   : m_RendererID(0), m_FilePath(path), m_LocalBuffer(nullptr),
-  m_Width(0), m_Height(0), m_BPP(0)
+  m_Width(0), m_Height(0), m_BPP(0), m_Size(0)
 {
-  stbi_set_flip_vertically_on_load(1);
-  m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, 4);
-
+  PROFILE_GPU_SCOPE("Texture::Texture");
+  GLState& state = GLState::Get();
   GLCall(glGenTextures(1, &m_RendererID));
-  GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+  state.BindTexture(state.GetActiveTexture(), GL_TEXTURE_2D, m_RendererID);
 
   GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
   GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
   GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
   GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
 
-  GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
-  GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+  // Cooked textures are uploaded straight from the file, everything else is decoded by stb_image
+  if (!EndsWith(path, CookedTextureExtension) || !LoadCooked(path))
+  {
+    stbi_set_flip_vertically_on_load(1);
+    m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, 4);
+
+    GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
+    m_Size = (uint64_t)m_Width * m_Height * 4;
 
-  if (m_LocalBuffer)
-    stbi_image_free(m_LocalBuffer);
+    if (m_LocalBuffer)
+    {
+      Profiler::AddCounter(ProfileCounter::BytesUploaded, (uint64_t)m_Width * m_Height * 4);
+      stbi_image_free(m_LocalBuffer);
+    }
+    m_LocalBuffer = nullptr;
+  }
+  state.BindTexture(state.GetActiveTexture(), GL_TEXTURE_2D, 0);
+}
+
+bool Texture::LoadCooked(const std::string& path)
+{
+  MappedFile file(path);
+  if (!file.IsValid() || file.GetSize() < sizeof(CookedTextureHeader))
+    return false;
+
+  const CookedTextureHeader& header = *(const CookedTextureHeader*)file.GetData();
+  // A 32-bit size has at most 32 mip levels
+  if (header.Magic != CookedTextureMagic || header.Version != CookedTextureVersion
+    || header.Width == 0 || header.Height == 0 || header.LevelCount == 0 || header.LevelCount > 32
+    || file.GetSize() < sizeof(CookedTextureHeader) + header.LevelCount * sizeof(CookedTextureLevel))
+  {
+    std::cout << "Invalid cooked texture '" << path << "'" << std::endl;
+    return false;
+  }
+
+  // GL reads uncompressed levels by their dimensions and format, whatever
+  // their Size says, so only the layout the cooker writes is accepted
+  bool compressed = header.Format == 0;
+  if (!compressed && (header.Format != GL_RGBA || header.Type != GL_UNSIGNED_BYTE))
+  {
+    std::cout << "Unsupported upload format of cooked texture '" << path << "'" << std::endl;
+    return false;
+  }
+
+  const CookedTextureLevel* levels = (const CookedTextureLevel*)(file.GetData() + sizeof(CookedTextureHeader));
+  uint64_t fileSize = file.GetSize();
+  for (unsigned int i = 0; i < header.LevelCount; i++)
+  {
+    const CookedTextureLevel& level = levels[i];
+    if (level.Width != std::max<uint32_t>(1, header.Width >> i) || level.Height != std::max<uint32_t>(1, header.Height >> i)
+      || (!compressed && level.Size < (uint64_t)level.Width * level.Height * 4))
+    {
+      std::cout << "Invalid mip level " << i << " of cooked texture '" << path << "'" << std::endl;
+      return false;
+    }
+    if (level.Offset > fileSize || level.Size > fileSize - level.Offset)
+    {
+      std::cout << "Truncated cooked texture '" << path << "'" << std::endl;
+      return false;
+    }
+  }
+
+  if (compressed && !IsCompressedFormatSupported(header.InternalFormat))
+  {
+    std::cout << "Compressed format " << std::hex << header.InternalFormat << std::dec
+      << " of '" << path << "' is not supported by this context" << std::endl;
+    return false;
+  }
+
+  m_Width = header.Width;
+  m_Height = header.Height;
+  m_BPP = compressed ? 0 : 4;
+
+  GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, header.LevelCount - 1));
+  if (header.LevelCount > 1)
+  {
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
+  }
+
+  for (unsigned int i = 0; i < header.LevelCount; i++)
+  {
+    const CookedTextureLevel& level = levels[i];
+    const unsigned char* data = file.GetData() + level.Offset;
+    if (compressed)
+    {
+      GLCall(glCompressedTexImage2D(GL_TEXTURE_2D, i, header.InternalFormat, level.Width, level.Height, 0, level.Size, data));
+    }
+    else
+    {
+      GLCall(glTexImage2D(GL_TEXTURE_2D, i, header.InternalFormat, level.Width, level.Height, 0, header.Format, header.Type, data));
+    }
+    Profiler::AddCounter(ProfileCounter::BytesUploaded, level.Size);
+    m_Size += level.Size;
+  }
+  return true;
+}
+
+Texture::Texture(int width, int height, const void* data)
+  : m_RendererID(0), m_LocalBuffer(nullptr),
+  m_Width(width), m_Height(height), m_BPP(4), m_Size((uint64_t)width * height * 4)
+{
+  GLState& state = GLState::Get();
+  GLCall(glGenTextures(1, &m_RendererID));
+  state.BindTexture(state.GetActiveTexture(), GL_TEXTURE_2D, m_RendererID);
+
+  GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+  GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+  GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+  GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+
+  GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data));
+  if (data)
+    Profiler::AddCounter(ProfileCounter::BytesUploaded, (uint64_t)m_Width * m_Height * 4);
+  state.BindTexture(state.GetActiveTexture(), GL_TEXTURE_2D, 0);
 }
 
 Texture::~Texture()
 {
+  if (!m_RendererID)
+    return;
   GLCall(glDeleteTextures(1, &m_RendererID));
+  GLState::Get().OnDeleteTexture(m_RendererID);
+}
+
+Texture::Texture(Texture&& other) noexcept
+  : m_RendererID(0), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0), m_Size(0)
+{
+  Swap(other);
+}
+
+Texture& Texture::operator=(Texture&& other) noexcept
+{
+  // Our old texture is deleted along with the temporary
+  Texture moved(std::move(other));
+  Swap(moved);
+  return *this;
+}
+
+void Texture::Swap(Texture& other)
+{
+  std::swap(m_RendererID, other.m_RendererID);
+  std::swap(m_FilePath, other.m_FilePath);
+  std::swap(m_LocalBuffer, other.m_LocalBuffer);
+  std::swap(m_Width, other.m_Width);
+  std::swap(m_Height, other.m_Height);
+  std::swap(m_BPP, other.m_BPP);
+  std::swap(m_Size, other.m_Size);
 }
 
 void Texture::Bind(unsigned int slot) const
 {
-  GLCall(glActiveTexture(GL_TEXTURE0 + slot));
-  GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+  GLState::Get().BindTexture(slot, GL_TEXTURE_2D, m_RendererID);
+}
+
+void Texture::SetSubImage(int yOffset, int height, const void* data)
+{
+  GLState& state = GLState::Get();
+  state.BindTexture(state.GetActiveTexture(), GL_TEXTURE_2D, m_RendererID);
+  GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, yOffset, m_Width, height, GL_RGBA, GL_UNSIGNED_BYTE, data));
 }
 
 void Texture::Unbind() const
 {
-  GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+  GLState& state = GLState::Get();
+  state.BindTexture(state.GetActiveTexture(), GL_TEXTURE_2D, 0);
 }
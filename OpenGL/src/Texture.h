@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 #include "Renderer.h"
 
 class Texture
@@ -9,13 +11,35 @@ private:
   std::string m_FilePath;
   unsigned char* m_LocalBuffer;
   int m_Width, m_Height, m_BPP;
+  // Bytes of texture storage, all mip levels
+  uint64_t m_Size;
 public:
+  // Files ending in .ctex are loaded as cooked textures (see CookedTexture.h),
+  // anything else is decoded with stb_image
   Texture(const std::string& path);
+  // Creates an RGBA8 texture from raw pixel data (e.g. a 1x1 white texture)
+  Texture(int width, int height, const void* data);
   ~Texture();
 
+  // Move-only, a moved-from texture owns nothing
+  Texture(Texture&& other) noexcept;
+  Texture& operator=(Texture&& other) noexcept;
+  Texture(const Texture&) = delete;
+  Texture& operator=(const Texture&) = delete;
+
   void Bind(unsigned int slot = 0) const;
   void Unbind() const;
 
+  // Uploads RGBA8 rows [yOffset, yOffset + height). With a pixel unpack
+  // buffer bound, data is an offset into that buffer.
+  void SetSubImage(int yOffset, int height, const void* data);
+
   inline int GetWidth() const { return m_Width; }
   inline int GetHeight() const { return m_Height; }
+  inline uint64_t GetSize() const { return m_Size; }
+  inline const std::string& GetFilePath() const { return m_FilePath; }
+  inline unsigned int GetRendererID() const { return m_RendererID; }
+private:
+  bool LoadCooked(const std::string& path);
+  void Swap(Texture& other);
 };
@@ -0,0 +1,221 @@
+#include "TextureLoader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "stb_image.h"
+
+#include "Renderer.h"
+#include "Texture.h"
+#include "Profiler.h"
+
+AsyncTexture::AsyncTexture(const std::string& path, const Texture* placeholder)
+  : m_FilePath(path), m_Status(Status::Pending), m_Placeholder(placeholder),
+    m_Pixels(nullptr), m_Width(0), m_Height(0), m_UploadedRows(0)
+{
+}
+
+AsyncTexture::~AsyncTexture()
+{
+  if (m_Pixels)
+    stbi_image_free(m_Pixels);
+}
+
+const Texture& AsyncTexture::GetTexture() const
+{
+  if (m_Status == Status::Ready)
+    return *m_Texture;
+  return *m_Placeholder;
+}
+
+void AsyncTexture::Bind(unsigned int slot) const
+{
+  GetTexture().Bind(slot);
+}
+
+TextureLoader::TextureLoader(unsigned int threadCount, unsigned int uploadBudget, unsigned int chunkSize)
+  : m_Quit(false), m_Decoding(0), m_UploadBudget(uploadBudget), m_ChunkSize(chunkSize), m_NextPixelBuffer(0)
+{
+  // Mid grey, visible against both black and white backgrounds
+  const unsigned int grey = 0xff808080;
+  m_Placeholder.reset(new Texture(1, 1, &grey));
+
+  GLCall(glGenBuffers(PixelBufferCount, m_PixelBuffers));
+  for (unsigned int i = 0; i < PixelBufferCount; i++)
+    m_PixelBufferSizes[i] = 0;
+
+  // hardware_concurrency() is 0 when it's unknown, at least one worker
+  if (threadCount == 0)
+    threadCount = std::max(1u, std::max(1u, std::thread::hardware_concurrency()) - 1);
+  for (unsigned int i = 0; i < threadCount; i++)
+    m_Workers.emplace_back(&TextureLoader::WorkerLoop, this);
+}
+
+TextureLoader::~TextureLoader()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Quit = true;
+  }
+  m_Condition.notify_all();
+  for (std::thread& worker : m_Workers)
+    worker.join();
+
+  GLCall(glDeleteBuffers(PixelBufferCount, m_PixelBuffers));
+}
+
+std::shared_ptr<AsyncTexture> TextureLoader::Load(const std::string& path)
+{
+  auto texture = std::make_shared<AsyncTexture>(path, m_Placeholder.get());
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_DecodeQueue.push_back(texture);
+  }
+  m_Condition.notify_one();
+  return texture;
+}
+
+void TextureLoader::WorkerLoop()
+{
+  stbi_set_flip_vertically_on_load_thread(1);
+  Profiler::SetThreadName("TextureLoader");
+
+  while (true)
+  {
+    std::shared_ptr<AsyncTexture> texture;
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_Condition.wait(lock, [this] { return m_Quit || !m_DecodeQueue.empty(); });
+      if (m_Quit)
+        return;
+      texture = std::move(m_DecodeQueue.front());
+      m_DecodeQueue.pop_front();
+      m_Decoding++;
+    }
+
+    // Nobody is waiting for it anymore
+    if (texture.use_count() > 1)
+    {
+      PROFILE_SCOPE("TextureLoader::Decode");
+      int channels;
+      texture->m_Pixels = stbi_load(texture->m_FilePath.c_str(), &texture->m_Width, &texture->m_Height, &channels, 4);
+      if (!texture->m_Pixels)
+        std::cout << "Failed to load texture '" << texture->m_FilePath << "': " << stbi_failure_reason() << std::endl;
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Decoding--;
+    m_UploadQueue.push_back(std::move(texture));
+  }
+}
+
+bool TextureLoader::Upload(AsyncTexture& texture, unsigned int& budget)
+{
+  if (!texture.m_Texture)
+    texture.m_Texture.reset(new Texture(texture.m_Width, texture.m_Height, nullptr));
+
+  const unsigned int rowSize = texture.m_Width * 4;
+  while (texture.m_UploadedRows < texture.m_Height)
+  {
+    // Always move at least one row, even if it is larger than a chunk
+    unsigned int rows = std::max(1u, std::min(m_ChunkSize, budget) / rowSize);
+    rows = std::min(rows, (unsigned int)(texture.m_Height - texture.m_UploadedRows));
+    unsigned int size = rows * rowSize;
+    if (size > budget && budget < m_UploadBudget)
+      return false;
+
+    // Round-robin over the PBOs and orphan the storage, so the copy never
+    // waits for the transfer of the previous chunk
+    unsigned int index = m_NextPixelBuffer;
+    m_NextPixelBuffer = (m_NextPixelBuffer + 1) % PixelBufferCount;
+    GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_PixelBuffers[index]));
+    m_PixelBufferSizes[index] = std::max(m_PixelBufferSizes[index], std::max(size, m_ChunkSize));
+    GLCall(glBufferData(GL_PIXEL_UNPACK_BUFFER, m_PixelBufferSizes[index], nullptr, GL_STREAM_DRAW));
+
+    void* mapped;
+    GLCall(mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (mapped)
+    {
+      memcpy(mapped, texture.m_Pixels + (size_t)texture.m_UploadedRows * rowSize, size);
+      GLCall(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+      texture.m_Texture->SetSubImage(texture.m_UploadedRows, rows, nullptr);
+    }
+    else
+    {
+      // Mapping failed, fall back to a direct upload
+      GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+      texture.m_Texture->SetSubImage(texture.m_UploadedRows, rows, texture.m_Pixels + (size_t)texture.m_UploadedRows * rowSize);
+    }
+
+    texture.m_UploadedRows += rows;
+    budget = size < budget ? budget - size : 0;
+    m_Stats.BytesUploaded += size;
+    m_Stats.Chunks++;
+    Profiler::AddCounter(ProfileCounter::BytesUploaded, size);
+
+    if (budget == 0 && texture.m_UploadedRows < texture.m_Height)
+      return false;
+  }
+  return true;
+}
+
+void TextureLoader::Update()
+{
+  PROFILE_GPU_SCOPE("TextureLoader::Update");
+  m_Stats.Completed = 0;
+  m_Stats.Failed = 0;
+  m_Stats.BytesUploaded = 0;
+  m_Stats.Chunks = 0;
+
+  unsigned int budget = m_UploadBudget;
+  while (budget > 0)
+  {
+    std::shared_ptr<AsyncTexture> texture;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      if (m_UploadQueue.empty())
+        break;
+      texture = m_UploadQueue.front();
+    }
+
+    bool done = true;
+    if (texture.use_count() <= 2)
+    {
+      // Dropped by the caller while loading, only the queue and this function hold it
+    }
+    else if (!texture->m_Pixels)
+    {
+      texture->m_Status = AsyncTexture::Status::Failed;
+      m_Stats.Failed++;
+    }
+    else if ((done = Upload(*texture, budget)))
+    {
+      stbi_image_free(texture->m_Pixels);
+      texture->m_Pixels = nullptr;
+      texture->m_Status = AsyncTexture::Status::Ready;
+      m_Stats.Completed++;
+    }
+
+    if (!done)
+      break;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_UploadQueue.pop_front();
+  }
+
+  // Client memory uploads must not source from a PBO
+  GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+}
+
+TextureLoader::Stats TextureLoader::GetStats()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  Stats stats = m_Stats;
+  stats.QueuedForDecode = (unsigned int)m_DecodeQueue.size() + m_Decoding;
+  stats.QueuedForUpload = (unsigned int)m_UploadQueue.size();
+  stats.Uploading = (!m_UploadQueue.empty() && m_UploadQueue.front()->m_UploadedRows > 0) ? 1 : 0;
+  if (stats.Uploading)
+    stats.QueuedForUpload--;
+  return stats;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Texture;
+
+// Texture that is loaded in the background by a TextureLoader. Until the
+// upload has finished, the loader's placeholder is bound in its place.
+class AsyncTexture
+{
+public:
+  enum class Status
+  {
+    Pending, Ready, Failed
+  };
+private:
+  friend class TextureLoader;
+
+  std::string m_FilePath;
+  std::atomic<Status> m_Status;
+  const Texture* m_Placeholder;
+  std::unique_ptr<Texture> m_Texture;
+
+  // Written by the decode thread, read on the GL thread
+  unsigned char* m_Pixels;
+  int m_Width, m_Height;
+  // Rows already uploaded
+  int m_UploadedRows;
+public:
+  AsyncTexture(const std::string& path, const Texture* placeholder);
+  ~AsyncTexture();
+
+  inline bool IsReady() const { return m_Status == Status::Ready; }
+  inline bool IsPending() const { return m_Status == Status::Pending; }
+  inline bool HasFailed() const { return m_Status == Status::Failed; }
+
+  // The loaded texture once ready, the placeholder before that
+  const Texture& GetTexture() const;
+  void Bind(unsigned int slot = 0) const;
+};
+
+// Decodes images with stb_image on worker threads and streams the pixels
+// to the GPU through pixel buffer objects, a few chunks per frame.
+// Load() may be called from any thread, Update() on the GL thread only.
+class TextureLoader
+{
+public:
+  struct Stats
+  {
+    unsigned int QueuedForDecode = 0;   // Waiting for or being decoded
+    unsigned int QueuedForUpload = 0;   // Decoded, waiting for the GL thread
+    unsigned int Uploading = 0;         // Partially uploaded
+    unsigned int Completed = 0;         // Finished during the last Update
+    unsigned int Failed = 0;            // Failed during the last Update
+    unsigned int BytesUploaded = 0;     // Uploaded during the last Update
+    unsigned int Chunks = 0;            // PBO transfers during the last Update
+  };
+
+  static const unsigned int PixelBufferCount = 3;
+private:
+  std::vector<std::thread> m_Workers;
+  std::mutex m_Mutex;
+  std::condition_variable m_Condition;
+  bool m_Quit;
+
+  std::deque<std::shared_ptr<AsyncTexture>> m_DecodeQueue;
+  std::deque<std::shared_ptr<AsyncTexture>> m_UploadQueue;
+  unsigned int m_Decoding;
+
+  unsigned int m_UploadBudget;
+  unsigned int m_ChunkSize;
+  unsigned int m_PixelBuffers[PixelBufferCount];
+  unsigned int m_PixelBufferSizes[PixelBufferCount];
+  unsigned int m_NextPixelBuffer;
+
+  std::unique_ptr<Texture> m_Placeholder;
+  Stats m_Stats;
+public:
+  // threadCount 0 uses all but one hardware thread. uploadBudget is the
+  // number of bytes sent to the GPU per Update, chunkSize the size of a
+  // single PBO transfer.
+  TextureLoader(unsigned int threadCount = 0, unsigned int uploadBudget = 4 * 1024 * 1024,
+    unsigned int chunkSize = 256 * 1024);
+  ~TextureLoader();
+
+  std::shared_ptr<AsyncTexture> Load(const std::string& path);
+
+  // Uploads decoded pixels within the per-frame budget, call once per frame
+  void Update();
+
+  inline void SetUploadBudget(unsigned int bytes) { m_UploadBudget = bytes; }
+  Stats GetStats();
+private:
+  void WorkerLoop();
+  // Returns false when the budget ran out before the texture was complete
+  bool Upload(AsyncTexture& texture, unsigned int& budget);
+};
@@ -0,0 +1,77 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <string>
+
+#include "Profiler.h"
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+  : m_Quit(false), m_Generation(0), m_Function(nullptr), m_Context(nullptr), m_JobCount(0), m_NextJob(0), m_Busy(0)
+{
+  if (threadCount == 0)
+    threadCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+  for (unsigned int i = 0; i < threadCount; i++)
+    m_Workers.emplace_back(&ThreadPool::WorkerLoop, this, i + 1);
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Quit = true;
+  }
+  m_WorkCondition.notify_all();
+  for (std::thread& worker : m_Workers)
+    worker.join();
+}
+
+void ThreadPool::Run(unsigned int jobCount, JobFunction function, void* context)
+{
+  if (jobCount == 0)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Function = function;
+    m_Context = context;
+    m_JobCount = jobCount;
+    m_NextJob = 0;
+    m_Busy = (unsigned int)m_Workers.size();
+    m_Generation++;
+  }
+  m_WorkCondition.notify_all();
+
+  Work(0);
+
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_DoneCondition.wait(lock, [this] { return m_Busy == 0; });
+}
+
+void ThreadPool::WorkerLoop(unsigned int thread)
+{
+  Profiler::SetThreadName(("Worker " + std::to_string(thread)).c_str());
+  uint64_t generation = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_WorkCondition.wait(lock, [&] { return m_Quit || m_Generation != generation; });
+      if (m_Quit)
+        return;
+      generation = m_Generation;
+    }
+
+    Work(thread);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (--m_Busy == 0)
+      m_DoneCondition.notify_one();
+  }
+}
+
+void ThreadPool::Work(unsigned int thread)
+{
+  unsigned int index;
+  while ((index = m_NextJob++) < m_JobCount)
+    m_Function(m_Context, index, thread);
+}
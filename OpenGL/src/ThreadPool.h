@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of worker threads that run a batch of jobs together with the
+// calling thread. Jobs are handed out one index at a time, so uneven jobs
+// balance themselves. Run() isn't reentrant and must be called from one
+// thread at a time.
+class ThreadPool
+{
+private:
+  typedef void (*JobFunction)(void* context, unsigned int index, unsigned int thread);
+
+  std::vector<std::thread> m_Workers;
+  std::mutex m_Mutex;
+  std::condition_variable m_WorkCondition;
+  std::condition_variable m_DoneCondition;
+  bool m_Quit;
+  // Bumped for every batch, workers wait for it to change
+  uint64_t m_Generation;
+
+  JobFunction m_Function;
+  void* m_Context;
+  unsigned int m_JobCount;
+  std::atomic<unsigned int> m_NextJob;
+  // Workers that haven't finished the current batch yet
+  unsigned int m_Busy;
+public:
+  // threadCount 0 uses one worker per hardware thread besides the caller's
+  ThreadPool(unsigned int threadCount = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Workers plus the calling thread, jobs get a thread index below this
+  inline unsigned int GetThreadCount() const { return (unsigned int)m_Workers.size() + 1; }
+
+  // Calls job(index, thread) for every index in [0, jobCount) and returns
+  // once all of them are done. The caller runs jobs as thread 0.
+  template<typename F>
+  void Run(unsigned int jobCount, F&& job)
+  {
+    typedef typename std::remove_reference<F>::type Job;
+    Run(jobCount, [](void* context, unsigned int index, unsigned int thread) {
+      (*(Job*)context)(index, thread);
+    }, (void*)&job);
+  }
+private:
+  void Run(unsigned int jobCount, JobFunction function, void* context);
+  void WorkerLoop(unsigned int thread);
+  void Work(unsigned int thread);
+};
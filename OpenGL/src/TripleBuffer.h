@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single producer, single consumer triple buffer. The writer
+// fills the back buffer and publishes it by swapping it with the shared
+// middle one; the reader swaps its front buffer with the middle one when
+// something new was published. Neither side ever waits, the reader just
+// skips states it was too slow for.
+template<typename T>
+class TripleBuffer
+{
+private:
+  static const uint8_t IndexMask = 0x3;
+  // Set in m_Middle when it holds a buffer the reader hasn't taken yet
+  static const uint8_t NewBit = 0x4;
+
+  T m_Buffers[3];
+  alignas(64) std::atomic<uint8_t> m_Middle;
+  // Each owned by one side only
+  alignas(64) uint8_t m_Back;
+  alignas(64) uint8_t m_Front;
+public:
+  TripleBuffer()
+    : m_Middle(0), m_Back(1), m_Front(2) {}
+
+  // Writer side
+  inline T& GetWriteBuffer() { return m_Buffers[m_Back]; }
+  void Publish()
+  {
+    uint8_t previous = m_Middle.exchange(m_Back | NewBit, std::memory_order_acq_rel);
+    m_Back = previous & IndexMask;
+  }
+
+  // Reader side. Returns true if a newer buffer was taken.
+  bool Update()
+  {
+    if (!(m_Middle.load(std::memory_order_relaxed) & NewBit))
+      return false;
+    uint8_t previous = m_Middle.exchange(m_Front, std::memory_order_acq_rel);
+    m_Front = previous & IndexMask;
+    return true;
+  }
+  inline const T& GetReadBuffer() const { return m_Buffers[m_Front]; }
+};
@@ -0,0 +1,160 @@
+#include "UniformBuffer.h"
+
+#include <iostream>
+#include <unordered_map>
+
+#include "GLState.h"
+
+// ---------------------------- Layout ----------------------------
+UniformMember UniformBufferLayout::Find(const std::string& name) const
+{
+  for (const UniformBufferElement& element : m_Elements)
+  {
+    if (element.Name == name)
+      return element.Member;
+  }
+  return UniformMember();
+}
+
+bool UniformBufferLayout::Matches(unsigned int program, const std::string& blockName) const
+{
+  unsigned int block;
+  GLCall(block = glGetUniformBlockIndex(program, blockName.c_str()));
+  if (block == GL_INVALID_INDEX)
+  {
+    std::cout << "Uniform block '" << blockName << "' not found in program " << program << std::endl;
+    return false;
+  }
+
+  bool matches = true;
+  int size;
+  GLCall(glGetActiveUniformBlockiv(program, block, GL_UNIFORM_BLOCK_DATA_SIZE, &size));
+  if ((unsigned int)size != GetSize())
+  {
+    std::cout << "Uniform block '" << blockName << "' is " << size << " bytes, the layout " << GetSize() << std::endl;
+    matches = false;
+  }
+
+  for (const UniformBufferElement& element : m_Elements)
+  {
+    // Arrays are reported under the name of their first element
+    std::string name = element.Member.Count > 1 ? element.Name + "[0]" : element.Name;
+    const char* names[] = { name.c_str() };
+    unsigned int index;
+    GLCall(glGetUniformIndices(program, 1, names, &index));
+    // Unused members may be optimized out even from std140 blocks
+    if (index == GL_INVALID_INDEX)
+      continue;
+
+    int offset, arrayStride, matrixStride;
+    GLCall(glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_OFFSET, &offset));
+    GLCall(glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_ARRAY_STRIDE, &arrayStride));
+    GLCall(glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_MATRIX_STRIDE, &matrixStride));
+    const UniformMember& member = element.Member;
+    if ((unsigned int)offset != member.Offset || (member.Count > 1 && (unsigned int)arrayStride != member.ArrayStride)
+      || (unsigned int)matrixStride != member.MatrixStride)
+    {
+      std::cout << "Uniform '" << element.Name << "' of block '" << blockName << "': offset " << offset << ", array stride "
+        << arrayStride << ", matrix stride " << matrixStride << " in GL, " << member.Offset << ", " << member.ArrayStride
+        << ", " << member.MatrixStride << " in the layout" << std::endl;
+      matches = false;
+    }
+  }
+  return matches;
+}
+// ----------------------------------------------------------------
+
+// --------------------------- Bindings ---------------------------
+unsigned int UniformBindings::Get(const std::string& blockName)
+{
+  static std::unordered_map<std::string, unsigned int> s_Bindings;
+
+  auto it = s_Bindings.find(blockName);
+  if (it != s_Bindings.end())
+    return it->second;
+
+  unsigned int binding = (unsigned int)s_Bindings.size();
+  if (binding >= GLState::MaxUniformBindings)
+  {
+    std::cout << "Warning: out of uniform buffer binding points, block '" << blockName << "' stays unbound" << std::endl;
+    binding = Invalid;
+  }
+  s_Bindings.emplace(blockName, binding);
+  return binding;
+}
+// ----------------------------------------------------------------
+
+// ------------------------- UniformBuffer ------------------------
+UniformBuffer::UniformBuffer(const std::string& blockName, const UniformBufferLayout& layout)
+  : m_RendererID(0), m_Binding(UniformBindings::Get(blockName)), m_Layout(layout), m_Data(layout.GetSize(), 0),
+    m_DirtyBegin(0), m_DirtyEnd(0)
+{
+  // Bound through the copy target so no other binding is disturbed
+  GLCall(glGenBuffers(1, &m_RendererID));
+  GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+  GLCall(glBufferData(GL_COPY_WRITE_BUFFER, m_Data.size(), m_Data.data(), GL_DYNAMIC_DRAW));
+  GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+  m_DirtyBegin = (unsigned int)m_Data.size();
+}
+
+UniformBuffer::~UniformBuffer()
+{
+  GLCall(glDeleteBuffers(1, &m_RendererID));
+  GLState::Get().OnDeleteBuffer(m_RendererID);
+}
+
+void UniformBuffer::Upload()
+{
+  if (m_DirtyBegin >= m_DirtyEnd)
+    return;
+
+  GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+  GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, m_DirtyBegin, m_DirtyEnd - m_DirtyBegin, m_Data.data() + m_DirtyBegin));
+  GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+  m_DirtyBegin = (unsigned int)m_Data.size();
+  m_DirtyEnd = 0;
+}
+
+void UniformBuffer::Bind() const
+{
+  if (m_Binding == UniformBindings::Invalid)
+    return;
+  GLState::Get().BindUniformBuffer(m_Binding, m_RendererID);
+}
+// ----------------------------------------------------------------
+
+// --------------------- DynamicUniformBuffer ---------------------
+static unsigned int GetOffsetAlignment()
+{
+  int alignment = 256;
+  GLCall(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+  return (unsigned int)alignment;
+}
+
+static unsigned int GetSlotStride(unsigned int size)
+{
+  unsigned int alignment = GetOffsetAlignment();
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+DynamicUniformBuffer::DynamicUniformBuffer(const std::string& blockName, const UniformBufferLayout& layout, unsigned int maxSlotsPerFrame)
+  : m_Stream(GL_UNIFORM_BUFFER, GetSlotStride(layout.GetSize()) * maxSlotsPerFrame), m_Binding(UniformBindings::Get(blockName)),
+    m_Layout(layout), m_Stride(GetSlotStride(layout.GetSize()))
+{
+}
+
+unsigned char* DynamicUniformBuffer::Allocate(unsigned int count, unsigned int& offset)
+{
+  unsigned char* slots = (unsigned char*)m_Stream.Allocate(count * m_Stride, m_Stride, offset);
+  if (!slots)
+    std::cout << "Warning: " << count << " uniform blocks don't fit into the " << m_Stream.GetRegionSize() << " bytes of a frame" << std::endl;
+  return slots;
+}
+
+void DynamicUniformBuffer::Bind(unsigned int offset) const
+{
+  if (m_Binding == UniformBindings::Invalid)
+    return;
+  GLState::Get().BindUniformBuffer(m_Binding, m_Stream.GetRendererID(), offset, m_Layout.GetSize());
+}
+// ----------------------------------------------------------------
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Renderer.h"
+#include "Math3D.h"
+#include "StreamBuffer.h"
+
+// Packing rules of an interface block, declared in GLSL as layout(std140)
+// or layout(std430). std430 is only allowed for shader storage blocks.
+enum class UniformLayoutRule
+{
+  Std140, Std430
+};
+
+// ------------------------- Block member formats -------------------------
+// GL type, base alignment and size of a block member type. Unsupported
+// types fail to compile here.
+template<typename T>
+struct UniformLayoutTraits;
+
+template<unsigned int T, unsigned int A, unsigned int S, unsigned int C = 1>
+struct UniformFormat
+{
+  static constexpr unsigned int Type = T;
+  static constexpr unsigned int Alignment = A;  // Of a column for matrices
+  static constexpr unsigned int Size = S;       // Of a column for matrices
+  static constexpr unsigned int Columns = C;
+};
+
+template<> struct UniformLayoutTraits<float>        : UniformFormat<GL_FLOAT, 4, 4> {};
+template<> struct UniformLayoutTraits<int>          : UniformFormat<GL_INT, 4, 4> {};
+template<> struct UniformLayoutTraits<unsigned int> : UniformFormat<GL_UNSIGNED_INT, 4, 4> {};
+template<> struct UniformLayoutTraits<Vec2>         : UniformFormat<GL_FLOAT_VEC2, 8, 8> {};
+template<> struct UniformLayoutTraits<Vec3>         : UniformFormat<GL_FLOAT_VEC3, 16, 12> {};
+template<> struct UniformLayoutTraits<Vec4>         : UniformFormat<GL_FLOAT_VEC4, 16, 16> {};
+// Matrices are arrays of column vectors
+template<> struct UniformLayoutTraits<Mat3>         : UniformFormat<GL_FLOAT_MAT3, 16, 12, 3> {};
+template<> struct UniformLayoutTraits<Mat4>         : UniformFormat<GL_FLOAT_MAT4, 16, 16, 4> {};
+// -----------------------------------------------------------------------
+
+// Where a member lives inside the block
+struct UniformMember
+{
+  unsigned int Type = 0;
+  unsigned int Offset = 0;
+  unsigned int Count = 0;         // Array elements, 1 for non-arrays
+  unsigned int ArrayStride = 0;   // Bytes between array elements
+  unsigned int MatrixStride = 0;  // Bytes between matrix columns, 0 for vectors
+};
+
+struct UniformBufferElement
+{
+  std::string Name;
+  UniformMember Member;
+};
+
+// Offsets of the members of a uniform or storage block, computed with
+// the std140 or std430 rules the same way VertexBufferLayout computes
+// vertex strides. Push in declaration order:
+//
+//   layout(std140) uniform Camera { mat4 u_ViewProjection; vec3 u_Eye; float u_Time; };
+//
+//   UniformBufferLayout layout;
+//   UniformMember viewProjection = layout.Push<Mat4>("u_ViewProjection");
+//   UniformMember eye = layout.Push<Vec3>("u_Eye");
+//   UniformMember time = layout.Push<float>("u_Time");  // Packs after the vec3
+class UniformBufferLayout
+{
+private:
+  UniformLayoutRule m_Rule;
+  std::vector<UniformBufferElement> m_Elements;
+  unsigned int m_Size;
+  unsigned int m_Alignment;  // Largest member alignment, the block size is a multiple
+public:
+  UniformBufferLayout(UniformLayoutRule rule = UniformLayoutRule::Std140)
+    : m_Rule(rule), m_Size(0), m_Alignment(rule == UniformLayoutRule::Std140 ? 16 : 4) {}
+
+  // count > 1 pushes an array of count elements
+  template<typename T>
+  UniformMember Push(const std::string& name, unsigned int count = 1)
+  {
+    using Traits = UniformLayoutTraits<T>;
+    ASSERT(count >= 1);
+
+    // Arrays and matrix columns are strided by the element alignment,
+    // which std140 rounds up to a vec4
+    bool strided = count > 1 || Traits::Columns > 1;
+    unsigned int alignment = Traits::Alignment;
+    if (strided && m_Rule == UniformLayoutRule::Std140)
+      alignment = 16;
+    unsigned int columnStride = strided ? RoundUp(Traits::Size, alignment) : Traits::Size;
+
+    UniformMember member;
+    member.Type = Traits::Type;
+    member.Offset = RoundUp(m_Size, alignment);
+    member.Count = count;
+    member.MatrixStride = Traits::Columns > 1 ? columnStride : 0;
+    member.ArrayStride = columnStride * Traits::Columns;
+
+    // A member after an array or matrix starts at the next multiple of its alignment
+    m_Size = member.Offset + (strided ? member.ArrayStride * count : Traits::Size);
+    if (strided)
+      m_Size = RoundUp(m_Size, alignment);
+    if (alignment > m_Alignment)
+      m_Alignment = alignment;
+
+    m_Elements.push_back({ name, member });
+    return member;
+  }
+
+  // Member pushed under name, a default member (Count 0) if there is none
+  UniformMember Find(const std::string& name) const;
+
+  // Size of the block as GL reports it (GL_UNIFORM_BLOCK_DATA_SIZE)
+  inline unsigned int GetSize() const { return RoundUp(m_Size, m_Alignment); }
+  inline UniformLayoutRule GetRule() const { return m_Rule; }
+  inline const std::vector<UniformBufferElement>& GetElements() const { return m_Elements; }
+
+  // Compares size and offsets with what the linker assigned to the block
+  // in a program, printing every difference. Meant for an ASSERT at load.
+  bool Matches(unsigned int program, const std::string& blockName) const;
+
+  // Writes value into block memory laid out by this class, e.g. memory
+  // from DynamicUniformBuffer::Allocate. Matrix columns are spread out
+  // to the matrix stride.
+  template<typename T>
+  static void Write(void* block, const UniformMember& member, const T& value, unsigned int index = 0)
+  {
+    using Traits = UniformLayoutTraits<T>;
+    ASSERT(member.Type == Traits::Type && index < member.Count);
+    unsigned char* destination = (unsigned char*)block + member.Offset + index * member.ArrayStride;
+    if (Traits::Columns == 1)
+    {
+      memcpy(destination, &value, Traits::Size);
+      return;
+    }
+    const unsigned char* source = (const unsigned char*)&value;
+    for (unsigned int column = 0; column < Traits::Columns; column++)
+      memcpy(destination + column * member.MatrixStride, source + column * Traits::Size, Traits::Size);
+  }
+private:
+  static constexpr unsigned int RoundUp(unsigned int value, unsigned int alignment)
+  {
+    return (value + alignment - 1) / alignment * alignment;
+  }
+};
+
+// Binding points of uniform blocks, assigned per block name the first
+// time a name is seen. Shader binds every block it links to the point of
+// its name, so a buffer bound to UniformBindings::Get("Camera") feeds the
+// Camera block of every program without any per-program calls.
+// At most GLState::MaxUniformBindings names, later ones get Invalid and
+// their blocks and buffers stay unbound. GL thread only.
+class UniformBindings
+{
+public:
+  static const unsigned int Invalid = ~0u;
+
+  static unsigned int Get(const std::string& blockName);
+};
+
+// Block data shared by many draws and programs, e.g. camera matrices and
+// time. Set() writes to a CPU copy, Upload() sends the changed bytes in
+// one glBufferSubData.
+class UniformBuffer
+{
+private:
+  unsigned int m_RendererID;
+  unsigned int m_Binding;
+  UniformBufferLayout m_Layout;
+  std::vector<unsigned char> m_Data;
+  unsigned int m_DirtyBegin, m_DirtyEnd;
+public:
+  UniformBuffer(const std::string& blockName, const UniformBufferLayout& layout);
+  ~UniformBuffer();
+
+  UniformBuffer(const UniformBuffer&) = delete;
+  UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+  template<typename T>
+  void Set(const UniformMember& member, const T& value, unsigned int index = 0)
+  {
+    UniformBufferLayout::Write(m_Data.data(), member, value, index);
+    unsigned int begin = member.Offset + index * member.ArrayStride;
+    m_DirtyBegin = std::min(m_DirtyBegin, begin);
+    m_DirtyEnd = std::min(std::max(m_DirtyEnd, begin + member.ArrayStride), (unsigned int)m_Data.size());
+  }
+
+  // Sends everything Set since the last upload, call before drawing
+  void Upload();
+  // Binds the whole buffer to the block's binding point
+  void Bind() const;
+
+  inline unsigned int GetRendererID() const { return m_RendererID; }
+  inline unsigned int GetBinding() const { return m_Binding; }
+  inline const UniformBufferLayout& GetLayout() const { return m_Layout; }
+};
+
+// Per-draw block data for thousands of draws. Every draw gets its own
+// slot in a StreamBuffer ring, the whole frame is written straight into
+// GL memory and each draw only binds its slot with glBindBufferRange:
+//
+//   unsigned int offset;
+//   unsigned char* slots = objects.Allocate(count, offset);
+//   UniformBufferLayout::Write(slots + i * objects.GetStride(), model, matrix);
+//   objects.Flush();
+//   ... objects.Bind(offset + i * objects.GetStride()); draw i ...
+//   objects.EndFrame();
+//
+// Allocate, Flush, Bind and EndFrame are GL thread only, but the slots
+// can be filled from any thread in between.
+class DynamicUniformBuffer
+{
+private:
+  StreamBuffer m_Stream;
+  unsigned int m_Binding;
+  UniformBufferLayout m_Layout;
+  unsigned int m_Stride;  // Block size rounded to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+public:
+  // maxSlotsPerFrame slots fit into a frame before the ring has to wrap
+  DynamicUniformBuffer(const std::string& blockName, const UniformBufferLayout& layout, unsigned int maxSlotsPerFrame);
+
+  // Memory for count consecutive slots, GetStride() bytes apart. offset
+  // receives the buffer offset of the first one.
+  unsigned char* Allocate(unsigned int count, unsigned int& offset);
+  // Makes the slots allocated so far visible to GL, call before drawing
+  inline void Flush() { m_Stream.Flush(); }
+  inline void EndFrame() { m_Stream.EndFrame(); }
+
+  // Binds the slot at offset to the block's binding point
+  void Bind(unsigned int offset) const;
+
+  inline unsigned int GetStride() const { return m_Stride; }
+  inline unsigned int GetBinding() const { return m_Binding; }
+  inline const UniformBufferLayout& GetLayout() const { return m_Layout; }
+  inline const StreamBuffer::Stats& GetStats() const { return m_Stream.GetStats(); }
+};
@@ -1,39 +1,88 @@
 #include "VertexArray.h"
 
+#include <cstdint>
+#include <utility>
+
 #include "VertexBufferLayout.h"
 #include "Renderer.h"
+#include "GLState.h"
 
 VertexArray::VertexArray()
+  : m_AttribIndex(0)
 {
   GLCall(glGenVertexArrays(1, &m_RendererID));
 }
 
 VertexArray::~VertexArray()
 {
+  if (!m_RendererID)
+    return;
   GLCall(glDeleteVertexArrays(1, &m_RendererID));
+  GLState::Get().OnDeleteVertexArray(m_RendererID);
+}
+
+VertexArray::VertexArray(VertexArray&& other) noexcept
+  : m_RendererID(0), m_AttribIndex(0)
+{
+  Swap(other);
+}
+
+VertexArray& VertexArray::operator=(VertexArray&& other) noexcept
+{
+  // Our old vertex array is deleted along with the temporary
+  VertexArray moved(std::move(other));
+  Swap(moved);
+  return *this;
+}
+
+void VertexArray::Swap(VertexArray& other)
+{
+  std::swap(m_RendererID, other.m_RendererID);
+  std::swap(m_AttribIndex, other.m_AttribIndex);
 }
 
 void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
+{
+  const auto& elements = layout.GetElements();
+  AddBuffer(vb, elements.data(), (unsigned int)elements.size(), layout.GetStride());
+}
+
+void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferElement* elements, unsigned int count, unsigned int stride)
 {
   Bind();
   vb.Bind();
-  const auto& elements = layout.GetElements();
-  unsigned int offset = 0;
-  for (unsigned int i = 0; i < elements.size(); i++)
+  for (unsigned int i = 0; i < count; i++)
   {
     const auto& element = elements[i];
-    GLCall(glEnableVertexAttribArray(i));
-    GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.GetStride(), (const void*)offset));
-    offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+    for (unsigned int column = 0; column < element.columns; column++)
+    {
+      unsigned int index = m_AttribIndex++;
+      const void* offset = (const void*)(uintptr_t)(element.offset + column * element.GetSize());
+      // Packed types always have 4 components
+      int size = element.type == GL_INT_2_10_10_10_REV ? 4 : element.count;
+      GLCall(glEnableVertexAttribArray(index));
+      if (element.integer)
+      {
+        GLCall(glVertexAttribIPointer(index, size, element.type, stride, offset));
+      }
+      else
+      {
+        GLCall(glVertexAttribPointer(index, size, element.type, element.normalized, stride, offset));
+      }
+      if (element.divisor)
+      {
+        GLCall(glVertexAttribDivisor(index, element.divisor));
+      }
+    }
   }
 }
 
 void VertexArray::Bind() const
 {
-  GLCall(glBindVertexArray(m_RendererID));
+  GLState::Get().BindVertexArray(m_RendererID);
 }
 
 void VertexArray::Unbind() const
 {
-  GLCall(glBindVertexArray(0));
+  GLState::Get().BindVertexArray(0);
 }
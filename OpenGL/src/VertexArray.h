@@ -3,17 +3,40 @@
 #include "VertexBuffer.h"
 
 class VertexBufferLayout;
+struct VertexBufferElement;
 
 class VertexArray
 {
 private:
   unsigned int m_RendererID;
+  // Next free attribute index, buffers added later continue from here
+  unsigned int m_AttribIndex;
 public:
   VertexArray();
   ~VertexArray();
 
+  // Move-only, a moved-from vertex array owns nothing
+  VertexArray(VertexArray&& other) noexcept;
+  VertexArray& operator=(VertexArray&& other) noexcept;
+  VertexArray(const VertexArray&) = delete;
+  VertexArray& operator=(const VertexArray&) = delete;
+
+  // Each buffer's attributes take the indices following the previous
+  // buffer's, e.g. per-vertex data at 0-1 and per-instance data from 2 on
   void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
 
+  // Compile-time layout of a vertex struct, see StaticVertexLayout
+  template<typename Layout>
+  void AddBuffer(const VertexBuffer& vb, const Layout&)
+  {
+    AddBuffer(vb, Layout::Elements, Layout::ElementCount, Layout::Stride);
+  }
+
   void Bind() const;
   void Unbind() const;
+
+  inline unsigned int GetRendererID() const { return m_RendererID; }
+private:
+  void AddBuffer(const VertexBuffer& vb, const VertexBufferElement* elements, unsigned int count, unsigned int stride);
+  void Swap(VertexArray& other);
 };
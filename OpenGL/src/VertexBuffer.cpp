@@ -1,24 +1,79 @@
 #include "VertexBuffer.h"
+
+#include <utility>
+
 #include "Renderer.h"
+#include "GLState.h"
 
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
+  : m_Size(size)
 {
   GLCall(glGenBuffers(1, &m_RendererID));
-  GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+  GLState::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
   GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
 }
 
+VertexBuffer::VertexBuffer(unsigned int size, BufferUsage usage)
+  : m_Size(size)
+{
+  if (usage == BufferUsage::Stream)
+  {
+    m_Stream.reset(new StreamBuffer(GL_ARRAY_BUFFER, size));
+    m_RendererID = m_Stream->GetRendererID();
+    // The orphaning fallback allocates a single region
+    m_Size = m_Stream->IsPersistent() ? size * StreamBuffer::RegionCount : size;
+    return;
+  }
+
+  GLCall(glGenBuffers(1, &m_RendererID));
+  GLState::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+  GLCall(glBufferData(GL_ARRAY_BUFFER, size, nullptr, usage == BufferUsage::Static ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW));
+}
+
 VertexBuffer::~VertexBuffer()
 {
+  // The stream owns its buffer
+  if (m_Stream || !m_RendererID)
+    return;
+
   GLCall(glDeleteBuffers(1, &m_RendererID));
+  GLState::Get().OnDeleteBuffer(m_RendererID);
+}
+
+VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept
+  : m_RendererID(0), m_Size(0)
+{
+  Swap(other);
+}
+
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept
+{
+  // Our old buffer is deleted along with the temporary
+  VertexBuffer moved(std::move(other));
+  Swap(moved);
+  return *this;
+}
+
+void VertexBuffer::Swap(VertexBuffer& other)
+{
+  std::swap(m_RendererID, other.m_RendererID);
+  std::swap(m_Size, other.m_Size);
+  std::swap(m_Stream, other.m_Stream);
+}
+
+void VertexBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+  ASSERT(!m_Stream);
+  Bind();
+  GLCall(glBufferSubData(GL_ARRAY_BUFFER, offset, size, data));
 }
 
 void VertexBuffer::Bind() const
 {
-  GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+  GLState::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
 }
 
 void VertexBuffer::Unbind() const
 {
-  GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+  GLState::Get().BindBuffer(GL_ARRAY_BUFFER, 0);
 }
@@ -1,13 +1,39 @@
 #pragma once
 
+#include <memory>
+
+#include "StreamBuffer.h"
+
 class VertexBuffer
 {
 private:
   unsigned int m_RendererID;
+  unsigned int m_Size;
+  std::unique_ptr<StreamBuffer> m_Stream;
 public:
   VertexBuffer(const void* data, unsigned int size);
+  // Allocates an empty buffer of the given size for data that changes.
+  // With BufferUsage::Stream, size is the number of bytes per frame.
+  VertexBuffer(unsigned int size, BufferUsage usage = BufferUsage::Dynamic);
   ~VertexBuffer();
 
+  // Move-only, a moved-from buffer owns nothing
+  VertexBuffer(VertexBuffer&& other) noexcept;
+  VertexBuffer& operator=(VertexBuffer&& other) noexcept;
+  VertexBuffer(const VertexBuffer&) = delete;
+  VertexBuffer& operator=(const VertexBuffer&) = delete;
+
+  // Dynamic buffers only
+  void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+  // Ring to write per-frame data to, nullptr unless BufferUsage::Stream
+  inline StreamBuffer* GetStream() const { return m_Stream.get(); }
+
   void Bind() const;
   void Unbind() const;
+
+  inline unsigned int GetRendererID() const { return m_RendererID; }
+  // Bytes of buffer storage, every region of a stream
+  inline unsigned int GetSize() const { return m_Size; }
+private:
+  void Swap(VertexBuffer& other);
 };
@@ -1,29 +1,183 @@
 #pragma once
 
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <vector>
 #include "Renderer.h"
 
+// ------------------------ Compact vertex formats ------------------------
+// 16-bit float (GL_HALF_FLOAT), e.g. for texture coordinates
+struct Half
+{
+  uint16_t Bits;
+
+  Half() = default;
+  Half(float value)
+    : Bits(FromFloat(value)) {}
+
+  // Round to nearest even, overflow goes to infinity
+  static uint16_t FromFloat(float value)
+  {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t abs = bits & 0x7fffffff;
+    int exponent = (int)(abs >> 23);
+
+    if (exponent == 255)  // Inf and NaN
+      return (uint16_t)(sign | 0x7c00 | (abs & 0x7fffff ? 0x200 : 0));
+    if (exponent >= 143)  // >= 2^16
+      return (uint16_t)(sign | 0x7c00);
+    if (exponent < 102)   // < 2^-25 rounds to zero
+      return (uint16_t)sign;
+
+    uint32_t half, remainder, halfway;
+    if (exponent < 113)
+    {
+      // Subnormal half, in units of 2^-24
+      uint32_t mantissa = (abs & 0x7fffff) | 0x800000;
+      unsigned int shift = 126 - exponent;
+      half = mantissa >> shift;
+      remainder = mantissa & ((1u << shift) - 1);
+      halfway = 1u << (shift - 1);
+    }
+    else
+    {
+      half = ((exponent - 112) << 10) | ((abs >> 13) & 0x3ff);
+      remainder = abs & 0x1fff;
+      halfway = 0x1000;
+    }
+    // A carry out of the mantissa correctly bumps the exponent
+    if (remainder > halfway || (remainder == halfway && (half & 1)))
+      half++;
+    return (uint16_t)(sign | half);
+  }
+};
+
+// Signed 16-bit integer read as [-1, 1]
+struct NormShort
+{
+  int16_t Value;
+
+  NormShort() = default;
+  NormShort(float value)
+    : Value((int16_t)lroundf(fminf(fmaxf(value, -1.0f), 1.0f) * 32767.0f)) {}
+};
+
+// Unsigned 16-bit integer read as [0, 1]
+struct NormUShort
+{
+  uint16_t Value;
+
+  NormUShort() = default;
+  NormUShort(float value)
+    : Value((uint16_t)lroundf(fminf(fmaxf(value, 0.0f), 1.0f) * 65535.0f)) {}
+};
+
+// Four signed normalized components in one GL_INT_2_10_10_10_REV word,
+// 10 bits each for x, y and z and 2 for w. Meant for normals and tangents.
+struct PackedNormal
+{
+  uint32_t Bits;
+
+  PackedNormal() = default;
+  PackedNormal(float x, float y, float z, float w = 0.0f)
+    : Bits(Pack(x, 10) | Pack(y, 10) << 10 | Pack(z, 10) << 20 | Pack(w, 2) << 30) {}
+
+private:
+  static uint32_t Pack(float value, unsigned int bits)
+  {
+    int max = (1 << (bits - 1)) - 1;
+    int v = (int)lroundf(fminf(fmaxf(value, -1.0f), 1.0f) * max);
+    return (uint32_t)v & ((1u << bits) - 1);
+  }
+};
+// -----------------------------------------------------------------------
+
 struct VertexBufferElement
 {
   unsigned int type;
   unsigned int count;
   unsigned char normalized;
+  // Instances drawn before the attribute advances, 0 advances per vertex
+  unsigned int divisor;
+  // Matrices take one attribute slot per column of count components
+  unsigned int columns;
+  // Read as int/uint in the shader (glVertexAttribIPointer) instead of float
+  bool integer;
+  // Byte offset of the first column within the vertex
+  unsigned int offset;
 
-  static unsigned int GetSizeOfType(unsigned int type)
+  static constexpr unsigned int GetSizeOfType(unsigned int type)
   {
     switch (type)
     {
-      case GL_FLOAT:          return 4;
-      case GL_UNSIGNED_INT:   return 4;
-      case GL_UNSIGNED_BYTE:  return 1;
+      case GL_FLOAT:                return 4;
+      case GL_HALF_FLOAT:           return 2;
+      case GL_INT:                  return 4;
+      case GL_UNSIGNED_INT:         return 4;
+      case GL_SHORT:                return 2;
+      case GL_UNSIGNED_SHORT:       return 2;
+      case GL_BYTE:                 return 1;
+      case GL_UNSIGNED_BYTE:        return 1;
+      // Packed types hold every component in one word
+      case GL_INT_2_10_10_10_REV:   return 4;
     }
     ASSERT(false);
     return 0;
   }
+
+  // Bytes taken by one column
+  constexpr unsigned int GetSize() const
+  {
+    return type == GL_INT_2_10_10_10_REV ? 4 : count * GetSizeOfType(type);
+  }
+};
+
+// Attribute format of a vertex member type. Unsupported types fail to
+// compile here instead of being silently skipped.
+template<typename T>
+struct VertexAttribTraits;
+
+template<unsigned int T, bool N, bool I, unsigned int C = 1>
+struct VertexAttribFormat
+{
+  static constexpr unsigned int Type = T;
+  static constexpr unsigned int Count = C;
+  static constexpr unsigned int Columns = 1;
+  static constexpr bool Normalized = N;
+  static constexpr bool Integer = I;
 };
 
-template<typename Tl>
-struct identity { typedef Tl type; };
+template<> struct VertexAttribTraits<float>          : VertexAttribFormat<GL_FLOAT, false, false> {};
+template<> struct VertexAttribTraits<Half>           : VertexAttribFormat<GL_HALF_FLOAT, false, false> {};
+template<> struct VertexAttribTraits<NormShort>      : VertexAttribFormat<GL_SHORT, true, false> {};
+template<> struct VertexAttribTraits<NormUShort>     : VertexAttribFormat<GL_UNSIGNED_SHORT, true, false> {};
+template<> struct VertexAttribTraits<unsigned char>  : VertexAttribFormat<GL_UNSIGNED_BYTE, true, false> {};
+template<> struct VertexAttribTraits<PackedNormal>   : VertexAttribFormat<GL_INT_2_10_10_10_REV, true, false, 4> {};
+template<> struct VertexAttribTraits<int>            : VertexAttribFormat<GL_INT, false, true> {};
+template<> struct VertexAttribTraits<unsigned int>   : VertexAttribFormat<GL_UNSIGNED_INT, false, true> {};
+template<> struct VertexAttribTraits<short>          : VertexAttribFormat<GL_SHORT, false, true> {};
+template<> struct VertexAttribTraits<unsigned short> : VertexAttribFormat<GL_UNSIGNED_SHORT, false, true> {};
+template<> struct VertexAttribTraits<signed char>    : VertexAttribFormat<GL_BYTE, false, true> {};
+
+// T[N] is a vector of N scalars, T[N][M] a matrix of N columns
+template<typename T, size_t N>
+struct VertexAttribTraits<T[N]>
+{
+private:
+  using Inner = VertexAttribTraits<T>;
+  static constexpr bool IsMatrix = Inner::Count > 1;
+  static_assert(Inner::Columns == 1, "vertex attributes have at most two dimensions");
+public:
+  static constexpr unsigned int Type = Inner::Type;
+  static constexpr unsigned int Count = IsMatrix ? Inner::Count : (unsigned int)N;
+  static constexpr unsigned int Columns = IsMatrix ? (unsigned int)N : 1;
+  static constexpr bool Normalized = Inner::Normalized;
+  static constexpr bool Integer = Inner::Integer;
+};
 
 class VertexBufferLayout
 {
@@ -34,35 +188,98 @@ public:
   VertexBufferLayout()
     : m_Stride(0) {}
 
+  // count components of T, e.g. Push<Half>(2) for half-float texture
+  // coordinates. Integer types other than unsigned char become integer
+  // attributes; PackedNormal takes all four components with a count of 1.
   template<typename T>
-  void Push(unsigned int count)
+  void Push(unsigned int count, unsigned int divisor = 0)
   {
-    Push(count, identity<T>());
+    using Traits = VertexAttribTraits<T>;
+    static_assert(Traits::Columns == 1, "use PushMat3/PushMat4 for matrices");
+    if (Traits::Count > 1)
+    {
+      ASSERT(count == 1);
+      count = Traits::Count;
+    }
+    Push({ Traits::Type, count, Traits::Normalized ? GL_TRUE : GL_FALSE, divisor, 1, Traits::Integer, m_Stride });
   }
 
-  inline const std::vector<VertexBufferElement> GetElements() const { return m_Elements; }
-  inline unsigned int GetStride() const { return m_Stride; }
+  // Column-major float matrices, spread over 3 or 4 attribute slots
+  void PushMat3(unsigned int divisor = 0)
+  {
+    Push({ GL_FLOAT, 3, GL_FALSE, divisor, 3, false, m_Stride });
+  }
 
-private:
-  template<typename T>
-  void Push(unsigned int count, identity<T>) {}
+  void PushMat4(unsigned int divisor = 0)
+  {
+    Push({ GL_FLOAT, 4, GL_FALSE, divisor, 4, false, m_Stride });
+  }
 
-  void Push(unsigned int count, identity<float>)
+  // Attribute described at runtime, e.g. by a mesh file. type is a GL
+  // component type; for GL_INT_2_10_10_10_REV count has to be 4.
+  void Push(unsigned int type, unsigned int count, bool normalized, bool integer = false, unsigned int divisor = 0)
   {
-    m_Elements.push_back({ GL_FLOAT, count, GL_FALSE });
-    m_Stride += count * VertexBufferElement::GetSizeOfType(GL_FLOAT);
+    Push({ type, count, (unsigned char)(normalized ? GL_TRUE : GL_FALSE), divisor, 1, integer, m_Stride });
   }
 
-  void Push(unsigned int count, identity<unsigned int>)
+  inline const std::vector<VertexBufferElement>& GetElements() const { return m_Elements; }
+  inline unsigned int GetStride() const { return m_Stride; }
+
+private:
+  void Push(const VertexBufferElement& element)
   {
-    m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
-    m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT);
+    ASSERT(element.count >= 1 && element.count <= 4);
+    m_Elements.push_back(element);
+    m_Stride += element.GetSize() * element.columns;
   }
+};
 
-  void Push(unsigned int count, identity<unsigned char>)
+// ------------------------ Compile-time layouts -------------------------
+// Attribute for one member of a vertex struct, see VERTEX_ATTRIB
+template<typename T, size_t Offset, unsigned int Divisor = 0>
+struct VertexAttrib
+{
+  using Traits = VertexAttribTraits<T>;
+  static_assert(Traits::Count >= 1 && Traits::Count <= 4, "vertex attributes have 1 to 4 components");
+
+  static constexpr VertexBufferElement Element = {
+    Traits::Type, Traits::Count, Traits::Normalized ? GL_TRUE : GL_FALSE, Divisor, Traits::Columns, Traits::Integer, (unsigned int)Offset
+  };
+  static_assert(Element.GetSize() * Element.columns == sizeof(T), "member size doesn't match its attribute format");
+};
+
+#define VERTEX_ATTRIB(Vertex, Member) VertexAttrib<decltype(Vertex::Member), offsetof(Vertex, Member)>
+#define VERTEX_ATTRIB_INSTANCED(Vertex, Member, Divisor) VertexAttrib<decltype(Vertex::Member), offsetof(Vertex, Member), Divisor>
+
+constexpr bool IsTightVertexLayout(const VertexBufferElement* elements, size_t count, size_t stride)
+{
+  size_t end = 0;
+  for (size_t i = 0; i < count; i++)
   {
-    m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
-    m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
+    if (elements[i].offset != end)
+      return false;
+    end += elements[i].GetSize() * elements[i].columns;
   }
+  return end == stride;
+}
+
+// Layout of a vertex struct with stride and offsets known at compile time:
+//
+//   using QuadVertexLayout = StaticVertexLayout<QuadVertex,
+//     VERTEX_ATTRIB(QuadVertex, Position),
+//     VERTEX_ATTRIB(QuadVertex, Color)>;
+//   va.AddBuffer(vb, QuadVertexLayout());
+//
+// The attributes have to be listed in member order and cover the whole
+// struct, so a forgotten member or padding fails to compile.
+template<typename Vertex, typename... Attribs>
+struct StaticVertexLayout
+{
+  static constexpr unsigned int Stride = sizeof(Vertex);
+  static constexpr unsigned int ElementCount = sizeof...(Attribs);
+  static constexpr VertexBufferElement Elements[] = { Attribs::Element... };
 
+  static_assert(IsTightVertexLayout(Elements, ElementCount, Stride),
+    "attributes must cover the vertex in member order, without gaps or padding");
 };
+// -----------------------------------------------------------------------
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Renderer.h"
+
+namespace demo {
+
+  // A scene the application can run, selected with --demo <name>.
+  // Constructed and destroyed with a current GL context.
+  class Demo
+  {
+  public:
+    Demo() {}
+    virtual ~Demo() {}
+
+    virtual void OnUpdate(float deltaTime) {}
+    virtual void OnRender(Renderer& renderer) {}
+
+    // Publish time of the simulation snapshot the last OnRender showed,
+    // for latency statistics. 0 for demos without a simulation thread.
+    virtual int64_t GetRenderedStateTime() const { return 0; }
+  };
+
+}
@@ -0,0 +1,116 @@
+#include "DemoBasic.h"
+
+#include <iostream>
+
+namespace demo {
+
+  static const int GridSize = 100;
+
+  DemoBasic::DemoBasic()
+    : m_Shader("OpenGL/res/shaders/Basic.shader"),
+      m_Texture("res/textures/pic.png"),
+      m_BatchShader("OpenGL/res/shaders/Batch.shader"),
+      m_R(0.0f), m_Increment(0.05f)
+  {
+    // -------------------- Data to be sent to the GPU --------------------
+    float positions[] = {
+      -0.5f, -0.5f, 0.0f, 0.0f, // 0
+       0.5f, -0.5f, 1.0f, 0.0f, // 1
+       0.5f,  0.5f, 0.0f, 1.0f, // 2
+      -0.5f,  0.5f, 1.0f, 1.0f  // 3
+    };
+
+    // Has to be unsigned
+    unsigned int indices[] = {
+      0, 1, 2,
+      2, 3, 0
+    };
+    // --------------------------------------------------------------------
+
+    // -------- Creating Vertex Buffers and storing the above data --------
+    m_VB.reset(new VertexBuffer(positions, 4 * 4 * sizeof(float)));
+
+    VertexBufferLayout layout;
+    layout.Push<float>(2);
+    layout.Push<float>(2);
+    m_VA.AddBuffer(*m_VB, layout);
+    // --------------------------------------------------------------------
+
+    // -------- Creating Index Buffers and storing the above data ---------
+    // Tip: Index Buffers can also be bound to vao before doing glVertexAttribPointer
+    m_IB.reset(new IndexBuffer(indices, 6));
+    // --------------------------------------------------------------------
+
+    // --------------------------- Set Uniforms ---------------------------
+    m_Shader.Bind();
+    m_Shader.SetUniform4f("u_Color", 0.0f, 0.5f, 0.9f, 1.0f);
+    m_ColorUniform = m_Shader.GetUniformHandle("u_Color");
+    m_MVPUniform = m_Shader.GetUniformHandle("u_MVP");
+    // --------------------------------------------------------------------
+
+    m_Texture.Bind();
+    m_Shader.SetUniform1i("u_Texture", 0);
+
+    // ------------------------ Unbind everything -------------------------
+    m_VA.Unbind();
+    m_VB->Unbind();
+    m_IB->Unbind();
+    m_Shader.Unbind();
+    // --------------------------------------------------------------------
+
+    // Decoded in the background, the grid shows a placeholder until then
+    m_GridTexture = m_TextureLoader.Load("res/textures/pic.png");
+  }
+
+  void DemoBasic::OnUpdate(float deltaTime)
+  {
+    m_TextureLoader.Update();
+
+    TextureLoader::Stats loaderStats = m_TextureLoader.GetStats();
+    if (loaderStats.BytesUploaded || loaderStats.QueuedForDecode || loaderStats.QueuedForUpload)
+      std::cout << "Textures: " << loaderStats.QueuedForDecode << " decoding, " << loaderStats.QueuedForUpload
+        << " waiting for upload, " << loaderStats.Uploading << " uploading, " << loaderStats.Completed << " completed, "
+        << loaderStats.BytesUploaded / 1024 << " KiB in " << loaderStats.Chunks << " chunks" << std::endl;
+
+    if (m_R > 1.0f)
+      m_Increment = -0.05f;
+    if (m_R < 0.0f)
+      m_Increment = 0.05f;
+
+    m_R += m_Increment;
+  }
+
+  void DemoBasic::OnRender(Renderer& renderer)
+  {
+    // Bind everything before drawing (in case stuff changed)
+    m_Shader.Bind();
+    m_Shader.SetUniform4f(m_ColorUniform, m_R, 0.5f, 0.9f, 1.0f);
+
+    // Camera one unit in front of the quad, which sits at the origin and
+    // rocks back and forth with the color
+    Mat4 projection = Mat4::Orthographic(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 10.0f);
+    Mat4 view = Mat4::LookAt(Vec3(0.0f, 0.0f, 1.0f), Vec3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f));
+    Mat4 model = Mat4::Rotate(Vec3(0.0f, 0.0f, 1.0f), (m_R - 0.5f) * 0.2f);
+    m_Shader.SetUniformMat4(m_MVPUniform, projection * view * model);
+
+    renderer.Draw(m_VA, *m_IB, m_Shader);
+
+    // GridSize^2 quads in a single draw call
+    const float cellSize = 2.0f / GridSize;
+    renderer.BeginBatch(m_BatchShader);
+    for (int y = 0; y < GridSize; y++)
+    {
+      for (int x = 0; x < GridSize; x++)
+      {
+        float px = -1.0f + x * cellSize;
+        float py = -1.0f + y * cellSize;
+        if ((x + y) % 8 == 0)
+          renderer.SubmitQuad(px, py, cellSize * 0.9f, cellSize * 0.9f, m_GridTexture->GetTexture());
+        else
+          renderer.SubmitQuad(px, py, cellSize * 0.9f, cellSize * 0.9f, (float)x / GridSize, m_R, (float)y / GridSize, 0.5f);
+      }
+    }
+    renderer.EndBatch();
+  }
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <memory>
+
+#include "Demo.h"
+
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "TextureLoader.h"
+
+namespace demo {
+
+  // Textured quad with an animated color uniform, on top of a batched
+  // grid of quads using an asynchronously loaded texture
+  class DemoBasic : public Demo
+  {
+  private:
+    VertexArray m_VA;
+    std::unique_ptr<VertexBuffer> m_VB;
+    std::unique_ptr<IndexBuffer> m_IB;
+    Shader m_Shader;
+    Texture m_Texture;
+    UniformHandle m_ColorUniform;
+    UniformHandle m_MVPUniform;
+
+    Shader m_BatchShader;
+    TextureLoader m_TextureLoader;
+    std::shared_ptr<AsyncTexture> m_GridTexture;
+
+    // Variables to change Uniforms
+    float m_R;
+    float m_Increment;
+  public:
+    DemoBasic();
+
+    void OnUpdate(float deltaTime) override;
+    void OnRender(Renderer& renderer) override;
+  };
+
+}
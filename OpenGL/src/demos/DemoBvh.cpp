@@ -0,0 +1,189 @@
+#include "DemoBvh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "GLState.h"
+#include "VertexBufferLayout.h"
+
+namespace demo {
+
+  // Half extents of the box the objects are scattered in
+  static const float FieldWidth = 250.0f;
+  static const float FieldHeight = 10.0f;
+  static const float CameraOrbit = 150.0f;
+  // Close enough that only a few percent of the field is in view
+  static const float FarPlane = 100.0f;
+  static const float BobHeight = 3.0f;
+  // Recording jobs per thread, the visible boxes are split evenly
+  static const unsigned int JobsPerThread = 4;
+
+  // Unit cube from -1 to 1, position and normal, four vertices per face
+  struct CubeMesh
+  {
+    std::vector<float> Vertices;
+    std::vector<unsigned int> Indices;
+
+    CubeMesh()
+    {
+      for (int axis = 0; axis < 3; axis++)
+        for (float side : { -1.0f, 1.0f })
+        {
+          unsigned int first = (unsigned int)Vertices.size() / 6;
+          const float u[4] = { -1.0f, 1.0f, 1.0f, -1.0f }, v[4] = { -1.0f, -1.0f, 1.0f, 1.0f };
+          for (int i = 0; i < 4; i++)
+          {
+            float p[3], n[3] = { 0.0f, 0.0f, 0.0f };
+            p[axis] = side;
+            p[(axis + 1) % 3] = u[i];
+            p[(axis + 2) % 3] = v[i];
+            n[axis] = side;
+            Vertices.insert(Vertices.end(), { p[0], p[1], p[2], n[0], n[1], n[2] });
+          }
+          // The corners go counterclockwise seen from the positive side
+          if (side > 0.0f)
+            Indices.insert(Indices.end(), { first, first + 1, first + 2, first + 2, first + 3, first });
+          else
+            Indices.insert(Indices.end(), { first, first + 2, first + 1, first, first + 3, first + 2 });
+        }
+    }
+  };
+
+  static const CubeMesh s_Cube;
+
+  static float Random(float min, float max)
+  {
+    return min + (max - min) * (rand() / (float)RAND_MAX);
+  }
+
+  DemoBvh::DemoBvh(unsigned int boxCount, float aspect)
+    : m_VB(s_Cube.Vertices.data(), (unsigned int)(s_Cube.Vertices.size() * sizeof(float))),
+      m_IB(s_Cube.Indices.data(), (unsigned int)s_Cube.Indices.size()),
+      m_Shader("OpenGL/res/shaders/Culled.shader"), m_Queue(m_Pool.GetThreadCount() * JobsPerThread),
+      m_Aspect(aspect), m_Time(0.0f), m_Frame(0)
+  {
+    VertexBufferLayout layout;
+    layout.Push<float>(3);
+    layout.Push<float>(3);
+    m_VA.AddBuffer(m_VB, layout);
+    m_VA.Unbind();
+
+    m_ViewProjection = m_FrameLayout.Push<Mat4>("u_ViewProjection");
+    ASSERT(m_FrameLayout.Matches(m_Shader.GetRendererID(), "Frame"));
+    m_FrameUniforms.reset(new UniformBuffer("Frame", m_FrameLayout));
+
+    m_Center = m_ObjectLayout.Push<Vec4>("u_Center");
+    m_Extent = m_ObjectLayout.Push<Vec4>("u_Extent");
+    m_Color = m_ObjectLayout.Push<Vec4>("u_Color");
+    ASSERT(m_ObjectLayout.Matches(m_Shader.GetRendererID(), "Object"));
+    m_ObjectUniforms.reset(new DynamicUniformBuffer("Object", m_ObjectLayout, boxCount));
+
+    srand(11);
+    m_Boxes.resize(boxCount);
+    std::vector<Aabb> bounds(boxCount);
+    for (unsigned int i = 0; i < boxCount; i++)
+    {
+      Box& box = m_Boxes[i];
+      box.Center = Vec3(Random(-FieldWidth, FieldWidth), Random(-FieldHeight, FieldHeight), Random(-FieldWidth, FieldWidth));
+      box.Extent = Vec3(Random(0.3f, 2.0f), Random(0.3f, 2.0f), Random(0.3f, 2.0f));
+      for (int c = 0; c < 3; c++)
+        box.Color[c] = Random(0.3f, 1.0f);
+      box.Phase = Random(0.0f, 6.2831853f);
+      if (i % 8 == 0)
+        m_Moving.push_back(i);
+      bounds[i] = Aabb(box.Center - box.Extent, box.Center + box.Extent);
+    }
+    m_Bvh.Build(bounds);
+
+    std::cout << "BVH: " << boxCount << " boxes, " << m_Moving.size() << " moving, " << m_Bvh.GetNodeCount() << " nodes, "
+      << GetSimdLevelName(GetSimdLevel()) << " box tests on " << m_Pool.GetThreadCount() << " threads" << std::endl;
+  }
+
+  void DemoBvh::OnUpdate(float deltaTime)
+  {
+    m_Time += deltaTime;
+
+    for (uint32_t i : m_Moving)
+    {
+      const Box& box = m_Boxes[i];
+      Vec3 center = box.Center + Vec3(0.0f, BobHeight * sinf(m_Time * 2.0f + box.Phase), 0.0f);
+      m_Bvh.SetBox(i, Aabb(center - box.Extent, center + box.Extent));
+    }
+    m_Bvh.Refit();
+  }
+
+  void DemoBvh::OnRender(Renderer& renderer)
+  {
+    // Circles the field at mid height, looking ahead along the orbit
+    float angle = m_Time * 0.1f;
+    Vec3 eye(cosf(angle) * CameraOrbit, 5.0f, sinf(angle) * CameraOrbit);
+    Vec3 ahead(cosf(angle + 0.6f) * CameraOrbit * 0.8f, 0.0f, sinf(angle + 0.6f) * CameraOrbit * 0.8f);
+    Mat4 projection = Mat4::Perspective(1.0472f, m_Aspect, 0.5f, FarPlane);
+    Mat4 viewProjection = projection * Mat4::LookAt(eye, ahead, Vec3(0.0f, 1.0f, 0.0f));
+
+    m_Bvh.Cull(Frustum::FromMatrix(viewProjection), m_Pool, m_Visible);
+
+    m_Queue.BeginFrame();
+    m_FrameUniforms->Set(m_ViewProjection, viewProjection);
+    m_FrameUniforms->Upload();
+    m_FrameUniforms->Bind();
+
+    // Nothing is drawn if the visible boxes don't fit into the ring, but
+    // the frame still ends like any other
+    const unsigned int visibleCount = (unsigned int)m_Visible.size();
+    unsigned int slotsOffset;
+    unsigned char* slots = m_ObjectUniforms->Allocate(visibleCount, slotsOffset);
+    if (slots)
+    {
+      const unsigned int stride = m_ObjectUniforms->GetStride();
+
+      // Only the visible boxes are recorded, split evenly over the jobs
+      const unsigned int jobs = m_Queue.GetCommandBufferCount();
+      const unsigned int perJob = (visibleCount + jobs - 1) / jobs;
+      m_Pool.Run(jobs, [&](unsigned int job, unsigned int thread) {
+        CommandBuffer& commands = m_Queue.GetCommandBuffer(job);
+        commands.Begin();
+
+        unsigned int end = std::min((job + 1) * perJob, visibleCount);
+        for (unsigned int i = job * perJob; i < end; i++)
+        {
+          uint32_t object = m_Visible[i];
+          const Aabb& bounds = m_Bvh.GetBox(object);
+          const Box& box = m_Boxes[object];
+          Vec3 center = bounds.GetCenter();
+
+          // Front to back, so depth testing rejects most hidden pixels
+          DrawCommand* command = commands.Draw(RenderPass::Opaque, Length(center - eye) / FarPlane, m_Shader, m_VA, m_IB);
+          unsigned char* slot = slots + i * stride;
+          UniformBufferLayout::Write(slot, m_Center, Vec4(center, 0.0f));
+          UniformBufferLayout::Write(slot, m_Extent, Vec4(bounds.GetExtent(), 0.0f));
+          UniformBufferLayout::Write(slot, m_Color, Vec4(box.Color[0], box.Color[1], box.Color[2], 1.0f));
+          commands.SetUniformBlock(command, *m_ObjectUniforms, slotsOffset + i * stride);
+        }
+
+        commands.End();
+      });
+
+      m_ObjectUniforms->Flush();
+      GLState::Get().SetDepthTest(true);
+      m_Queue.Execute(renderer);
+      GLState::Get().SetDepthTest(false);
+    }
+    m_ObjectUniforms->EndFrame();
+
+    if (++m_Frame % 60 == 0)
+      PrintStats();
+  }
+
+  void DemoBvh::PrintStats()
+  {
+    const SceneBvh::Stats& stats = m_Bvh.GetStats();
+    const RenderQueue::Stats& queue = m_Queue.GetStats();
+    std::cout << "BVH: " << stats.Visible << " visible, " << stats.Culled << " culled, " << stats.NodesTested << " nodes tested in "
+      << stats.Jobs << " jobs, cull " << stats.CullMs << " ms, refit " << stats.NodesRefit << " nodes in " << stats.RefitMs
+      << " ms, record " << queue.RecordMs << " ms, submit " << queue.SubmitMs << " ms" << std::endl;
+  }
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Demo.h"
+
+#include "IndexBuffer.h"
+#include "RenderQueue.h"
+#include "SceneBvh.h"
+#include "Shader.h"
+#include "ThreadPool.h"
+#include "UniformBuffer.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+
+namespace demo {
+
+  // A field of boxes, 100k by default (--objects), drawn one draw call per
+  // box, but only the boxes a SceneBvh finds in the view frustum. Every
+  // eighth box bobs up and down and is refit into the tree each frame.
+  // Culling and recording the visible draws into a RenderQueue both run
+  // on the thread pool.
+  class DemoBvh : public Demo
+  {
+  private:
+    struct Box
+    {
+      Vec3 Center;
+      Vec3 Extent;
+      float Color[3];
+      float Phase;    // Of the bobbing, moving boxes only
+    };
+
+    VertexArray m_VA;
+    VertexBuffer m_VB;
+    IndexBuffer m_IB;
+    Shader m_Shader;
+    UniformBufferLayout m_FrameLayout;
+    UniformMember m_ViewProjection;
+    std::unique_ptr<UniformBuffer> m_FrameUniforms;
+    // One slot per visible box and frame
+    UniformBufferLayout m_ObjectLayout;
+    UniformMember m_Center;
+    UniformMember m_Extent;
+    UniformMember m_Color;
+    std::unique_ptr<DynamicUniformBuffer> m_ObjectUniforms;
+
+    std::vector<Box> m_Boxes;
+    std::vector<uint32_t> m_Moving;
+    SceneBvh m_Bvh;
+    std::vector<uint32_t> m_Visible;
+    ThreadPool m_Pool;
+    RenderQueue m_Queue;
+    float m_Aspect;
+    float m_Time;
+    unsigned int m_Frame;
+  public:
+    DemoBvh(unsigned int boxCount, float aspect);
+
+    void OnUpdate(float deltaTime) override;
+    void OnRender(Renderer& renderer) override;
+  private:
+    void PrintStats();
+  };
+
+}
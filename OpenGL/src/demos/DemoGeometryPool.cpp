@@ -0,0 +1,118 @@
+#include "DemoGeometryPool.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "FrameArena.h"
+
+namespace demo {
+
+  static const unsigned int Columns = 40;
+  static const unsigned int Rows = 25;
+  // Meshes replaced per frame
+  static const unsigned int Churn = 16;
+  // Fraction of free space lost to holes before the pool is defragmented
+  static const float MaxFragmentation = 0.2f;
+
+  struct ShapeVertex
+  {
+    float Position[2];
+    unsigned char Color[4];
+  };
+
+  DemoGeometryPool::DemoGeometryPool()
+    : m_Pool(16 * 1024, 48 * 1024), m_Shader("OpenGL/res/shaders/Shape.shader"), m_Frame(0)
+  {
+    m_Layout.Push<float>(2);
+    m_Layout.Push<unsigned char>(4);
+    m_RectUniform = m_Shader.GetUniformHandle("u_Rect");
+
+    srand(3);
+    m_Cells.resize(Columns * Rows);
+    for (Cell& cell : m_Cells)
+      cell.Mesh = AddShape();
+    PrintStats();
+  }
+
+  DemoGeometryPool::~DemoGeometryPool()
+  {
+    for (Cell& cell : m_Cells)
+      m_Pool.Remove(cell.Mesh);
+  }
+
+  GeometryHandle DemoGeometryPool::AddShape()
+  {
+    // A fan around the center, stars alternate between two radii
+    bool star = rand() % 3 == 0;
+    unsigned int points = 3 + rand() % 30;
+    unsigned int rim = star ? points * 2 : points;
+    unsigned char inner[4] = { (unsigned char)(rand() % 256), (unsigned char)(rand() % 256), (unsigned char)(rand() % 256), 255 };
+    unsigned char outer[4] = { (unsigned char)(inner[1] / 2), (unsigned char)(inner[2] / 2), (unsigned char)(inner[0] / 2), 255 };
+
+    // Only needed until they're copied into the pool
+    FrameArena& arena = Memory::GetFrameArena();
+    FrameArena::Marker marker = arena.GetMarker();
+    ShapeVertex* vertices = arena.NewArray<ShapeVertex>(rim + 1);
+    vertices[0] = { { 0.0f, 0.0f }, { inner[0], inner[1], inner[2], inner[3] } };
+    for (unsigned int i = 0; i < rim; i++)
+    {
+      float angle = 6.2831853f * i / rim;
+      float radius = star && i % 2 ? 0.45f : 1.0f;
+      vertices[i + 1] = { { cosf(angle) * radius, sinf(angle) * radius }, { outer[0], outer[1], outer[2], outer[3] } };
+    }
+
+    unsigned short* indices = arena.NewArray<unsigned short>(rim * 3);
+    for (unsigned int i = 0; i < rim; i++)
+    {
+      indices[i * 3 + 0] = 0;
+      indices[i * 3 + 1] = (unsigned short)(i + 1);
+      indices[i * 3 + 2] = (unsigned short)((i + 1) % rim + 1);
+    }
+
+    GeometryHandle mesh = m_Pool.Add(m_Layout, vertices, rim + 1, indices, rim * 3, IndexType::UnsignedShort);
+    arena.Rewind(marker);
+    return mesh;
+  }
+
+  void DemoGeometryPool::OnUpdate(float deltaTime)
+  {
+    for (unsigned int i = 0; i < Churn; i++)
+    {
+      Cell& cell = m_Cells[rand() % m_Cells.size()];
+      m_Pool.Remove(cell.Mesh);
+      cell.Mesh = AddShape();
+    }
+
+    if (m_Pool.GetFragmentation() > MaxFragmentation)
+      m_Pool.Defragment();
+  }
+
+  void DemoGeometryPool::OnRender(Renderer& renderer)
+  {
+    const float halfWidth = 1.0f / Columns, halfHeight = 1.0f / Rows;
+
+    m_Shader.Bind();
+    for (unsigned int i = 0; i < m_Cells.size(); i++)
+    {
+      float x = -1.0f + (2 * (i % Columns) + 1) * halfWidth;
+      float y = -1.0f + (2 * (i / Columns) + 1) * halfHeight;
+      m_Shader.SetUniform4f(m_RectUniform, x, y, halfWidth * 0.9f, halfHeight * 0.9f);
+      renderer.Draw(m_Pool, m_Cells[i].Mesh, m_Shader);
+    }
+
+    if (++m_Frame % 60 == 0)
+      PrintStats();
+  }
+
+  void DemoGeometryPool::PrintStats() const
+  {
+    GeometryPool::Stats stats = m_Pool.GetStats();
+    std::cout << "Geometry pool: " << stats.Meshes << " meshes in " << stats.Arenas << " arenas, vertices "
+      << stats.VertexBytes / 1024 << "/" << stats.VertexCapacity / 1024 << " KiB, indices "
+      << stats.IndexBytes / 1024 << "/" << stats.IndexCapacity / 1024 << " KiB, " << stats.FreeRanges << " free ranges ("
+      << m_Pool.GetFragmentation() * 100.0f << "% fragmented), " << stats.Grows << " grows, " << stats.Defragments
+      << " defragments, " << stats.BytesMoved / 1024 << " KiB moved" << std::endl;
+  }
+
+}
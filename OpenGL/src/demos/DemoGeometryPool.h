@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+#include "Demo.h"
+
+#include "GeometryPool.h"
+#include "Shader.h"
+
+namespace demo {
+
+  // A thousand small meshes suballocated from one GeometryPool arena, so
+  // the whole grid is drawn without switching VAOs or buffers. A few
+  // meshes are replaced by differently sized ones every frame, which
+  // fragments the arena until it's defragmented.
+  class DemoGeometryPool : public Demo
+  {
+  private:
+    struct Cell
+    {
+      GeometryHandle Mesh;
+    };
+
+    GeometryPool m_Pool;
+    VertexBufferLayout m_Layout;
+    Shader m_Shader;
+    UniformHandle m_RectUniform;
+    std::vector<Cell> m_Cells;
+    unsigned int m_Frame;
+  public:
+    DemoGeometryPool();
+    ~DemoGeometryPool();
+
+    void OnUpdate(float deltaTime) override;
+    void OnRender(Renderer& renderer) override;
+  private:
+    // Random polygon or star
+    GeometryHandle AddShape();
+    void PrintStats() const;
+  };
+
+}
@@ -0,0 +1,199 @@
+#include "DemoIndirect.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+
+#include "GLState.h"
+
+namespace demo {
+
+  // Half extents of the box the objects are scattered in
+  static const float FieldWidth = 250.0f;
+  static const float FieldHeight = 25.0f;
+  static const float CameraOrbit = 150.0f;
+  static const float FarPlane = 300.0f;
+
+  struct SolidVertex
+  {
+    float Position[3];
+    PackedNormal Normal;
+  };
+
+  // Flat shaded triangle, wound counterclockwise seen from outside
+  static void AddTriangle(std::vector<SolidVertex>& vertices, Vec3 a, Vec3 b, Vec3 c)
+  {
+    Vec3 normal = Normalize(Cross(b - a, c - a));
+    // The solids are convex around the origin
+    if (Dot(normal, a + b + c) < 0.0f)
+    {
+      std::swap(b, c);
+      normal = -normal;
+    }
+    PackedNormal packed(normal.x, normal.y, normal.z);
+    for (const Vec3& p : { a, b, c })
+      vertices.push_back({ { p.x, p.y, p.z }, packed });
+  }
+
+  // Convex solid whose faces are the triangles of points with all edges
+  // of the given length, which covers the tetrahedron, octahedron and
+  // icosahedron. The points have to lie on the unit sphere.
+  static std::vector<SolidVertex> BuildSolid(const std::vector<Vec3>& points, float edge)
+  {
+    std::vector<SolidVertex> vertices;
+    auto isEdge = [&](size_t i, size_t j) { return fabsf(Length(points[i] - points[j]) - edge) < edge * 0.01f; };
+    for (size_t i = 0; i < points.size(); i++)
+      for (size_t j = i + 1; j < points.size(); j++)
+        for (size_t k = j + 1; k < points.size(); k++)
+        {
+          if (isEdge(i, j) && isEdge(j, k) && isEdge(i, k))
+            AddTriangle(vertices, points[i], points[j], points[k]);
+        }
+    return vertices;
+  }
+
+  static std::vector<SolidVertex> BuildCube()
+  {
+    std::vector<SolidVertex> vertices;
+    const float s = 1.0f / sqrtf(3.0f);
+    for (int axis = 0; axis < 3; axis++)
+      for (float side : { -s, s })
+      {
+        // Corners of the face in order around it
+        Vec3 corners[4];
+        const float u[4] = { -s, s, s, -s }, v[4] = { -s, -s, s, s };
+        for (int i = 0; i < 4; i++)
+        {
+          float c[3];
+          c[axis] = side;
+          c[(axis + 1) % 3] = u[i];
+          c[(axis + 2) % 3] = v[i];
+          corners[i] = Vec3(c[0], c[1], c[2]);
+        }
+        AddTriangle(vertices, corners[0], corners[1], corners[2]);
+        AddTriangle(vertices, corners[0], corners[2], corners[3]);
+      }
+    return vertices;
+  }
+
+  static std::vector<Vec3> NormalizePoints(std::vector<Vec3> points)
+  {
+    for (Vec3& p : points)
+      p = Normalize(p);
+    return points;
+  }
+
+  static float Random(float min, float max)
+  {
+    return min + (max - min) * (rand() / (float)RAND_MAX);
+  }
+
+  DemoIndirect::DemoIndirect(unsigned int objectCount, IndirectPath path, float aspect)
+    : m_Shader("OpenGL/res/shaders/Indirect.shader"), m_Aspect(aspect), m_Time(0.0f), m_Frame(0)
+  {
+    m_ViewProjectionUniform = m_Shader.GetUniformHandle("u_ViewProjection");
+    m_TimeUniform = m_Shader.GetUniformHandle("u_Time");
+
+    VertexBufferLayout layout;
+    layout.Push<float>(3);
+    layout.Push<PackedNormal>(1);
+
+    const float phi = (1.0f + sqrtf(5.0f)) * 0.5f;
+    std::vector<Vec3> icosahedron;
+    for (float a : { -1.0f, 1.0f })
+      for (float b : { -phi, phi })
+      {
+        icosahedron.push_back(Vec3(0.0f, a, b));
+        icosahedron.push_back(Vec3(a, b, 0.0f));
+        icosahedron.push_back(Vec3(b, 0.0f, a));
+      }
+    icosahedron = NormalizePoints(icosahedron);
+
+    std::vector<Vec3> tetrahedron = NormalizePoints({ Vec3(1, 1, 1), Vec3(1, -1, -1), Vec3(-1, 1, -1), Vec3(-1, -1, 1) });
+    std::vector<Vec3> octahedron = { Vec3(1, 0, 0), Vec3(-1, 0, 0), Vec3(0, 1, 0), Vec3(0, -1, 0), Vec3(0, 0, 1), Vec3(0, 0, -1) };
+    std::vector<std::vector<SolidVertex>> solids = {
+      BuildSolid(tetrahedron, Length(tetrahedron[0] - tetrahedron[1])),
+      BuildCube(),
+      BuildSolid(octahedron, sqrtf(2.0f)),
+      BuildSolid(icosahedron, 2.0f / sqrtf(1.0f + phi * phi))
+    };
+
+    // Vertices aren't shared between the flat faces, so the indices just count
+    for (const std::vector<SolidVertex>& vertices : solids)
+    {
+      std::vector<unsigned short> indices(vertices.size());
+      for (size_t i = 0; i < indices.size(); i++)
+        indices[i] = (unsigned short)i;
+      m_Meshes.push_back(m_Pool.Add(layout, vertices.data(), (unsigned int)vertices.size(),
+        indices.data(), (unsigned int)indices.size(), IndexType::UnsignedShort));
+    }
+
+    // Tinted per solid so the kinds can be told apart
+    const Vec3 tints[] = { Vec3(1.0f, 0.45f, 0.3f), Vec3(0.35f, 0.6f, 1.0f), Vec3(0.45f, 0.9f, 0.4f), Vec3(0.95f, 0.85f, 0.35f) };
+    srand(7);
+    std::vector<IndirectObject> objects(objectCount);
+    for (IndirectObject& object : objects)
+    {
+      object.Mesh = rand() % (unsigned int)m_Meshes.size();
+      object.Sphere[0] = Random(-FieldWidth, FieldWidth);
+      object.Sphere[1] = Random(-FieldHeight, FieldHeight);
+      object.Sphere[2] = Random(-FieldWidth, FieldWidth);
+      object.Sphere[3] = Random(0.5f, 1.5f);
+      Vec3 color = tints[object.Mesh] * Random(0.6f, 1.0f);
+      object.Color[0] = (unsigned char)(color.x * 255.0f);
+      object.Color[1] = (unsigned char)(color.y * 255.0f);
+      object.Color[2] = (unsigned char)(color.z * 255.0f);
+      object.Color[3] = 255;
+      object.Spin[0] = Random(0.0f, 6.2831853f);
+      object.Spin[1] = Random(-2.0f, 2.0f);
+    }
+    m_Scene.reset(new IndirectScene(m_Pool, m_Meshes, objects, path));
+
+    std::cout << "Indirect scene: " << objectCount << " objects, " << IndirectScene::GetPathName(m_Scene->GetPath()) << " path"
+      << (m_Scene->UsesIndirectCount() ? " with indirect count" : "") << std::endl;
+  }
+
+  DemoIndirect::~DemoIndirect()
+  {
+    m_Scene.reset();
+    for (GeometryHandle mesh : m_Meshes)
+      m_Pool.Remove(mesh);
+  }
+
+  void DemoIndirect::OnUpdate(float deltaTime)
+  {
+    m_Time += deltaTime;
+  }
+
+  void DemoIndirect::OnRender(Renderer& renderer)
+  {
+    // Circles the field at mid height, looking ahead along the orbit and
+    // slightly inwards
+    float angle = m_Time * 0.1f;
+    Vec3 eye(cosf(angle) * CameraOrbit, 5.0f, sinf(angle) * CameraOrbit);
+    Vec3 ahead(cosf(angle + 0.6f) * CameraOrbit * 0.8f, 0.0f, sinf(angle + 0.6f) * CameraOrbit * 0.8f);
+    Mat4 projection = Mat4::Perspective(1.0472f, m_Aspect, 0.5f, FarPlane);
+    Mat4 viewProjection = projection * Mat4::LookAt(eye, ahead, Vec3(0.0f, 1.0f, 0.0f));
+
+    m_Shader.Bind();
+    m_Shader.SetUniformMat4(m_ViewProjectionUniform, viewProjection);
+    m_Shader.SetUniform1f(m_TimeUniform, m_Time);
+
+    GLState::Get().SetDepthTest(true);
+    m_Scene->Draw(m_Shader, Frustum::FromMatrix(viewProjection));
+    GLState::Get().SetDepthTest(false);
+
+    if (++m_Frame % 120 == 0)
+      PrintStats();
+  }
+
+  void DemoIndirect::PrintStats()
+  {
+    unsigned int visible = m_Scene->ReadVisibleCount();
+    const IndirectScene::Stats& stats = m_Scene->GetStats();
+    std::cout << "Indirect scene: " << visible << " of " << m_Scene->GetObjectCount() << " objects visible, "
+      << stats.Commands << " commands in " << stats.DrawCalls << " draw calls, culling took " << stats.CullMs << " ms" << std::endl;
+  }
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Demo.h"
+
+#include "GeometryPool.h"
+#include "IndirectScene.h"
+#include "Shader.h"
+
+namespace demo {
+
+  // A field of spinning solids, 100k by default, drawn by an IndirectScene
+  // while the camera circles through it. On the GPU culling path the
+  // whole field costs one compute dispatch and one draw call per frame.
+  // Pick the object count with --objects and the path with --indirect.
+  class DemoIndirect : public Demo
+  {
+  private:
+    GeometryPool m_Pool;
+    std::vector<GeometryHandle> m_Meshes;
+    std::unique_ptr<IndirectScene> m_Scene;
+    Shader m_Shader;
+    UniformHandle m_ViewProjectionUniform;
+    UniformHandle m_TimeUniform;
+    float m_Aspect;
+    float m_Time;
+    unsigned int m_Frame;
+  public:
+    DemoIndirect(unsigned int objectCount, IndirectPath path, float aspect);
+    ~DemoIndirect();
+
+    void OnUpdate(float deltaTime) override;
+    void OnRender(Renderer& renderer) override;
+  private:
+    void PrintStats();
+  };
+
+}
@@ -0,0 +1,90 @@
+#include "DemoInstancing.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "Math3D.h"
+#include "VertexBufferLayout.h"
+
+namespace demo {
+
+  struct InstanceData
+  {
+    unsigned char Color[4];
+    float Transform[4][4];  // Column-major
+  };
+
+  using InstanceLayout = StaticVertexLayout<InstanceData,
+    VERTEX_ATTRIB_INSTANCED(InstanceData, Color, 1),
+    VERTEX_ATTRIB_INSTANCED(InstanceData, Transform, 1)>;
+
+  DemoInstancing::DemoInstancing(unsigned int instanceCount)
+    : m_Shader("OpenGL/res/shaders/Instanced.shader"), m_InstanceCount(instanceCount), m_Time(0.0f)
+  {
+    float positions[] = {
+      -0.5f, -0.5f,
+       0.5f, -0.5f,
+       0.5f,  0.5f,
+      -0.5f,  0.5f
+    };
+    unsigned int indices[] = {
+      0, 1, 2,
+      2, 3, 0
+    };
+
+    // Scattered over the screen with random size, rotation and color
+    std::vector<InstanceData> instances(instanceCount);
+    std::vector<Vec3> translations(instanceCount), scales(instanceCount);
+    std::vector<Quat> rotations(instanceCount);
+    srand(1);
+    for (unsigned int i = 0; i < instanceCount; i++)
+    {
+      float x = rand() / (float)RAND_MAX * 2.0f - 1.0f;
+      float y = rand() / (float)RAND_MAX * 2.0f - 1.0f;
+      float scale = 0.005f + rand() / (float)RAND_MAX * 0.02f;
+      float angle = rand() / (float)RAND_MAX * 6.2831853f;
+      translations[i] = Vec3(x, y, 0.0f);
+      scales[i] = Vec3(scale, scale, 1.0f);
+      rotations[i] = Quat::FromAxisAngle(Vec3(0.0f, 0.0f, 1.0f), angle);
+
+      InstanceData& instance = instances[i];
+      instance.Color[0] = (unsigned char)((x + 1.0f) * 127.5f);
+      instance.Color[1] = (unsigned char)((y + 1.0f) * 127.5f);
+      instance.Color[2] = (unsigned char)(rand() % 256);
+      instance.Color[3] = 255;
+    }
+
+    std::vector<Mat4> transforms(instanceCount);
+    ComposeTransforms(translations.data(), rotations.data(), scales.data(), transforms.data(), instanceCount);
+    for (unsigned int i = 0; i < instanceCount; i++)
+      memcpy(instances[i].Transform, transforms[i].Data(), sizeof(instances[i].Transform));
+
+    m_QuadVB.reset(new VertexBuffer(positions, sizeof(positions)));
+    VertexBufferLayout quadLayout;
+    quadLayout.Push<float>(2);
+    m_VA.AddBuffer(*m_QuadVB, quadLayout);
+
+    // Attribute 1 is the color, 2-5 the columns of the transform
+    m_InstanceVB.reset(new VertexBuffer(instances.data(), (unsigned int)(instances.size() * sizeof(InstanceData))));
+    m_VA.AddBuffer(*m_InstanceVB, InstanceLayout());
+
+    m_IB.reset(new IndexBuffer(indices, 6));
+    m_VA.Unbind();
+
+    m_TimeUniform = m_Shader.GetUniformHandle("u_Time");
+  }
+
+  void DemoInstancing::OnUpdate(float deltaTime)
+  {
+    m_Time += deltaTime;
+  }
+
+  void DemoInstancing::OnRender(Renderer& renderer)
+  {
+    m_Shader.Bind();
+    m_Shader.SetUniform1f(m_TimeUniform, m_Time);
+    renderer.DrawInstanced(m_VA, *m_IB, m_Shader, m_InstanceCount);
+  }
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <memory>
+
+#include "Demo.h"
+
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "Shader.h"
+
+namespace demo {
+
+  // 100k quads with a per-instance transform and color in one draw call
+  class DemoInstancing : public Demo
+  {
+  private:
+    VertexArray m_VA;
+    std::unique_ptr<VertexBuffer> m_QuadVB;
+    std::unique_ptr<VertexBuffer> m_InstanceVB;
+    std::unique_ptr<IndexBuffer> m_IB;
+    Shader m_Shader;
+    UniformHandle m_TimeUniform;
+    unsigned int m_InstanceCount;
+    float m_Time;
+  public:
+    DemoInstancing(unsigned int instanceCount = 100000);
+
+    void OnUpdate(float deltaTime) override;
+    void OnRender(Renderer& renderer) override;
+  };
+
+}
@@ -0,0 +1,48 @@
+#include "DemoMesh.h"
+
+#include "GLState.h"
+
+namespace demo {
+
+  DemoMesh::DemoMesh(const std::string& path, float aspect)
+    : m_Mesh(path), m_Shader("OpenGL/res/shaders/Mesh.shader"), m_Aspect(aspect), m_Time(0.0f)
+  {
+    m_TransformUniform = m_Shader.GetUniformHandle("u_Transform");
+    m_NormalMatrixUniform = m_Shader.GetUniformHandle("u_NormalMatrix");
+  }
+
+  void DemoMesh::OnUpdate(float deltaTime)
+  {
+    m_Time += deltaTime;
+  }
+
+  void DemoMesh::OnRender(Renderer& renderer)
+  {
+    if (!m_Mesh.IsValid())
+      return;
+
+    // Fit the bounds into a unit sphere around the origin
+    Vec3 min(m_Mesh.GetBoundsMin()[0], m_Mesh.GetBoundsMin()[1], m_Mesh.GetBoundsMin()[2]);
+    Vec3 max(m_Mesh.GetBoundsMax()[0], m_Mesh.GetBoundsMax()[1], m_Mesh.GetBoundsMax()[2]);
+    float radius = Length(max - min) * 0.5f;
+    float scale = radius > 0.0f ? 1.0f / radius : 1.0f;
+    Mat4 fit = Mat4::Scale(Vec3(scale, scale, scale)) * Mat4::Translate((min + max) * -0.5f);
+
+    // Spin around y, tilted towards the camera
+    Quat rotation = Quat::FromAxisAngle(Vec3(1.0f, 0.0f, 0.0f), 0.5f) * Quat::FromAxisAngle(Vec3(0.0f, 1.0f, 0.0f), m_Time * 0.7f);
+    Mat4 model = Mat4::FromQuat(rotation) * fit;
+
+    // 60 degree vertical field of view, camera 2.5 units back
+    Mat4 projection = Mat4::Perspective(1.0472f, m_Aspect, 0.1f, 10.0f);
+    Mat4 view = Mat4::LookAt(Vec3(0.0f, 0.0f, 2.5f), Vec3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f));
+
+    m_Shader.Bind();
+    m_Shader.SetUniformMat4(m_TransformUniform, projection * view * model);
+    m_Shader.SetUniformMat3(m_NormalMatrixUniform, NormalMatrix(model));
+
+    GLState::Get().SetDepthTest(true);
+    renderer.Draw(m_Mesh.GetVertexArray(), m_Mesh.GetIndexBuffer(), m_Shader);
+    GLState::Get().SetDepthTest(false);
+  }
+
+}
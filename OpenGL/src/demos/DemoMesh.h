@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Demo.h"
+
+#include "Mesh.h"
+#include "Shader.h"
+
+namespace demo {
+
+  // Spinning cooked mesh, drawn with depth testing. Cook the sample with
+  //   MeshCooker OpenGL/res/meshes/torus.obj OpenGL/res/meshes/torus.cmesh
+  class DemoMesh : public Demo
+  {
+  private:
+    Mesh m_Mesh;
+    Shader m_Shader;
+    UniformHandle m_TransformUniform;
+    UniformHandle m_NormalMatrixUniform;
+    float m_Aspect;
+    float m_Time;
+  public:
+    DemoMesh(const std::string& path, float aspect);
+
+    void OnUpdate(float deltaTime) override;
+    void OnRender(Renderer& renderer) override;
+  };
+
+}
@@ -0,0 +1,159 @@
+#include "DemoRenderQueue.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "VertexBufferLayout.h"
+
+namespace demo {
+
+  // Sprites per recording job, small enough for the pool to balance
+  static const unsigned int SpritesPerJob = 512;
+
+  DemoRenderQueue::DemoRenderQueue(ResourceManager& resources, unsigned int spriteCount)
+    : m_Resources(resources), m_Queue((spriteCount + SpritesPerJob - 1) / SpritesPerJob), m_Time(0.0f), m_Frame(0)
+  {
+    m_Shader = m_Resources.LoadShader("OpenGL/res/shaders/Sprite.shader");
+    Shader& shader = *m_Resources.Get(m_Shader);
+
+    // A quad and a diamond, both with position and texture coordinates
+    const float shapes[MeshCount][16] = {
+      { -1.0f, -1.0f, 0.0f, 0.0f,   1.0f, -1.0f, 1.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,   -1.0f, 1.0f, 0.0f, 1.0f },
+      {  0.0f, -1.0f, 0.5f, 0.0f,   1.0f,  0.0f, 1.0f, 0.5f,   0.0f, 1.0f, 0.5f, 1.0f,   -1.0f, 0.0f, 0.0f, 0.5f }
+    };
+    const unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+    // Both meshes end up with the same index buffer
+    for (unsigned int i = 0; i < MeshCount; i++)
+    {
+      Mesh& mesh = m_Meshes[i];
+      mesh.VB = m_Resources.CreateVertexBuffer(shapes[i], sizeof(shapes[i]));
+      VertexBufferLayout layout;
+      layout.Push<float>(2);
+      layout.Push<float>(2);
+      mesh.VA.AddBuffer(*m_Resources.Get(mesh.VB), layout);
+      mesh.IB = m_Resources.CreateIndexBuffer(indices, 6, IndexType::UnsignedInt);
+    }
+    m_Meshes[0].VA.Unbind();
+
+    unsigned int white = 0xffffffff;
+    unsigned int checker[8 * 8];
+    for (unsigned int i = 0; i < 8 * 8; i++)
+      checker[i] = ((i / 8 + i % 8) % 2) ? 0xffffffff : 0xff404040;
+    m_Textures[0] = m_Resources.CreateTexture(1, 1, &white);
+    m_Textures[1] = m_Resources.CreateTexture(8, 8, checker);
+    m_Textures[2] = m_Resources.LoadTexture("res/textures/pic.png");
+
+    shader.Bind();
+    shader.SetUniform1i("u_Texture", 0);
+
+    m_ViewProjection = m_FrameLayout.Push<Mat4>("u_ViewProjection");
+    ASSERT(m_FrameLayout.Matches(shader.GetRendererID(), "Frame"));
+    m_FrameUniforms.reset(new UniformBuffer("Frame", m_FrameLayout));
+
+    m_Rect = m_SpriteLayout.Push<Vec4>("u_Rect");
+    m_Color = m_SpriteLayout.Push<Vec4>("u_Color");
+    ASSERT(m_SpriteLayout.Matches(shader.GetRendererID(), "Sprite"));
+    m_SpriteUniforms.reset(new DynamicUniformBuffer("Sprite", m_SpriteLayout, spriteCount));
+
+    // Random order, so an immediate-mode renderer would switch state on
+    // almost every draw
+    srand(2);
+    m_Sprites.resize(spriteCount);
+    for (Sprite& sprite : m_Sprites)
+    {
+      sprite.X = rand() / (float)RAND_MAX * 2.0f - 1.0f;
+      sprite.Y = rand() / (float)RAND_MAX * 2.0f - 1.0f;
+      sprite.Size = 0.01f + rand() / (float)RAND_MAX * 0.03f;
+      sprite.Depth = rand() / (float)RAND_MAX;
+      sprite.Mesh = rand() % MeshCount;
+      sprite.Texture = rand() % TextureCount;
+      for (int c = 0; c < 3; c++)
+        sprite.Color[c] = 0.3f + rand() / (float)RAND_MAX * 0.7f;
+      // Every fourth sprite is see-through
+      sprite.Color[3] = rand() % 4 == 0 ? 0.5f : 1.0f;
+    }
+  }
+
+  DemoRenderQueue::~DemoRenderQueue()
+  {
+    for (Mesh& mesh : m_Meshes)
+    {
+      m_Resources.Release(mesh.VB);
+      m_Resources.Release(mesh.IB);
+    }
+    for (TextureHandle texture : m_Textures)
+      m_Resources.Release(texture);
+    m_Resources.Release(m_Shader);
+  }
+
+  void DemoRenderQueue::OnUpdate(float deltaTime)
+  {
+    m_Time += deltaTime;
+  }
+
+  void DemoRenderQueue::OnRender(Renderer& renderer)
+  {
+    m_Queue.BeginFrame();
+
+    m_FrameUniforms->Set(m_ViewProjection, Mat4::Orthographic(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f));
+    m_FrameUniforms->Upload();
+    m_FrameUniforms->Bind();
+
+    // Jobs fill their sprites' slots directly, the buffer is only touched
+    // by GL calls on this thread
+    unsigned int slotsOffset;
+    unsigned char* slots = m_SpriteUniforms->Allocate((unsigned int)m_Sprites.size(), slotsOffset);
+    if (!slots)
+      return;
+    const unsigned int stride = m_SpriteUniforms->GetStride();
+
+    // Resolved once, the pointers stay valid while the handles are held
+    Shader& shader = *m_Resources.Get(m_Shader);
+    const IndexBuffer* indexBuffers[MeshCount];
+    const Texture* textures[TextureCount];
+    for (unsigned int i = 0; i < MeshCount; i++)
+      indexBuffers[i] = m_Resources.Get(m_Meshes[i].IB);
+    for (unsigned int i = 0; i < TextureCount; i++)
+      textures[i] = m_Resources.Get(m_Textures[i]);
+
+    // One command buffer per job, so the draw order doesn't depend on scheduling
+    m_Pool.Run(m_Queue.GetCommandBufferCount(), [&](unsigned int job, unsigned int thread) {
+      CommandBuffer& commands = m_Queue.GetCommandBuffer(job);
+      commands.Begin();
+
+      unsigned int end = std::min((job + 1) * SpritesPerJob, (unsigned int)m_Sprites.size());
+      for (unsigned int i = job * SpritesPerJob; i < end; i++)
+      {
+        const Sprite& sprite = m_Sprites[i];
+        float x = sprite.X + 0.02f * sinf(m_Time + i * 0.1f);
+        float y = sprite.Y + 0.02f * cosf(m_Time * 1.3f + i * 0.1f);
+
+        RenderPass pass = sprite.Color[3] < 1.0f ? RenderPass::Transparent : RenderPass::Opaque;
+        DrawCommand* command = commands.Draw(pass, sprite.Depth, shader, m_Meshes[sprite.Mesh].VA,
+          *indexBuffers[sprite.Mesh], textures[sprite.Texture]);
+        unsigned char* slot = slots + i * stride;
+        UniformBufferLayout::Write(slot, m_Rect, Vec4(x, y, sprite.Size, sprite.Size));
+        UniformBufferLayout::Write(slot, m_Color, Vec4(sprite.Color[0], sprite.Color[1], sprite.Color[2], sprite.Color[3]));
+        commands.SetUniformBlock(command, *m_SpriteUniforms, slotsOffset + i * stride);
+      }
+
+      commands.End();
+    });
+
+    m_SpriteUniforms->Flush();
+    m_Queue.Execute(renderer);
+    m_SpriteUniforms->EndFrame();
+
+    if (++m_Frame % 60 == 0)
+    {
+      const RenderQueue::Stats& stats = m_Queue.GetStats();
+      std::cout << "Queue: " << stats.Commands << " commands in " << stats.Buffers << " buffers on " << m_Pool.GetThreadCount() << " threads, record "
+        << stats.RecordMs << " ms (slowest buffer " << stats.RecordMaxMs << " ms), sort " << stats.SortMs
+        << " ms, submit " << stats.SubmitMs << " ms, " << stats.ArenaBytes / 1024 << " KiB" << std::endl;
+    }
+  }
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Demo.h"
+
+#include "VertexArray.h"
+#include "ResourceManager.h"
+#include "RenderQueue.h"
+#include "ThreadPool.h"
+#include "UniformBuffer.h"
+
+namespace demo {
+
+  // Thousands of individual draws in random order, recorded in parallel
+  // into a RenderQueue which sorts them to minimize state changes. Each
+  // draw's rectangle and color live in a slot of one dynamic uniform
+  // buffer, so the whole frame's uniforms are a single upload. Buffers,
+  // textures and the shader come from the ResourceManager.
+  class DemoRenderQueue : public Demo
+  {
+  private:
+    struct Mesh
+    {
+      VertexArray VA;
+      VertexBufferHandle VB;
+      IndexBufferHandle IB;
+    };
+
+    struct Sprite
+    {
+      float X, Y, Size;
+      float Color[4];
+      float Depth;
+      unsigned int Mesh;
+      unsigned int Texture;
+    };
+
+    static const unsigned int MeshCount = 2;
+    static const unsigned int TextureCount = 3;
+
+    ResourceManager& m_Resources;
+    Mesh m_Meshes[MeshCount];
+    TextureHandle m_Textures[TextureCount];
+    ShaderHandle m_Shader;
+    // Shared by every draw, updated once per frame
+    UniformBufferLayout m_FrameLayout;
+    UniformMember m_ViewProjection;
+    std::unique_ptr<UniformBuffer> m_FrameUniforms;
+    // One slot per sprite and frame
+    UniformBufferLayout m_SpriteLayout;
+    UniformMember m_Rect;
+    UniformMember m_Color;
+    std::unique_ptr<DynamicUniformBuffer> m_SpriteUniforms;
+
+    std::vector<Sprite> m_Sprites;
+    ThreadPool m_Pool;
+    RenderQueue m_Queue;
+    float m_Time;
+    unsigned int m_Frame;
+  public:
+    DemoRenderQueue(ResourceManager& resources, unsigned int spriteCount = 10000);
+    ~DemoRenderQueue();
+
+    void OnUpdate(float deltaTime) override;
+    void OnRender(Renderer& renderer) override;
+  };
+
+}
@@ -0,0 +1,77 @@
+#include "DemoShaderVariants.h"
+
+#include <algorithm>
+
+#include "VertexBufferLayout.h"
+
+namespace demo {
+
+  static const unsigned int Columns = 20;
+
+  static const std::vector<ShaderVariants::KeywordSet> MaterialKeywords = {
+    { "", "STRIPES", "CHECKER", "RINGS", "DOTS" },
+    { "", "WARM", "COOL", "MONO", "RAINBOW" },
+    { "", "ANIMATED" },
+    { "", "VIGNETTE" },
+    { "", "OUTLINE" }
+  };
+
+  DemoShaderVariants::DemoShaderVariants()
+    : m_Variants("OpenGL/res/shaders/Material.shader", MaterialKeywords), m_Time(0.0f)
+  {
+    float positions[] = {
+      -1.0f, -1.0f, 0.0f, 0.0f,
+       1.0f, -1.0f, 1.0f, 0.0f,
+       1.0f,  1.0f, 1.0f, 1.0f,
+      -1.0f,  1.0f, 0.0f, 1.0f
+    };
+    unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+    m_VB.reset(new VertexBuffer(positions, sizeof(positions)));
+    VertexBufferLayout layout;
+    layout.Push<float>(2);
+    layout.Push<float>(2);
+    m_VA.AddBuffer(*m_VB, layout);
+    m_IB.reset(new IndexBuffer(indices, 6));
+    m_VA.Unbind();
+
+    m_Variants.PrintReport(5);
+
+    for (unsigned int i = 0; i < m_Variants.GetVariantCount(); i++)
+    {
+      Shader& shader = m_Variants.GetVariant(i);
+      ShaderDefines keywords = m_Variants.GetKeywords(i);
+      bool animated = std::find(keywords.begin(), keywords.end(), "ANIMATED") != keywords.end();
+      m_RectUniforms.push_back(shader.IsValid() ? shader.GetUniformHandle("u_Rect") : UniformHandle());
+      m_TimeUniforms.push_back(shader.IsValid() && animated ? shader.GetUniformHandle("u_Time") : UniformHandle());
+    }
+  }
+
+  void DemoShaderVariants::OnUpdate(float deltaTime)
+  {
+    m_Time += deltaTime;
+  }
+
+  void DemoShaderVariants::OnRender(Renderer& renderer)
+  {
+    const unsigned int count = m_Variants.GetVariantCount();
+    const unsigned int rows = (count + Columns - 1) / Columns;
+    const float halfWidth = 1.0f / Columns, halfHeight = 1.0f / rows;
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+      Shader& shader = m_Variants.GetVariant(i);
+      if (!shader.IsValid())
+        continue;
+
+      float x = -1.0f + (2 * (i % Columns) + 1) * halfWidth;
+      float y = 1.0f - (2 * (i / Columns) + 1) * halfHeight;
+      shader.Bind();
+      shader.SetUniform4f(m_RectUniforms[i], x, y, halfWidth * 0.9f, halfHeight * 0.9f);
+      if (m_TimeUniforms[i].IsValid())
+        shader.SetUniform1f(m_TimeUniforms[i], m_Time);
+      renderer.Draw(m_VA, *m_IB, shader);
+    }
+  }
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Demo.h"
+
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "ShaderVariants.h"
+
+namespace demo {
+
+  // Every permutation of Material.shader, 200 programs compiled in one
+  // batch at startup, each drawn as a tile of a 20x10 grid
+  class DemoShaderVariants : public Demo
+  {
+  private:
+    VertexArray m_VA;
+    std::unique_ptr<VertexBuffer> m_VB;
+    std::unique_ptr<IndexBuffer> m_IB;
+    ShaderVariants m_Variants;
+    // Per variant, u_Time only exists in the ANIMATED ones
+    std::vector<UniformHandle> m_RectUniforms;
+    std::vector<UniformHandle> m_TimeUniforms;
+    float m_Time;
+  public:
+    DemoShaderVariants();
+
+    void OnUpdate(float deltaTime) override;
+    void OnRender(Renderer& renderer) override;
+  };
+
+}
@@ -0,0 +1,76 @@
+#include "DemoSimulation.h"
+
+#include <cstdlib>
+#include <iostream>
+
+namespace demo {
+
+  static const float BallSize = 0.02f;
+  static const float Gravity = -2.0f;
+
+  static void Step(DemoSimulation::World& world, double dt)
+  {
+    float t = (float)dt;
+    for (DemoSimulation::Ball& ball : world.Balls)
+    {
+      ball.VelocityY += Gravity * t;
+      ball.X += ball.VelocityX * t;
+      ball.Y += ball.VelocityY * t;
+
+      // Bounce off the edges of the screen
+      if (ball.X < -1.0f || ball.X > 1.0f - BallSize)
+      {
+        ball.VelocityX = -ball.VelocityX;
+        ball.X = ball.X < 0.0f ? -1.0f : 1.0f - BallSize;
+      }
+      if (ball.Y < -1.0f)
+      {
+        ball.VelocityY = -ball.VelocityY;
+        ball.Y = -1.0f;
+      }
+    }
+  }
+
+  DemoSimulation::DemoSimulation(double tickRate)
+    : m_BatchShader("OpenGL/res/shaders/Batch.shader"), m_RenderedStateTime(0), m_Frame(0)
+  {
+    World world;
+    srand(3);
+    for (Ball& ball : world.Balls)
+    {
+      ball.X = rand() / (float)RAND_MAX * 2.0f - 1.0f;
+      ball.Y = rand() / (float)RAND_MAX * 2.0f - 1.0f;
+      ball.VelocityX = rand() / (float)RAND_MAX - 0.5f;
+      ball.VelocityY = rand() / (float)RAND_MAX * 2.0f;
+    }
+    m_Simulation.reset(new Simulation<World>(world, tickRate, Step));
+  }
+
+  void DemoSimulation::OnRender(Renderer& renderer)
+  {
+    const SimulationSnapshot<World>& snapshot = m_Simulation->Acquire();
+    if (snapshot.Tick == 0)
+      return;
+
+    float alpha = (float)m_Simulation->GetAlpha(snapshot, Profiler::Now());
+    renderer.BeginBatch(m_BatchShader);
+    for (unsigned int i = 0; i < BallCount; i++)
+    {
+      const Ball& previous = snapshot.Previous.Balls[i];
+      const Ball& current = snapshot.Current.Balls[i];
+      float x = previous.X + (current.X - previous.X) * alpha;
+      float y = previous.Y + (current.Y - previous.Y) * alpha;
+      renderer.SubmitQuad(x, y, BallSize, BallSize, (float)(i % 7) / 7.0f, 0.6f, (float)(i % 13) / 13.0f, 1.0f);
+    }
+    renderer.EndBatch();
+    m_RenderedStateTime = snapshot.PublishTime;
+
+    if (++m_Frame % 120 == 0)
+    {
+      Simulation<World>::Stats stats = m_Simulation->GetStats();
+      std::cout << "Simulation: " << stats.Ticks << " ticks, " << stats.CatchUpTicks << " caught up, "
+        << stats.DroppedTicks << " dropped, " << stats.StepMs << " ms per step, " << stats.LateMs << " ms late" << std::endl;
+    }
+  }
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <memory>
+
+#include "Demo.h"
+
+#include "Shader.h"
+#include "Simulation.h"
+
+namespace demo {
+
+  // Bouncing balls stepped at a low fixed rate on the simulation thread
+  // and drawn with interpolated positions at the display rate
+  class DemoSimulation : public Demo
+  {
+  public:
+    static const unsigned int BallCount = 2000;
+
+    struct Ball
+    {
+      float X, Y;
+      float VelocityX, VelocityY;
+    };
+
+    struct World
+    {
+      std::array<Ball, BallCount> Balls;
+    };
+  private:
+    Shader m_BatchShader;
+    std::unique_ptr<Simulation<World>> m_Simulation;
+    int64_t m_RenderedStateTime;
+    unsigned int m_Frame;
+  public:
+    DemoSimulation(double tickRate = 20.0);
+
+    void OnRender(Renderer& renderer) override;
+    int64_t GetRenderedStateTime() const override { return m_RenderedStateTime; }
+  };
+
+}
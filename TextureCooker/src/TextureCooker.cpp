@@ -0,0 +1,235 @@
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "stb_image.h"
+
+#include "GLDebug.h"
+#include "HeadlessContext.h"
+#include "CookedTexture.h"
+
+// Offline converter from any image stb_image decodes to a .ctex file with
+// a full mip chain and, optionally, block compressed payloads. The
+// compression is done by the GL driver of a headless context, so the
+// available formats depend on the machine that cooks.
+
+struct Level
+{
+  std::vector<unsigned char> Data;
+  int Width, Height;
+};
+
+struct FormatInfo
+{
+  const char* Name;
+  GLenum InternalFormat;
+};
+
+static const FormatInfo s_Formats[] = {
+  { "rgba8", GL_RGBA8 },
+  { "bc7",   GL_COMPRESSED_RGBA_BPTC_UNORM },
+  { "etc2",  GL_COMPRESSED_RGBA8_ETC2_EAC },
+  { "rgtc",  GL_COMPRESSED_RG_RGTC2 }
+};
+
+// Halves an RGBA8 level with a box filter, odd edges reuse the last texel
+static Level Downsample(const Level& source)
+{
+  Level level;
+  level.Width = source.Width > 1 ? source.Width / 2 : 1;
+  level.Height = source.Height > 1 ? source.Height / 2 : 1;
+  level.Data.resize((size_t)level.Width * level.Height * 4);
+
+  for (int y = 0; y < level.Height; y++)
+  {
+    int y0 = std::min(y * 2, source.Height - 1);
+    int y1 = std::min(y * 2 + 1, source.Height - 1);
+    for (int x = 0; x < level.Width; x++)
+    {
+      int x0 = std::min(x * 2, source.Width - 1);
+      int x1 = std::min(x * 2 + 1, source.Width - 1);
+      for (int c = 0; c < 4; c++)
+      {
+        unsigned int sum = source.Data[((size_t)y0 * source.Width + x0) * 4 + c]
+          + source.Data[((size_t)y0 * source.Width + x1) * 4 + c]
+          + source.Data[((size_t)y1 * source.Width + x0) * 4 + c]
+          + source.Data[((size_t)y1 * source.Width + x1) * 4 + c];
+        level.Data[((size_t)y * level.Width + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+      }
+    }
+  }
+  return level;
+}
+
+// Lets the driver encode every level. Returns false if it can't produce
+// the requested format, in which case the levels are left untouched.
+static bool Compress(std::vector<Level>& levels, GLenum internalFormat)
+{
+  unsigned int texture;
+  GLCall(glGenTextures(1, &texture));
+  GLCall(glBindTexture(GL_TEXTURE_2D, texture));
+
+  std::vector<std::vector<unsigned char>> compressed(levels.size());
+  bool success = true;
+  for (size_t i = 0; i < levels.size() && success; i++)
+  {
+    // Drivers refuse to encode some formats (Mesa can't encode ETC2), so
+    // an error here is an expected outcome rather than a bug
+    GLClearError();
+    glTexImage2D(GL_TEXTURE_2D, (GLint)i, internalFormat, levels[i].Width, levels[i].Height, 0,
+      GL_RGBA, GL_UNSIGNED_BYTE, levels[i].Data.data());
+    if (glGetError() != GL_NO_ERROR)
+    {
+      success = false;
+      break;
+    }
+
+    GLint isCompressed = GL_FALSE, actualFormat = 0, size = 0;
+    GLCall(glGetTexLevelParameteriv(GL_TEXTURE_2D, (GLint)i, GL_TEXTURE_COMPRESSED, &isCompressed));
+    GLCall(glGetTexLevelParameteriv(GL_TEXTURE_2D, (GLint)i, GL_TEXTURE_INTERNAL_FORMAT, &actualFormat));
+    if (!isCompressed || (GLenum)actualFormat != internalFormat)
+    {
+      success = false;
+      break;
+    }
+
+    GLCall(glGetTexLevelParameteriv(GL_TEXTURE_2D, (GLint)i, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size));
+    compressed[i].resize(size);
+    GLCall(glGetCompressedTexImage(GL_TEXTURE_2D, (GLint)i, compressed[i].data()));
+  }
+
+  GLCall(glDeleteTextures(1, &texture));
+
+  if (success)
+  {
+    for (size_t i = 0; i < levels.size(); i++)
+      levels[i].Data.swap(compressed[i]);
+  }
+  return success;
+}
+
+static bool Write(const std::string& path, const std::vector<Level>& levels, GLenum internalFormat, bool compressed)
+{
+  CookedTextureHeader header = {};
+  header.Magic = CookedTextureMagic;
+  header.Version = CookedTextureVersion;
+  header.InternalFormat = internalFormat;
+  header.Format = compressed ? 0 : GL_RGBA;
+  header.Type = compressed ? 0 : GL_UNSIGNED_BYTE;
+  header.Width = levels[0].Width;
+  header.Height = levels[0].Height;
+  header.LevelCount = (uint32_t)levels.size();
+
+  std::vector<CookedTextureLevel> table(levels.size());
+  uint64_t offset = sizeof(header) + table.size() * sizeof(CookedTextureLevel);
+  for (size_t i = 0; i < levels.size(); i++)
+  {
+    offset = (offset + 15) & ~(uint64_t)15;
+    table[i] = { offset, (uint32_t)levels[i].Data.size(), (uint32_t)levels[i].Width, (uint32_t)levels[i].Height, 0 };
+    offset += levels[i].Data.size();
+  }
+
+  std::ofstream stream(path, std::ios::binary);
+  if (!stream)
+    return false;
+
+  stream.write((const char*)&header, sizeof(header));
+  stream.write((const char*)table.data(), table.size() * sizeof(CookedTextureLevel));
+  for (size_t i = 0; i < levels.size(); i++)
+  {
+    static const char padding[16] = {};
+    stream.write(padding, table[i].Offset - stream.tellp());
+    stream.write((const char*)levels[i].Data.data(), levels[i].Data.size());
+  }
+  return (bool)stream;
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 3)
+  {
+    std::cout << "Usage: TextureCooker <input> <output" << CookedTextureExtension << "> [--format rgba8|bc7|etc2|rgtc] [--no-mips]" << std::endl;
+    return -1;
+  }
+
+  std::string input = argv[1], output = argv[2];
+  const FormatInfo* format = &s_Formats[0];
+  bool mips = true;
+  for (int i = 3; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--no-mips") == 0)
+    {
+      mips = false;
+    }
+    else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+    {
+      const char* name = argv[++i];
+      format = nullptr;
+      for (const FormatInfo& info : s_Formats)
+      {
+        if (strcmp(info.Name, name) == 0)
+          format = &info;
+      }
+      if (!format)
+      {
+        std::cout << "Unknown format '" << name << "'" << std::endl;
+        return -1;
+      }
+    }
+  }
+
+  // Same orientation as Texture, so cooked and decoded files look alike
+  stbi_set_flip_vertically_on_load(1);
+  Level base;
+  int channels;
+  unsigned char* pixels = stbi_load(input.c_str(), &base.Width, &base.Height, &channels, 4);
+  if (!pixels)
+  {
+    std::cout << "Failed to load '" << input << "': " << stbi_failure_reason() << std::endl;
+    return -1;
+  }
+  base.Data.assign(pixels, pixels + (size_t)base.Width * base.Height * 4);
+  stbi_image_free(pixels);
+
+  std::vector<Level> levels;
+  levels.push_back(std::move(base));
+  while (mips && (levels.back().Width > 1 || levels.back().Height > 1))
+    levels.push_back(Downsample(levels.back()));
+
+  GLenum internalFormat = GL_RGBA8;
+  bool compressed = false;
+  if (format->InternalFormat != GL_RGBA8)
+  {
+    HeadlessContext context(3, 3);
+    glewExperimental = GL_TRUE;
+    GLenum glewStatus = context.IsValid() ? glewInit() : GLEW_ERROR_NO_GL_VERSION;
+    if (!context.IsValid() || (glewStatus != GLEW_OK && glewStatus != GLEW_ERROR_NO_GLX_DISPLAY))
+      std::cout << "No GL context to compress with, writing rgba8" << std::endl;
+    else if (!Compress(levels, format->InternalFormat))
+      std::cout << glGetString(GL_RENDERER) << " can't encode " << format->Name << ", writing rgba8" << std::endl;
+    else
+    {
+      internalFormat = format->InternalFormat;
+      compressed = true;
+    }
+  }
+
+  if (!Write(output, levels, internalFormat, compressed))
+  {
+    std::cout << "Failed to write '" << output << "'" << std::endl;
+    return -1;
+  }
+
+  size_t size = 0;
+  for (const Level& level : levels)
+    size += level.Data.size();
+  std::cout << "Cooked '" << input << "' (" << levels[0].Width << "x" << levels[0].Height << ", "
+    << levels.size() << " levels, " << (compressed ? format->Name : "rgba8") << ", " << size / 1024 << " KiB)" << std::endl;
+  return 0;
+}
@@ -71,6 +71,7 @@ project "OpenGL"
 		links
 		{
 			"GL",
+			"EGL",
 			"dl",
 			"pthread"
 		}
@@ -85,11 +86,223 @@ project "OpenGL"
 			"libopengl32.lib"
 		}
 
+	-- GL_ERROR_CHECKS selects how GLCall checks for errors, see GLDebug.h
+	-- PROFILING=0 strips the profiler markers, see Profiler.h
 	filter "configurations:Debug"
+		defines "GL_ERROR_CHECKS=2"
 		symbols "On"
 
 	filter "configurations:Release"
+		defines "GL_ERROR_CHECKS=1"
 		optimize "On"
 
 	filter "configurations:Dist"
+		defines { "GL_ERROR_CHECKS=0", "PROFILING=0" }
+		optimize "On"
+
+project "TextureCooker"
+	location "TextureCooker"
+	kind "ConsoleApp"
+	language "C++"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+
+	files
+	{
+		"%{prj.name}/src/**.h",
+		"%{prj.name}/src/**.cpp",
+		"OpenGL/src/CookedTexture.h",
+		"OpenGL/src/GLDebug.h",
+		"OpenGL/src/GLDebug.cpp",
+		"OpenGL/src/HeadlessContext.h",
+		"OpenGL/src/HeadlessContext.cpp",
+		"OpenGL/vendor/stb_image/**.h",
+		"OpenGL/vendor/stb_image/**.cpp"
+	}
+
+	includedirs
+	{
+		"%{prj.name}/src",
+		"OpenGL/src",
+		"%{IncludeDir.GLEW}",
+		"%{IncludeDir.stb_image}"
+	}
+
+	libdirs
+	{
+		"OpenGL/vendor/GLEW/lib"
+	}
+
+	links
+	{
+		"GLEW:static"
+	}
+
+	defines
+	{
+		"GLEW_STATIC"
+	}
+
+	filter "system:linux"
+		cppdialect "C++17"
+		staticruntime "On"
+
+		links
+		{
+			"GL",
+			"EGL",
+			"dl"
+		}
+
+	filter "system:windows"
+		cppdialect "C++17"
+		staticruntime "On"
+		systemversion "latest"
+
+		links
+		{
+			"libopengl32.lib"
+		}
+
+	filter "configurations:Debug"
+		defines "GL_ERROR_CHECKS=2"
+		symbols "On"
+
+	filter "configurations:Release"
+		defines "GL_ERROR_CHECKS=1"
+		optimize "On"
+
+	filter "configurations:Dist"
+		defines "GL_ERROR_CHECKS=0"
+		optimize "On"
+
+project "MeshCooker"
+	location "MeshCooker"
+	kind "ConsoleApp"
+	language "C++"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+
+	-- Only headers of the engine, for the vertex formats and GL enums
+	files
+	{
+		"%{prj.name}/src/**.h",
+		"%{prj.name}/src/**.cpp",
+		"OpenGL/src/CookedMesh.h",
+		"OpenGL/src/VertexBufferLayout.h"
+	}
+
+	includedirs
+	{
+		"%{prj.name}/src",
+		"OpenGL/src",
+		"%{IncludeDir.GLEW}"
+	}
+
+	defines
+	{
+		"GLEW_STATIC"
+	}
+
+	filter "system:linux"
+		cppdialect "C++17"
+		staticruntime "On"
+
+	filter "system:windows"
+		cppdialect "C++17"
+		staticruntime "On"
+		systemversion "latest"
+
+	filter "configurations:Debug"
+		symbols "On"
+
+	filter "configurations:Release"
+		optimize "On"
+
+	filter "configurations:Dist"
+		optimize "On"
+
+project "Benchmarks"
+	location "Benchmarks"
+	kind "ConsoleApp"
+	language "C++"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+
+	-- The whole engine except the application and its demos
+	files
+	{
+		"%{prj.name}/src/**.h",
+		"%{prj.name}/src/**.cpp",
+		"OpenGL/src/**.h",
+		"OpenGL/src/**.cpp",
+		"OpenGL/vendor/stb_image/**.h",
+		"OpenGL/vendor/stb_image/**.cpp"
+	}
+
+	removefiles
+	{
+		"OpenGL/src/Application.cpp",
+		"OpenGL/src/demos/**"
+	}
+
+	includedirs
+	{
+		"%{prj.name}/src",
+		"OpenGL/src",
+		"%{IncludeDir.GLEW}",
+		"%{IncludeDir.stb_image}"
+	}
+
+	libdirs
+	{
+		"OpenGL/vendor/GLEW/lib"
+	}
+
+	links
+	{
+		"GLEW:static"
+	}
+
+	defines
+	{
+		"GLEW_STATIC"
+	}
+
+	filter "system:linux"
+		cppdialect "C++17"
+		staticruntime "On"
+
+		links
+		{
+			"GL",
+			"EGL",
+			"dl",
+			"pthread"
+		}
+
+	filter "system:windows"
+		cppdialect "C++17"
+		staticruntime "On"
+		systemversion "latest"
+
+		links
+		{
+			"libopengl32.lib"
+		}
+
+	-- Same defines as the engine, so each configuration measures its build
+	filter "configurations:Debug"
+		defines "GL_ERROR_CHECKS=2"
+		symbols "On"
+
+	filter "configurations:Release"
+		defines "GL_ERROR_CHECKS=1"
+		optimize "On"
+
+	filter "configurations:Dist"
+		defines { "GL_ERROR_CHECKS=0", "PROFILING=0" }
 		optimize "On"